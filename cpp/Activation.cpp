@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Activation.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "Activation.h"
+
+using namespace std;
+
+namespace {
+	// all activations in the order of their values
+	Activation const cActivations[] = { Activation::Clip, Activation::Tanh, Activation::Sigmoid,
+		Activation::ReLU, Activation::TanhRational, Activation::SigmoidRational, Activation::TanhTable,
+		Activation::SigmoidTable };
+
+	template<typename Real>
+	array<Real, activation::cTableSize + 1> MakeTanhTable()
+	{
+		using activation::cTableSize;
+		using activation::cTableRange;
+
+		array<Real, cTableSize + 1> values;
+		for (size_t i = 0; i <= cTableSize; ++i) {
+			values[i] = static_cast<Real>(tanh(-cTableRange + i * (2 * cTableRange / cTableSize)));
+		}
+		return values;
+	}
+}
+
+template<typename Real>
+array<Real, activation::cTableSize + 1> const activation::TanhTableValues<Real>::values = MakeTanhTable<Real>();
+
+template struct activation::TanhTableValues<double>;
+template struct activation::TanhTableValues<float>;
+
+template<typename Real>
+void activation::Apply(Activation const activation, Real* values, size_t const n)
+{
+	Dispatch(activation, [=](auto policy) {
+		decltype(policy)::Apply(values, n);
+	});
+}
+
+template<typename Real>
+void activation::MultiplyDeriv(Activation const activation, Real const* outputs, Real* gradients, size_t const n)
+{
+	Dispatch(activation, [=](auto policy) {
+		decltype(policy)::MultiplyDeriv(outputs, gradients, n);
+	});
+}
+
+bool activation::IsValid(Activation const activation)
+{
+	for (auto known : cActivations) {
+		if (activation == known) return true;
+	}
+	return false;
+}
+
+char const* activation::Name(Activation const activation)
+{
+	switch (activation) {
+	case Activation::Clip: return "clip";
+	case Activation::Tanh: return "tanh";
+	case Activation::Sigmoid: return "sigmoid";
+	case Activation::ReLU: return "relu";
+	case Activation::TanhRational: return "tanh-rational";
+	case Activation::SigmoidRational: return "sigmoid-rational";
+	case Activation::TanhTable: return "tanh-table";
+	case Activation::SigmoidTable: return "sigmoid-table";
+	default: return "unknown";
+	}
+}
+
+Activation activation::Parse(string const& name)
+{
+	for (auto activation : cActivations) {
+		if (name == Name(activation)) return activation;
+	}
+	throw string("Unknown activation function " + name);
+}
+
+template void activation::Apply(Activation const, double*, size_t const);
+template void activation::Apply(Activation const, float*, size_t const);
+template void activation::MultiplyDeriv(Activation const, double const*, double*, size_t const);
+template void activation::MultiplyDeriv(Activation const, float const*, float*, size_t const);
@@ -0,0 +1,268 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Activation.h
+// Date:        2026/10/16
+// Description: Activation functions of the hidden and output layers. Every activation is a
+//              policy struct with the function and its derivative as inline static
+//              templates, a layer picks one per pass (not per neuron) and runs a loop that
+//              is compiled for that policy, so the function is inlined into the loop.
+//
+//              Clip            - the hardware activation, x clipped to [-1, 1]
+//              Tanh, Sigmoid   - std::tanh and 1 / (1 + exp(-x))
+//              ReLU            - max(0, x)
+//              TanhRational    - x * P(x^2) / Q(x^2) with a degree 13/6 rational on
+//                                [-7.905, 7.905], clamped outside, evaluated by
+//                                kernels::Tanh with SIMD
+//              TanhTable       - linear interpolation in a table of 2049 values of tanh
+//                                on [-8, 8], clamped outside
+//              SigmoidRational,
+//              SigmoidTable    - 0.5 + 0.5 * tanh(x / 2) with the approximations above
+//
+//              Error bounds of the approximations (max. |approx(x) - f(x)| over all x,
+//              measured in steps of 1e-5 on [-20, 20]):
+//
+//                                  double      float
+//              TanhRational        2.7e-7      4.0e-7
+//              SigmoidRational     1.3e-7      2.3e-7
+//              TanhTable           5.9e-6      6.3e-6
+//              SigmoidTable        3.0e-6      3.2e-6
+//
+//              The error of TanhRational is mostly the clamping, tanh(7.905) = 1 - 2.7e-7.
+//              The rational needs a division per value, the table only a multiplication
+//              and a load, which is cheaper on targets without a fast divider.
+//
+//              The derivatives take the OUTPUT value of the neuron, like the backward
+//              pass has it at hand. The approximations use the derivative of the function
+//              they approximate. Clip keeps the derivative the net was always trained with,
+//              1 / (1 + y^2): the exact derivative of a clip is 0 once a neuron saturates,
+//              which would stop the training of that neuron for good.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _ACTIVATION
+#define _ACTIVATION
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "Kernels.h"
+
+//-------------------------------------------------------------------------------------------
+///Activation function of a layer, the values are stored in model files
+enum class Activation : uint32_t {
+	Clip = 1, Tanh = 2, Sigmoid = 3, ReLU = 4,
+	TanhRational = 5, SigmoidRational = 6, TanhTable = 7, SigmoidTable = 8
+};
+//-------------------------------------------------------------------------------------------
+///Activations of the layers after the input layer
+typedef std::vector<Activation> Activations;
+
+namespace activation {
+	// number of intervals of the tables and the range they cover, [-cTableRange, cTableRange]
+	size_t const cTableSize = 2048;
+	double const cTableRange = 8.0;
+
+	//-------------------------------------------------------------------------------------
+	///Values of tanh at the cTableSize + 1 borders of the intervals, filled during static
+	///initialization in Activation.cpp
+	template<typename Real>
+	struct TanhTableValues {
+		static std::array<Real, cTableSize + 1> const values;
+	};
+	extern template struct TanhTableValues<double>;
+	extern template struct TanhTableValues<float>;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Loops of a policy over whole rows of a layer. [Policy] provides the
+	///static templates Func and Deriv, a policy with a kernel of its own overrides Apply.
+	template<typename Policy>
+	struct Elementwise {
+		//-------------------------------------------------------------------------------------
+		///Description: values[i] = Func(values[i])
+		template<typename Real>
+		static void Apply(Real* values, size_t const n) {
+			for (size_t i = 0; i < n; ++i) {
+				values[i] = Policy::Func(values[i]);
+			}
+		}
+		//-------------------------------------------------------------------------------------
+		///Description: gradients[i] = gradients[i] * Deriv(outputs[i])
+		template<typename Real>
+		static void MultiplyDeriv(Real const* outputs, Real* gradients, size_t const n) {
+			for (size_t i = 0; i < n; ++i) {
+				gradients[i] = gradients[i] * Policy::Deriv(outputs[i]);
+			}
+		}
+	};
+
+	struct Clip: Elementwise<Clip> {
+		static Activation const id = Activation::Clip;
+		template<typename Real>
+		static Real Func(Real const x) {
+			if (x > Real(1)) return Real(1);
+			else if (x < Real(-1)) return Real(-1);
+			else return x;
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return Real(1) / (Real(1) + y*y);
+		}
+	};
+
+	struct Tanh: Elementwise<Tanh> {
+		static Activation const id = Activation::Tanh;
+		template<typename Real>
+		static Real Func(Real const x) {
+			return std::tanh(x);
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return Real(1) - y*y;
+		}
+	};
+
+	struct Sigmoid: Elementwise<Sigmoid> {
+		static Activation const id = Activation::Sigmoid;
+		template<typename Real>
+		static Real Func(Real const x) {
+			return Real(1) / (Real(1) + std::exp(-x));
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return y * (Real(1) - y);
+		}
+	};
+
+	struct ReLU: Elementwise<ReLU> {
+		static Activation const id = Activation::ReLU;
+		template<typename Real>
+		static Real Func(Real const x) {
+			return (x > Real(0)) ? x : Real(0);
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return (y > Real(0)) ? Real(1) : Real(0);
+		}
+	};
+
+	struct TanhRational: Elementwise<TanhRational> {
+		static Activation const id = Activation::TanhRational;
+		template<typename Real>
+		static Real Func(Real const x) {
+			Real value = x;
+			kernels::Tanh(&value, 1);
+			return value;
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return Tanh::Deriv(y);
+		}
+		// the SIMD kernel instead of the elementwise loop
+		template<typename Real>
+		static void Apply(Real* values, size_t const n) {
+			kernels::Tanh(values, n);
+		}
+	};
+
+	struct SigmoidRational: Elementwise<SigmoidRational> {
+		static Activation const id = Activation::SigmoidRational;
+		template<typename Real>
+		static Real Func(Real const x) {
+			Real value = x;
+			Apply(&value, 1);
+			return value;
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return Sigmoid::Deriv(y);
+		}
+		template<typename Real>
+		static void Apply(Real* values, size_t const n) {
+			for (size_t i = 0; i < n; ++i) {
+				values[i] = Real(0.5) * values[i];
+			}
+			kernels::Tanh(values, n);
+			for (size_t i = 0; i < n; ++i) {
+				values[i] = Real(0.5) + Real(0.5) * values[i];
+			}
+		}
+	};
+
+	struct TanhTable: Elementwise<TanhTable> {
+		static Activation const id = Activation::TanhTable;
+		template<typename Real>
+		static Real Func(Real const x) {
+			// NaN is passed on like by the exact tanh, it has no position in the table
+			if (std::isnan(x)) return x;
+			Real const* values = TanhTableValues<Real>::values.data();
+			// position in the table, clamped to its ends, the last interval also takes the
+			// position cTableSize
+			Real position = (x + Real(cTableRange)) * Real(cTableSize / (2 * cTableRange));
+			position = !(position >= Real(0)) ? Real(0) : position;
+			position = (position > Real(cTableSize)) ? Real(cTableSize) : position;
+			size_t index = static_cast<size_t>(position);
+			index = (index > cTableSize - 1) ? cTableSize - 1 : index;
+			Real const fraction = position - Real(index);
+			return values[index] + fraction * (values[index + 1] - values[index]);
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return Tanh::Deriv(y);
+		}
+	};
+
+	struct SigmoidTable: Elementwise<SigmoidTable> {
+		static Activation const id = Activation::SigmoidTable;
+		template<typename Real>
+		static Real Func(Real const x) {
+			return Real(0.5) + Real(0.5) * TanhTable::Func(Real(0.5) * x);
+		}
+		template<typename Real>
+		static Real Deriv(Real const y) {
+			return Sigmoid::Deriv(y);
+		}
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Call [visitor] with the policy of an activation, e.g.
+	///Dispatch(a, [&](auto policy) { decltype(policy)::Apply(values, n); }). Throws for
+	///unknown activations.
+	template<typename Visitor>
+	void Dispatch(Activation const activation, Visitor&& visitor) {
+		switch (activation) {
+		case Activation::Clip: visitor(Clip()); break;
+		case Activation::Tanh: visitor(Tanh()); break;
+		case Activation::Sigmoid: visitor(Sigmoid()); break;
+		case Activation::ReLU: visitor(ReLU()); break;
+		case Activation::TanhRational: visitor(TanhRational()); break;
+		case Activation::SigmoidRational: visitor(SigmoidRational()); break;
+		case Activation::TanhTable: visitor(TanhTable()); break;
+		case Activation::SigmoidTable: visitor(SigmoidTable()); break;
+		default: throw std::string("Unknown activation function");
+		}
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: Apply an activation to a row of sums in place
+	///Params: [activation] The activation, [values] Sums of the neurons, [n] Number of values
+	template<typename Real>
+	void Apply(Activation const activation, Real* values, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Multiply a row of gradients with the derivative of an activation
+	///Params: [activation] The activation, [outputs] Output values of the neurons,
+	///[gradients] Gradients of the neurons, [n] Number of neurons
+	template<typename Real>
+	void MultiplyDeriv(Activation const activation, Real const* outputs, Real* gradients, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Check if a value (e.g. of a model file) is a known activation
+	bool IsValid(Activation const activation);
+	//-------------------------------------------------------------------------------------
+	///Description: Get a printable name of an activation, e.g. "tanh-rational"
+	char const* Name(Activation const activation);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the activation with a name returned by Name, throws if there is none
+	Activation Parse(std::string const& name);
+}
+
+#endif //_ACTIVATION
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    AllocationCounter.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+using namespace std;
+
+#ifdef NEURO_COUNT_ALLOCATIONS
+static atomic<size_t> allocationCount(0);
+
+static void* CountedAlloc(size_t size)
+{
+	allocationCount.fetch_add(1, memory_order_relaxed);
+	void* ptr = malloc((size > 0) ? size : 1);
+	if (ptr == nullptr) throw bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void* operator new(size_t size, nothrow_t const&) noexcept {
+	allocationCount.fetch_add(1, memory_order_relaxed);
+	return malloc((size > 0) ? size : 1);
+}
+void* operator new[](size_t size, nothrow_t const&) noexcept {
+	allocationCount.fetch_add(1, memory_order_relaxed);
+	return malloc((size > 0) ? size : 1);
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, nothrow_t const&) noexcept { free(ptr); }
+void operator delete[](void* ptr, nothrow_t const&) noexcept { free(ptr); }
+
+bool allocations::isEnabled()
+{
+	return true;
+}
+
+size_t allocations::getCount()
+{
+	return allocationCount.load(memory_order_relaxed);
+}
+#else
+bool allocations::isEnabled()
+{
+	return false;
+}
+
+size_t allocations::getCount()
+{
+	return 0;
+}
+#endif //NEURO_COUNT_ALLOCATIONS
@@ -0,0 +1,24 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    AllocationCounter.h
+// Date:        2026/10/16
+// Description: Test hook that counts heap allocations. When the program is compiled with
+//              NEURO_COUNT_ALLOCATIONS defined, the global operators new and delete are
+//              replaced by versions that count every allocation. Otherwise nothing is
+//              replaced and the count stays 0.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _ALLOCATIONCOUNTER
+#define _ALLOCATIONCOUNTER
+
+#include <cstddef>
+
+namespace allocations {
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the allocations are counted
+	bool isEnabled();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of allocations (of all threads) since program start
+	size_t getCount();
+}
+
+#endif //_ALLOCATIONCOUNTER
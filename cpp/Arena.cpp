@@ -0,0 +1,109 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Arena.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <cstdint>
+#include "Arena.h"
+
+using namespace std;
+
+size_t const Arena::cAlignment;
+
+size_t Arena::Align(size_t const offset)
+{
+	return (offset + cAlignment - 1) / cAlignment * cAlignment;
+}
+
+Arena::Arena()
+{
+}
+
+Arena::Arena(size_t const size)
+{
+	Allocate(size);
+	if (mSize > 0) memset(mData, 0, mSize);
+}
+
+Arena::Arena(Arena const& other)
+{
+	Allocate(other.mSize);
+	if (mSize > 0) memcpy(mData, other.mData, mSize);
+}
+
+Arena::Arena(Arena&& other)
+	: mBlock(other.mBlock), mData(other.mData), mSize(other.mSize)
+{
+	other.mBlock = nullptr;
+	other.mData = nullptr;
+	other.mSize = 0;
+}
+
+Arena& Arena::operator=(Arena const& other)
+{
+	if (this != &other) {
+		// the block is only reallocated if the size changes
+		if (mSize != other.mSize) {
+			Free();
+			Allocate(other.mSize);
+		}
+		if (mSize > 0) memcpy(mData, other.mData, mSize);
+	}
+	return *this;
+}
+
+Arena& Arena::operator=(Arena&& other)
+{
+	if (this != &other) {
+		Free();
+		mBlock = other.mBlock;
+		mData = other.mData;
+		mSize = other.mSize;
+		other.mBlock = nullptr;
+		other.mData = nullptr;
+		other.mSize = 0;
+	}
+	return *this;
+}
+
+Arena::~Arena()
+{
+	Free();
+}
+
+char* Arena::getData()
+{
+	return mData;
+}
+
+char const* Arena::getData() const
+{
+	return mData;
+}
+
+size_t Arena::getSize() const
+{
+	return mSize;
+}
+
+void Arena::Allocate(size_t const size)
+{
+	if (size == 0) return;
+
+	// new only guarantees the alignment of the fundamental types, the block starts at the
+	// first aligned byte of a slightly larger allocation
+	mBlock = new char[size + cAlignment - 1];
+	uintptr_t const address = reinterpret_cast<uintptr_t>(mBlock);
+	mData = mBlock + (Align(address) - address);
+	mSize = size;
+}
+
+void Arena::Free()
+{
+	delete[] mBlock;
+	mBlock = nullptr;
+	mData = nullptr;
+	mSize = 0;
+}
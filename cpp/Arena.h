@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Arena.h
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _ARENA
+#define _ARENA
+
+#include <cstddef>
+#include "Object.h"
+
+//###########################################################################################
+///This class is one aligned block of memory that holds all buffers of an object. The owner
+///sizes the block up front: it places every buffer at an offset rounded up with Align, so
+///each buffer starts on a cache line, and allocates the sum once. The memory is zeroed.
+///Copying an arena is one allocation and one memcpy. Pointers into the source arena that
+///were copied along (e.g. in objects placed in the arena) are translated with Rebase.
+class Arena: public Object
+{
+public:
+	// alignment of the block and of every buffer in bytes (a cache line, enough for any
+	// SIMD load)
+	static size_t const cAlignment = 64;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Round an offset up to the next multiple of cAlignment
+	static size_t Align(size_t const offset);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor of an empty arena
+	Arena();
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, allocates the zeroed block
+	///Params: [size] Size of the block in bytes
+	explicit Arena(size_t const size);
+	//-------------------------------------------------------------------------------------
+	///Description: Copy constructor, copies the whole block at once
+	Arena(Arena const& other);
+	//-------------------------------------------------------------------------------------
+	///Description: Move constructor, takes the block, so pointers into it stay valid
+	Arena(Arena&& other);
+	//-------------------------------------------------------------------------------------
+	///Description: Assignment, copies the whole block at once
+	Arena& operator=(Arena const& other);
+	//-------------------------------------------------------------------------------------
+	///Description: Move assignment, takes the block
+	Arena& operator=(Arena&& other);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, frees the block
+	~Arena();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the first byte of the block (nullptr if empty), it is aligned
+	char* getData();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the first byte of the block (nullptr if empty), it is aligned
+	char const* getData() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the size of the block in bytes
+	size_t getSize() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Translate a pointer into another arena, whose block was copied into
+	///this one, to the same offset in this arena
+	///Params: [pointer] Pointer into [from], [from] The copied arena
+	template<typename T>
+	T* Rebase(T* pointer, Arena const& from) const;
+
+private:
+	//-------------------------------------------------------------------------------------
+	///Description: Allocate an aligned block of [size] bytes, nothing for 0
+	void Allocate(size_t const size);
+	//-------------------------------------------------------------------------------------
+	///Description: Free the block
+	void Free();
+
+	// the allocation and the aligned start of the block in it
+	char* mBlock = nullptr;
+	char* mData = nullptr;
+	size_t mSize = 0;
+};
+
+// called for every pointer of every layer of a copied net, so it is defined here to let
+// the compiler inline it
+template<typename T>
+inline T* Arena::Rebase(T* pointer, Arena const& from) const
+{
+	if (pointer == nullptr) return nullptr;
+	size_t const offset = reinterpret_cast<char const*>(pointer) - from.mData;
+	return reinterpret_cast<T*>(mData + offset);
+}
+#endif //_ARENA
@@ -0,0 +1,605 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Benchmark.cpp
+// Date:        2026/10/16
+// Description: Benchmark suite of the neural net. Construction, copies, ForwardPropagate,
+//              BackPropagate, Train, TrainBatch and Predict are timed on a matrix of
+//              topologies for double and float, ForwardPropagate and Train also for the
+//              fixed-point model of the hardware. Every measurement is repeated and the median
+//              is reported as ns/sample, samples/s and GFLOP/s. The results can be written
+//              as JSON and CSV and compared with the CSV of an earlier run to find
+//              regressions.
+//
+//              GFLOP/s are nominal: a net with W weights (including the bias weights) is
+//              counted with 2W flops per sample for the forward pass and 4W for the backward
+//              pass (propagating the gradients and updating the weights), like it is usual
+//              for dense nets. Activations are not counted.
+//
+//              Denormals are flushed to zero by default: once a net stops learning, its
+//              gradients can decay into the denormal range, and every operation on them
+//              takes a microcode assist (the 2-5-1 net gets about ten times slower after
+//              a million Train calls on random targets). --denormals keeps IEEE behaviour.
+//
+//              Usage: benchmark [options], see PrintUsage
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+#include "NeuralNet.h"
+#include "FixedNeuralNet.h"
+#include "Kernels.h"
+#include "Manipulators.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define HAS_MXCSR
+#endif
+
+using namespace std;
+using namespace ownmanips;
+
+namespace {
+	// distinct samples the operations cycle through
+	size_t const cNumSamples = 64;
+	// samples per call of TrainBatch
+	size_t const cBatchSize = 32;
+	// first line of the CSV output, change it together with the columns
+	char const cCsvHeader[] = "operation,topology,scalar,batch,iterations,repetitions,ns_per_sample,"
+		"ns_per_sample_min,samples_per_second,gflops";
+
+	typedef chrono::steady_clock Clock;
+
+	struct Options {
+		double minTime = 0.2;
+		size_t repetitions = 5;
+		size_t threads = 1;
+		bool quick = false;
+		bool denormals = false;
+		kernels::Isa isa = kernels::DetectIsa();
+		Activation activation = Activation::Clip;
+		vector<LayerSizes> topologies;
+		string filter;
+		string jsonFile;
+		string csvFile;
+		string baselineFile;
+		double tolerance = 0.1;
+	};
+
+	struct Result {
+		string operation;
+		string topology;
+		string scalar;
+		size_t batchSize;
+		size_t iterations;
+		size_t repetitions;
+		double nsPerSample;
+		double nsPerSampleMin;
+		double samplesPerSecond;
+		double gflops;
+	};
+
+	double Identity(double const x)
+	{
+		return x;
+	}
+
+	double Seconds(Clock::duration const duration)
+	{
+		return chrono::duration<double>(duration).count();
+	}
+
+	string TopologyName(LayerSizes const& layerSizes)
+	{
+		string name;
+		for (auto size : layerSizes) {
+			name += (name.empty() ? "" : "-") + to_string(size);
+		}
+		return name;
+	}
+
+	LayerSizes ParseTopology(string const& name)
+	{
+		LayerSizes layerSizes;
+		stringstream stream(name);
+		string size;
+		while (getline(stream, size, '-')) {
+			char* end = nullptr;
+			unsigned long const value = strtoul(size.c_str(), &end, 10);
+			if (size.empty() || *end != '\0' || value == 0) throw string("Invalid topology " + name);
+			layerSizes.push_back(value);
+		}
+		if (layerSizes.size() < 2) throw string("Invalid topology " + name + ", at least two layers are needed");
+		return layerSizes;
+	}
+
+	// weights of all layers, every neuron has one weight per neuron of the previous layer
+	// and one for the bias neuron
+	double CountWeights(LayerSizes const& layerSizes)
+	{
+		double weights = 0;
+		for (size_t i = 1; i < layerSizes.size(); ++i) {
+			weights += double(layerSizes[i - 1] + 1) * layerSizes[i];
+		}
+		return weights;
+	}
+
+	template<typename Real> char const* ScalarName();
+	template<> char const* ScalarName<double>() { return "double"; }
+	template<> char const* ScalarName<float>() { return "float"; }
+	template<> char const* ScalarName<NeuroReal>() { return "fixed"; }
+
+	string CompilerName()
+	{
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + to_string(_MSC_VER);
+#else
+		return "unknown";
+#endif
+	}
+
+	string Timestamp()
+	{
+		time_t const now = time(nullptr);
+		tm utc;
+#ifdef _WIN32
+		gmtime_s(&utc, &now);
+#else
+		gmtime_r(&now, &utc);
+#endif
+		char buffer[32];
+		strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+		return buffer;
+	}
+
+	// sets the flush-to-zero and denormals-are-zero bits of the calling thread, threads
+	// started afterwards inherit them on POSIX systems
+	bool FlushDenormals()
+	{
+#ifdef HAS_MXCSR
+		_mm_setcsr(_mm_getcsr() | 0x8040);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	string JsonString(string const& text)
+	{
+		string quoted = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\') quoted += '\\';
+			if (c == '\n') c = ' ';
+			quoted += c;
+		}
+		return quoted + "\"";
+	}
+
+	// time of one call of Clock::now, subtracted from measurements that time single calls
+	double MeasureClockOverhead()
+	{
+		size_t const calls = 100000;
+		Clock::duration total(0);
+		for (size_t i = 0; i < calls; ++i) {
+			Clock::time_point const start = Clock::now();
+			total += Clock::now() - start;
+		}
+		return Seconds(total) / calls;
+	}
+
+	//---------------------------------------------------------------------------------------
+	///Description: Time an operation. [run] executes the given number of iterations and
+	///returns the seconds they took, so it can leave out work that must not be measured.
+	///The number of iterations is raised until one repetition takes at least the minimum
+	///time, then all repetitions are run with the same number.
+	///Return: ns per sample of every repetition, sorted
+	template<typename Run>
+	vector<double> Measure(Run run, size_t const samplesPerIteration, Options const& options, size_t& iterations)
+	{
+		// warm up caches, branch predictors and the pages of the buffers
+		run(1);
+
+		iterations = 1;
+		for (;;) {
+			double const seconds = run(iterations);
+			if (seconds >= options.minTime) break;
+			double const factor = (seconds > 0) ? 1.2 * options.minTime / seconds : 10;
+			iterations = max(iterations + 1, static_cast<size_t>(iterations * min(factor, 10.0)));
+		}
+
+		vector<double> nsPerSample;
+		for (size_t r = 0; r < options.repetitions; ++r) {
+			nsPerSample.push_back(run(iterations) * 1e9 / (double(iterations) * samplesPerIteration));
+		}
+		sort(nsPerSample.begin(), nsPerSample.end());
+		return nsPerSample;
+	}
+
+	void PrintTableHeader()
+	{
+		cout << left << setw(12) << "Operation" << setw(20) << "Topology" << setw(8) << "Type" << setw(7) << "Batch"
+			<< right << setw(14) << "ns/sample" << setw(14) << "min" << setw(14) << "samples/s" << setw(10) << "GFLOP/s"
+			<< endl;
+	}
+
+	void PrintResult(Result const& result)
+	{
+		cout << left << setw(12) << result.operation << setw(20) << result.topology << setw(8) << result.scalar
+			<< setw(7) << result.batchSize << right << fixed << setprecision(1) << setw(14) << result.nsPerSample
+			<< setw(14) << result.nsPerSampleMin << setprecision(0) << setw(14) << result.samplesPerSecond
+			<< setprecision(2) << setw(10) << result.gflops << endl;
+		cout.unsetf(ios::floatfield | ios::adjustfield);
+		cout << setprecision(6);
+	}
+
+	//---------------------------------------------------------------------------------------
+	///Description: Measure an operation if "operation topology type" contains the filter,
+	///print the result and add it to the results
+	template<typename Run>
+	void Benchmark(string const& operation, string const& topology, string const& scalar, size_t const batchSize,
+		double const flopsPerSample, Run run, Options const& options, vector<Result>& results)
+	{
+		string const name = operation + " " + topology + " " + scalar;
+		if (name.find(options.filter) == string::npos) return;
+
+		Result result = { operation, topology, scalar, batchSize, 0, 0, 0.0, 0.0, 0.0, 0.0 };
+		vector<double> const nsPerSample = Measure(run, batchSize, options, result.iterations);
+		result.repetitions = nsPerSample.size();
+		result.nsPerSample = nsPerSample[nsPerSample.size() / 2];
+		result.nsPerSampleMin = nsPerSample.front();
+		result.samplesPerSecond = 1e9 / result.nsPerSample;
+		result.gflops = flopsPerSample / result.nsPerSample;
+		results.push_back(result);
+		PrintResult(result);
+	}
+
+	//---------------------------------------------------------------------------------------
+	///Description: Run all operations on one topology and number type
+	template<typename Real>
+	void BenchmarkTopology(LayerSizes const& layerSizes, Options const& options, vector<Result>& results)
+	{
+		size_t const inputSize = layerSizes.front();
+		size_t const outputSize = layerSizes.back();
+		string const topology = TopologyName(layerSizes);
+		double const weights = CountWeights(layerSizes);
+		Activations const activations(layerSizes.size() - 1, options.activation);
+
+		// random samples in the range of the activation function, the same for every run
+		mt19937 generator(1);
+		uniform_real_distribution<double> distribution(-1.0, 1.0);
+		BasicData<Real> inputs(cNumSamples * inputSize);
+		BasicData<Real> targets(cNumSamples * outputSize);
+		BasicData<Real> outputs(cNumSamples * outputSize);
+		for (auto& value : inputs) value = static_cast<Real>(distribution(generator));
+		for (auto& value : targets) value = static_cast<Real>(distribution(generator));
+
+		auto benchmark = [&](string const& operation, size_t const batchSize, double const flopsPerSample, auto run) {
+			Benchmark(operation, topology, ScalarName<Real>(), batchSize, flopsPerSample, run, options, results);
+		};
+
+		// construction including the random initialization of all weights, one net per sample
+		benchmark("Construct", 1, 0, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				BasicNeuralNet<Real> net(layerSizes, activations, Identity, cBatchSize);
+			}
+			return Seconds(Clock::now() - start);
+		});
+
+		BasicNeuralNet<Real> net(layerSizes, activations, Identity, cBatchSize);
+
+		// copies of a net, e.g. the replicas of a sweep: a new net allocates its arena, an
+		// existing one of the same topology is overwritten in place
+		benchmark("Clone", 1, 0, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				BasicNeuralNet<Real> clone(net);
+			}
+			return Seconds(Clock::now() - start);
+		});
+
+		BasicNeuralNet<Real> replica(net);
+		benchmark("Assign", 1, 0, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				replica = net;
+			}
+			return Seconds(Clock::now() - start);
+		});
+
+		net.SetThreads(options.threads);
+
+		benchmark("Forward", 1, 2 * weights, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				net.ForwardPropagate(&inputs[i % cNumSamples * inputSize]);
+			}
+			return Seconds(Clock::now() - start);
+		});
+
+		// every backpropagation needs the outputs of its own forward pass, so the calls are
+		// timed one by one
+		double const clockOverhead = MeasureClockOverhead();
+		benchmark("Backprop", 1, 4 * weights, [&](size_t const iterations) {
+			double seconds = 0;
+			for (size_t i = 0; i < iterations; ++i) {
+				net.ForwardPropagate(&inputs[i % cNumSamples * inputSize]);
+				Clock::time_point const start = Clock::now();
+				net.BackPropagate(&targets[i % cNumSamples * outputSize]);
+				seconds += Seconds(Clock::now() - start) - clockOverhead;
+			}
+			return max(seconds, 0.0);
+		});
+
+		benchmark("Train", 1, 6 * weights, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				net.Train(&inputs[i % cNumSamples * inputSize], &targets[i % cNumSamples * outputSize]);
+			}
+			return Seconds(Clock::now() - start);
+		});
+
+		benchmark("TrainBatch", cBatchSize, 6 * weights, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				size_t const first = i * cBatchSize % cNumSamples;
+				net.TrainBatch(&inputs[first * inputSize], &targets[first * outputSize], cBatchSize);
+			}
+			return Seconds(Clock::now() - start);
+		});
+
+		benchmark("Predict", cNumSamples, 2 * weights, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				net.Predict(inputs.data(), cNumSamples, outputs.data());
+			}
+			return Seconds(Clock::now() - start);
+		});
+	}
+
+	//---------------------------------------------------------------------------------------
+	///Description: Forward propagation and training of the fixed-point model of the hardware
+	///(FixedNeuralNet with NeuroReal, always with the clipping activation). Its weights are
+	///updated sample by sample, there are no batches.
+	void BenchmarkFixedTopology(LayerSizes const& layerSizes, Options const& options, vector<Result>& results)
+	{
+		size_t const inputSize = layerSizes.front();
+		size_t const outputSize = layerSizes.back();
+		string const topology = TopologyName(layerSizes);
+		double const weights = CountWeights(layerSizes);
+
+		// the same samples as BenchmarkTopology, rounded to the number format
+		mt19937 generator(1);
+		uniform_real_distribution<double> distribution(-1.0, 1.0);
+		vector<NeuroReal> inputs(cNumSamples * inputSize);
+		vector<NeuroReal> targets(cNumSamples * outputSize);
+		for (auto& value : inputs) value = NeuroReal::FromDouble(distribution(generator));
+		for (auto& value : targets) value = NeuroReal::FromDouble(distribution(generator));
+
+		FixedNeuralNet<NeuroReal> net(layerSizes, Identity);
+
+		Benchmark("Forward", topology, ScalarName<NeuroReal>(), 1, 2 * weights, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				net.ForwardPropagate(&inputs[i % cNumSamples * inputSize]);
+			}
+			return Seconds(Clock::now() - start);
+		}, options, results);
+
+		Benchmark("Train", topology, ScalarName<NeuroReal>(), 1, 6 * weights, [&](size_t const iterations) {
+			Clock::time_point const start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				net.ForwardPropagate(&inputs[i % cNumSamples * inputSize]);
+				net.CalcGradients(&targets[i % cNumSamples * outputSize]);
+				net.UpdateWeights();
+			}
+			return Seconds(Clock::now() - start);
+		}, options, results);
+	}
+
+	void WriteCsv(string const& fileName, vector<Result> const& results)
+	{
+		ofstream file(fileName);
+		if (!file.is_open()) throw string("Could not open " + fileName);
+
+		file << cCsvHeader << '\n' << setprecision(10);
+		for (auto& result : results) {
+			file << result.operation << ',' << result.topology << ',' << result.scalar << ',' << result.batchSize << ','
+				<< result.iterations << ',' << result.repetitions << ',' << result.nsPerSample << ','
+				<< result.nsPerSampleMin << ',' << result.samplesPerSecond << ',' << result.gflops << '\n';
+		}
+		if (!file) throw string("Could not write " + fileName);
+	}
+
+	void WriteJson(string const& fileName, vector<Result> const& results, Options const& options)
+	{
+		ofstream file(fileName);
+		if (!file.is_open()) throw string("Could not open " + fileName);
+
+		file << setprecision(10) << "{\n"
+			<< "  \"timestamp\": " << JsonString(Timestamp()) << ",\n"
+			<< "  \"compiler\": " << JsonString(CompilerName()) << ",\n"
+			<< "  \"isa\": " << JsonString(kernels::IsaName(kernels::GetIsa())) << ",\n"
+			<< "  \"activation\": " << JsonString(activation::Name(options.activation)) << ",\n"
+			<< "  \"threads\": " << options.threads << ",\n"
+			<< "  \"denormals\": " << (options.denormals ? "true" : "false") << ",\n"
+			<< "  \"min_time\": " << options.minTime << ",\n"
+			<< "  \"repetitions\": " << options.repetitions << ",\n"
+			<< "  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			Result const& result = results[i];
+			file << "    { \"operation\": " << JsonString(result.operation)
+				<< ", \"topology\": " << JsonString(result.topology)
+				<< ", \"scalar\": " << JsonString(result.scalar)
+				<< ", \"batch\": " << result.batchSize
+				<< ", \"iterations\": " << result.iterations
+				<< ", \"ns_per_sample\": " << result.nsPerSample
+				<< ", \"ns_per_sample_min\": " << result.nsPerSampleMin
+				<< ", \"samples_per_second\": " << result.samplesPerSecond
+				<< ", \"gflops\": " << result.gflops << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+		}
+		file << "  ]\n}\n";
+		if (!file) throw string("Could not write " + fileName);
+	}
+
+	//---------------------------------------------------------------------------------------
+	///Description: Compare the results with the CSV of an earlier run
+	///Return: Number of measurements that got slower by more than the tolerance
+	size_t CompareWithBaseline(vector<Result> const& results, Options const& options)
+	{
+		ifstream file(options.baselineFile);
+		if (!file.is_open()) throw string("Could not open " + options.baselineFile);
+		string line;
+		if (!getline(file, line) || line != cCsvHeader) throw string(options.baselineFile + " is not a benchmark result");
+
+		// ns/sample of every measurement, the key are the first four columns
+		map<string, double> baseline;
+		while (getline(file, line)) {
+			vector<string> columns;
+			stringstream stream(line);
+			string column;
+			while (getline(stream, column, ',')) columns.push_back(column);
+			if (columns.size() < 7) continue;
+			baseline[columns[0] + "," + columns[1] + "," + columns[2] + "," + columns[3]] = atof(columns[6].c_str());
+		}
+
+		PrintHeader("Comparison with " + options.baselineFile);
+		cout << left << setw(12) << "Operation" << setw(20) << "Topology" << setw(8) << "Type" << setw(7) << "Batch"
+			<< right << setw(14) << "baseline" << setw(14) << "ns/sample" << setw(10) << "change" << endl;
+		size_t regressions = 0;
+		for (auto& result : results) {
+			auto const entry = baseline.find(result.operation + "," + result.topology + "," + result.scalar + "," +
+				to_string(result.batchSize));
+			if (entry == baseline.end() || entry->second <= 0) continue;
+
+			double const change = result.nsPerSample / entry->second - 1;
+			bool const regression = change > options.tolerance;
+			if (regression) ++regressions;
+			cout << left << setw(12) << result.operation << setw(20) << result.topology << setw(8) << result.scalar
+				<< setw(7) << result.batchSize << right << fixed << setprecision(1) << setw(14) << entry->second
+				<< setw(14) << result.nsPerSample << setw(9) << showpos << change * 100 << noshowpos << "%"
+				<< (regression ? "  REGRESSION" : "") << endl;
+		}
+		cout.unsetf(ios::floatfield | ios::adjustfield);
+		cout << setprecision(6);
+		return regressions;
+	}
+
+	void PrintUsage()
+	{
+		cout << "Usage: benchmark [options]" << endl
+			<< "  --quick              short run on the small topologies" << endl
+			<< "  --topology A-B-C     benchmark this topology instead of the default ones (repeatable)" << endl
+			<< "  --filter TEXT        only run measurements whose \"operation topology type\" contains TEXT" << endl
+			<< "  --min-time SECONDS   minimum time of one repetition (default 0.2)" << endl
+			<< "  --repetitions N      repetitions per measurement, the median is reported (default 5)" << endl
+			<< "  --threads N          threads of TrainBatch and Predict (default 1)" << endl
+			<< "  --denormals          don't flush denormals to zero" << endl
+			<< "  --isa NAME           scalar, sse2, avx2 or avx512 (default: best supported)" << endl
+			<< "  --activation NAME    activation of all layers: clip (default), tanh, sigmoid, relu," << endl
+			<< "                       tanh-rational, sigmoid-rational, tanh-table or sigmoid-table" << endl
+			<< "  --json FILE          write the results as JSON" << endl
+			<< "  --csv FILE           write the results as CSV" << endl
+			<< "  --baseline FILE      compare with the CSV of an earlier run, exit code 2 on regressions" << endl
+			<< "  --tolerance PERCENT  slowdown that counts as regression (default 10)" << endl;
+	}
+
+	Options ParseOptions(int const argc, char const* const argv[])
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i) {
+			string const option = argv[i];
+			auto value = [&]() -> string {
+				if (i + 1 >= argc) throw string("Missing value of " + option);
+				return argv[++i];
+			};
+
+			if (option == "--quick") options.quick = true;
+			else if (option == "--denormals") options.denormals = true;
+			else if (option == "--topology") options.topologies.push_back(ParseTopology(value()));
+			else if (option == "--filter") options.filter = value();
+			else if (option == "--min-time") options.minTime = atof(value().c_str());
+			else if (option == "--repetitions") options.repetitions = max(atoi(value().c_str()), 1);
+			else if (option == "--threads") options.threads = max(atoi(value().c_str()), 1);
+			else if (option == "--json") options.jsonFile = value();
+			else if (option == "--csv") options.csvFile = value();
+			else if (option == "--baseline") options.baselineFile = value();
+			else if (option == "--tolerance") options.tolerance = atof(value().c_str()) / 100;
+			else if (option == "--activation") options.activation = activation::Parse(value());
+			else if (option == "--isa") {
+				string const name = value();
+				if (name == "scalar") options.isa = kernels::Isa::Scalar;
+				else if (name == "sse2") options.isa = kernels::Isa::SSE2;
+				else if (name == "avx2") options.isa = kernels::Isa::AVX2;
+				else if (name == "avx512") options.isa = kernels::Isa::AVX512;
+				else throw string("Unknown instruction set " + name);
+			}
+			else throw string("Unknown option " + option);
+		}
+
+		if (options.topologies.empty()) {
+			// from the XOR net of the test driver up to thousands of neurons per layer
+			options.topologies = { { 2, 5, 1 }, { 16, 32, 8 }, { 64, 256, 256, 10 }, { 256, 1024, 1024, 32 } };
+			if (!options.quick) options.topologies.push_back({ 784, 2048, 2048, 10 });
+		}
+		if (options.quick) {
+			options.minTime = min(options.minTime, 0.05);
+			options.repetitions = min<size_t>(options.repetitions, 3);
+		}
+		return options;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	try {
+		options = ParseOptions(argc, argv);
+	}
+	catch (string const& error) {
+		PrintError("Benchmark", error);
+		PrintUsage();
+		return 1;
+	}
+
+	try {
+		// the same weights in every run
+		srand(1);
+		kernels::Isa const isa = kernels::SetIsa(options.isa);
+		if (!options.denormals && !FlushDenormals()) options.denormals = true;
+
+		PrintHeader("Benchmark");
+		cout << "Instruction set: " << kernels::IsaName(isa) << ", activation: " << activation::Name(options.activation)
+			<< ", threads: " << options.threads
+			<< ", denormals: " << (options.denormals ? "kept" : "flushed to zero") << ", repetitions: " << options.repetitions << ", min. time: " << options.minTime << " s" << endl << endl;
+		PrintTableHeader();
+
+		vector<Result> results;
+		for (auto& layerSizes : options.topologies) {
+			BenchmarkTopology<double>(layerSizes, options, results);
+			BenchmarkTopology<float>(layerSizes, options, results);
+			BenchmarkFixedTopology(layerSizes, options, results);
+		}
+
+		if (!options.csvFile.empty()) WriteCsv(options.csvFile, results);
+		if (!options.jsonFile.empty()) WriteJson(options.jsonFile, results, options);
+		if (!options.baselineFile.empty() && CompareWithBaseline(results, options) > 0) return 2;
+	}
+	catch (string const& error) {
+		PrintError("Benchmark", error);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,255 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Dataset.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "Dataset.h"
+
+using namespace std;
+
+namespace {
+	// size of the chunks DatasetWriter collects before writing
+	size_t const cChunkBytes = 1 << 20;
+
+	bool IsSeparator(char const c)
+	{
+		return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// a line that only consists of separators doesn't hold a sample
+	bool IsEmptyLine(char const* begin, char const* end)
+	{
+		return all_of(begin, end, IsSeparator);
+	}
+
+	// the end of the line that starts at [begin], i.e. the position of '\n' or [end]
+	char const* FindLineEnd(char const* begin, char const* end)
+	{
+		char const* lineEnd = static_cast<char const*>(memchr(begin, '\n', end - begin));
+		return (lineEnd != nullptr) ? lineEnd : end;
+	}
+
+	// the mapping isn't null terminated, so every number is copied before it is converted
+	double ParseValue(char const* begin, char const* end, size_t const line)
+	{
+		char buffer[64];
+		size_t const length = end - begin;
+		if (length >= sizeof(buffer)) throw string("Value too long in line " + to_string(line));
+		memcpy(buffer, begin, length);
+		buffer[length] = '\0';
+
+		char* parsed = nullptr;
+		double const value = strtod(buffer, &parsed);
+		if (parsed != buffer + length) throw string("Invalid value in line " + to_string(line));
+		return value;
+	}
+}
+
+template<typename Real>
+Dataset<Real>::Dataset(string const& fileName, bool const sequential)
+	: mFile(fileName)
+{
+	size_t const size = mFile.getSize();
+	if (size < sizeof(dataset::Header)) throw string("Dataset file is too short");
+
+	dataset::Header const& header = *reinterpret_cast<dataset::Header const*>(mFile.getData());
+	if (memcmp(header.magic, dataset::cMagic, sizeof(dataset::cMagic)) != 0) throw string("Not a dataset file");
+	if (header.byteOrder != model::cByteOrder) throw string("Dataset file was written with a different byte order");
+	if (header.version != dataset::cVersion) throw string("Dataset file has version " + to_string(header.version) +
+		", expected " + to_string(dataset::cVersion));
+	if (header.scalar != model::ScalarOf<Real>::value) throw string("Dataset file has a different number type");
+	if (header.fileSize != size) throw string("Dataset file is truncated");
+	if (header.inputSize == 0 || header.outputSize == 0) throw string("Samples must have at least one input and target");
+
+	// both matrices must be aligned and inside the file, the sizes are checked in values per
+	// row first so that corrupt sizes can't overflow
+	size_t const maxValues = size / sizeof(Real);
+	for (uint64_t const rowSize : { header.inputSize, header.outputSize }) {
+		if (rowSize > maxValues || header.count > maxValues / rowSize) throw string("Dataset file is truncated");
+	}
+	uint64_t const inputBytes = header.count * header.inputSize * sizeof(Real);
+	uint64_t const targetBytes = header.count * header.outputSize * sizeof(Real);
+	if (header.inputs % model::cAlignment != 0 || header.targets % model::cAlignment != 0) {
+		throw string("Matrix of the dataset file is not aligned");
+	}
+	if (header.inputs < sizeof(header) || header.inputs > size || inputBytes > size - header.inputs ||
+		header.targets < sizeof(header) || header.targets > size || targetBytes > size - header.targets) {
+		throw string("Dataset file is truncated");
+	}
+
+	mCount = static_cast<size_t>(header.count);
+	mInputSize = static_cast<size_t>(header.inputSize);
+	mOutputSize = static_cast<size_t>(header.outputSize);
+	mInputs = reinterpret_cast<Real const*>(mFile.getData() + header.inputs);
+	mTargets = reinterpret_cast<Real const*>(mFile.getData() + header.targets);
+	if (sequential) mFile.AdviseSequential();
+}
+
+template<typename Real>
+size_t Dataset<Real>::getCount() const
+{
+	return mCount;
+}
+
+template<typename Real>
+size_t Dataset<Real>::getInputSize() const
+{
+	return mInputSize;
+}
+
+template<typename Real>
+size_t Dataset<Real>::getOutputSize() const
+{
+	return mOutputSize;
+}
+
+template<typename Real>
+Real const* Dataset<Real>::getInputs(size_t const index) const
+{
+	return mInputs + index * mInputSize;
+}
+
+template<typename Real>
+Real const* Dataset<Real>::getTargets(size_t const index) const
+{
+	return mTargets + index * mOutputSize;
+}
+
+template<typename Real>
+size_t Dataset<Real>::ConvertCsv(string const& csvFileName, string const& fileName, size_t const inputSize,
+	size_t const outputSize, bool const hasHeader)
+{
+	MappedFile csv(csvFileName);
+	csv.AdviseSequential();
+	char const* begin = reinterpret_cast<char const*>(csv.getData());
+	char const* end = begin + csv.getSize();
+
+	// first pass: count the samples
+	size_t count = 0;
+	bool skipHeader = hasHeader;
+	for (char const* line = begin; line < end;) {
+		char const* lineEnd = FindLineEnd(line, end);
+		if (!IsEmptyLine(line, lineEnd)) {
+			if (skipHeader) skipHeader = false;
+			else ++count;
+		}
+		line = lineEnd + 1;
+	}
+
+	// second pass: parse and write the samples
+	DatasetWriter<Real> writer(fileName, inputSize, outputSize, count);
+	BasicData<Real> values(inputSize + outputSize);
+	size_t lineNumber = 0;
+	skipHeader = hasHeader;
+	for (char const* line = begin; line < end;) {
+		char const* lineEnd = FindLineEnd(line, end);
+		++lineNumber;
+		if (IsEmptyLine(line, lineEnd)) {
+			line = lineEnd + 1;
+			continue;
+		}
+		if (skipHeader) {
+			skipHeader = false;
+			line = lineEnd + 1;
+			continue;
+		}
+
+		size_t numValues = 0;
+		bool tooMany = false;
+		for (char const* value = line; value < lineEnd;) {
+			if (IsSeparator(*value)) {
+				++value;
+				continue;
+			}
+			char const* valueEnd = find_if(value, lineEnd, IsSeparator);
+			if (numValues == values.size()) {
+				tooMany = true;
+				break;
+			}
+			values[numValues++] = static_cast<Real>(ParseValue(value, valueEnd, lineNumber));
+			value = valueEnd;
+		}
+		if (numValues != values.size() || tooMany) {
+			throw string("Line " + to_string(lineNumber) + " doesn't have " + to_string(values.size()) + " values");
+		}
+
+		writer.Append(values.data(), values.data() + inputSize);
+		line = lineEnd + 1;
+	}
+	writer.Close();
+
+	return count;
+}
+
+template<typename Real>
+DatasetWriter<Real>::DatasetWriter(string const& fileName, size_t const inputSize, size_t const outputSize,
+	size_t const count)
+	: mFileName(fileName), mFile(fileName, ios::binary | ios::trunc)
+{
+	if (!mFile.is_open()) throw string("Could not open " + fileName);
+	if (inputSize == 0 || outputSize == 0) throw string("Samples must have at least one input and target");
+
+	memcpy(mHeader.magic, dataset::cMagic, sizeof(mHeader.magic));
+	mHeader.byteOrder = model::cByteOrder;
+	mHeader.version = dataset::cVersion;
+	mHeader.scalar = model::ScalarOf<Real>::value;
+	mHeader.inputSize = inputSize;
+	mHeader.outputSize = outputSize;
+	mHeader.count = count;
+	mHeader.inputs = model::Align(sizeof(mHeader));
+	mHeader.targets = model::Align(mHeader.inputs + count * inputSize * sizeof(Real));
+	mHeader.fileSize = mHeader.targets + count * outputSize * sizeof(Real);
+	mFile.write(reinterpret_cast<char const*>(&mHeader), sizeof(mHeader));
+
+	size_t const chunk = max<size_t>(cChunkBytes / ((inputSize + outputSize) * sizeof(Real)), 1);
+	mInputs.resize(chunk * inputSize);
+	mTargets.resize(chunk * outputSize);
+}
+
+template<typename Real>
+void DatasetWriter<Real>::Append(Real const* inputs, Real const* targets)
+{
+	size_t const inputSize = static_cast<size_t>(mHeader.inputSize);
+	size_t const outputSize = static_cast<size_t>(mHeader.outputSize);
+	if (mWritten + mBuffered == mHeader.count) throw string("More samples than announced for " + mFileName);
+
+	copy(inputs, inputs + inputSize, mInputs.begin() + mBuffered * inputSize);
+	copy(targets, targets + outputSize, mTargets.begin() + mBuffered * outputSize);
+	if (++mBuffered * inputSize == mInputs.size()) Flush();
+}
+
+template<typename Real>
+void DatasetWriter<Real>::Close()
+{
+	Flush();
+	mFile.close();
+	if (!mFile) throw string("Could not write " + mFileName);
+	if (mWritten != mHeader.count) throw string("Less samples than announced for " + mFileName);
+}
+
+template<typename Real>
+void DatasetWriter<Real>::Flush()
+{
+	if (mBuffered == 0) return;
+
+	// the chunk is split into the two matrices, a gap in front of the targets is filled
+	// by the file system
+	size_t const inputBytes = static_cast<size_t>(mHeader.inputSize) * sizeof(Real);
+	size_t const targetBytes = static_cast<size_t>(mHeader.outputSize) * sizeof(Real);
+	mFile.seekp(mHeader.inputs + mWritten * inputBytes);
+	mFile.write(reinterpret_cast<char const*>(mInputs.data()), mBuffered * inputBytes);
+	mFile.seekp(mHeader.targets + mWritten * targetBytes);
+	mFile.write(reinterpret_cast<char const*>(mTargets.data()), mBuffered * targetBytes);
+
+	mWritten += mBuffered;
+	mBuffered = 0;
+}
+
+template class Dataset<double>;
+template class Dataset<float>;
+template class DatasetWriter<double>;
+template class DatasetWriter<float>;
@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Dataset.h
+// Date:        2026/10/16
+// Description: Binary file format of training data. A dataset file starts with a Header,
+//              followed by two row-major matrices in the number type of the net:
+//
+//              Header   64 bytes, see below
+//              Inputs   count x inputSize, starts at a multiple of model::cAlignment
+//              Targets  count x outputSize, starts at a multiple of model::cAlignment
+//
+//              Every row has a fixed stride, so the inputs and targets of a sample (or of
+//              a range of samples for TrainBatch) are addressed directly. All numbers are
+//              stored in the byte order of the machine that wrote the file.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _DATASET
+#define _DATASET
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include "Object.h"
+#include "Layer.h"
+#include "ModelFile.h"
+#include "MappedFile.h"
+
+namespace dataset {
+	char const cMagic[4] = { 'N', 'S', 'E', 'T' };
+	// increase for every change of the format
+	uint32_t const cVersion = 1;
+
+	//-------------------------------------------------------------------------------------
+	///First bytes of a dataset file, [inputs] and [targets] are the file offsets of the
+	///two matrices
+	struct Header {
+		char magic[4];
+		uint32_t byteOrder;
+		uint32_t version;
+		model::Scalar scalar;
+		uint64_t inputSize;
+		uint64_t outputSize;
+		uint64_t count;
+		uint64_t inputs;
+		uint64_t targets;
+		uint64_t fileSize;
+	};
+	static_assert(sizeof(Header) == 64, "The header must not contain padding");
+}
+
+//###########################################################################################
+///This class gives read-only access to a dataset file. The file is mapped into memory and
+///the samples are used where they are: getInputs and getTargets return pointers into the
+///mapping, which can be passed to Train and TrainBatch without copying. Only the pages that
+///are touched are read from disk, so datasets may be much bigger than the memory. The
+///template is instantiated for double and float in Dataset.cpp.
+template<typename Real>
+class Dataset: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, maps and validates the file
+	///Params: [fileName] Name of the file, the number type must match Real, [sequential]
+	///The samples will be read from front to back (see MappedFile::AdviseSequential)
+	explicit Dataset(std::string const& fileName, bool const sequential = true);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of samples
+	size_t getCount() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of input values per sample
+	size_t getInputSize() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of target values per sample
+	size_t getOutputSize() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the inputs of a sample, the inputs of the following samples come
+	///directly after them
+	///Params: [index] Index of the sample
+	///Return: Row-major inputs [(count - index) x input size]
+	Real const* getInputs(size_t const index) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the targets of a sample, the targets of the following samples come
+	///directly after them
+	///Params: [index] Index of the sample
+	///Return: Row-major targets [(count - index) x output size]
+	Real const* getTargets(size_t const index) const;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Convert a text file with one sample per line into a dataset file. The
+	///values of a line are separated by commas, semicolons, spaces or tabs, the first
+	///[inputSize] values are the inputs and the next [outputSize] values the targets. Empty
+	///lines are skipped. The text file is mapped and read twice (once to count the lines),
+	///the memory needed does not depend on its size.
+	///Params: [csvFileName] Name of the text file, [fileName] Name of the dataset file,
+	///[inputSize], [outputSize] Values per sample, [hasHeader] Skip the first line
+	///Return: Number of samples
+	static size_t ConvertCsv(std::string const& csvFileName, std::string const& fileName,
+		size_t const inputSize, size_t const outputSize, bool const hasHeader = false);
+
+private:
+	MappedFile mFile;
+	size_t mCount = 0;
+	size_t mInputSize = 0;
+	size_t mOutputSize = 0;
+	Real const* mInputs = nullptr;
+	Real const* mTargets = nullptr;
+};
+
+//###########################################################################################
+///This class writes a dataset file sample by sample. The number of samples has to be known
+///in advance, the samples are collected in small chunks that are written to the input and
+///target matrices when they are full.
+template<typename Real>
+class DatasetWriter: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, creates the file and writes the header
+	///Params: [fileName] Name of the file, an existing file is overwritten, [inputSize],
+	///[outputSize] Values per sample, [count] Number of samples that will be appended
+	DatasetWriter(std::string const& fileName, size_t const inputSize, size_t const outputSize,
+		size_t const count);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Append a sample
+	///Params: [inputs] Input values, [targets] Target values
+	void Append(Real const* inputs, Real const* targets);
+	//-------------------------------------------------------------------------------------
+	///Description: Write the remaining samples and close the file. Throws if not all
+	///samples were appended or the file couldn't be written.
+	void Close();
+
+private:
+	//-------------------------------------------------------------------------------------
+	///Description: Write the collected samples
+	void Flush();
+
+	std::string mFileName;
+	std::ofstream mFile;
+	dataset::Header mHeader;
+	size_t mWritten = 0;
+	size_t mBuffered = 0;
+	BasicData<Real> mInputs;
+	BasicData<Real> mTargets;
+};
+#endif //_DATASET
@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Fixed.h
+// Date:        2026/10/16
+// Description: Signed fixed-point numbers with the semantics of the VHDL-2008 fixed_pkg
+//              (see syn/ieee/fixed_pkg_c.vhdl), so the C++ model computes bit for bit
+//              what the hardware computes.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _FIXED
+#define _FIXED
+
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+
+//-------------------------------------------------------------------------------------------
+///Rounding of resize, like fixed_round_style_type:
+///Round    - round to nearest, ties to even (fixed_round)
+///Truncate - drop the fractional bits, i.e. round towards -infinity (fixed_truncate)
+enum class FixedRound { Round, Truncate };
+
+//-------------------------------------------------------------------------------------------
+///Overflow handling of resize, like fixed_overflow_style_type:
+///Saturate - clamp to the biggest or smallest value (fixed_saturate)
+///Wrap     - keep the low bits, two's complement wrap around (fixed_wrap)
+enum class FixedOverflow { Saturate, Wrap };
+
+namespace fixedpoint {
+	// number of guard bits of to_sfixed(real) and divide (fixed_guard_bits)
+	int const cGuardBits = 3;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Remove [shift] fractional bits of a value (shift <= 0 appends bits)
+	inline int64_t Shift(int64_t const value, int const shift, FixedRound const round)
+	{
+		if (shift <= 0) return value * (int64_t(1) << -shift);
+
+		// >> of a negative value is an arithmetic shift on all supported compilers
+		int64_t result = value >> shift;
+		if (round == FixedRound::Round) {
+			int64_t const remainder = value - result * (int64_t(1) << shift);
+			int64_t const half = int64_t(1) << (shift - 1);
+			if (remainder > half || (remainder == half && (result & 1) != 0)) {
+				++result;
+			}
+		}
+		return result;
+	}
+}
+
+//###########################################################################################
+///This class represents a signed fixed-point number sfixed(IntBits - 1 downto -FracBits),
+///e.g. Fixed<6, 10> is the neuro_real of the hardware. Like in the fixed_pkg, operations
+///are calculated at full precision and the result is brought back to the format with
+///Resize, which applies the rounding and overflow styles given as template parameters.
+///Formats with up to 16 bits are stored in an int16_t.
+template<int IntBits, int FracBits, FixedRound RoundStyle = FixedRound::Round,
+	FixedOverflow OverflowStyle = FixedOverflow::Saturate>
+class Fixed
+{
+	static_assert(IntBits >= 1 && FracBits >= 0, "A fixed-point number needs at least a sign bit");
+	// the weight update multiplies three numbers at full precision
+	static_assert(3 * (IntBits + FracBits) <= 62, "Intermediate results must fit into 64 bits");
+public:
+	typedef typename std::conditional<(IntBits + FracBits <= 16), int16_t, int32_t>::type Raw;
+
+	static int const cIntBits = IntBits;
+	static int const cFracBits = FracBits;
+	static FixedRound const cRound = RoundStyle;
+	static FixedOverflow const cOverflow = OverflowStyle;
+	static int64_t const cMaxRaw = (int64_t(1) << (IntBits + FracBits - 1)) - 1;
+	static int64_t const cMinRaw = -(int64_t(1) << (IntBits + FracBits - 1));
+
+	Fixed() = default;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Create a number from its two's complement bits
+	static Fixed FromRaw(int64_t const raw) {
+		Fixed result;
+		result.mRaw = static_cast<Raw>(raw);
+		return result;
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Conversion from double like to_sfixed(real): the magnitude is truncated
+	///to FracBits + 3 guard bits, negated and then rounded
+	static Fixed FromDouble(double const x) {
+		double const limit = std::ldexp(1.0, IntBits - 1);
+		double magnitude = std::fabs(x);
+		if (x >= limit || x < -limit) {
+			if (OverflowStyle == FixedOverflow::Saturate) return Resize((x < 0.0) ? -1 : 1, -(IntBits + FracBits));
+			magnitude = std::fmod(magnitude, 2.0 * limit);
+		}
+		int64_t value = static_cast<int64_t>(std::floor(std::ldexp(magnitude, FracBits + fixedpoint::cGuardBits)));
+		if (x < 0.0) value = -value;
+		return Resize(value, FracBits + fixedpoint::cGuardBits);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Resize of a full precision result like resize(arg, IntBits - 1, -FracBits)
+	///Params: [value] Result as integer, [fracBits] Number of fractional bits of value
+	static Fixed Resize(int64_t const value, int const fracBits) {
+		int64_t result = fixedpoint::Shift(value, fracBits - FracBits, RoundStyle);
+		if (OverflowStyle == FixedOverflow::Saturate) {
+			if (result > cMaxRaw) result = cMaxRaw;
+			else if (result < cMinRaw) result = cMinRaw;
+		}
+		else {
+			// keep the low bits and extend the sign
+			int const unused = 64 - (IntBits + FracBits);
+			result = static_cast<int64_t>(static_cast<uint64_t>(result) << unused) >> unused;
+		}
+		return FromRaw(result);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Division like the fixed_pkg "/": the quotient of l = sfixed(.. downto
+	///-lFrac) and r = sfixed(rHigh downto -rFrac) is calculated with 3 guard bits, rounded to
+	///-lFrac - rHigh fractional bits and finally resized to this format.
+	///Params: [l], [r] Operands as integers with [lFrac] and [rFrac] fractional bits,
+	///[rHigh] Index of the sign bit of r
+	static Fixed Divide(int64_t const l, int const lFrac, int64_t const r, int const rHigh,
+		int const rFrac) {
+		int const quotientFrac = lFrac + rHigh;
+		if (r == 0) return Resize((l < 0) ? -1 : 1, -(IntBits + FracBits));
+
+		// the dividend is extended by the fractional bits of the divisor plus the guard bits,
+		// the integer division truncates towards zero like numeric_std
+		int const guardFrac = quotientFrac + fixedpoint::cGuardBits;
+		int64_t const quotient = (l * (int64_t(1) << (guardFrac - lFrac + rFrac))) / r;
+		return Resize(fixedpoint::Shift(quotient, fixedpoint::cGuardBits, RoundStyle), quotientFrac);
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the two's complement bits
+	Raw getRaw() const {
+		return mRaw;
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Conversion to double like to_real, always exact
+	double ToDouble() const {
+		return std::ldexp(static_cast<double>(mRaw), -FracBits);
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: resize(a + b)
+	friend Fixed Add(Fixed const a, Fixed const b) {
+		return Resize(int64_t(a.mRaw) + b.mRaw, FracBits);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: resize(a - b)
+	friend Fixed Sub(Fixed const a, Fixed const b) {
+		return Resize(int64_t(a.mRaw) - b.mRaw, FracBits);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: resize(a * b)
+	friend Fixed Mul(Fixed const a, Fixed const b) {
+		return Resize(int64_t(a.mRaw) * b.mRaw, 2 * FracBits);
+	}
+
+	friend bool operator<(Fixed const a, Fixed const b) { return a.mRaw < b.mRaw; }
+	friend bool operator>(Fixed const a, Fixed const b) { return a.mRaw > b.mRaw; }
+	friend bool operator==(Fixed const a, Fixed const b) { return a.mRaw == b.mRaw; }
+	friend bool operator!=(Fixed const a, Fixed const b) { return a.mRaw != b.mRaw; }
+
+private:
+	Raw mRaw;
+};
+#endif //_FIXED
@@ -0,0 +1,298 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    FixedNeuralNet.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <string>
+#include <type_traits>
+#include "FixedNeuralNet.h"
+#include "Neuron.h"
+#include "Kernels.h"
+
+using namespace std;
+
+namespace {
+	// initial weights of the hardware (package NeuroFPGA)
+	double const cRandomNumbers1[] = { 0.49, 0.82, 0.19, 0.92, 0.56, 0.71, 0.62, 0.01, 0.23, 0.45, 0.93, 0.43, 0.54, 0.66, 0.82 };
+	double const cRandomNumbers2[] = { 0.29, 0.65, 0.93, 0.72, 0.11, 0.02 };
+
+	//###########################################################################################
+	// Element-wise products, scalar version for all formats
+	template<typename Real, typename Enable = void>
+	struct FixedKernels {
+		static void MulArray(Real const* a, Real const* b, Real* c, size_t const n) {
+			for (size_t i = 0; i < n; ++i) {
+				c[i] = Mul(a[i], b[i]);
+			}
+		}
+		static void AxpyArray(Real const a, Real const* x, Real* y, size_t const n) {
+			for (size_t i = 0; i < n; ++i) {
+				y[i] = Add(y[i], Mul(a, x[i]));
+			}
+		}
+	};
+
+	// 16 bit formats with rounding and saturation are what the SIMD kernels calculate
+	template<int IntBits, int FracBits>
+	struct FixedKernels<Fixed<IntBits, FracBits, FixedRound::Round, FixedOverflow::Saturate>,
+		typename enable_if<IntBits + FracBits == 16>::type> {
+		typedef Fixed<IntBits, FracBits, FixedRound::Round, FixedOverflow::Saturate> Real;
+		static_assert(sizeof(Real) == sizeof(int16_t), "Fixed must not contain more than its bits");
+
+		static void MulArray(Real const* a, Real const* b, Real* c, size_t const n) {
+			kernels::MulFixed(reinterpret_cast<int16_t const*>(a), reinterpret_cast<int16_t const*>(b),
+				reinterpret_cast<int16_t*>(c), n, FracBits);
+		}
+		static void AxpyArray(Real const a, Real const* x, Real* y, size_t const n) {
+			kernels::AxpyFixed(a.getRaw(), reinterpret_cast<int16_t const*>(x), reinterpret_cast<int16_t*>(y),
+				n, FracBits);
+		}
+	};
+}
+
+template<typename Real>
+FixedNeuralNet<Real>::FixedNeuralNet(LayerSizes const& layerSizes, ActivationFunc outputActivation)
+	: mLayerSizes(layerSizes), mOutputs(layerSizes.size()), mGradients(layerSizes.size()),
+	mDows(layerSizes.size()), mWeights(layerSizes.size()), mDeltaWeights(layerSizes.size()),
+	mEta(Real::FromDouble(0.15)), mAlpha(Real::FromDouble(0.5)), mError(Real::FromRaw(0)),
+	mOutputActivationFunc(outputActivation)
+{
+	if (layerSizes.size() < 2) throw string("A neural net must have at least an input and an output layer...");
+
+	size_t maxInputs = 0;
+	for (size_t l = 0; l < mLayerSizes.size(); ++l) {
+		size_t const size = mLayerSizes[l];
+		if (size == 0) throw string("A layer must have at least 1 neuron");
+
+		// bias neuron -> force its output val to 1.0
+		mOutputs[l].assign(size + 1, Real::FromRaw(0));
+		mOutputs[l].back() = Real::FromDouble(1.0);
+		mGradients[l].assign(size, Real::FromRaw(0));
+		mDows[l].assign(size, Real::FromRaw(0));
+		if (l == 0) continue;
+
+		// the random weights are drawn in the same order as in Layer
+		size_t const numInputs = mLayerSizes[l - 1] + 1;
+		mWeights[l].assign(size * numInputs, Real::FromRaw(0));
+		mDeltaWeights[l].assign(size * numInputs, Real::FromRaw(0));
+		for (size_t i = 0; i < numInputs; ++i) {
+			for (size_t j = 0; j < size; ++j) {
+				mWeights[l][j * numInputs + i] = Real::FromDouble(Neuron::getRandomWeight());
+			}
+		}
+		if (numInputs > maxInputs) maxInputs = numInputs;
+	}
+
+	mProducts.assign(maxInputs, Real::FromRaw(0));
+	mTargets.assign(mLayerSizes.back(), Real::FromRaw(0));
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::InitHardwareWeights()
+{
+	size_t const length1 = sizeof(cRandomNumbers1) / sizeof(cRandomNumbers1[0]);
+	size_t const length2 = sizeof(cRandomNumbers2) / sizeof(cRandomNumbers2[0]);
+
+	// the connection to input i of neuron j gets the number (j * (prev size + 1) + i) mod
+	// length of the table, which is the index of our row-major weights
+	for (size_t l = 1; l < mLayerSizes.size(); ++l) {
+		for (size_t m = 0; m < mWeights[l].size(); ++m) {
+			double const weight = (l == 1) ? cRandomNumbers1[m % length1] : cRandomNumbers2[m % length2];
+			mWeights[l][m] = Real::FromDouble(weight);
+			mDeltaWeights[l][m] = Real::FromRaw(0);
+		}
+	}
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::setEta(double const eta)
+{
+	mEta = Real::FromDouble(eta);
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::setAlpha(double const alpha)
+{
+	mAlpha = Real::FromDouble(alpha);
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::ForwardPropagate(Data const& input)
+{
+	if (input.size() != mLayerSizes.front()) throw string("Input vector size does not match number of input neurons");
+
+	for (size_t i = 0; i < input.size(); ++i) {
+		mOutputs[0][i] = Real::FromDouble(input[i]);
+	}
+	ForwardPropagate(mOutputs[0].data());
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::ForwardPropagate(Real const* input)
+{
+	Real const minInput = Real::FromDouble(-2.0);
+
+	// pass values to input neurons
+	for (size_t i = 0; i < mLayerSizes[0]; ++i) {
+		mOutputs[0][i] = input[i];
+	}
+
+	for (size_t l = 1; l < mLayerSizes.size(); ++l) {
+		size_t const numInputs = mLayerSizes[l - 1] + 1;
+		Real const* prevOutputs = mOutputs[l - 1].data();
+
+		for (size_t j = 0; j < mLayerSizes[l]; ++j) {
+			// weighted inputs of the connections, the neuron sums them up one after the other
+			// and ignores all that are not above -2.0
+			FixedKernels<Real>::MulArray(prevOutputs, mWeights[l].data() + j * numInputs, mProducts.data(), numInputs);
+			Real sum = Real::FromRaw(0);
+			for (size_t i = 0; i < numInputs; ++i) {
+				if (mProducts[i] > minInput) sum = Add(sum, mProducts[i]);
+			}
+			mOutputs[l][j] = activationFunc(sum);
+		}
+	}
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::CalcGradients(Data const& target)
+{
+	if (target.size() != mLayerSizes.back()) throw string("Number of target values does not match number of output neurons");
+
+	for (size_t i = 0; i < target.size(); ++i) {
+		mTargets[i] = Real::FromDouble(target[i]);
+	}
+	CalcGradients(mTargets.data());
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::CalcGradients(Real const* target)
+{
+	size_t const last = mLayerSizes.size() - 1;
+	size_t const outputSize = mLayerSizes[last];
+
+	// output layer gradients
+	for (size_t j = 0; j < outputSize; ++j) {
+		mDows[last][j] = Sub(target[j], mOutputs[last][j]);
+		mGradients[last][j] = Mul(mDows[last][j], activationFuncDeriv(mOutputs[last][j]));
+	}
+
+	// calculate_sqr: the mean of the squared dows, the VHDL loop runs over a downto range
+	int64_t const fracBits = Real::cFracBits;
+	Real sum = Real::FromRaw(0);
+	for (size_t j = outputSize; j-- > 0;) {
+		int64_t const dow = mDows[last][j].getRaw();
+		sum = Real::Resize(sum.getRaw() * (int64_t(1) << fracBits) + dow * dow, 2 * fracBits);
+	}
+	mError = Real::Divide(sum.getRaw(), fracBits, int64_t(outputSize), Real::cIntBits - 1, 0);
+
+	// hidden layers: sum up the gradients of the next layer weighted by the connections
+	for (size_t l = last - 1; l > 0; --l) {
+		size_t const size = mLayerSizes[l];
+		size_t const nextInputs = size + 1;
+
+		for (size_t j = 0; j < size; ++j) {
+			mDows[l][j] = Real::FromRaw(0);
+		}
+		for (size_t k = 0; k < mLayerSizes[l + 1]; ++k) {
+			FixedKernels<Real>::AxpyArray(mGradients[l + 1][k], mWeights[l + 1].data() + k * nextInputs,
+				mDows[l].data(), size);
+		}
+		for (size_t j = 0; j < size; ++j) {
+			mGradients[l][j] = Mul(mDows[l][j], activationFuncDeriv(mOutputs[l][j]));
+		}
+	}
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::UpdateWeights()
+{
+	Real const minInput = Real::FromDouble(-2.0);
+	int64_t const fracBits = Real::cFracBits;
+	int64_t const eta = mEta.getRaw();
+	int64_t const alpha = mAlpha.getRaw();
+
+	for (size_t l = 1; l < mLayerSizes.size(); ++l) {
+		size_t const numInputs = mLayerSizes[l - 1] + 1;
+		Real const* prevOutputs = mOutputs[l - 1].data();
+
+		for (size_t j = 0; j < mLayerSizes[l]; ++j) {
+			int64_t const etaGradient = eta * mGradients[l][j].getRaw();
+			Real* weights = mWeights[l].data() + j * numInputs;
+			Real* deltaWeights = mDeltaWeights[l].data() + j * numInputs;
+
+			// resize(eta * input * gradient + alpha * deltaWeight) at full precision
+			for (size_t i = 0; i < numInputs; ++i) {
+				if (!(prevOutputs[i] > minInput)) continue;
+				int64_t const delta = etaGradient * prevOutputs[i].getRaw()
+					+ alpha * deltaWeights[i].getRaw() * (int64_t(1) << fracBits);
+				deltaWeights[i] = Real::Resize(delta, 3 * fracBits);
+				weights[i] = Add(weights[i], deltaWeights[i]);
+			}
+		}
+	}
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::BackPropagate(Data const& target)
+{
+	CalcGradients(target);
+	UpdateWeights();
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::Train(Data const& input, Data const& target)
+{
+	ForwardPropagate(input);
+	BackPropagate(target);
+}
+
+template<typename Real>
+Data FixedNeuralNet<Real>::getResults()
+{
+	Data res(mLayerSizes.back());
+	getResults(res.data());
+	return res;
+}
+
+template<typename Real>
+void FixedNeuralNet<Real>::getResults(double* results) const
+{
+	vector<Real> const& outputs = mOutputs.back();
+	for (size_t i = 0; i < mLayerSizes.back(); ++i) {
+		results[i] = mOutputActivationFunc(outputs[i].ToDouble());
+	}
+}
+
+template<typename Real>
+double FixedNeuralNet<Real>::getError() const
+{
+	return mError.ToDouble();
+}
+
+template<typename Real>
+Real FixedNeuralNet<Real>::activationFunc(Real const x)
+{
+	Real const low = Real::FromDouble(-1.0);
+	Real const high = Real::FromDouble(1.0);
+	if (x < low) return low;
+	else if (x > high) return high;
+	else return x;
+}
+
+template<typename Real>
+Real FixedNeuralNet<Real>::activationFuncDeriv(Real const x)
+{
+	// 1 + x * x is sfixed(2 * IntBits downto -2 * FracBits), the integer 1 is converted to
+	// sfixed(2 * IntBits downto 0) before the division
+	int64_t const fracBits = Real::cFracBits;
+	int64_t const square = int64_t(x.getRaw()) * x.getRaw();
+	return Real::Divide(1, 0, (int64_t(1) << (2 * fracBits)) + square, 2 * Real::cIntBits, 2 * fracBits);
+}
+
+template class FixedNeuralNet<NeuroReal>;
+template class FixedNeuralNet<Fixed<8, 8>>;
+template class FixedNeuralNet<Fixed<4, 12>>;
+template class FixedNeuralNet<Fixed<6, 10, FixedRound::Truncate, FixedOverflow::Wrap>>;
+template class FixedNeuralNet<Fixed<8, 12>>;
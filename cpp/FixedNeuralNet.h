@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    FixedNeuralNet.h
+// Date:        2026/10/16
+// Description: Bit-accurate C++ model of the VHDL backpropagation net (src/Backpropagation)
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _FIXEDNET
+#define _FIXEDNET
+
+#include <vector>
+#include "Object.h"
+#include "Fixed.h"
+#include "NeuralNet.h"
+
+//-------------------------------------------------------------------------------------------
+///Number format of the hardware: neuro_real is sfixed(5 downto -10)
+typedef Fixed<6, 10> NeuroReal;
+
+//###########################################################################################
+///This class represents the neural net of the hardware (BP_Net) in fixed-point arithmetic.
+///Every operation is done like in the VHDL code: products and sums are resized to the
+///number format after each step, the activation clips at -1/1 and its derivative is
+///resize(1 / (1 + x * x)). For Real = NeuroReal the results are bit-identical to a
+///simulation of the hardware. Eta and alpha are inputs of the hardware and are not adapted
+///by the net. Formats with 16 bits, rounding and saturation use the 16 bit SIMD kernels.
+///The template is instantiated in FixedNeuralNet.cpp for NeuroReal, Fixed<8, 8> and
+///Fixed<4, 12> (SIMD kernels), NeuroReal with truncation and wrap around and the 20 bit
+///Fixed<8, 12> (scalar code).
+template<typename Real>
+class FixedNeuralNet: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, which takes the nets layerSizes as parameter. The weights
+	///are drawn from rand() in the same order as in NeuralNet.
+	FixedNeuralNet(LayerSizes const& layerSizes, ActivationFunc outputActivation);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Load the initial weights of the hardware (cRandomNumbers1 for the
+	///connections of the input layer, cRandomNumbers2 for all others) and clear the deltas
+	void InitHardwareWeights();
+	//-------------------------------------------------------------------------------------
+	///Description: Set the learning rate like the iEta input of the hardware
+	void setEta(double const eta);
+	//-------------------------------------------------------------------------------------
+	///Description: Set the momentum like the iAlpha input of the hardware
+	void setAlpha(double const alpha);
+
+	//-------------------------------------------------------------------------------------
+	///Description: A forward propagation cycle
+	///Params: [input] Input data
+	void ForwardPropagate(Data const& input);
+	//-------------------------------------------------------------------------------------
+	///Description: A forward propagation cycle without size check
+	///Params: [input] Input values, one per input neuron
+	void ForwardPropagate(Real const* input);
+	//-------------------------------------------------------------------------------------
+	///Description: First half of a backpropagation: calculates the error and the gradients
+	///of all neurons, the weights are not changed yet
+	///Params: [target] Target vector
+	void CalcGradients(Data const& target);
+	//-------------------------------------------------------------------------------------
+	///Description: CalcGradients without size check
+	///Params: [target] Target values, one per output neuron
+	void CalcGradients(Real const* target);
+	//-------------------------------------------------------------------------------------
+	///Description: Second half of a backpropagation: update all weights at once with the
+	///gradients of CalcGradients, like the iUpdateWeight pulse of the hardware
+	void UpdateWeights();
+	//-------------------------------------------------------------------------------------
+	///Description: Backpropagation - CalcGradients and UpdateWeights
+	///Params: [target] Target vector
+	void BackPropagate(Data const& target);
+	//-------------------------------------------------------------------------------------
+	///Description: Training cycle - forward- and backpropagation
+	///Params: [input] Input data, [target] Target vector
+	void Train(Data const& input, Data const& target);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the results of a forwardpropagation
+	///Return: Data vector
+	Data getResults();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the results of a forwardpropagation without allocating memory
+	///Params: [results] Receives one value per output neuron
+	void getResults(double* results) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the mean squared output error of the last CalcGradients (oError)
+	double getError() const;
+
+private:
+	//-------------------------------------------------------------------------------------
+	///Description: neuro_activation_func - clips at cActLow and cActHigh
+	static Real activationFunc(Real const x);
+	//-------------------------------------------------------------------------------------
+	///Description: neuro_activation_deriv - resize(1 / (1 + x * x))
+	static Real activationFuncDeriv(Real const x);
+
+	LayerSizes mLayerSizes;
+	// per layer: outputs (the last one belongs to the bias neuron), gradients, dows and the
+	// row-major weights and delta weights (one row of inputs per neuron)
+	std::vector<std::vector<Real>> mOutputs;
+	std::vector<std::vector<Real>> mGradients;
+	std::vector<std::vector<Real>> mDows;
+	std::vector<std::vector<Real>> mWeights;
+	std::vector<std::vector<Real>> mDeltaWeights;
+	std::vector<Real> mProducts;
+	std::vector<Real> mTargets;
+	Real mEta;
+	Real mAlpha;
+	Real mError;
+	const ActivationFunc mOutputActivationFunc;
+};
+#endif //_FIXEDNET
@@ -0,0 +1,98 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Initializer.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <cmath>
+#include "Initializer.h"
+
+using namespace std;
+
+namespace {
+	Initializer const cInitializers[] = {
+		Initializer::Rand, Initializer::Uniform, Initializer::XavierUniform, Initializer::XavierNormal,
+		Initializer::HeUniform, Initializer::HeNormal
+	};
+
+	// the counter of a weight: connection, neuron and layer, the last word is left for
+	// other streams of the same seed
+	Philox::Block Counter(size_t const layer, size_t const neuron, size_t const connection)
+	{
+		return { { static_cast<uint32_t>(connection), static_cast<uint32_t>(neuron), static_cast<uint32_t>(layer), 0 } };
+	}
+}
+
+initializer::Settings initializer::Make(Initializer const type, uint64_t const seed)
+{
+	Settings settings = { type, seed };
+	Validate(settings);
+	return settings;
+}
+
+void initializer::Validate(Settings const& settings)
+{
+	if (!IsValid(settings.type)) throw string("Unknown initializer");
+}
+
+bool initializer::IsCounterBased(Initializer const type)
+{
+	return IsValid(type) && type != Initializer::Rand;
+}
+
+bool initializer::IsValid(Initializer const type)
+{
+	for (auto known : cInitializers) {
+		if (type == known) return true;
+	}
+	return false;
+}
+
+char const* initializer::Name(Initializer const type)
+{
+	switch (type) {
+	case Initializer::Rand: return "rand";
+	case Initializer::Uniform: return "uniform";
+	case Initializer::XavierUniform: return "xavier-uniform";
+	case Initializer::XavierNormal: return "xavier-normal";
+	case Initializer::HeUniform: return "he-uniform";
+	case Initializer::HeNormal: return "he-normal";
+	default: return "unknown";
+	}
+}
+
+Initializer initializer::Parse(string const& name)
+{
+	for (auto type : cInitializers) {
+		if (name == Name(type)) return type;
+	}
+	throw string("Unknown initializer " + name);
+}
+
+template<typename Real>
+void initializer::DrawRow(Initializer const type, Philox const& generator, size_t const layer, size_t const neuron,
+	Real* weights, size_t const fanIn, size_t const fanOut)
+{
+	double const fanSum = static_cast<double>(fanIn + fanOut);
+	for (size_t i = 0; i < fanIn; ++i) {
+		Philox::Block const counter = Counter(layer, neuron, i);
+		double weight;
+		switch (type) {
+		case Initializer::Uniform: weight = generator.Uniform(counter); break;
+		case Initializer::XavierUniform: weight = sqrt(6.0 / fanSum) * (2.0 * generator.Uniform(counter) - 1.0); break;
+		case Initializer::XavierNormal: weight = sqrt(2.0 / fanSum) * generator.Normal(counter); break;
+		case Initializer::HeUniform: weight = sqrt(6.0 / fanIn) * (2.0 * generator.Uniform(counter) - 1.0); break;
+		case Initializer::HeNormal: weight = sqrt(2.0 / fanIn) * generator.Normal(counter); break;
+		default: throw string("The initializer is not counter-based");
+		}
+		weights[i] = static_cast<Real>(weight);
+	}
+
+	// the bias weight is the last connection
+	weights[fanIn] = static_cast<Real>((type == Initializer::Uniform) ? generator.Uniform(Counter(layer, neuron, fanIn)) : 0.0);
+}
+
+template void initializer::DrawRow(Initializer const type, Philox const& generator, size_t const layer,
+	size_t const neuron, double* weights, size_t const fanIn, size_t const fanOut);
+template void initializer::DrawRow(Initializer const type, Philox const& generator, size_t const layer,
+	size_t const neuron, float* weights, size_t const fanIn, size_t const fanOut);
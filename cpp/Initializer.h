@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Initializer.h
+// Date:        2026/10/16
+// Description: Initializers, the distributions the initial weights of a net are drawn from.
+//              fanIn is the size of the previous layer, fanOut the size of the layer:
+//
+//              Rand            - rand() / RAND_MAX in [0, 1] from the global generator of
+//                                the C library, the weights the net was always built with
+//                                and the default (see BasicNeuron::getRandomWeight)
+//              Uniform         - uniform in [0, 1) like Rand, but counter-based
+//              XavierUniform   - uniform in [-a, a), a = sqrt(6 / (fanIn + fanOut))
+//              XavierNormal    - normal with sigma = sqrt(2 / (fanIn + fanOut))
+//              HeUniform       - uniform in [-a, a), a = sqrt(6 / fanIn)
+//              HeNormal        - normal with sigma = sqrt(2 / fanIn)
+//
+//              Xavier (Glorot and Bengio, 2010) keeps the variance of the signals of
+//              tanh-like activations the same in all layers, He (He et al., 2015) does the
+//              same for ReLU. Their bias weights start at zero, the ones of Uniform are
+//              drawn like the other weights.
+//
+//              All initializers except Rand draw from a Philox generator (see Random.h) with
+//              the seed of the settings: the weight of connection i of neuron j in layer l
+//              is a function of (seed, l, j, i) only. The rows of a layer can be drawn in any
+//              order and on any number of threads with bit-identical results, and a net of
+//              the same seed and topology always starts with the same weights, independent
+//              of the state of rand().
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _INITIALIZER
+#define _INITIALIZER
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "Random.h"
+
+//-------------------------------------------------------------------------------------------
+///Initializer of the weights of a net
+enum class Initializer : uint32_t {
+	Rand = 1, Uniform = 2, XavierUniform = 3, XavierNormal = 4, HeUniform = 5, HeNormal = 6
+};
+
+namespace initializer {
+	//-------------------------------------------------------------------------------------
+	///How the weights of a net are drawn
+	struct Settings {
+		Initializer type;
+		// key of the Philox generator, not used by Rand
+		uint64_t seed;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the settings of an initializer with a seed
+	Settings Make(Initializer const type, uint64_t const seed);
+	//-------------------------------------------------------------------------------------
+	///Description: Check the settings, throws if the initializer is unknown
+	void Validate(Settings const& settings);
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the initializer draws from a Philox generator, so the
+	///rows of a layer can be drawn in parallel
+	bool IsCounterBased(Initializer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the value is one of the initializers
+	bool IsValid(Initializer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the name of an initializer, e.g. "he-normal"
+	char const* Name(Initializer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the initializer of a name, throws if there is none
+	Initializer Parse(std::string const& name);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Draw the input weights of a neuron with a counter-based initializer
+	///Params: [type] The initializer, not Rand, [generator] Generator with the seed of the
+	///net, [layer] Index of the layer, [neuron] Index of the neuron in the layer, [weights]
+	///Receives the row [fanIn + 1], the last weight is the bias weight, [fanIn] Size of the
+	///previous layer, [fanOut] Size of the layer
+	template<typename Real>
+	void DrawRow(Initializer const type, Philox const& generator, size_t const layer, size_t const neuron,
+		Real* weights, size_t const fanIn, size_t const fanOut);
+}
+#endif //_INITIALIZER
@@ -0,0 +1,2156 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Kernels.cpp
+// Date:        2026/10/16
+// Description: Scalar, SSE2, AVX2 and AVX-512 versions of the kernels for double, float and
+//              16 bit fixed-point numbers and the runtime dispatch between them.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// the element-wise kernels must not be contracted to fused multiply-adds, otherwise they
+// would no longer match the scalar reference bit for bit. Every compiler has its own switch:
+// MSVC only contracts with /fp:fast or /fp:contract, the projects build with the default
+// /fp:precise and the pragma keeps it off for this file in any case.
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma fp_contract (off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include <cmath>
+#include <atomic>
+#include "Kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NEURO_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define NEURO_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NEURO_TARGET(isa)
+#endif
+
+using namespace std;
+
+namespace {
+	//###########################################################################################
+	// Scalar reference kernels for double and float
+	template<typename Real>
+	Real DotScalar(Real const* a, Real const* b, size_t const n)
+	{
+		Real sum = 0;
+		for (size_t i = 0; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	template<typename Real>
+	void AxpyScalar(Real const a, Real const* x, Real* y, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			y[i] += x[i] * a;
+		}
+	}
+
+	template<typename Real>
+	void UpdateWeightsScalar(Real* weights, Real* deltaWeights, Real const* inputs,
+		Real const eta, Real const gradient, Real const alpha, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			Real newDeltaWeight = eta * inputs[i] * gradient + alpha * deltaWeights[i];
+			deltaWeights[i] = newDeltaWeight;
+			weights[i] += newDeltaWeight;
+		}
+	}
+
+	template<typename Real>
+	void UpdateNesterovScalar(Real* weights, Real* velocities, Real const* inputs,
+		Real const eta, Real const gradient, Real const alpha, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			Real const step = eta * inputs[i] * gradient;
+			Real const velocity = alpha * velocities[i] + step;
+			velocities[i] = velocity;
+			weights[i] += alpha * velocity + step;
+		}
+	}
+
+	template<typename Real>
+	void UpdateRMSPropScalar(Real* weights, Real* squares, Real const* inputs,
+		Real const eta, Real const gradient, Real const decay, Real const epsilon, size_t const n)
+	{
+		Real const rest = 1 - decay;
+		for (size_t i = 0; i < n; ++i) {
+			Real const g = inputs[i] * gradient;
+			Real const square = decay * squares[i] + rest * (g * g);
+			squares[i] = square;
+			weights[i] += eta * g / (sqrt(square) + epsilon);
+		}
+	}
+
+	template<typename Real>
+	void UpdateAdamScalar(Real* weights, Real* moments, Real* squares, Real const* inputs,
+		Real const eta, Real const gradient, Real const beta1, Real const beta2, Real const epsilon, size_t const n)
+	{
+		Real const rest1 = 1 - beta1;
+		Real const rest2 = 1 - beta2;
+		for (size_t i = 0; i < n; ++i) {
+			Real const g = inputs[i] * gradient;
+			Real const moment = beta1 * moments[i] + rest1 * g;
+			Real const square = beta2 * squares[i] + rest2 * (g * g);
+			moments[i] = moment;
+			squares[i] = square;
+			weights[i] += eta * moment / (sqrt(square) + epsilon);
+		}
+	}
+
+	template<typename Real>
+	void Dot4Scalar(Real const* a, Real const* b0, Real const* b1, Real const* b2,
+		Real const* b3, size_t const n, Real* sums)
+	{
+		sums[0] = DotScalar(a, b0, n);
+		sums[1] = DotScalar(a, b1, n);
+		sums[2] = DotScalar(a, b2, n);
+		sums[3] = DotScalar(a, b3, n);
+	}
+
+	template<typename Real>
+	Real SparseDotScalar(Real const* values, uint32_t const* columns, Real const* x, size_t const n)
+	{
+		Real sum = 0;
+		for (size_t i = 0; i < n; ++i) {
+			sum += values[i] * x[columns[i]];
+		}
+		return sum;
+	}
+
+	template<typename Real>
+	void GatherScalar(Real const* x, uint32_t const* columns, Real* y, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			y[i] = x[columns[i]];
+		}
+	}
+
+	template<typename Real>
+	void GatherAxpyScalar(Real const a, Real const* x, uint32_t const* columns, Real* y, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			y[i] += x[columns[i]] * a;
+		}
+	}
+
+	template<typename Real>
+	void ScatterAxpyScalar(Real const a, Real const* x, uint32_t const* columns, Real* y, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			y[columns[i]] += x[i] * a;
+		}
+	}
+
+	template<typename Real>
+	void MultiplyScalar(Real const* x, Real* y, size_t const n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			y[i] *= x[i];
+		}
+	}
+
+	// rational approximation of tanh on [-cTanhClamp, cTanhClamp]: x * P(x^2) / Q(x^2), the
+	// coefficients are in the order of the Horner scheme, the values outside are clamped.
+	// NaN is passed on: the comparisons are false for it and the SIMD min/max return their
+	// second operand if one is NaN, which is the value.
+	double const cTanhClamp = 7.90531110763549805;
+	double const cTanhP[7] = { -2.76076847742355e-16, 2.00018790482477e-13, -8.60467152213735e-11,
+		5.12229709037114e-08, 1.48572235717979e-05, 6.37261928875436e-04, 4.89352455891786e-03 };
+	double const cTanhQ[4] = { 1.19825839466702e-06, 1.18534705686654e-04, 2.26843463243900e-03,
+		4.89352518554385e-03 };
+
+	template<typename Real>
+	void TanhScalar(Real* values, size_t const n)
+	{
+		Real const clamp = static_cast<Real>(cTanhClamp);
+		for (size_t i = 0; i < n; ++i) {
+			Real x = (values[i] < -clamp) ? -clamp : values[i];
+			x = (x > clamp) ? clamp : x;
+			Real const x2 = x * x;
+			Real p = static_cast<Real>(cTanhP[0]);
+			for (size_t k = 1; k < 7; ++k) {
+				p = p * x2 + static_cast<Real>(cTanhP[k]);
+			}
+			Real q = static_cast<Real>(cTanhQ[0]);
+			for (size_t k = 1; k < 4; ++k) {
+				q = q * x2 + static_cast<Real>(cTanhQ[k]);
+			}
+			values[i] = x * p / q;
+		}
+	}
+
+	int16_t MulFixedScalar(int16_t const a, int16_t const b, int const fracBits)
+	{
+		// round to nearest, ties to even: add half an LSB minus one, plus one if the
+		// truncated result is odd
+		int32_t const product = int32_t(a) * b;
+		int32_t const half = (fracBits > 0) ? (1 << (fracBits - 1)) - 1 + ((product >> fracBits) & 1) : 0;
+		int32_t const result = (product + half) >> fracBits;
+		return static_cast<int16_t>((result > INT16_MAX) ? INT16_MAX : (result < INT16_MIN) ? INT16_MIN : result);
+	}
+
+	int16_t AddFixedScalar(int16_t const a, int16_t const b)
+	{
+		int32_t const result = int32_t(a) + b;
+		return static_cast<int16_t>((result > INT16_MAX) ? INT16_MAX : (result < INT16_MIN) ? INT16_MIN : result);
+	}
+
+	void MulFixedScalar(int16_t const* a, int16_t const* b, int16_t* c, size_t const n, int const fracBits)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			c[i] = MulFixedScalar(a[i], b[i], fracBits);
+		}
+	}
+
+	void AxpyFixedScalar(int16_t const a, int16_t const* x, int16_t* y, size_t const n, int const fracBits)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			y[i] = AddFixedScalar(y[i], MulFixedScalar(a, x[i], fracBits));
+		}
+	}
+
+	int32_t DotInt8Scalar(int8_t const* a, int8_t const* b, size_t const n)
+	{
+		int32_t sum = 0;
+		for (size_t i = 0; i < n; ++i) {
+			sum += int32_t(a[i]) * b[i];
+		}
+		return sum;
+	}
+
+	void Dot4Int8Scalar(int8_t const* a, int8_t const* b0, int8_t const* b1, int8_t const* b2,
+		int8_t const* b3, size_t const n, int32_t* sums)
+	{
+		sums[0] = DotInt8Scalar(a, b0, n);
+		sums[1] = DotInt8Scalar(a, b1, n);
+		sums[2] = DotInt8Scalar(a, b2, n);
+		sums[3] = DotInt8Scalar(a, b3, n);
+	}
+
+#ifdef NEURO_X86
+	//###########################################################################################
+	// SSE2 kernels
+	double HorizontalSum(__m128d v)
+	{
+		double lanes[2];
+		_mm_storeu_pd(lanes, v);
+		return lanes[0] + lanes[1];
+	}
+
+	// rows that are shorter than one loop iteration skip the horizontal sums, which
+	// gives the same result: the vector part would only add zeros
+	double DotSSE2(double const* a, double const* b, size_t const n)
+	{
+		if (n < 4) return DotScalar(a, b, n);
+		__m128d sum0 = _mm_setzero_pd();
+		__m128d sum1 = _mm_setzero_pd();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+			sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+		}
+		double sum = HorizontalSum(_mm_add_pd(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	void AxpySSE2(double const a, double const* x, double* y, size_t const n)
+	{
+		__m128d va = _mm_set1_pd(a);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d vy = _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(_mm_loadu_pd(x + i), va));
+			_mm_storeu_pd(y + i, vy);
+		}
+		AxpyScalar(a, x + i, y + i, n - i);
+	}
+
+	void UpdateWeightsSSE2(double* weights, double* deltaWeights, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n)
+	{
+		__m128d vEta = _mm_set1_pd(eta);
+		__m128d vGradient = _mm_set1_pd(gradient);
+		__m128d vAlpha = _mm_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d delta = _mm_add_pd(
+				_mm_mul_pd(_mm_mul_pd(vEta, _mm_loadu_pd(inputs + i)), vGradient),
+				_mm_mul_pd(vAlpha, _mm_loadu_pd(deltaWeights + i)));
+			_mm_storeu_pd(deltaWeights + i, delta);
+			_mm_storeu_pd(weights + i, _mm_add_pd(_mm_loadu_pd(weights + i), delta));
+		}
+		UpdateWeightsScalar(weights + i, deltaWeights + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	void UpdateNesterovSSE2(double* weights, double* velocities, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n)
+	{
+		__m128d vEta = _mm_set1_pd(eta);
+		__m128d vGradient = _mm_set1_pd(gradient);
+		__m128d vAlpha = _mm_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d step = _mm_mul_pd(_mm_mul_pd(vEta, _mm_loadu_pd(inputs + i)), vGradient);
+			__m128d velocity = _mm_add_pd(_mm_mul_pd(vAlpha, _mm_loadu_pd(velocities + i)), step);
+			_mm_storeu_pd(velocities + i, velocity);
+			_mm_storeu_pd(weights + i, _mm_add_pd(_mm_loadu_pd(weights + i), _mm_add_pd(_mm_mul_pd(vAlpha, velocity), step)));
+		}
+		UpdateNesterovScalar(weights + i, velocities + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	void UpdateRMSPropSSE2(double* weights, double* squares, double const* inputs,
+		double const eta, double const gradient, double const decay, double const epsilon, size_t const n)
+	{
+		__m128d vEta = _mm_set1_pd(eta);
+		__m128d vGradient = _mm_set1_pd(gradient);
+		__m128d vDecay = _mm_set1_pd(decay);
+		__m128d vRest = _mm_set1_pd(1 - decay);
+		__m128d vEpsilon = _mm_set1_pd(epsilon);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d g = _mm_mul_pd(_mm_loadu_pd(inputs + i), vGradient);
+			__m128d square = _mm_add_pd(_mm_mul_pd(vDecay, _mm_loadu_pd(squares + i)), _mm_mul_pd(vRest, _mm_mul_pd(g, g)));
+			_mm_storeu_pd(squares + i, square);
+			__m128d step = _mm_div_pd(_mm_mul_pd(vEta, g), _mm_add_pd(_mm_sqrt_pd(square), vEpsilon));
+			_mm_storeu_pd(weights + i, _mm_add_pd(_mm_loadu_pd(weights + i), step));
+		}
+		UpdateRMSPropScalar(weights + i, squares + i, inputs + i, eta, gradient, decay, epsilon, n - i);
+	}
+
+	void UpdateAdamSSE2(double* weights, double* moments, double* squares, double const* inputs,
+		double const eta, double const gradient, double const beta1, double const beta2, double const epsilon, size_t const n)
+	{
+		__m128d vEta = _mm_set1_pd(eta);
+		__m128d vGradient = _mm_set1_pd(gradient);
+		__m128d vBeta1 = _mm_set1_pd(beta1);
+		__m128d vBeta2 = _mm_set1_pd(beta2);
+		__m128d vRest1 = _mm_set1_pd(1 - beta1);
+		__m128d vRest2 = _mm_set1_pd(1 - beta2);
+		__m128d vEpsilon = _mm_set1_pd(epsilon);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d g = _mm_mul_pd(_mm_loadu_pd(inputs + i), vGradient);
+			__m128d moment = _mm_add_pd(_mm_mul_pd(vBeta1, _mm_loadu_pd(moments + i)), _mm_mul_pd(vRest1, g));
+			__m128d square = _mm_add_pd(_mm_mul_pd(vBeta2, _mm_loadu_pd(squares + i)), _mm_mul_pd(vRest2, _mm_mul_pd(g, g)));
+			_mm_storeu_pd(moments + i, moment);
+			_mm_storeu_pd(squares + i, square);
+			__m128d step = _mm_div_pd(_mm_mul_pd(vEta, moment), _mm_add_pd(_mm_sqrt_pd(square), vEpsilon));
+			_mm_storeu_pd(weights + i, _mm_add_pd(_mm_loadu_pd(weights + i), step));
+		}
+		UpdateAdamScalar(weights + i, moments + i, squares + i, inputs + i, eta, gradient, beta1, beta2, epsilon, n - i);
+	}
+
+	void Dot4SSE2(double const* a, double const* b0, double const* b1, double const* b2,
+		double const* b3, size_t const n, double* sums)
+	{
+		if (n < 2) return Dot4Scalar(a, b0, b1, b2, b3, n, sums);
+		__m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+		__m128d sum2 = _mm_setzero_pd(), sum3 = _mm_setzero_pd();
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d va = _mm_loadu_pd(a + i);
+			sum0 = _mm_add_pd(sum0, _mm_mul_pd(va, _mm_loadu_pd(b0 + i)));
+			sum1 = _mm_add_pd(sum1, _mm_mul_pd(va, _mm_loadu_pd(b1 + i)));
+			sum2 = _mm_add_pd(sum2, _mm_mul_pd(va, _mm_loadu_pd(b2 + i)));
+			sum3 = _mm_add_pd(sum3, _mm_mul_pd(va, _mm_loadu_pd(b3 + i)));
+		}
+		sums[0] = HorizontalSum(sum0) + DotScalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotScalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotScalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotScalar(a + i, b3 + i, n - i);
+	}
+
+	void TanhSSE2(double* values, size_t const n)
+	{
+		__m128d const clamp = _mm_set1_pd(cTanhClamp);
+		__m128d const minusClamp = _mm_set1_pd(-cTanhClamp);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128d x = _mm_min_pd(clamp, _mm_max_pd(minusClamp, _mm_loadu_pd(values + i)));
+			__m128d x2 = _mm_mul_pd(x, x);
+			__m128d p = _mm_set1_pd(cTanhP[0]);
+			for (size_t k = 1; k < 7; ++k) {
+				p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(cTanhP[k]));
+			}
+			__m128d q = _mm_set1_pd(cTanhQ[0]);
+			for (size_t k = 1; k < 4; ++k) {
+				q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(cTanhQ[k]));
+			}
+			_mm_storeu_pd(values + i, _mm_div_pd(_mm_mul_pd(x, p), q));
+		}
+		TanhScalar(values + i, n - i);
+	}
+
+	float HorizontalSum(__m128 v)
+	{
+		float lanes[4];
+		_mm_storeu_ps(lanes, v);
+		return (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+	}
+
+	float DotSSE2(float const* a, float const* b, size_t const n)
+	{
+		if (n < 8) return DotScalar(a, b, n);
+		__m128 sum0 = _mm_setzero_ps();
+		__m128 sum1 = _mm_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+		}
+		float sum = HorizontalSum(_mm_add_ps(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	void AxpySSE2(float const a, float const* x, float* y, size_t const n)
+	{
+		__m128 va = _mm_set1_ps(a);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 vy = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(x + i), va));
+			_mm_storeu_ps(y + i, vy);
+		}
+		AxpyScalar(a, x + i, y + i, n - i);
+	}
+
+	void UpdateWeightsSSE2(float* weights, float* deltaWeights, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n)
+	{
+		__m128 vEta = _mm_set1_ps(eta);
+		__m128 vGradient = _mm_set1_ps(gradient);
+		__m128 vAlpha = _mm_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 delta = _mm_add_ps(
+				_mm_mul_ps(_mm_mul_ps(vEta, _mm_loadu_ps(inputs + i)), vGradient),
+				_mm_mul_ps(vAlpha, _mm_loadu_ps(deltaWeights + i)));
+			_mm_storeu_ps(deltaWeights + i, delta);
+			_mm_storeu_ps(weights + i, _mm_add_ps(_mm_loadu_ps(weights + i), delta));
+		}
+		UpdateWeightsScalar(weights + i, deltaWeights + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	void UpdateNesterovSSE2(float* weights, float* velocities, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n)
+	{
+		__m128 vEta = _mm_set1_ps(eta);
+		__m128 vGradient = _mm_set1_ps(gradient);
+		__m128 vAlpha = _mm_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 step = _mm_mul_ps(_mm_mul_ps(vEta, _mm_loadu_ps(inputs + i)), vGradient);
+			__m128 velocity = _mm_add_ps(_mm_mul_ps(vAlpha, _mm_loadu_ps(velocities + i)), step);
+			_mm_storeu_ps(velocities + i, velocity);
+			_mm_storeu_ps(weights + i, _mm_add_ps(_mm_loadu_ps(weights + i), _mm_add_ps(_mm_mul_ps(vAlpha, velocity), step)));
+		}
+		UpdateNesterovScalar(weights + i, velocities + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	void UpdateRMSPropSSE2(float* weights, float* squares, float const* inputs,
+		float const eta, float const gradient, float const decay, float const epsilon, size_t const n)
+	{
+		__m128 vEta = _mm_set1_ps(eta);
+		__m128 vGradient = _mm_set1_ps(gradient);
+		__m128 vDecay = _mm_set1_ps(decay);
+		__m128 vRest = _mm_set1_ps(1 - decay);
+		__m128 vEpsilon = _mm_set1_ps(epsilon);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 g = _mm_mul_ps(_mm_loadu_ps(inputs + i), vGradient);
+			__m128 square = _mm_add_ps(_mm_mul_ps(vDecay, _mm_loadu_ps(squares + i)), _mm_mul_ps(vRest, _mm_mul_ps(g, g)));
+			_mm_storeu_ps(squares + i, square);
+			__m128 step = _mm_div_ps(_mm_mul_ps(vEta, g), _mm_add_ps(_mm_sqrt_ps(square), vEpsilon));
+			_mm_storeu_ps(weights + i, _mm_add_ps(_mm_loadu_ps(weights + i), step));
+		}
+		UpdateRMSPropScalar(weights + i, squares + i, inputs + i, eta, gradient, decay, epsilon, n - i);
+	}
+
+	void UpdateAdamSSE2(float* weights, float* moments, float* squares, float const* inputs,
+		float const eta, float const gradient, float const beta1, float const beta2, float const epsilon, size_t const n)
+	{
+		__m128 vEta = _mm_set1_ps(eta);
+		__m128 vGradient = _mm_set1_ps(gradient);
+		__m128 vBeta1 = _mm_set1_ps(beta1);
+		__m128 vBeta2 = _mm_set1_ps(beta2);
+		__m128 vRest1 = _mm_set1_ps(1 - beta1);
+		__m128 vRest2 = _mm_set1_ps(1 - beta2);
+		__m128 vEpsilon = _mm_set1_ps(epsilon);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 g = _mm_mul_ps(_mm_loadu_ps(inputs + i), vGradient);
+			__m128 moment = _mm_add_ps(_mm_mul_ps(vBeta1, _mm_loadu_ps(moments + i)), _mm_mul_ps(vRest1, g));
+			__m128 square = _mm_add_ps(_mm_mul_ps(vBeta2, _mm_loadu_ps(squares + i)), _mm_mul_ps(vRest2, _mm_mul_ps(g, g)));
+			_mm_storeu_ps(moments + i, moment);
+			_mm_storeu_ps(squares + i, square);
+			__m128 step = _mm_div_ps(_mm_mul_ps(vEta, moment), _mm_add_ps(_mm_sqrt_ps(square), vEpsilon));
+			_mm_storeu_ps(weights + i, _mm_add_ps(_mm_loadu_ps(weights + i), step));
+		}
+		UpdateAdamScalar(weights + i, moments + i, squares + i, inputs + i, eta, gradient, beta1, beta2, epsilon, n - i);
+	}
+
+	void Dot4SSE2(float const* a, float const* b0, float const* b1, float const* b2,
+		float const* b3, size_t const n, float* sums)
+	{
+		if (n < 4) return Dot4Scalar(a, b0, b1, b2, b3, n, sums);
+		__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+		__m128 sum2 = _mm_setzero_ps(), sum3 = _mm_setzero_ps();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 va = _mm_loadu_ps(a + i);
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(va, _mm_loadu_ps(b0 + i)));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(va, _mm_loadu_ps(b1 + i)));
+			sum2 = _mm_add_ps(sum2, _mm_mul_ps(va, _mm_loadu_ps(b2 + i)));
+			sum3 = _mm_add_ps(sum3, _mm_mul_ps(va, _mm_loadu_ps(b3 + i)));
+		}
+		sums[0] = HorizontalSum(sum0) + DotScalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotScalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotScalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotScalar(a + i, b3 + i, n - i);
+	}
+
+	void TanhSSE2(float* values, size_t const n)
+	{
+		__m128 const clamp = _mm_set1_ps(static_cast<float>(cTanhClamp));
+		__m128 const minusClamp = _mm_set1_ps(static_cast<float>(-cTanhClamp));
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 x = _mm_min_ps(clamp, _mm_max_ps(minusClamp, _mm_loadu_ps(values + i)));
+			__m128 x2 = _mm_mul_ps(x, x);
+			__m128 p = _mm_set1_ps(static_cast<float>(cTanhP[0]));
+			for (size_t k = 1; k < 7; ++k) {
+				p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(static_cast<float>(cTanhP[k])));
+			}
+			__m128 q = _mm_set1_ps(static_cast<float>(cTanhQ[0]));
+			for (size_t k = 1; k < 4; ++k) {
+				q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(static_cast<float>(cTanhQ[k])));
+			}
+			_mm_storeu_ps(values + i, _mm_div_ps(_mm_mul_ps(x, p), q));
+		}
+		TanhScalar(values + i, n - i);
+	}
+
+	void MultiplySSE2(double const* x, double* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			_mm_storeu_pd(y + i, _mm_mul_pd(_mm_loadu_pd(y + i), _mm_loadu_pd(x + i)));
+		}
+		MultiplyScalar(x + i, y + i, n - i);
+	}
+
+	void MultiplySSE2(float const* x, float* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+		}
+		MultiplyScalar(x + i, y + i, n - i);
+	}
+
+	// rounds 32 bit products like MulFixedScalar, [shift] holds fracBits
+	__m128i RoundFixed(__m128i const product, __m128i const shift, __m128i const half, __m128i const one)
+	{
+		__m128i const odd = _mm_and_si128(_mm_sra_epi32(product, shift), one);
+		return _mm_sra_epi32(_mm_add_epi32(product, _mm_add_epi32(half, odd)), shift);
+	}
+
+	// full precision products of 16 bit numbers, rounded and saturated (packs) to 16 bit
+	__m128i MulFixed(__m128i const a, __m128i const b, __m128i const shift, __m128i const half, __m128i const one)
+	{
+		__m128i const low = _mm_mullo_epi16(a, b);
+		__m128i const high = _mm_mulhi_epi16(a, b);
+		__m128i const product0 = RoundFixed(_mm_unpacklo_epi16(low, high), shift, half, one);
+		__m128i const product1 = RoundFixed(_mm_unpackhi_epi16(low, high), shift, half, one);
+		return _mm_packs_epi32(product0, product1);
+	}
+
+	void MulFixedSSE2(int16_t const* a, int16_t const* b, int16_t* c, size_t const n, int const fracBits)
+	{
+		__m128i const shift = _mm_cvtsi32_si128(fracBits);
+		__m128i const one = _mm_set1_epi32((fracBits > 0) ? 1 : 0);
+		__m128i const half = _mm_set1_epi32((fracBits > 0) ? (1 << (fracBits - 1)) - 1 : 0);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m128i const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+			__m128i const vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(c + i), MulFixed(va, vb, shift, half, one));
+		}
+		MulFixedScalar(a + i, b + i, c + i, n - i, fracBits);
+	}
+
+	void AxpyFixedSSE2(int16_t const a, int16_t const* x, int16_t* y, size_t const n, int const fracBits)
+	{
+		__m128i const shift = _mm_cvtsi32_si128(fracBits);
+		__m128i const one = _mm_set1_epi32((fracBits > 0) ? 1 : 0);
+		__m128i const half = _mm_set1_epi32((fracBits > 0) ? (1 << (fracBits - 1)) - 1 : 0);
+		__m128i const va = _mm_set1_epi16(a);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m128i const vx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(x + i));
+			__m128i const vy = _mm_loadu_si128(reinterpret_cast<__m128i const*>(y + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(y + i), _mm_adds_epi16(vy, MulFixed(va, vx, shift, half, one)));
+		}
+		AxpyFixedScalar(a, x + i, y + i, n - i, fracBits);
+	}
+
+	int32_t HorizontalSum(__m128i v)
+	{
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(v);
+	}
+
+	// products of 16 signed bytes summed up in pairs to 32 bit: the bytes are sign-extended
+	// to 16 bit by unpacking them with themselves and shifting them back
+	__m128i MulAddInt8(__m128i const a, __m128i const b)
+	{
+		__m128i const low = _mm_madd_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(a, a), 8),
+			_mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8));
+		__m128i const high = _mm_madd_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(a, a), 8),
+			_mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8));
+		return _mm_add_epi32(low, high);
+	}
+
+	int32_t DotInt8SSE2(int8_t const* a, int8_t const* b, size_t const n)
+	{
+		__m128i sum = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m128i const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+			sum = _mm_add_epi32(sum, MulAddInt8(va, _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i))));
+		}
+		return HorizontalSum(sum) + DotInt8Scalar(a + i, b + i, n - i);
+	}
+
+	void Dot4Int8SSE2(int8_t const* a, int8_t const* b0, int8_t const* b1, int8_t const* b2,
+		int8_t const* b3, size_t const n, int32_t* sums)
+	{
+		__m128i sum0 = _mm_setzero_si128(), sum1 = _mm_setzero_si128();
+		__m128i sum2 = _mm_setzero_si128(), sum3 = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m128i const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+			sum0 = _mm_add_epi32(sum0, MulAddInt8(va, _mm_loadu_si128(reinterpret_cast<__m128i const*>(b0 + i))));
+			sum1 = _mm_add_epi32(sum1, MulAddInt8(va, _mm_loadu_si128(reinterpret_cast<__m128i const*>(b1 + i))));
+			sum2 = _mm_add_epi32(sum2, MulAddInt8(va, _mm_loadu_si128(reinterpret_cast<__m128i const*>(b2 + i))));
+			sum3 = _mm_add_epi32(sum3, MulAddInt8(va, _mm_loadu_si128(reinterpret_cast<__m128i const*>(b3 + i))));
+		}
+		sums[0] = HorizontalSum(sum0) + DotInt8Scalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotInt8Scalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotInt8Scalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotInt8Scalar(a + i, b3 + i, n - i);
+	}
+
+	//###########################################################################################
+	// AVX2 kernels
+	NEURO_TARGET("avx2")
+	double HorizontalSum(__m256d v)
+	{
+		return HorizontalSum(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+	}
+
+	NEURO_TARGET("avx2")
+	double DotAVX2(double const* a, double const* b, size_t const n)
+	{
+		if (n < 8) return DotScalar(a, b, n);
+		__m256d sum0 = _mm256_setzero_pd();
+		__m256d sum1 = _mm256_setzero_pd();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+			sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+		}
+		double sum = HorizontalSum(_mm256_add_pd(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx2")
+	void AxpyAVX2(double const a, double const* x, double* y, size_t const n)
+	{
+		__m256d va = _mm256_set1_pd(a);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d vy = _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(_mm256_loadu_pd(x + i), va));
+			_mm256_storeu_pd(y + i, vy);
+		}
+		AxpyScalar(a, x + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateWeightsAVX2(double* weights, double* deltaWeights, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n)
+	{
+		__m256d vEta = _mm256_set1_pd(eta);
+		__m256d vGradient = _mm256_set1_pd(gradient);
+		__m256d vAlpha = _mm256_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d delta = _mm256_add_pd(
+				_mm256_mul_pd(_mm256_mul_pd(vEta, _mm256_loadu_pd(inputs + i)), vGradient),
+				_mm256_mul_pd(vAlpha, _mm256_loadu_pd(deltaWeights + i)));
+			_mm256_storeu_pd(deltaWeights + i, delta);
+			_mm256_storeu_pd(weights + i, _mm256_add_pd(_mm256_loadu_pd(weights + i), delta));
+		}
+		UpdateWeightsScalar(weights + i, deltaWeights + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateNesterovAVX2(double* weights, double* velocities, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n)
+	{
+		__m256d vEta = _mm256_set1_pd(eta);
+		__m256d vGradient = _mm256_set1_pd(gradient);
+		__m256d vAlpha = _mm256_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d step = _mm256_mul_pd(_mm256_mul_pd(vEta, _mm256_loadu_pd(inputs + i)), vGradient);
+			__m256d velocity = _mm256_add_pd(_mm256_mul_pd(vAlpha, _mm256_loadu_pd(velocities + i)), step);
+			_mm256_storeu_pd(velocities + i, velocity);
+			_mm256_storeu_pd(weights + i, _mm256_add_pd(_mm256_loadu_pd(weights + i), _mm256_add_pd(_mm256_mul_pd(vAlpha, velocity), step)));
+		}
+		UpdateNesterovScalar(weights + i, velocities + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateRMSPropAVX2(double* weights, double* squares, double const* inputs,
+		double const eta, double const gradient, double const decay, double const epsilon, size_t const n)
+	{
+		__m256d vEta = _mm256_set1_pd(eta);
+		__m256d vGradient = _mm256_set1_pd(gradient);
+		__m256d vDecay = _mm256_set1_pd(decay);
+		__m256d vRest = _mm256_set1_pd(1 - decay);
+		__m256d vEpsilon = _mm256_set1_pd(epsilon);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d g = _mm256_mul_pd(_mm256_loadu_pd(inputs + i), vGradient);
+			__m256d square = _mm256_add_pd(_mm256_mul_pd(vDecay, _mm256_loadu_pd(squares + i)), _mm256_mul_pd(vRest, _mm256_mul_pd(g, g)));
+			_mm256_storeu_pd(squares + i, square);
+			__m256d step = _mm256_div_pd(_mm256_mul_pd(vEta, g), _mm256_add_pd(_mm256_sqrt_pd(square), vEpsilon));
+			_mm256_storeu_pd(weights + i, _mm256_add_pd(_mm256_loadu_pd(weights + i), step));
+		}
+		UpdateRMSPropScalar(weights + i, squares + i, inputs + i, eta, gradient, decay, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateAdamAVX2(double* weights, double* moments, double* squares, double const* inputs,
+		double const eta, double const gradient, double const beta1, double const beta2, double const epsilon, size_t const n)
+	{
+		__m256d vEta = _mm256_set1_pd(eta);
+		__m256d vGradient = _mm256_set1_pd(gradient);
+		__m256d vBeta1 = _mm256_set1_pd(beta1);
+		__m256d vBeta2 = _mm256_set1_pd(beta2);
+		__m256d vRest1 = _mm256_set1_pd(1 - beta1);
+		__m256d vRest2 = _mm256_set1_pd(1 - beta2);
+		__m256d vEpsilon = _mm256_set1_pd(epsilon);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d g = _mm256_mul_pd(_mm256_loadu_pd(inputs + i), vGradient);
+			__m256d moment = _mm256_add_pd(_mm256_mul_pd(vBeta1, _mm256_loadu_pd(moments + i)), _mm256_mul_pd(vRest1, g));
+			__m256d square = _mm256_add_pd(_mm256_mul_pd(vBeta2, _mm256_loadu_pd(squares + i)), _mm256_mul_pd(vRest2, _mm256_mul_pd(g, g)));
+			_mm256_storeu_pd(moments + i, moment);
+			_mm256_storeu_pd(squares + i, square);
+			__m256d step = _mm256_div_pd(_mm256_mul_pd(vEta, moment), _mm256_add_pd(_mm256_sqrt_pd(square), vEpsilon));
+			_mm256_storeu_pd(weights + i, _mm256_add_pd(_mm256_loadu_pd(weights + i), step));
+		}
+		UpdateAdamScalar(weights + i, moments + i, squares + i, inputs + i, eta, gradient, beta1, beta2, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void Dot4AVX2(double const* a, double const* b0, double const* b1, double const* b2,
+		double const* b3, size_t const n, double* sums)
+	{
+		if (n < 4) return Dot4Scalar(a, b0, b1, b2, b3, n, sums);
+		__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+		__m256d sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d va = _mm256_loadu_pd(a + i);
+			sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(va, _mm256_loadu_pd(b0 + i)));
+			sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(va, _mm256_loadu_pd(b1 + i)));
+			sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(va, _mm256_loadu_pd(b2 + i)));
+			sum3 = _mm256_add_pd(sum3, _mm256_mul_pd(va, _mm256_loadu_pd(b3 + i)));
+		}
+		sums[0] = HorizontalSum(sum0) + DotScalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotScalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotScalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotScalar(a + i, b3 + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void TanhAVX2(double* values, size_t const n)
+	{
+		__m256d const clamp = _mm256_set1_pd(cTanhClamp);
+		__m256d const minusClamp = _mm256_set1_pd(-cTanhClamp);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d x = _mm256_min_pd(clamp, _mm256_max_pd(minusClamp, _mm256_loadu_pd(values + i)));
+			__m256d x2 = _mm256_mul_pd(x, x);
+			__m256d p = _mm256_set1_pd(cTanhP[0]);
+			for (size_t k = 1; k < 7; ++k) {
+				p = _mm256_add_pd(_mm256_mul_pd(p, x2), _mm256_set1_pd(cTanhP[k]));
+			}
+			__m256d q = _mm256_set1_pd(cTanhQ[0]);
+			for (size_t k = 1; k < 4; ++k) {
+				q = _mm256_add_pd(_mm256_mul_pd(q, x2), _mm256_set1_pd(cTanhQ[k]));
+			}
+			_mm256_storeu_pd(values + i, _mm256_div_pd(_mm256_mul_pd(x, p), q));
+		}
+		// the call of the scalar tail is compiled to a jump without clearing the upper
+		// halves of the vector registers, SSE code of the caller (e.g. exp) would be slow
+		_mm256_zeroupper();
+		TanhScalar(values + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	float HorizontalSum(__m256 v)
+	{
+		return HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+	}
+
+	NEURO_TARGET("avx2")
+	float DotAVX2(float const* a, float const* b, size_t const n)
+	{
+		if (n < 16) return DotScalar(a, b, n);
+		__m256 sum0 = _mm256_setzero_ps();
+		__m256 sum1 = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+			sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+		}
+		float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx2")
+	void AxpyAVX2(float const a, float const* x, float* y, size_t const n)
+	{
+		__m256 va = _mm256_set1_ps(a);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 vy = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(x + i), va));
+			_mm256_storeu_ps(y + i, vy);
+		}
+		AxpyScalar(a, x + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateWeightsAVX2(float* weights, float* deltaWeights, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n)
+	{
+		__m256 vEta = _mm256_set1_ps(eta);
+		__m256 vGradient = _mm256_set1_ps(gradient);
+		__m256 vAlpha = _mm256_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 delta = _mm256_add_ps(
+				_mm256_mul_ps(_mm256_mul_ps(vEta, _mm256_loadu_ps(inputs + i)), vGradient),
+				_mm256_mul_ps(vAlpha, _mm256_loadu_ps(deltaWeights + i)));
+			_mm256_storeu_ps(deltaWeights + i, delta);
+			_mm256_storeu_ps(weights + i, _mm256_add_ps(_mm256_loadu_ps(weights + i), delta));
+		}
+		UpdateWeightsScalar(weights + i, deltaWeights + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateNesterovAVX2(float* weights, float* velocities, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n)
+	{
+		__m256 vEta = _mm256_set1_ps(eta);
+		__m256 vGradient = _mm256_set1_ps(gradient);
+		__m256 vAlpha = _mm256_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 step = _mm256_mul_ps(_mm256_mul_ps(vEta, _mm256_loadu_ps(inputs + i)), vGradient);
+			__m256 velocity = _mm256_add_ps(_mm256_mul_ps(vAlpha, _mm256_loadu_ps(velocities + i)), step);
+			_mm256_storeu_ps(velocities + i, velocity);
+			_mm256_storeu_ps(weights + i, _mm256_add_ps(_mm256_loadu_ps(weights + i), _mm256_add_ps(_mm256_mul_ps(vAlpha, velocity), step)));
+		}
+		UpdateNesterovScalar(weights + i, velocities + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateRMSPropAVX2(float* weights, float* squares, float const* inputs,
+		float const eta, float const gradient, float const decay, float const epsilon, size_t const n)
+	{
+		__m256 vEta = _mm256_set1_ps(eta);
+		__m256 vGradient = _mm256_set1_ps(gradient);
+		__m256 vDecay = _mm256_set1_ps(decay);
+		__m256 vRest = _mm256_set1_ps(1 - decay);
+		__m256 vEpsilon = _mm256_set1_ps(epsilon);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 g = _mm256_mul_ps(_mm256_loadu_ps(inputs + i), vGradient);
+			__m256 square = _mm256_add_ps(_mm256_mul_ps(vDecay, _mm256_loadu_ps(squares + i)), _mm256_mul_ps(vRest, _mm256_mul_ps(g, g)));
+			_mm256_storeu_ps(squares + i, square);
+			__m256 step = _mm256_div_ps(_mm256_mul_ps(vEta, g), _mm256_add_ps(_mm256_sqrt_ps(square), vEpsilon));
+			_mm256_storeu_ps(weights + i, _mm256_add_ps(_mm256_loadu_ps(weights + i), step));
+		}
+		UpdateRMSPropScalar(weights + i, squares + i, inputs + i, eta, gradient, decay, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void UpdateAdamAVX2(float* weights, float* moments, float* squares, float const* inputs,
+		float const eta, float const gradient, float const beta1, float const beta2, float const epsilon, size_t const n)
+	{
+		__m256 vEta = _mm256_set1_ps(eta);
+		__m256 vGradient = _mm256_set1_ps(gradient);
+		__m256 vBeta1 = _mm256_set1_ps(beta1);
+		__m256 vBeta2 = _mm256_set1_ps(beta2);
+		__m256 vRest1 = _mm256_set1_ps(1 - beta1);
+		__m256 vRest2 = _mm256_set1_ps(1 - beta2);
+		__m256 vEpsilon = _mm256_set1_ps(epsilon);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 g = _mm256_mul_ps(_mm256_loadu_ps(inputs + i), vGradient);
+			__m256 moment = _mm256_add_ps(_mm256_mul_ps(vBeta1, _mm256_loadu_ps(moments + i)), _mm256_mul_ps(vRest1, g));
+			__m256 square = _mm256_add_ps(_mm256_mul_ps(vBeta2, _mm256_loadu_ps(squares + i)), _mm256_mul_ps(vRest2, _mm256_mul_ps(g, g)));
+			_mm256_storeu_ps(moments + i, moment);
+			_mm256_storeu_ps(squares + i, square);
+			__m256 step = _mm256_div_ps(_mm256_mul_ps(vEta, moment), _mm256_add_ps(_mm256_sqrt_ps(square), vEpsilon));
+			_mm256_storeu_ps(weights + i, _mm256_add_ps(_mm256_loadu_ps(weights + i), step));
+		}
+		UpdateAdamScalar(weights + i, moments + i, squares + i, inputs + i, eta, gradient, beta1, beta2, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void Dot4AVX2(float const* a, float const* b0, float const* b1, float const* b2,
+		float const* b3, size_t const n, float* sums)
+	{
+		if (n < 8) return Dot4Scalar(a, b0, b1, b2, b3, n, sums);
+		__m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+		__m256 sum2 = _mm256_setzero_ps(), sum3 = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 va = _mm256_loadu_ps(a + i);
+			sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(va, _mm256_loadu_ps(b0 + i)));
+			sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(va, _mm256_loadu_ps(b1 + i)));
+			sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(va, _mm256_loadu_ps(b2 + i)));
+			sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(va, _mm256_loadu_ps(b3 + i)));
+		}
+		sums[0] = HorizontalSum(sum0) + DotScalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotScalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotScalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotScalar(a + i, b3 + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void TanhAVX2(float* values, size_t const n)
+	{
+		__m256 const clamp = _mm256_set1_ps(static_cast<float>(cTanhClamp));
+		__m256 const minusClamp = _mm256_set1_ps(static_cast<float>(-cTanhClamp));
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 x = _mm256_min_ps(clamp, _mm256_max_ps(minusClamp, _mm256_loadu_ps(values + i)));
+			__m256 x2 = _mm256_mul_ps(x, x);
+			__m256 p = _mm256_set1_ps(static_cast<float>(cTanhP[0]));
+			for (size_t k = 1; k < 7; ++k) {
+				p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(static_cast<float>(cTanhP[k])));
+			}
+			__m256 q = _mm256_set1_ps(static_cast<float>(cTanhQ[0]));
+			for (size_t k = 1; k < 4; ++k) {
+				q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(static_cast<float>(cTanhQ[k])));
+			}
+			_mm256_storeu_ps(values + i, _mm256_div_ps(_mm256_mul_ps(x, p), q));
+		}
+		// the call of the scalar tail is compiled to a jump without clearing the upper
+		// halves of the vector registers, SSE code of the caller (e.g. exp) would be slow
+		_mm256_zeroupper();
+		TanhScalar(values + i, n - i);
+	}
+
+	// unpack and pack work within 128 bit lanes, so the order of the elements is kept
+	NEURO_TARGET("avx2")
+	__m256i RoundFixed(__m256i const product, __m128i const shift, __m256i const half, __m256i const one)
+	{
+		__m256i const odd = _mm256_and_si256(_mm256_sra_epi32(product, shift), one);
+		return _mm256_sra_epi32(_mm256_add_epi32(product, _mm256_add_epi32(half, odd)), shift);
+	}
+
+	NEURO_TARGET("avx2")
+	__m256i MulFixed(__m256i const a, __m256i const b, __m128i const shift, __m256i const half, __m256i const one)
+	{
+		__m256i const low = _mm256_mullo_epi16(a, b);
+		__m256i const high = _mm256_mulhi_epi16(a, b);
+		__m256i const product0 = RoundFixed(_mm256_unpacklo_epi16(low, high), shift, half, one);
+		__m256i const product1 = RoundFixed(_mm256_unpackhi_epi16(low, high), shift, half, one);
+		return _mm256_packs_epi32(product0, product1);
+	}
+
+	NEURO_TARGET("avx2")
+	void MulFixedAVX2(int16_t const* a, int16_t const* b, int16_t* c, size_t const n, int const fracBits)
+	{
+		__m128i const shift = _mm_cvtsi32_si128(fracBits);
+		__m256i const one = _mm256_set1_epi32((fracBits > 0) ? 1 : 0);
+		__m256i const half = _mm256_set1_epi32((fracBits > 0) ? (1 << (fracBits - 1)) - 1 : 0);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m256i const va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+			__m256i const vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i), MulFixed(va, vb, shift, half, one));
+		}
+		MulFixedSSE2(a + i, b + i, c + i, n - i, fracBits);
+	}
+
+	NEURO_TARGET("avx2")
+	void AxpyFixedAVX2(int16_t const a, int16_t const* x, int16_t* y, size_t const n, int const fracBits)
+	{
+		__m128i const shift = _mm_cvtsi32_si128(fracBits);
+		__m256i const one = _mm256_set1_epi32((fracBits > 0) ? 1 : 0);
+		__m256i const half = _mm256_set1_epi32((fracBits > 0) ? (1 << (fracBits - 1)) - 1 : 0);
+		__m256i const va = _mm256_set1_epi16(a);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m256i const vx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(x + i));
+			__m256i const vy = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(y + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i), _mm256_adds_epi16(vy, MulFixed(va, vx, shift, half, one)));
+		}
+		AxpyFixedSSE2(a, x + i, y + i, n - i, fracBits);
+	}
+
+	NEURO_TARGET("avx2")
+	int32_t HorizontalSum(__m256i v)
+	{
+		return HorizontalSum(_mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+	}
+
+	// products of 16 signed bytes sign-extended to 16 bit and summed up in pairs to 32 bit
+	NEURO_TARGET("avx2")
+	__m256i MulAddInt8(__m256i const a, int8_t const* b)
+	{
+		return _mm256_madd_epi16(a, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b))));
+	}
+
+	NEURO_TARGET("avx2")
+	int32_t DotInt8AVX2(int8_t const* a, int8_t const* b, size_t const n)
+	{
+		__m256i sum = _mm256_setzero_si256();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m256i const va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i)));
+			sum = _mm256_add_epi32(sum, MulAddInt8(va, b + i));
+		}
+		return HorizontalSum(sum) + DotInt8Scalar(a + i, b + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void Dot4Int8AVX2(int8_t const* a, int8_t const* b0, int8_t const* b1, int8_t const* b2,
+		int8_t const* b3, size_t const n, int32_t* sums)
+	{
+		__m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+		__m256i sum2 = _mm256_setzero_si256(), sum3 = _mm256_setzero_si256();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m256i const va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i)));
+			sum0 = _mm256_add_epi32(sum0, MulAddInt8(va, b0 + i));
+			sum1 = _mm256_add_epi32(sum1, MulAddInt8(va, b1 + i));
+			sum2 = _mm256_add_epi32(sum2, MulAddInt8(va, b2 + i));
+			sum3 = _mm256_add_epi32(sum3, MulAddInt8(va, b3 + i));
+		}
+		sums[0] = HorizontalSum(sum0) + DotInt8Scalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotInt8Scalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotInt8Scalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotInt8Scalar(a + i, b3 + i, n - i);
+	}
+
+	// the gathers take signed 32 bit indices, the columns of a layer are far below 2^31.
+	// They are masked with all lanes set and start from zeros like the sqrt of the AVX-512
+	// kernels, the unmasked intrinsics start from an undefined vector.
+	NEURO_TARGET("avx2")
+	__m256d GatherPd4(double const* x, uint32_t const* columns)
+	{
+		__m256d const all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+		return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, _mm_loadu_si128(reinterpret_cast<__m128i const*>(columns)),
+			all, 8);
+	}
+
+	NEURO_TARGET("avx2")
+	__m256 GatherPs8(float const* x, uint32_t const* columns)
+	{
+		__m256 const all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns)),
+			all, 4);
+	}
+
+	// SparseDot sums in the lanes of Dot, so it gives the result of Dot on the gathered
+	// inputs
+	NEURO_TARGET("avx2")
+	double SparseDotAVX2(double const* values, uint32_t const* columns, double const* x, size_t const n)
+	{
+		if (n < 8) return SparseDotScalar(values, columns, x, n);
+		__m256d sum0 = _mm256_setzero_pd();
+		__m256d sum1 = _mm256_setzero_pd();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256d x0 = GatherPd4(x, columns + i);
+			__m256d x1 = GatherPd4(x, columns + i + 4);
+			sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(values + i), x0));
+			sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(values + i + 4), x1));
+		}
+		double sum = HorizontalSum(_mm256_add_pd(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += values[i] * x[columns[i]];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx2")
+	void GatherAVX2(double const* x, uint32_t const* columns, double* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm256_storeu_pd(y + i, GatherPd4(x, columns + i));
+		}
+		GatherScalar(x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void GatherAxpyAVX2(double const a, double const* x, uint32_t const* columns, double* y, size_t const n)
+	{
+		__m256d va = _mm256_set1_pd(a);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d vx = GatherPd4(x, columns + i);
+			_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(vx, va)));
+		}
+		GatherAxpyScalar(a, x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void MultiplyAVX2(double const* x, double* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm256_storeu_pd(y + i, _mm256_mul_pd(_mm256_loadu_pd(y + i), _mm256_loadu_pd(x + i)));
+		}
+		MultiplyScalar(x + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	float SparseDotAVX2(float const* values, uint32_t const* columns, float const* x, size_t const n)
+	{
+		if (n < 16) return SparseDotScalar(values, columns, x, n);
+		__m256 sum0 = _mm256_setzero_ps();
+		__m256 sum1 = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m256 x0 = GatherPs8(x, columns + i);
+			__m256 x1 = GatherPs8(x, columns + i + 8);
+			sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(values + i), x0));
+			sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(values + i + 8), x1));
+		}
+		float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += values[i] * x[columns[i]];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx2")
+	void GatherAVX2(float const* x, uint32_t const* columns, float* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(y + i, GatherPs8(x, columns + i));
+		}
+		GatherScalar(x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void GatherAxpyAVX2(float const a, float const* x, uint32_t const* columns, float* y, size_t const n)
+	{
+		__m256 va = _mm256_set1_ps(a);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 vx = GatherPs8(x, columns + i);
+			_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(vx, va)));
+		}
+		GatherAxpyScalar(a, x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx2")
+	void MultiplyAVX2(float const* x, float* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+		}
+		MultiplyScalar(x + i, y + i, n - i);
+	}
+
+	//###########################################################################################
+	// AVX-512 kernels
+	NEURO_TARGET("avx512f")
+	double HorizontalSum(__m512d v)
+	{
+		double lanes[8];
+		_mm512_storeu_pd(lanes, v);
+		return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+	}
+
+	NEURO_TARGET("avx512f")
+	double DotAVX512(double const* a, double const* b, size_t const n)
+	{
+		if (n < 16) return DotScalar(a, b, n);
+		__m512d sum0 = _mm512_setzero_pd();
+		__m512d sum1 = _mm512_setzero_pd();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+			sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8)));
+		}
+		double sum = HorizontalSum(_mm512_add_pd(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx512f")
+	void AxpyAVX512(double const a, double const* x, double* y, size_t const n)
+	{
+		__m512d va = _mm512_set1_pd(a);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d vy = _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_mul_pd(_mm512_loadu_pd(x + i), va));
+			_mm512_storeu_pd(y + i, vy);
+		}
+		AxpyScalar(a, x + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateWeightsAVX512(double* weights, double* deltaWeights, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n)
+	{
+		__m512d vEta = _mm512_set1_pd(eta);
+		__m512d vGradient = _mm512_set1_pd(gradient);
+		__m512d vAlpha = _mm512_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d delta = _mm512_add_pd(
+				_mm512_mul_pd(_mm512_mul_pd(vEta, _mm512_loadu_pd(inputs + i)), vGradient),
+				_mm512_mul_pd(vAlpha, _mm512_loadu_pd(deltaWeights + i)));
+			_mm512_storeu_pd(deltaWeights + i, delta);
+			_mm512_storeu_pd(weights + i, _mm512_add_pd(_mm512_loadu_pd(weights + i), delta));
+		}
+		UpdateWeightsScalar(weights + i, deltaWeights + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateNesterovAVX512(double* weights, double* velocities, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n)
+	{
+		__m512d vEta = _mm512_set1_pd(eta);
+		__m512d vGradient = _mm512_set1_pd(gradient);
+		__m512d vAlpha = _mm512_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d step = _mm512_mul_pd(_mm512_mul_pd(vEta, _mm512_loadu_pd(inputs + i)), vGradient);
+			__m512d velocity = _mm512_add_pd(_mm512_mul_pd(vAlpha, _mm512_loadu_pd(velocities + i)), step);
+			_mm512_storeu_pd(velocities + i, velocity);
+			_mm512_storeu_pd(weights + i, _mm512_add_pd(_mm512_loadu_pd(weights + i), _mm512_add_pd(_mm512_mul_pd(vAlpha, velocity), step)));
+		}
+		UpdateNesterovScalar(weights + i, velocities + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateRMSPropAVX512(double* weights, double* squares, double const* inputs,
+		double const eta, double const gradient, double const decay, double const epsilon, size_t const n)
+	{
+		__m512d vEta = _mm512_set1_pd(eta);
+		__m512d vGradient = _mm512_set1_pd(gradient);
+		__m512d vDecay = _mm512_set1_pd(decay);
+		__m512d vRest = _mm512_set1_pd(1 - decay);
+		__m512d vEpsilon = _mm512_set1_pd(epsilon);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d g = _mm512_mul_pd(_mm512_loadu_pd(inputs + i), vGradient);
+			__m512d square = _mm512_add_pd(_mm512_mul_pd(vDecay, _mm512_loadu_pd(squares + i)), _mm512_mul_pd(vRest, _mm512_mul_pd(g, g)));
+			_mm512_storeu_pd(squares + i, square);
+			// zero-masked with all lanes set like the min/max of Tanh
+			__m512d step = _mm512_div_pd(_mm512_mul_pd(vEta, g), _mm512_add_pd(_mm512_maskz_sqrt_pd(0xff, square), vEpsilon));
+			_mm512_storeu_pd(weights + i, _mm512_add_pd(_mm512_loadu_pd(weights + i), step));
+		}
+		UpdateRMSPropScalar(weights + i, squares + i, inputs + i, eta, gradient, decay, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateAdamAVX512(double* weights, double* moments, double* squares, double const* inputs,
+		double const eta, double const gradient, double const beta1, double const beta2, double const epsilon, size_t const n)
+	{
+		__m512d vEta = _mm512_set1_pd(eta);
+		__m512d vGradient = _mm512_set1_pd(gradient);
+		__m512d vBeta1 = _mm512_set1_pd(beta1);
+		__m512d vBeta2 = _mm512_set1_pd(beta2);
+		__m512d vRest1 = _mm512_set1_pd(1 - beta1);
+		__m512d vRest2 = _mm512_set1_pd(1 - beta2);
+		__m512d vEpsilon = _mm512_set1_pd(epsilon);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d g = _mm512_mul_pd(_mm512_loadu_pd(inputs + i), vGradient);
+			__m512d moment = _mm512_add_pd(_mm512_mul_pd(vBeta1, _mm512_loadu_pd(moments + i)), _mm512_mul_pd(vRest1, g));
+			__m512d square = _mm512_add_pd(_mm512_mul_pd(vBeta2, _mm512_loadu_pd(squares + i)), _mm512_mul_pd(vRest2, _mm512_mul_pd(g, g)));
+			_mm512_storeu_pd(moments + i, moment);
+			_mm512_storeu_pd(squares + i, square);
+			__m512d step = _mm512_div_pd(_mm512_mul_pd(vEta, moment), _mm512_add_pd(_mm512_maskz_sqrt_pd(0xff, square), vEpsilon));
+			_mm512_storeu_pd(weights + i, _mm512_add_pd(_mm512_loadu_pd(weights + i), step));
+		}
+		UpdateAdamScalar(weights + i, moments + i, squares + i, inputs + i, eta, gradient, beta1, beta2, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void Dot4AVX512(double const* a, double const* b0, double const* b1, double const* b2,
+		double const* b3, size_t const n, double* sums)
+	{
+		if (n < 8) return Dot4Scalar(a, b0, b1, b2, b3, n, sums);
+		__m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+		__m512d sum2 = _mm512_setzero_pd(), sum3 = _mm512_setzero_pd();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d va = _mm512_loadu_pd(a + i);
+			sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(va, _mm512_loadu_pd(b0 + i)));
+			sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(va, _mm512_loadu_pd(b1 + i)));
+			sum2 = _mm512_add_pd(sum2, _mm512_mul_pd(va, _mm512_loadu_pd(b2 + i)));
+			sum3 = _mm512_add_pd(sum3, _mm512_mul_pd(va, _mm512_loadu_pd(b3 + i)));
+		}
+		sums[0] = HorizontalSum(sum0) + DotScalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotScalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotScalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotScalar(a + i, b3 + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void TanhAVX512(double* values, size_t const n)
+	{
+		__m512d const clamp = _mm512_set1_pd(cTanhClamp);
+		__m512d const minusClamp = _mm512_set1_pd(-cTanhClamp);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			// zero-masked with all lanes set: the plain min/max leave a register undefined,
+			// which some compilers warn about
+			__m512d x = _mm512_maskz_min_pd(0xff, clamp, _mm512_maskz_max_pd(0xff, minusClamp, _mm512_loadu_pd(values + i)));
+			__m512d x2 = _mm512_mul_pd(x, x);
+			__m512d p = _mm512_set1_pd(cTanhP[0]);
+			for (size_t k = 1; k < 7; ++k) {
+				p = _mm512_add_pd(_mm512_mul_pd(p, x2), _mm512_set1_pd(cTanhP[k]));
+			}
+			__m512d q = _mm512_set1_pd(cTanhQ[0]);
+			for (size_t k = 1; k < 4; ++k) {
+				q = _mm512_add_pd(_mm512_mul_pd(q, x2), _mm512_set1_pd(cTanhQ[k]));
+			}
+			_mm512_storeu_pd(values + i, _mm512_div_pd(_mm512_mul_pd(x, p), q));
+		}
+		// the call of the scalar tail is compiled to a jump without clearing the upper
+		// halves of the vector registers, SSE code of the caller (e.g. exp) would be slow
+		_mm256_zeroupper();
+		TanhScalar(values + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	float HorizontalSum(__m512 v)
+	{
+		float lanes[16];
+		_mm512_storeu_ps(lanes, v);
+		for (size_t width = 8; width > 0; width /= 2) {
+			for (size_t i = 0; i < width; ++i) {
+				lanes[i] += lanes[i + width];
+			}
+		}
+		return lanes[0];
+	}
+
+	NEURO_TARGET("avx512f")
+	float DotAVX512(float const* a, float const* b, size_t const n)
+	{
+		if (n < 32) return DotScalar(a, b, n);
+		__m512 sum0 = _mm512_setzero_ps();
+		__m512 sum1 = _mm512_setzero_ps();
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32) {
+			sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+			sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16)));
+		}
+		float sum = HorizontalSum(_mm512_add_ps(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx512f")
+	void AxpyAVX512(float const a, float const* x, float* y, size_t const n)
+	{
+		__m512 va = _mm512_set1_ps(a);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 vy = _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(_mm512_loadu_ps(x + i), va));
+			_mm512_storeu_ps(y + i, vy);
+		}
+		AxpyScalar(a, x + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateWeightsAVX512(float* weights, float* deltaWeights, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n)
+	{
+		__m512 vEta = _mm512_set1_ps(eta);
+		__m512 vGradient = _mm512_set1_ps(gradient);
+		__m512 vAlpha = _mm512_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 delta = _mm512_add_ps(
+				_mm512_mul_ps(_mm512_mul_ps(vEta, _mm512_loadu_ps(inputs + i)), vGradient),
+				_mm512_mul_ps(vAlpha, _mm512_loadu_ps(deltaWeights + i)));
+			_mm512_storeu_ps(deltaWeights + i, delta);
+			_mm512_storeu_ps(weights + i, _mm512_add_ps(_mm512_loadu_ps(weights + i), delta));
+		}
+		UpdateWeightsScalar(weights + i, deltaWeights + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateNesterovAVX512(float* weights, float* velocities, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n)
+	{
+		__m512 vEta = _mm512_set1_ps(eta);
+		__m512 vGradient = _mm512_set1_ps(gradient);
+		__m512 vAlpha = _mm512_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 step = _mm512_mul_ps(_mm512_mul_ps(vEta, _mm512_loadu_ps(inputs + i)), vGradient);
+			__m512 velocity = _mm512_add_ps(_mm512_mul_ps(vAlpha, _mm512_loadu_ps(velocities + i)), step);
+			_mm512_storeu_ps(velocities + i, velocity);
+			_mm512_storeu_ps(weights + i, _mm512_add_ps(_mm512_loadu_ps(weights + i), _mm512_add_ps(_mm512_mul_ps(vAlpha, velocity), step)));
+		}
+		UpdateNesterovScalar(weights + i, velocities + i, inputs + i, eta, gradient, alpha, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateRMSPropAVX512(float* weights, float* squares, float const* inputs,
+		float const eta, float const gradient, float const decay, float const epsilon, size_t const n)
+	{
+		__m512 vEta = _mm512_set1_ps(eta);
+		__m512 vGradient = _mm512_set1_ps(gradient);
+		__m512 vDecay = _mm512_set1_ps(decay);
+		__m512 vRest = _mm512_set1_ps(1 - decay);
+		__m512 vEpsilon = _mm512_set1_ps(epsilon);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 g = _mm512_mul_ps(_mm512_loadu_ps(inputs + i), vGradient);
+			__m512 square = _mm512_add_ps(_mm512_mul_ps(vDecay, _mm512_loadu_ps(squares + i)), _mm512_mul_ps(vRest, _mm512_mul_ps(g, g)));
+			_mm512_storeu_ps(squares + i, square);
+			// zero-masked with all lanes set like the min/max of Tanh
+			__m512 step = _mm512_div_ps(_mm512_mul_ps(vEta, g), _mm512_add_ps(_mm512_maskz_sqrt_ps(0xffff, square), vEpsilon));
+			_mm512_storeu_ps(weights + i, _mm512_add_ps(_mm512_loadu_ps(weights + i), step));
+		}
+		UpdateRMSPropScalar(weights + i, squares + i, inputs + i, eta, gradient, decay, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void UpdateAdamAVX512(float* weights, float* moments, float* squares, float const* inputs,
+		float const eta, float const gradient, float const beta1, float const beta2, float const epsilon, size_t const n)
+	{
+		__m512 vEta = _mm512_set1_ps(eta);
+		__m512 vGradient = _mm512_set1_ps(gradient);
+		__m512 vBeta1 = _mm512_set1_ps(beta1);
+		__m512 vBeta2 = _mm512_set1_ps(beta2);
+		__m512 vRest1 = _mm512_set1_ps(1 - beta1);
+		__m512 vRest2 = _mm512_set1_ps(1 - beta2);
+		__m512 vEpsilon = _mm512_set1_ps(epsilon);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 g = _mm512_mul_ps(_mm512_loadu_ps(inputs + i), vGradient);
+			__m512 moment = _mm512_add_ps(_mm512_mul_ps(vBeta1, _mm512_loadu_ps(moments + i)), _mm512_mul_ps(vRest1, g));
+			__m512 square = _mm512_add_ps(_mm512_mul_ps(vBeta2, _mm512_loadu_ps(squares + i)), _mm512_mul_ps(vRest2, _mm512_mul_ps(g, g)));
+			_mm512_storeu_ps(moments + i, moment);
+			_mm512_storeu_ps(squares + i, square);
+			__m512 step = _mm512_div_ps(_mm512_mul_ps(vEta, moment), _mm512_add_ps(_mm512_maskz_sqrt_ps(0xffff, square), vEpsilon));
+			_mm512_storeu_ps(weights + i, _mm512_add_ps(_mm512_loadu_ps(weights + i), step));
+		}
+		UpdateAdamScalar(weights + i, moments + i, squares + i, inputs + i, eta, gradient, beta1, beta2, epsilon, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void Dot4AVX512(float const* a, float const* b0, float const* b1, float const* b2,
+		float const* b3, size_t const n, float* sums)
+	{
+		if (n < 16) return Dot4Scalar(a, b0, b1, b2, b3, n, sums);
+		__m512 sum0 = _mm512_setzero_ps(), sum1 = _mm512_setzero_ps();
+		__m512 sum2 = _mm512_setzero_ps(), sum3 = _mm512_setzero_ps();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 va = _mm512_loadu_ps(a + i);
+			sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(va, _mm512_loadu_ps(b0 + i)));
+			sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(va, _mm512_loadu_ps(b1 + i)));
+			sum2 = _mm512_add_ps(sum2, _mm512_mul_ps(va, _mm512_loadu_ps(b2 + i)));
+			sum3 = _mm512_add_ps(sum3, _mm512_mul_ps(va, _mm512_loadu_ps(b3 + i)));
+		}
+		sums[0] = HorizontalSum(sum0) + DotScalar(a + i, b0 + i, n - i);
+		sums[1] = HorizontalSum(sum1) + DotScalar(a + i, b1 + i, n - i);
+		sums[2] = HorizontalSum(sum2) + DotScalar(a + i, b2 + i, n - i);
+		sums[3] = HorizontalSum(sum3) + DotScalar(a + i, b3 + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void TanhAVX512(float* values, size_t const n)
+	{
+		__m512 const clamp = _mm512_set1_ps(static_cast<float>(cTanhClamp));
+		__m512 const minusClamp = _mm512_set1_ps(static_cast<float>(-cTanhClamp));
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 x = _mm512_maskz_min_ps(0xffff, clamp, _mm512_maskz_max_ps(0xffff, minusClamp, _mm512_loadu_ps(values + i)));
+			__m512 x2 = _mm512_mul_ps(x, x);
+			__m512 p = _mm512_set1_ps(static_cast<float>(cTanhP[0]));
+			for (size_t k = 1; k < 7; ++k) {
+				p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(static_cast<float>(cTanhP[k])));
+			}
+			__m512 q = _mm512_set1_ps(static_cast<float>(cTanhQ[0]));
+			for (size_t k = 1; k < 4; ++k) {
+				q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(static_cast<float>(cTanhQ[k])));
+			}
+			_mm512_storeu_ps(values + i, _mm512_div_ps(_mm512_mul_ps(x, p), q));
+		}
+		// the call of the scalar tail is compiled to a jump without clearing the upper
+		// halves of the vector registers, SSE code of the caller (e.g. exp) would be slow
+		_mm256_zeroupper();
+		TanhScalar(values + i, n - i);
+	}
+
+	// gathers of all lanes into zeros like the ones of the AVX2 kernels
+	NEURO_TARGET("avx512f")
+	__m512d GatherPd8(double const* x, __m256i const index)
+	{
+		return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, index, x, 8);
+	}
+
+	NEURO_TARGET("avx512f")
+	__m512 GatherPs16(float const* x, __m512i const index)
+	{
+		return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, index, x, 4);
+	}
+
+	// the columns of a row are distinct, so the scatter of ScatterAxpy never writes an
+	// element twice
+	NEURO_TARGET("avx512f")
+	double SparseDotAVX512(double const* values, uint32_t const* columns, double const* x, size_t const n)
+	{
+		if (n < 16) return SparseDotScalar(values, columns, x, n);
+		__m512d sum0 = _mm512_setzero_pd();
+		__m512d sum1 = _mm512_setzero_pd();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512d x0 = GatherPd8(x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns + i)));
+			__m512d x1 = GatherPd8(x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns + i + 8)));
+			sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(_mm512_loadu_pd(values + i), x0));
+			sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(_mm512_loadu_pd(values + i + 8), x1));
+		}
+		double sum = HorizontalSum(_mm512_add_pd(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += values[i] * x[columns[i]];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx512f")
+	void GatherAVX512(double const* x, uint32_t const* columns, double* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm512_storeu_pd(y + i, GatherPd8(x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns + i))));
+		}
+		GatherScalar(x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void GatherAxpyAVX512(double const a, double const* x, uint32_t const* columns, double* y, size_t const n)
+	{
+		__m512d va = _mm512_set1_pd(a);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d vx = GatherPd8(x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns + i)));
+			_mm512_storeu_pd(y + i, _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_mul_pd(vx, va)));
+		}
+		GatherAxpyScalar(a, x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void ScatterAxpyAVX512(double const a, double const* x, uint32_t const* columns, double* y, size_t const n)
+	{
+		__m512d va = _mm512_set1_pd(a);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i index = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns + i));
+			__m512d vy = _mm512_add_pd(GatherPd8(y, index), _mm512_mul_pd(_mm512_loadu_pd(x + i), va));
+			_mm512_i32scatter_pd(y, index, vy, 8);
+		}
+		ScatterAxpyScalar(a, x + i, columns + i, y, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void MultiplyAVX512(double const* x, double* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm512_storeu_pd(y + i, _mm512_mul_pd(_mm512_loadu_pd(y + i), _mm512_loadu_pd(x + i)));
+		}
+		MultiplyScalar(x + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	float SparseDotAVX512(float const* values, uint32_t const* columns, float const* x, size_t const n)
+	{
+		if (n < 32) return SparseDotScalar(values, columns, x, n);
+		__m512 sum0 = _mm512_setzero_ps();
+		__m512 sum1 = _mm512_setzero_ps();
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32) {
+			__m512 x0 = GatherPs16(x, _mm512_loadu_si512(columns + i));
+			__m512 x1 = GatherPs16(x, _mm512_loadu_si512(columns + i + 16));
+			sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(_mm512_loadu_ps(values + i), x0));
+			sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(_mm512_loadu_ps(values + i + 16), x1));
+		}
+		float sum = HorizontalSum(_mm512_add_ps(sum0, sum1));
+		for (; i < n; ++i) {
+			sum += values[i] * x[columns[i]];
+		}
+		return sum;
+	}
+
+	NEURO_TARGET("avx512f")
+	void GatherAVX512(float const* x, uint32_t const* columns, float* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			_mm512_storeu_ps(y + i, GatherPs16(x, _mm512_loadu_si512(columns + i)));
+		}
+		GatherScalar(x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void GatherAxpyAVX512(float const a, float const* x, uint32_t const* columns, float* y, size_t const n)
+	{
+		__m512 va = _mm512_set1_ps(a);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 vx = GatherPs16(x, _mm512_loadu_si512(columns + i));
+			_mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(vx, va)));
+		}
+		GatherAxpyScalar(a, x, columns + i, y + i, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void ScatterAxpyAVX512(float const a, float const* x, uint32_t const* columns, float* y, size_t const n)
+	{
+		__m512 va = _mm512_set1_ps(a);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512i index = _mm512_loadu_si512(columns + i);
+			__m512 vy = _mm512_add_ps(GatherPs16(y, index), _mm512_mul_ps(_mm512_loadu_ps(x + i), va));
+			_mm512_i32scatter_ps(y, index, vy, 4);
+		}
+		ScatterAxpyScalar(a, x + i, columns + i, y, n - i);
+	}
+
+	NEURO_TARGET("avx512f")
+	void MultiplyAVX512(float const* x, float* y, size_t const n)
+	{
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			_mm512_storeu_ps(y + i, _mm512_mul_ps(_mm512_loadu_ps(y + i), _mm512_loadu_ps(x + i)));
+		}
+		MultiplyScalar(x + i, y + i, n - i);
+	}
+#endif //NEURO_X86
+
+	//###########################################################################################
+	// Dispatch
+	template<typename Real>
+	struct RealKernels {
+		Real(*dot)(Real const*, Real const*, size_t const);
+		void(*axpy)(Real const, Real const*, Real*, size_t const);
+		void(*updateWeights)(Real*, Real*, Real const*, Real const, Real const, Real const, size_t const);
+		void(*updateNesterov)(Real*, Real*, Real const*, Real const, Real const, Real const, size_t const);
+		void(*updateRMSProp)(Real*, Real*, Real const*, Real const, Real const, Real const, Real const, size_t const);
+		void(*updateAdam)(Real*, Real*, Real*, Real const*, Real const, Real const, Real const, Real const, Real const,
+			size_t const);
+		void(*dot4)(Real const*, Real const*, Real const*, Real const*, Real const*, size_t const, Real*);
+		void(*tanh)(Real*, size_t const);
+		Real(*sparseDot)(Real const*, uint32_t const*, Real const*, size_t const);
+		void(*gather)(Real const*, uint32_t const*, Real*, size_t const);
+		void(*gatherAxpy)(Real const, Real const*, uint32_t const*, Real*, size_t const);
+		void(*scatterAxpy)(Real const, Real const*, uint32_t const*, Real*, size_t const);
+		void(*multiply)(Real const*, Real*, size_t const);
+		// density of a row below which SparseDot is faster than Dot, measured on rows of
+		// 1025 weights. The sparse batches of BasicLayer break even at higher densities, so
+		// below it a sparse layer is faster for single samples and batches
+		double sparseCrossover;
+	};
+
+	struct KernelTable {
+		kernels::Isa isa;
+		RealKernels<double> doubles;
+		RealKernels<float> floats;
+		void(*mulFixed)(int16_t const*, int16_t const*, int16_t*, size_t const, int const);
+		void(*axpyFixed)(int16_t const, int16_t const*, int16_t*, size_t const, int const);
+		int32_t(*dotInt8)(int8_t const*, int8_t const*, size_t const);
+		void(*dot4Int8)(int8_t const*, int8_t const*, int8_t const*, int8_t const*, int8_t const*, size_t const,
+			int32_t*);
+	};
+
+	KernelTable const cScalarTable = { kernels::Isa::Scalar,
+		{ DotScalar<double>, AxpyScalar<double>, UpdateWeightsScalar<double>, UpdateNesterovScalar<double>,
+			UpdateRMSPropScalar<double>, UpdateAdamScalar<double>, Dot4Scalar<double>, TanhScalar<double>,
+			SparseDotScalar<double>, GatherScalar<double>, GatherAxpyScalar<double>, ScatterAxpyScalar<double>, MultiplyScalar<double>,
+			0.7 },
+		{ DotScalar<float>, AxpyScalar<float>, UpdateWeightsScalar<float>, UpdateNesterovScalar<float>,
+			UpdateRMSPropScalar<float>, UpdateAdamScalar<float>, Dot4Scalar<float>, TanhScalar<float>,
+			SparseDotScalar<float>, GatherScalar<float>, GatherAxpyScalar<float>, ScatterAxpyScalar<float>, MultiplyScalar<float>,
+			0.7 },
+		MulFixedScalar, AxpyFixedScalar, DotInt8Scalar, Dot4Int8Scalar };
+#ifdef NEURO_X86
+	KernelTable const cSSE2Table = { kernels::Isa::SSE2,
+		{ DotSSE2, AxpySSE2, UpdateWeightsSSE2, UpdateNesterovSSE2, UpdateRMSPropSSE2, UpdateAdamSSE2,
+			Dot4SSE2, TanhSSE2, SparseDotScalar<double>, GatherScalar<double>, GatherAxpyScalar<double>,
+			ScatterAxpyScalar<double>, MultiplySSE2, 0.25 },
+		{ DotSSE2, AxpySSE2, UpdateWeightsSSE2, UpdateNesterovSSE2, UpdateRMSPropSSE2, UpdateAdamSSE2,
+			Dot4SSE2, TanhSSE2, SparseDotScalar<float>, GatherScalar<float>, GatherAxpyScalar<float>,
+			ScatterAxpyScalar<float>, MultiplySSE2, 0.1 },
+		MulFixedSSE2, AxpyFixedSSE2, DotInt8SSE2, Dot4Int8SSE2 };
+	KernelTable const cAVX2Table = { kernels::Isa::AVX2,
+		{ DotAVX2, AxpyAVX2, UpdateWeightsAVX2, UpdateNesterovAVX2, UpdateRMSPropAVX2, UpdateAdamAVX2,
+			Dot4AVX2, TanhAVX2, SparseDotAVX2, GatherAVX2, GatherAxpyAVX2, ScatterAxpyScalar<double>, MultiplyAVX2,
+			0.35 },
+		{ DotAVX2, AxpyAVX2, UpdateWeightsAVX2, UpdateNesterovAVX2, UpdateRMSPropAVX2, UpdateAdamAVX2,
+			Dot4AVX2, TanhAVX2, SparseDotAVX2, GatherAVX2, GatherAxpyAVX2, ScatterAxpyScalar<float>, MultiplyAVX2,
+			0.2 },
+		MulFixedAVX2, AxpyFixedAVX2, DotInt8AVX2, Dot4Int8AVX2 };
+	// SSE2 has no gather instructions and AVX2 no scatter, the scalar versions are used.
+	// AVX-512F has no 8 and 16 bit integer arithmetic (it needs AVX-512BW), the AVX2 versions
+	// are used
+	KernelTable const cAVX512Table = { kernels::Isa::AVX512,
+		{ DotAVX512, AxpyAVX512, UpdateWeightsAVX512, UpdateNesterovAVX512, UpdateRMSPropAVX512, UpdateAdamAVX512,
+			Dot4AVX512, TanhAVX512, SparseDotAVX512, GatherAVX512, GatherAxpyAVX512, ScatterAxpyAVX512, MultiplyAVX512,
+			0.3 },
+		{ DotAVX512, AxpyAVX512, UpdateWeightsAVX512, UpdateNesterovAVX512, UpdateRMSPropAVX512, UpdateAdamAVX512,
+			Dot4AVX512, TanhAVX512, SparseDotAVX512, GatherAVX512, GatherAxpyAVX512, ScatterAxpyAVX512, MultiplyAVX512,
+			0.15 },
+		MulFixedAVX2, AxpyFixedAVX2, DotInt8AVX2, Dot4Int8AVX2 };
+#endif
+
+	KernelTable const* SelectTable(kernels::Isa const isa)
+	{
+		switch (isa) {
+#ifdef NEURO_X86
+		case kernels::Isa::AVX512: return &cAVX512Table;
+		case kernels::Isa::AVX2: return &cAVX2Table;
+		case kernels::Isa::SSE2: return &cSSE2Table;
+#endif
+		default: return &cScalarTable;
+		}
+	}
+
+	// tile sizes of the blocked matrix products: a tile of the reused operand should stay
+	// in the L2 cache (cTileBytes = 128 KiB) while the other operand streams by
+	size_t const cTileBytes = 131072;
+	size_t const cTileRows = 64;
+
+	size_t TileLength(size_t const rowLength, size_t const multiple, size_t const elementSize)
+	{
+		size_t rows = cTileBytes / elementSize / ((rowLength > 0) ? rowLength : 1);
+		rows -= rows % multiple;
+		return (rows < multiple) ? multiple : rows;
+	}
+
+	// the table in use, nullptr until the first kernel call detects the instruction set.
+	// The atomic is constant-initialized, so it is valid before any dynamic initializer
+	// runs and nets constructed during static initialization detect it as well. The tables
+	// are immutable, relaxed accesses are enough when SetIsa switches them while the
+	// threads of a pool run kernels.
+	atomic<KernelTable const*> sKernels(nullptr);
+
+	KernelTable const* Kernels()
+	{
+		KernelTable const* table = sKernels.load(memory_order_relaxed);
+		if (table != nullptr) return table;
+
+		// several threads may detect at the same time, the first one wins
+		KernelTable const* expected = nullptr;
+		table = SelectTable(kernels::DetectIsa());
+		if (!sKernels.compare_exchange_strong(expected, table, memory_order_relaxed)) table = expected;
+		return table;
+	}
+
+	RealKernels<double> const& KernelsFor(double const*)
+	{
+		return Kernels()->doubles;
+	}
+
+	RealKernels<float> const& KernelsFor(float const*)
+	{
+		return Kernels()->floats;
+	}
+
+	//###########################################################################################
+	// Blocked matrix products for double and float
+	template<typename Real>
+	void GemmNTBlocked(Real const* a, size_t const lda, Real const* b, size_t const ldb,
+		Real* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+	{
+		RealKernels<Real> const& kernels = KernelsFor(a);
+		size_t const tileN = TileLength(k, 4, sizeof(Real));
+
+		// keep a tile of B rows in cache and stream the rows of A past it, four rows of B
+		// are multiplied with each row of A at once
+		for (size_t n0 = 0; n0 < n; n0 += tileN) {
+			size_t const n1 = (n0 + tileN < n) ? n0 + tileN : n;
+			for (size_t m0 = 0; m0 < m; m0 += cTileRows) {
+				size_t const m1 = (m0 + cTileRows < m) ? m0 + cTileRows : m;
+				for (size_t i = m0; i < m1; ++i) {
+					Real const* rowA = a + i * lda;
+					Real* rowC = c + i * ldc;
+					size_t j = n0;
+					for (; j + 4 <= n1; j += 4) {
+						kernels.dot4(rowA, b + j * ldb, b + (j + 1) * ldb, b + (j + 2) * ldb,
+							b + (j + 3) * ldb, k, rowC + j);
+					}
+					for (; j < n1; ++j) {
+						rowC[j] = kernels.dot(rowA, b + j * ldb, k);
+					}
+				}
+			}
+		}
+	}
+
+	template<typename Real>
+	void GemmNNBlocked(Real const* a, size_t const lda, Real const* b, size_t const ldb,
+		Real* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+	{
+		RealKernels<Real> const& kernels = KernelsFor(a);
+		size_t const tileK = TileLength(n, 1, sizeof(Real));
+
+		// keep a tile of B rows in cache and add them to every row of C, the k loop runs in
+		// ascending order for each element of C
+		for (size_t k0 = 0; k0 < k; k0 += tileK) {
+			size_t const k1 = (k0 + tileK < k) ? k0 + tileK : k;
+			for (size_t i = 0; i < m; ++i) {
+				Real const* rowA = a + i * lda;
+				Real* rowC = c + i * ldc;
+				for (size_t l = k0; l < k1; ++l) {
+					kernels.axpy(rowA[l], b + l * ldb, rowC, n);
+				}
+			}
+		}
+	}
+
+	template<typename Real>
+	void GemmTNBlocked(Real const* a, size_t const lda, Real const* b, size_t const ldb,
+		Real* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+	{
+		RealKernels<Real> const& kernels = KernelsFor(a);
+		size_t const tileK = TileLength(n, 1, sizeof(Real));
+
+		// keep a tile of B rows in cache while each row of C collects its contributions,
+		// the k loop runs in ascending order for each element of C
+		for (size_t k0 = 0; k0 < k; k0 += tileK) {
+			size_t const k1 = (k0 + tileK < k) ? k0 + tileK : k;
+			for (size_t i = 0; i < m; ++i) {
+				Real* rowC = c + i * ldc;
+				for (size_t l = k0; l < k1; ++l) {
+					kernels.axpy(a[l * lda + i], b + l * ldb, rowC, n);
+				}
+			}
+		}
+	}
+}
+
+kernels::Isa kernels::DetectIsa()
+{
+#if defined(NEURO_X86) && defined(_MSC_VER)
+	int info[4] = { 0 };
+	__cpuid(info, 0);
+	int const maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool const sse2 = (info[3] & (1 << 26)) != 0;
+	bool const osxsave = (info[2] & (1 << 27)) != 0;
+	bool const avx = (info[2] & (1 << 28)) != 0;
+	unsigned long long const xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool const osAvx = (xcr0 & 0x6) == 0x6;
+	bool const osAvx512 = (xcr0 & 0xe6) == 0xe6;
+	bool avx2 = false, avx512 = false;
+	if (maxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+		avx512 = (info[1] & (1 << 16)) != 0;
+	}
+	if (avx512 && osAvx512) return Isa::AVX512;
+	if (avx && avx2 && osAvx) return Isa::AVX2;
+	if (sse2) return Isa::SSE2;
+	return Isa::Scalar;
+#elif defined(NEURO_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+	if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+	if (__builtin_cpu_supports("sse2")) return Isa::SSE2;
+	return Isa::Scalar;
+#else
+	return Isa::Scalar;
+#endif
+}
+
+kernels::Isa kernels::GetIsa()
+{
+	return Kernels()->isa;
+}
+
+kernels::Isa kernels::SetIsa(Isa const isa)
+{
+	Isa const best = DetectIsa();
+	KernelTable const* table = SelectTable((isa > best) ? best : isa);
+	sKernels.store(table, memory_order_relaxed);
+	return table->isa;
+}
+
+char const* kernels::IsaName(Isa const isa)
+{
+	switch (isa) {
+	case Isa::SSE2: return "SSE2";
+	case Isa::AVX2: return "AVX2";
+	case Isa::AVX512: return "AVX-512";
+	default: return "Scalar";
+	}
+}
+
+double kernels::Dot(double const* a, double const* b, size_t const n)
+{
+	return Kernels()->doubles.dot(a, b, n);
+}
+
+float kernels::Dot(float const* a, float const* b, size_t const n)
+{
+	return Kernels()->floats.dot(a, b, n);
+}
+
+void kernels::Axpy(double const a, double const* x, double* y, size_t const n)
+{
+	Kernels()->doubles.axpy(a, x, y, n);
+}
+
+void kernels::Axpy(float const a, float const* x, float* y, size_t const n)
+{
+	Kernels()->floats.axpy(a, x, y, n);
+}
+
+void kernels::UpdateWeights(double* weights, double* deltaWeights, double const* inputs,
+	double const eta, double const gradient, double const alpha, size_t const n)
+{
+	Kernels()->doubles.updateWeights(weights, deltaWeights, inputs, eta, gradient, alpha, n);
+}
+
+void kernels::UpdateWeights(float* weights, float* deltaWeights, float const* inputs,
+	float const eta, float const gradient, float const alpha, size_t const n)
+{
+	Kernels()->floats.updateWeights(weights, deltaWeights, inputs, eta, gradient, alpha, n);
+}
+
+void kernels::UpdateWeightsNesterov(double* weights, double* velocities, double const* inputs,
+	double const eta, double const gradient, double const alpha, size_t const n)
+{
+	Kernels()->doubles.updateNesterov(weights, velocities, inputs, eta, gradient, alpha, n);
+}
+
+void kernels::UpdateWeightsNesterov(float* weights, float* velocities, float const* inputs,
+	float const eta, float const gradient, float const alpha, size_t const n)
+{
+	Kernels()->floats.updateNesterov(weights, velocities, inputs, eta, gradient, alpha, n);
+}
+
+void kernels::UpdateWeightsRMSProp(double* weights, double* squares, double const* inputs,
+	double const eta, double const gradient, double const decay, double const epsilon, size_t const n)
+{
+	Kernels()->doubles.updateRMSProp(weights, squares, inputs, eta, gradient, decay, epsilon, n);
+}
+
+void kernels::UpdateWeightsRMSProp(float* weights, float* squares, float const* inputs,
+	float const eta, float const gradient, float const decay, float const epsilon, size_t const n)
+{
+	Kernels()->floats.updateRMSProp(weights, squares, inputs, eta, gradient, decay, epsilon, n);
+}
+
+void kernels::UpdateWeightsAdam(double* weights, double* moments, double* squares, double const* inputs,
+	double const eta, double const gradient, double const beta1, double const beta2, double const epsilon,
+	size_t const n)
+{
+	Kernels()->doubles.updateAdam(weights, moments, squares, inputs, eta, gradient, beta1, beta2, epsilon, n);
+}
+
+void kernels::UpdateWeightsAdam(float* weights, float* moments, float* squares, float const* inputs,
+	float const eta, float const gradient, float const beta1, float const beta2, float const epsilon,
+	size_t const n)
+{
+	Kernels()->floats.updateAdam(weights, moments, squares, inputs, eta, gradient, beta1, beta2, epsilon, n);
+}
+
+void kernels::Dot4(double const* a, double const* b0, double const* b1, double const* b2,
+	double const* b3, size_t const n, double* sums)
+{
+	Kernels()->doubles.dot4(a, b0, b1, b2, b3, n, sums);
+}
+
+void kernels::Dot4(float const* a, float const* b0, float const* b1, float const* b2,
+	float const* b3, size_t const n, float* sums)
+{
+	Kernels()->floats.dot4(a, b0, b1, b2, b3, n, sums);
+}
+
+void kernels::Tanh(double* values, size_t const n)
+{
+	Kernels()->doubles.tanh(values, n);
+}
+
+void kernels::Tanh(float* values, size_t const n)
+{
+	Kernels()->floats.tanh(values, n);
+}
+
+double kernels::SparseDot(double const* values, uint32_t const* columns, double const* x, size_t const n)
+{
+	return Kernels()->doubles.sparseDot(values, columns, x, n);
+}
+
+float kernels::SparseDot(float const* values, uint32_t const* columns, float const* x, size_t const n)
+{
+	return Kernels()->floats.sparseDot(values, columns, x, n);
+}
+
+void kernels::Gather(double const* x, uint32_t const* columns, double* y, size_t const n)
+{
+	Kernels()->doubles.gather(x, columns, y, n);
+}
+
+void kernels::Gather(float const* x, uint32_t const* columns, float* y, size_t const n)
+{
+	Kernels()->floats.gather(x, columns, y, n);
+}
+
+void kernels::GatherAxpy(double const a, double const* x, uint32_t const* columns, double* y, size_t const n)
+{
+	Kernels()->doubles.gatherAxpy(a, x, columns, y, n);
+}
+
+void kernels::GatherAxpy(float const a, float const* x, uint32_t const* columns, float* y, size_t const n)
+{
+	Kernels()->floats.gatherAxpy(a, x, columns, y, n);
+}
+
+void kernels::ScatterAxpy(double const a, double const* x, uint32_t const* columns, double* y, size_t const n)
+{
+	Kernels()->doubles.scatterAxpy(a, x, columns, y, n);
+}
+
+void kernels::ScatterAxpy(float const a, float const* x, uint32_t const* columns, float* y, size_t const n)
+{
+	Kernels()->floats.scatterAxpy(a, x, columns, y, n);
+}
+
+void kernels::Multiply(double const* x, double* y, size_t const n)
+{
+	Kernels()->doubles.multiply(x, y, n);
+}
+
+void kernels::Multiply(float const* x, float* y, size_t const n)
+{
+	Kernels()->floats.multiply(x, y, n);
+}
+
+template<>
+double kernels::SparseCrossover<double>()
+{
+	return Kernels()->doubles.sparseCrossover;
+}
+
+template<>
+double kernels::SparseCrossover<float>()
+{
+	return Kernels()->floats.sparseCrossover;
+}
+
+void kernels::GemmNT(double const* a, size_t const lda, double const* b, size_t const ldb,
+	double* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+{
+	GemmNTBlocked(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+void kernels::GemmNT(float const* a, size_t const lda, float const* b, size_t const ldb,
+	float* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+{
+	GemmNTBlocked(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+void kernels::GemmNN(double const* a, size_t const lda, double const* b, size_t const ldb,
+	double* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+{
+	GemmNNBlocked(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+void kernels::GemmNN(float const* a, size_t const lda, float const* b, size_t const ldb,
+	float* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+{
+	GemmNNBlocked(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+void kernels::GemmTN(double const* a, size_t const lda, double const* b, size_t const ldb,
+	double* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+{
+	GemmTNBlocked(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+void kernels::GemmTN(float const* a, size_t const lda, float const* b, size_t const ldb,
+	float* c, size_t const ldc, size_t const m, size_t const n, size_t const k)
+{
+	GemmTNBlocked(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+void kernels::MulFixed(int16_t const* a, int16_t const* b, int16_t* c, size_t const n, int const fracBits)
+{
+	Kernels()->mulFixed(a, b, c, n, fracBits);
+}
+
+void kernels::AxpyFixed(int16_t const a, int16_t const* x, int16_t* y, size_t const n, int const fracBits)
+{
+	Kernels()->axpyFixed(a, x, y, n, fracBits);
+}
+
+int32_t kernels::DotInt8(int8_t const* a, int8_t const* b, size_t const n)
+{
+	return Kernels()->dotInt8(a, b, n);
+}
+
+void kernels::Dot4Int8(int8_t const* a, int8_t const* b0, int8_t const* b1, int8_t const* b2, int8_t const* b3,
+	size_t const n, int32_t* sums)
+{
+	Kernels()->dot4Int8(a, b0, b1, b2, b3, n, sums);
+}
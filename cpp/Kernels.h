@@ -0,0 +1,192 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Kernels.h
+// Date:        2026/10/16
+// Description: This module contains the vectorized inner loops of the neural net. The best
+//              instruction set is detected at runtime, the scalar kernels are kept as
+//              fallback and as reference for verification.
+//
+//              Tolerance: Axpy, the UpdateWeights kernels, Tanh, Multiply and the sparse
+//              kernels except SparseDot are evaluated element by element with the same
+//              operations as the scalar code (no fused multiply-add, square roots and
+//              divisions are correctly rounded), so all ISAs give bit-identical results. Dot
+//              sums in several lanes and reduces them at the end, which changes the rounding
+//              order. For n products the difference to the scalar result is bounded by
+//              |simd - scalar| <= 2 * n * DBL_EPSILON * sum(|a[i]*b[i]|) (FLT_EPSILON for the
+//              float kernels). The same holds for Dot4, GemmNT and SparseDot. The fixed-point
+//              and int8 kernels work on integers and are bit-identical on all ISAs.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _KERNELS
+#define _KERNELS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kernels {
+	//-------------------------------------------------------------------------------------
+	///Instruction sets a kernel can be compiled for, ordered from worst to best
+	enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+	//-------------------------------------------------------------------------------------
+	///Description: Detect the best instruction set supported by CPU and operating system
+	Isa DetectIsa();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the instruction set that is currently used by the kernels
+	Isa GetIsa();
+	//-------------------------------------------------------------------------------------
+	///Description: Force an instruction set (e.g. Isa::Scalar for verification). Requests
+	///that are not supported by the CPU fall back to the best supported one.
+	///Return: The instruction set that is used from now on
+	Isa SetIsa(Isa const isa);
+	//-------------------------------------------------------------------------------------
+	///Description: Get a printable name of an instruction set
+	char const* IsaName(Isa const isa);
+
+	//-------------------------------------------------------------------------------------
+	///All kernels on real numbers exist for double and float, the float versions process
+	///twice as many elements per instruction.
+
+	//-------------------------------------------------------------------------------------
+	///Description: Dot product sum(a[i] * b[i])
+	double Dot(double const* a, double const* b, size_t const n);
+	float Dot(float const* a, float const* b, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: y[i] += x[i] * a
+	void Axpy(double const a, double const* x, double* y, size_t const n);
+	void Axpy(float const a, float const* x, float* y, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Weight update of one neuron:
+	///deltaWeights[i] = eta * inputs[i] * gradient + alpha * deltaWeights[i]
+	///weights[i] += deltaWeights[i]
+	void UpdateWeights(double* weights, double* deltaWeights, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n);
+	void UpdateWeights(float* weights, float* deltaWeights, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Weight update with Nesterov momentum, the velocity is applied once more
+	///as if the weights were already moved by it (look-ahead):
+	///step = eta * inputs[i] * gradient
+	///velocities[i] = alpha * velocities[i] + step
+	///weights[i] += alpha * velocities[i] + step
+	void UpdateWeightsNesterov(double* weights, double* velocities, double const* inputs,
+		double const eta, double const gradient, double const alpha, size_t const n);
+	void UpdateWeightsNesterov(float* weights, float* velocities, float const* inputs,
+		float const eta, float const gradient, float const alpha, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Weight update with RMSProp, every weight is scaled by the running RMS of
+	///its gradients:
+	///g = inputs[i] * gradient
+	///squares[i] = decay * squares[i] + (1 - decay) * g * g
+	///weights[i] += eta * g / (sqrt(squares[i]) + epsilon)
+	void UpdateWeightsRMSProp(double* weights, double* squares, double const* inputs,
+		double const eta, double const gradient, double const decay, double const epsilon, size_t const n);
+	void UpdateWeightsRMSProp(float* weights, float* squares, float const* inputs,
+		float const eta, float const gradient, float const decay, float const epsilon, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Weight update with Adam, [eta] must already contain the bias correction
+	///of the step:
+	///g = inputs[i] * gradient
+	///moments[i] = beta1 * moments[i] + (1 - beta1) * g
+	///squares[i] = beta2 * squares[i] + (1 - beta2) * g * g
+	///weights[i] += eta * moments[i] / (sqrt(squares[i]) + epsilon)
+	void UpdateWeightsAdam(double* weights, double* moments, double* squares, double const* inputs,
+		double const eta, double const gradient, double const beta1, double const beta2, double const epsilon,
+		size_t const n);
+	void UpdateWeightsAdam(float* weights, float* moments, float* squares, float const* inputs,
+		float const eta, float const gradient, float const beta1, float const beta2, float const epsilon,
+		size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Four dot products of a with b0..b3 at once, a is only loaded once
+	///Params: [sums] Receives the four results
+	void Dot4(double const* a, double const* b0, double const* b1, double const* b2,
+		double const* b3, size_t const n, double* sums);
+	void Dot4(float const* a, float const* b0, float const* b1, float const* b2,
+		float const* b3, size_t const n, float* sums);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Rational approximation of tanh in place (activation::TanhRational, see
+	///Activation.h for its error bound): values[i] = tanh(values[i])
+	void Tanh(double* values, size_t const n);
+	void Tanh(float* values, size_t const n);
+
+	//-------------------------------------------------------------------------------------
+	///Kernels on the rows of a sparse matrix in compressed sparse row (CSR) format: a row
+	///stores its [n] nonzero values and their [columns], in ascending order and distinct.
+
+	//-------------------------------------------------------------------------------------
+	///Description: Dot product of a sparse row and a dense vector sum(values[i] * x[columns[i]])
+	double SparseDot(double const* values, uint32_t const* columns, double const* x, size_t const n);
+	float SparseDot(float const* values, uint32_t const* columns, float const* x, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Gather the elements of a dense vector at the columns of a row: y[i] = x[columns[i]]
+	void Gather(double const* x, uint32_t const* columns, double* y, size_t const n);
+	void Gather(float const* x, uint32_t const* columns, float* y, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: y[i] += x[columns[i]] * a, e.g. the weight gradients of a sparse row
+	void GatherAxpy(double const a, double const* x, uint32_t const* columns, double* y, size_t const n);
+	void GatherAxpy(float const a, float const* x, uint32_t const* columns, float* y, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: y[columns[i]] += x[i] * a, e.g. a sparse row added to a dense vector
+	void ScatterAxpy(double const a, double const* x, uint32_t const* columns, double* y, size_t const n);
+	void ScatterAxpy(float const a, float const* x, uint32_t const* columns, float* y, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: y[i] *= x[i], e.g. a row of weights with a mask of zeros and ones
+	void Multiply(double const* x, double* y, size_t const n);
+	void Multiply(float const* x, float* y, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the density (nonzeros / length) of a row below which the sparse
+	///kernels are faster than the dense ones with the current instruction set. Wide vectors
+	///make the dense kernels cheap, so the crossover is lower for float than for double.
+	template<typename Real>
+	double SparseCrossover();
+
+	//-------------------------------------------------------------------------------------
+	///Cache-blocked matrix-matrix products on row-major matrices. [lda], [ldb] and [ldc] are
+	///the row strides. The NT product has the same tolerance as Dot, the NN and TN products
+	///sum in the same order as the scalar code and are bit-identical on all ISAs.
+
+	//-------------------------------------------------------------------------------------
+	///Description: C[m x n] = A[m x k] * B[n x k]^T (C is overwritten)
+	void GemmNT(double const* a, size_t const lda, double const* b, size_t const ldb,
+		double* c, size_t const ldc, size_t const m, size_t const n, size_t const k);
+	void GemmNT(float const* a, size_t const lda, float const* b, size_t const ldb,
+		float* c, size_t const ldc, size_t const m, size_t const n, size_t const k);
+	//-------------------------------------------------------------------------------------
+	///Description: C[m x n] += A[m x k] * B[k x n]
+	void GemmNN(double const* a, size_t const lda, double const* b, size_t const ldb,
+		double* c, size_t const ldc, size_t const m, size_t const n, size_t const k);
+	void GemmNN(float const* a, size_t const lda, float const* b, size_t const ldb,
+		float* c, size_t const ldc, size_t const m, size_t const n, size_t const k);
+	//-------------------------------------------------------------------------------------
+	///Description: C[m x n] += A[k x m]^T * B[k x n]
+	void GemmTN(double const* a, size_t const lda, double const* b, size_t const ldb,
+		double* c, size_t const ldc, size_t const m, size_t const n, size_t const k);
+	void GemmTN(float const* a, size_t const lda, float const* b, size_t const ldb,
+		float* c, size_t const ldc, size_t const m, size_t const n, size_t const k);
+
+	//-------------------------------------------------------------------------------------
+	///Fixed-point kernels on 16 bit numbers with [fracBits] fractional bits (0..15). Products
+	///are calculated at full precision, rounded to nearest with ties to even and saturated,
+	///which is the resize of the VHDL fixed_pkg with its default styles.
+
+	//-------------------------------------------------------------------------------------
+	///Description: c[i] = resize(a[i] * b[i])
+	void MulFixed(int16_t const* a, int16_t const* b, int16_t* c, size_t const n, int const fracBits);
+	//-------------------------------------------------------------------------------------
+	///Description: y[i] = resize(y[i] + resize(a * x[i]))
+	void AxpyFixed(int16_t const a, int16_t const* x, int16_t* y, size_t const n, int const fracBits);
+
+	//-------------------------------------------------------------------------------------
+	///Integer kernels of quantized inference: 8 bit numbers are multiplied and summed up in
+	///32 bit. The sums are exact as long as n * 128 * 128 fits into 32 bit (n < 131072).
+
+	//-------------------------------------------------------------------------------------
+	///Description: Dot product sum(a[i] * b[i])
+	int32_t DotInt8(int8_t const* a, int8_t const* b, size_t const n);
+	//-------------------------------------------------------------------------------------
+	///Description: Four dot products of [a] with [b0] to [b3] in one pass over [a]
+	void Dot4Int8(int8_t const* a, int8_t const* b0, int8_t const* b1, int8_t const* b2, int8_t const* b3,
+		size_t const n, int32_t* sums);
+}
+
+#endif //_KERNELS
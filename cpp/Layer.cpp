@@ -5,43 +5,642 @@
 // Author:      Nik Haminger
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include <string>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <limits>
 #include "Layer.h"
+#include "Kernels.h"
 
 using namespace std;
 
-Layer::Layer(size_t const numberNeurons, size_t const numCon)
+namespace {
+	// byte offsets of the buffers of a layer in its storage, each one starts on a cache line
+	struct StorageLayout {
+		size_t gradients;
+		size_t weights;
+		size_t deltaWeights;
+		size_t squares;
+		size_t mask;
+		size_t rowStarts;
+		size_t columns;
+		size_t gathered;
+		size_t size;
+	};
+
+	// a dense layer has the buffers up to the squares, the buffers of the other formats
+	// follow them
+	template<typename Real>
+	StorageLayout getLayout(size_t const numberNeurons, size_t const numPrevNeurons, bool const squares,
+		WeightFormat const format, size_t const numWeights)
+	{
+		size_t const numInputs = (numPrevNeurons > 0) ? numPrevNeurons + 1 : 0;
+		size_t const denseSize = numberNeurons * numInputs * sizeof(Real);
+		size_t const matrixSize = (format == WeightFormat::Sparse) ? numWeights * sizeof(Real) : denseSize;
+		StorageLayout layout;
+
+		// the outputs come first
+		layout.gradients = Arena::Align((numberNeurons + 1) * sizeof(Real));
+		layout.weights = Arena::Align(layout.gradients + numberNeurons * sizeof(Real));
+		layout.deltaWeights = Arena::Align(layout.weights + matrixSize);
+		layout.squares = Arena::Align(layout.deltaWeights + matrixSize);
+		layout.mask = squares ? Arena::Align(layout.squares + matrixSize) : layout.squares;
+		layout.rowStarts = (format == WeightFormat::Masked) ? Arena::Align(layout.mask + denseSize) : layout.mask;
+		layout.columns = layout.rowStarts;
+		layout.gathered = layout.rowStarts;
+		if (format == WeightFormat::Sparse) {
+			layout.columns = Arena::Align(layout.rowStarts + (numberNeurons + 1) * sizeof(uint32_t));
+			layout.gathered = Arena::Align(layout.columns + numWeights * sizeof(uint32_t));
+		}
+		layout.size = (format == WeightFormat::Sparse) ? Arena::Align(layout.gathered + numInputs * sizeof(Real))
+			: layout.gathered;
+		return layout;
+	}
+}
+
+template<typename Real>
+size_t BasicLayer<Real>::getStorageSize(size_t const numberNeurons, size_t const numPrevNeurons, bool const squares,
+	WeightFormat const format, size_t const numWeights)
+{
+	return getLayout<Real>(numberNeurons, numPrevNeurons, squares, format, numWeights).size;
+}
+
+template<typename Real>
+BasicLayer<Real>::BasicLayer(size_t const numberNeurons, size_t const numPrevNeurons, Activation const activation,
+	char* storage, bool const squares)
+	: mSize(numberNeurons), mNumInputs((numPrevNeurons > 0) ? numPrevNeurons + 1 : 0), mActivation(activation),
+	mNumWeights(mSize * mNumInputs)
 {
 	if (numberNeurons == 0) throw string("A layer must have at least 1 neuron");
+	if (!activation::IsValid(activation)) throw string("Unknown activation function");
+
+	StorageLayout const layout = getLayout<Real>(numberNeurons, numPrevNeurons, squares, WeightFormat::Dense, 0);
+	mOutputs = reinterpret_cast<Real*>(storage);
+	mGradients = reinterpret_cast<Real*>(storage + layout.gradients);
+	mWeights = reinterpret_cast<Real*>(storage + layout.weights);
+	mDeltaWeights = reinterpret_cast<Real*>(storage + layout.deltaWeights);
+	if (squares) mSquares = reinterpret_cast<Real*>(storage + layout.squares);
+
+	// outputs of [numberNeurons] neurons plus the bias neuron -> force its output val to
+	// 1.0, the other buffers start zeroed
+	mOutputs[mSize] = 1.0;
+}
+
+template<typename Real>
+void BasicLayer<Real>::Rebase(Arena const& from, Arena const& to)
+{
+	mOutputs = to.Rebase(mOutputs, from);
+	mGradients = to.Rebase(mGradients, from);
+	mWeights = to.Rebase(mWeights, from);
+	mDeltaWeights = to.Rebase(mDeltaWeights, from);
+	mSquares = to.Rebase(mSquares, from);
+	mMask = to.Rebase(mMask, from);
+	mRowStarts = to.Rebase(mRowStarts, from);
+	mColumns = to.Rebase(mColumns, from);
+	mGathered = to.Rebase(mGathered, from);
+}
+
+template<typename Real>
+void BasicLayer<Real>::Relocate(char* storage, bool const squares)
+{
+	Rebuild(storage, squares, mFormat, nullptr);
+}
+
+template<typename Real>
+size_t BasicLayer<Real>::SelectWeights(double const sparsity, vector<char>& keep) const
+{
+	if (!(sparsity >= 0.0 && sparsity <= 1.0)) throw string("The sparsity must be in [0, 1]");
+
+	size_t const matrixSize = mSize * mNumInputs;
+	keep.assign(matrixSize, 1);
+	if (mNumInputs < 2) return matrixSize;
+
+	// candidates without the bias weights, the pruned weights are ordered first, the
+	// position breaks ties
+	vector<pair<Real, size_t>> candidates;
+	candidates.reserve(mSize * (mNumInputs - 1));
+	vector<Real> weights(mNumInputs);
+	vector<char> kept(mNumInputs);
+	size_t pruned = 0;
+	for (size_t j = 0; j < mSize; ++j) {
+		ExpandRow(j, weights.data(), nullptr, nullptr, kept.data());
+		for (size_t i = 0; i + 1 < mNumInputs; ++i) {
+			candidates.emplace_back(kept[i] ? abs(weights[i]) : Real(-1), j * mNumInputs + i);
+			if (!kept[i]) ++pruned;
+		}
+	}
+
+	size_t const target = static_cast<size_t>(llround(sparsity * candidates.size()));
+	size_t const count = max(target, pruned);
+	if (count > 0 && count < candidates.size()) {
+		nth_element(candidates.begin(), candidates.begin() + count, candidates.end());
+	}
+	for (size_t k = 0; k < count; ++k) {
+		keep[candidates[k].second] = 0;
+	}
+	return matrixSize - count;
+}
+
+template<typename Real>
+void BasicLayer<Real>::Prune(char* storage, bool const squares, WeightFormat const format, char const* keep)
+{
+	Rebuild(storage, squares, format, keep);
+}
+
+template<typename Real>
+void BasicLayer<Real>::Rebuild(char* storage, bool const squares, WeightFormat const format, char const* keep)
+{
+	size_t const matrixSize = mSize * mNumInputs;
+	size_t numWeights = matrixSize;
+	if (keep != nullptr) {
+		for (size_t j = 0; j < mSize; ++j) {
+			if (!keep[j * mNumInputs + mNumInputs - 1]) throw string("The bias weights can't be pruned");
+		}
+		if (format == WeightFormat::Sparse) numWeights = static_cast<size_t>(count_if(keep, keep + matrixSize,
+			[](char const flag) { return flag != 0; }));
+	}
+	else if (format == WeightFormat::Sparse) {
+		numWeights = mNumWeights;
+	}
+	if (numWeights > numeric_limits<uint32_t>::max()) throw string("A sparse layer can't have that many weights");
+
+	StorageLayout const layout = getLayout<Real>(mSize, (mNumInputs > 0) ? mNumInputs - 1 : 0, squares, format,
+		numWeights);
+	Real* outputs = reinterpret_cast<Real*>(storage);
+	Real* gradients = reinterpret_cast<Real*>(storage + layout.gradients);
+	Real* weights = reinterpret_cast<Real*>(storage + layout.weights);
+	Real* deltaWeights = reinterpret_cast<Real*>(storage + layout.deltaWeights);
+	Real* squareValues = squares ? reinterpret_cast<Real*>(storage + layout.squares) : nullptr;
+	Real* mask = (format == WeightFormat::Masked) ? reinterpret_cast<Real*>(storage + layout.mask) : nullptr;
+	uint32_t* rowStarts = nullptr;
+	uint32_t* columns = nullptr;
+	Real* gathered = nullptr;
+	if (format == WeightFormat::Sparse) {
+		rowStarts = reinterpret_cast<uint32_t*>(storage + layout.rowStarts);
+		columns = reinterpret_cast<uint32_t*>(storage + layout.columns);
+		gathered = reinterpret_cast<Real*>(storage + layout.gathered);
+	}
+
+	copy(mOutputs, mOutputs + mSize + 1, outputs);
+	copy(mGradients, mGradients + mSize, gradients);
+
+	// every row is expanded to dense rows and written in the new format
+	vector<Real> rowWeights(mNumInputs), rowDeltas(mNumInputs), rowSquares(mNumInputs);
+	vector<char> kept(mNumInputs);
+	size_t next = 0;
+	for (size_t j = 0; j < mSize; ++j) {
+		size_t const row = j * mNumInputs;
+		ExpandRow(j, rowWeights.data(), rowDeltas.data(), rowSquares.data(), kept.data());
+		if (keep != nullptr) copy(keep + row, keep + row + mNumInputs, kept.begin());
+
+		if (format == WeightFormat::Sparse) rowStarts[j] = static_cast<uint32_t>(next);
+		for (size_t i = 0; i < mNumInputs; ++i) {
+			if (format == WeightFormat::Sparse) {
+				if (!kept[i]) continue;
+				columns[next] = static_cast<uint32_t>(i);
+				weights[next] = rowWeights[i];
+				deltaWeights[next] = rowDeltas[i];
+				if (squareValues != nullptr) squareValues[next] = rowSquares[i];
+				++next;
+				continue;
+			}
+			weights[row + i] = kept[i] ? rowWeights[i] : Real(0);
+			deltaWeights[row + i] = kept[i] ? rowDeltas[i] : Real(0);
+			if (squareValues != nullptr) squareValues[row + i] = kept[i] ? rowSquares[i] : Real(0);
+			if (mask != nullptr) mask[row + i] = kept[i] ? Real(1) : Real(0);
+		}
+	}
+	if (format == WeightFormat::Sparse) rowStarts[mSize] = static_cast<uint32_t>(next);
+
+	mFormat = format;
+	mNumWeights = numWeights;
+	mOutputs = outputs;
+	mGradients = gradients;
+	mWeights = weights;
+	mDeltaWeights = deltaWeights;
+	mSquares = squareValues;
+	mMask = mask;
+	mRowStarts = rowStarts;
+	mColumns = columns;
+	mGathered = gathered;
+}
 
-	// create [numberNeurons] neurons with the specified activationFunction and number of connections
-	// to the next layer
-	for (size_t i = 0; i <= numberNeurons; ++i) {
-		mNeurons.push_back(Neuron(numCon, i));
+template<typename Real>
+void BasicLayer<Real>::ExpandRow(size_t const index, Real* weights, Real* deltaWeights, Real* squares,
+	char* kept) const
+{
+	if (mFormat == WeightFormat::Sparse) {
+		if (weights != nullptr) fill(weights, weights + mNumInputs, Real(0));
+		if (deltaWeights != nullptr) fill(deltaWeights, deltaWeights + mNumInputs, Real(0));
+		if (squares != nullptr) fill(squares, squares + mNumInputs, Real(0));
+		if (kept != nullptr) fill(kept, kept + mNumInputs, 0);
+		for (size_t k = mRowStarts[index]; k < mRowStarts[index + 1]; ++k) {
+			size_t const column = mColumns[k];
+			if (weights != nullptr) weights[column] = mWeights[k];
+			if (deltaWeights != nullptr) deltaWeights[column] = mDeltaWeights[k];
+			if (squares != nullptr) squares[column] = (mSquares != nullptr) ? mSquares[k] : Real(0);
+			if (kept != nullptr) kept[column] = 1;
+		}
+		return;
+	}
+
+	size_t const row = index * mNumInputs;
+	for (size_t i = 0; i < mNumInputs; ++i) {
+		if (weights != nullptr) weights[i] = mWeights[row + i];
+		if (deltaWeights != nullptr) deltaWeights[i] = mDeltaWeights[row + i];
+		if (squares != nullptr) squares[i] = (mSquares != nullptr) ? mSquares[row + i] : Real(0);
+		if (kept != nullptr) kept[i] = (mMask == nullptr || mMask[row + i] != Real(0)) ? 1 : 0;
 	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::DrawRandomWeights()
+{
+	if (mFormat == WeightFormat::Sparse) throw string("The weights of a sparse layer can't be replaced");
+
+	// one row of input weights per neuron, the random weights are drawn in the same order
+	// as the neurons of the previous layer would draw their forward connections
+	for (size_t i = 0; i < mNumInputs; ++i) {
+		for (size_t j = 0; j < mSize; ++j) {
+			mWeights[j * mNumInputs + i] = BasicNeuron<Real>::getRandomWeight();
+		}
+	}
+	if (mMask != nullptr) {
+		for (size_t j = 0; j < mSize; ++j) {
+			kernels::Multiply(mMask + j * mNumInputs, mWeights + j * mNumInputs, mNumInputs);
+		}
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::DrawWeights(Initializer const type, Philox const& generator, size_t const index,
+	size_t const first, size_t const count)
+{
+	if (mFormat == WeightFormat::Sparse) throw string("The weights of a sparse layer can't be replaced");
+	if (mNumInputs == 0) return;
+
+	for (size_t j = first; j < first + count; ++j) {
+		initializer::DrawRow(type, generator, index, j, mWeights + j * mNumInputs, mNumInputs - 1, mSize);
+		if (mMask != nullptr) kernels::Multiply(mMask + j * mNumInputs, mWeights + j * mNumInputs, mNumInputs);
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::ResetState()
+{
+	fill(mDeltaWeights, mDeltaWeights + mNumWeights, Real(0));
+	if (mSquares != nullptr) fill(mSquares, mSquares + mNumWeights, Real(0));
+}
+
+template<typename Real>
+size_t BasicLayer<Real>::getSize() const
+{
+	return mSize;
+}
 
-	// bias neuron -> force output val to 1.0
-	mNeurons.back().setOutputVal(1.0);
+template<typename Real>
+size_t BasicLayer<Real>::getNumInputs() const
+{
+	return mNumInputs;
+}
+
+template<typename Real>
+Activation BasicLayer<Real>::getActivation() const
+{
+	return mActivation;
+}
+
+template<typename Real>
+WeightFormat BasicLayer<Real>::getFormat() const
+{
+	return mFormat;
+}
+
+template<typename Real>
+size_t BasicLayer<Real>::getNumWeights() const
+{
+	return mNumWeights;
+}
+
+template<typename Real>
+BasicNeuron<Real> BasicLayer<Real>::getNeuronAt(size_t const index)
+{
+	if (index > mSize) throw string("Layer doesn't have that many neurons");
+	if (mFormat == WeightFormat::Sparse) throw string("The neurons of a sparse layer have no weight rows");
+
+	// the bias neuron has neither a gradient nor input weights
+	if (index == mSize) return BasicNeuron<Real>(&mOutputs[index], nullptr, nullptr, nullptr, 0);
+	return BasicNeuron<Real>(&mOutputs[index], &mGradients[index], mWeights + index * mNumInputs,
+		mDeltaWeights + index * mNumInputs, mNumInputs);
+}
+
+template<typename Real>
+Real const* BasicLayer<Real>::getOutputs() const
+{
+	return mOutputs;
+}
+
+template<typename Real>
+Real const* BasicLayer<Real>::getGradients() const
+{
+	return mGradients;
 }
 
-size_t Layer::getSize() const
+template<typename Real>
+Real const* BasicLayer<Real>::getWeights() const
 {
-	return mNeurons.size() - 1;
+	return mWeights;
 }
 
-std::vector<Neuron>& Layer::getNeurons()
+template<typename Real>
+Real const* BasicLayer<Real>::getDeltaWeights() const
 {
-	return mNeurons;
+	return mDeltaWeights;
 }
 
-Neuron & Layer::getNeuronAt(size_t const index)
+template<typename Real>
+Real const* BasicLayer<Real>::getSquares() const
 {
-	if (index >= mNeurons.size()) throw string("Layer doesn't have that many neurons");
-	return mNeurons[index];
+	return mSquares;
 }
 
-void Layer::setEta(double const & eta)
+template<typename Real>
+void BasicLayer<Real>::CopyWeights(Real* weights, Real* deltaWeights, Real* squares, char* keep) const
 {
-	for (int i = 0; i < mNeurons.size(); ++i) {
-		mNeurons[i].setEta(eta);
+	for (size_t j = 0; j < mSize; ++j) {
+		ExpandRow(j, weights + j * mNumInputs, (deltaWeights != nullptr) ? deltaWeights + j * mNumInputs : nullptr,
+			(squares != nullptr) ? squares + j * mNumInputs : nullptr, (keep != nullptr) ? keep + j * mNumInputs : nullptr);
 	}
 }
+
+template<typename Real>
+void BasicLayer<Real>::setWeights(Real const* weights, Real const* deltaWeights, Real const* squares)
+{
+	if (mFormat == WeightFormat::Sparse) throw string("The weights of a sparse layer can't be replaced");
+	if (squares != nullptr && mSquares == nullptr) throw string("The layer has no running squares");
+
+	copy(weights, weights + mSize * mNumInputs, mWeights);
+	copy(deltaWeights, deltaWeights + mSize * mNumInputs, mDeltaWeights);
+	if (squares != nullptr) copy(squares, squares + mSize * mNumInputs, mSquares);
+	if (mMask != nullptr) {
+		for (size_t j = 0; j < mSize; ++j) {
+			kernels::Multiply(mMask + j * mNumInputs, mWeights + j * mNumInputs, mNumInputs);
+		}
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::setOutputs(Real const* input)
+{
+	for (size_t i = 0; i < mSize; ++i) {
+		mOutputs[i] = input[i];
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::ForwardPropagate(BasicLayer const& prevLayer)
+{
+	Real const* prevOutputs = prevLayer.mOutputs;
+
+	for (size_t j = 0; j < mSize; ++j) {
+		// sum up values of previous layer's neurons x the weight of the connections
+		if (mFormat == WeightFormat::Sparse) {
+			size_t const start = mRowStarts[j];
+			mOutputs[j] = kernels::SparseDot(mWeights + start, mColumns + start, prevOutputs, mRowStarts[j + 1] - start);
+		}
+		else {
+			mOutputs[j] = kernels::Dot(prevOutputs, mWeights + j * mNumInputs, mNumInputs);
+		}
+	}
+	activation::Apply(mActivation, mOutputs, mSize);
+}
+
+template<typename Real>
+Real BasicLayer<Real>::CalcOutputGradients(Real const* target)
+{
+	Real sqrError = 0;
+	for (size_t j = 0; j < mSize; ++j) {
+		Real delta = target[j] - mOutputs[j];
+		sqrError += delta*delta;
+		mGradients[j] = delta;
+	}
+	activation::MultiplyDeriv(mActivation, mOutputs, mGradients, mSize);
+	return sqrError;
+}
+
+template<typename Real>
+void BasicLayer<Real>::BackPropagate(BasicLayer& prevLayer, optimizer::Step<Real> const& step)
+{
+	// the input layer has no input weights and needs no gradients
+	bool const hidden = prevLayer.mNumInputs > 0;
+	if (hidden) {
+		for (size_t i = 0; i < prevLayer.mSize; ++i) {
+			prevLayer.mGradients[i] = 0.0;
+		}
+	}
+
+	for (size_t j = 0; j < mSize; ++j) {
+		if (mFormat == WeightFormat::Sparse) {
+			// the same steps on the stored weights of the row, the inputs of the update are
+			// gathered from their columns
+			size_t const start = mRowStarts[j];
+			size_t const length = mRowStarts[j + 1] - start;
+			if (hidden) kernels::ScatterAxpy(mGradients[j], mWeights + start, mColumns + start, prevLayer.mGradients,
+				length - 1);
+			kernels::Gather(prevLayer.mOutputs, mColumns + start, mGathered, length);
+			optimizer::Update(step, mWeights + start, mDeltaWeights + start,
+				(mSquares != nullptr) ? mSquares + start : nullptr, mGathered, mGradients[j], length);
+			continue;
+		}
+
+		Real* weights = mWeights + j * mNumInputs;
+
+		// sum the contributions of the previous layer's neurons to the error at neuron j,
+		// the bias weight at the end of the row is skipped
+		if (hidden) kernels::Axpy(mGradients[j], weights, prevLayer.mGradients, prevLayer.mSize);
+
+		// while the row is in the cache: individual input, magnified by the gradient, the
+		// optimizer turns it into the update of the row
+		size_t const row = j * mNumInputs;
+		optimizer::Update(step, weights, mDeltaWeights + row, (mSquares != nullptr) ? mSquares + row : nullptr,
+			prevLayer.mOutputs, mGradients[j], mNumInputs);
+		// the pruned weights are set back to zero
+		if (mMask != nullptr) kernels::Multiply(mMask + row, weights, mNumInputs);
+	}
+
+	if (hidden) activation::MultiplyDeriv(prevLayer.mActivation, prevLayer.mOutputs, prevLayer.mGradients, prevLayer.mSize);
+}
+
+template<typename Real>
+void BasicLayer<Real>::ForwardPropagateBatch(Real const* prevOutputs, Real* outputs, size_t const count) const
+{
+	if (mFormat != WeightFormat::Sparse) {
+		ForwardPropagateBatch(mWeights, mSize, mNumInputs, mActivation, prevOutputs, outputs, count);
+		return;
+	}
+
+	// the inputs are transposed, so every stored weight adds its column of all samples to
+	// the sums of its row with one Axpy, the sums are added in the order of the weights.
+	// The scratch buffers of the thread only grow, so Predict stays thread-safe.
+	thread_local BasicData<Real> transposed, sums;
+	if (transposed.size() < mNumInputs * count) transposed.resize(mNumInputs * count);
+	if (sums.size() < count) sums.resize(count);
+	for (size_t s = 0; s < count; ++s) {
+		for (size_t i = 0; i < mNumInputs; ++i) {
+			transposed[i * count + s] = prevOutputs[s * mNumInputs + i];
+		}
+	}
+
+	// the bias column of the outputs is left untouched
+	size_t const columns = mSize + 1;
+	for (size_t j = 0; j < mSize; ++j) {
+		fill(sums.begin(), sums.begin() + count, Real(0));
+		for (size_t k = mRowStarts[j]; k < mRowStarts[j + 1]; ++k) {
+			kernels::Axpy(mWeights[k], transposed.data() + mColumns[k] * count, sums.data(), count);
+		}
+		for (size_t s = 0; s < count; ++s) {
+			outputs[s * columns + j] = sums[s];
+		}
+	}
+	for (size_t s = 0; s < count; ++s) {
+		activation::Apply(mActivation, outputs + s * columns, mSize);
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::ForwardPropagateBatch(Real const* weights, size_t const size, size_t const numInputs,
+	Activation const activation, Real const* prevOutputs, Real* outputs, size_t const count)
+{
+	size_t const columns = size + 1;
+
+	// sum up values of previous layer's neurons x the weight of the connections for all
+	// samples at once, the bias column of the outputs is left untouched
+	kernels::GemmNT(prevOutputs, numInputs, weights, numInputs, outputs, columns, count, size, numInputs);
+
+	for (size_t s = 0; s < count; ++s) {
+		activation::Apply(activation, outputs + s * columns, size);
+	}
+}
+
+template<typename Real>
+Real BasicLayer<Real>::CalcOutputGradientsBatch(Real const* outputs, Real const* targets, Real* gradients,
+	size_t const count) const
+{
+	size_t const columns = mSize + 1;
+	Real sqrError = 0;
+
+	for (size_t s = 0; s < count; ++s) {
+		Real const* row = outputs + s * columns;
+		for (size_t j = 0; j < mSize; ++j) {
+			Real delta = targets[s * mSize + j] - row[j];
+			sqrError += delta*delta;
+			gradients[s * mSize + j] = delta;
+		}
+		activation::MultiplyDeriv(mActivation, row, gradients + s * mSize, mSize);
+	}
+
+	return sqrError;
+}
+
+template<typename Real>
+Real BasicLayer<Real>::AddSquaredErrorsBatch(Real const* outputs, Real const* targets, size_t const count,
+	Real sqrError) const
+{
+	size_t const columns = mSize + 1;
+
+	for (size_t s = 0; s < count; ++s) {
+		Real const* row = outputs + s * columns;
+		for (size_t j = 0; j < mSize; ++j) {
+			Real delta = targets[s * mSize + j] - row[j];
+			sqrError += delta*delta;
+		}
+	}
+
+	return sqrError;
+}
+
+template<typename Real>
+void BasicLayer<Real>::CalcHiddenGradientsBatch(BasicLayer const& nextLayer, Real const* nextGradients,
+	Real const* outputs, Real* gradients, size_t const count) const
+{
+	size_t const columns = mSize + 1;
+
+	// sum our contributions of the errors at the nodes we feed, the bias column of the
+	// next layer's weights is skipped
+	for (size_t i = 0; i < count * mSize; ++i) {
+		gradients[i] = 0.0;
+	}
+	if (nextLayer.mFormat == WeightFormat::Sparse) {
+		// every stored weight of the next layer adds to the gradient of its column
+		for (size_t s = 0; s < count; ++s) {
+			for (size_t j = 0; j < nextLayer.mSize; ++j) {
+				size_t const start = nextLayer.mRowStarts[j];
+				kernels::ScatterAxpy(nextGradients[s * nextLayer.mSize + j], nextLayer.mWeights + start,
+					nextLayer.mColumns + start, gradients + s * mSize, nextLayer.mRowStarts[j + 1] - start - 1);
+			}
+		}
+	}
+	else {
+		kernels::GemmNN(nextGradients, nextLayer.mSize, nextLayer.mWeights, nextLayer.mNumInputs,
+			gradients, mSize, count, mSize, nextLayer.mSize);
+	}
+
+	for (size_t s = 0; s < count; ++s) {
+		activation::MultiplyDeriv(mActivation, outputs + s * columns, gradients + s * mSize, mSize);
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::CalcWeightGradientsBatch(Real const* prevOutputs, Real const* gradients,
+	Real* weightGradients, size_t const count) const
+{
+	AddWeightGradientsBatch(prevOutputs, gradients, weightGradients, count, 0, mSize, true);
+}
+
+template<typename Real>
+void BasicLayer<Real>::AddWeightGradientsBatch(Real const* prevOutputs, Real const* gradients,
+	Real* weightGradients, size_t const count, size_t const first, size_t const rows, bool const clear) const
+{
+	size_t const begin = (mFormat == WeightFormat::Sparse) ? mRowStarts[first] : first * mNumInputs;
+	size_t const end = (mFormat == WeightFormat::Sparse) ? mRowStarts[first + rows] : (first + rows) * mNumInputs;
+
+	if (clear) {
+		for (size_t i = begin; i < end; ++i) {
+			weightGradients[i] = 0.0;
+		}
+	}
+	if (mFormat != WeightFormat::Sparse) {
+		kernels::GemmTN(gradients + first, mSize, prevOutputs, mNumInputs, weightGradients + begin, mNumInputs,
+			rows, mNumInputs, count);
+		return;
+	}
+
+	// the weight gradients are only summed up for the stored weights, in their order
+	for (size_t s = 0; s < count; ++s) {
+		for (size_t j = first; j < first + rows; ++j) {
+			size_t const start = mRowStarts[j];
+			kernels::GatherAxpy(gradients[s * mSize + j], prevOutputs + s * mNumInputs, mColumns + start,
+				weightGradients + start, mRowStarts[j + 1] - start);
+		}
+	}
+}
+
+template<typename Real>
+void BasicLayer<Real>::UpdateInputWeightsBatch(Real const* weightGradients, size_t const count,
+	optimizer::Step<Real> const& step)
+{
+	Real const scale = Real(1) / count;
+
+	// the summed input x gradient products are averaged over the batch, the optimizer
+	// updates the rows like for a single sample
+	for (size_t j = 0; j < mSize; ++j) {
+		size_t const row = (mFormat == WeightFormat::Sparse) ? mRowStarts[j] : j * mNumInputs;
+		size_t const length = (mFormat == WeightFormat::Sparse) ? mRowStarts[j + 1] - row : mNumInputs;
+		optimizer::Update(step, mWeights + row, mDeltaWeights + row, (mSquares != nullptr) ? mSquares + row : nullptr,
+			weightGradients + row, scale, length);
+		if (mMask != nullptr) kernels::Multiply(mMask + row, mWeights + row, length);
+	}
+}
+
+template class BasicLayer<double>;
+template class BasicLayer<float>;
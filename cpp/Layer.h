@@ -8,38 +8,282 @@
 #define _LAYER
 
 #include <vector>
-#include "Object.h"
 #include "Neuron.h"
+#include "Activation.h"
+#include "Optimizer.h"
+#include "Initializer.h"
+#include "Arena.h"
+
+//-------------------------------------------------------------------------------------------
+///Vectors of input, target and result values in the number type of a net
+template<typename Real>
+using BasicData = std::vector<Real>;
+typedef BasicData<double> Data;
+typedef BasicData<float> FloatData;
+typedef std::vector<size_t> LayerSizes;
+
+//-------------------------------------------------------------------------------------------
+///How a layer stores its weights:
+///Dense  - the row-major matrix of all weights
+///Masked - the dense matrix and a mask of zeros and ones, pruned weights are kept at zero
+///         after every update
+///Sparse - compressed sparse rows (CSR): every row only stores the weights that were not
+///         pruned and their columns, the dense matrix is never formed
+enum class WeightFormat { Dense, Masked, Sparse };
 
 //###########################################################################################
 ///This class represents a layer in a neural network. It can be either an input, output or
-///hidden layer. Basically, it consists of a vector of neurons. When constructed, you have
-///to specify the number of neurons and the activation function for all the neurons in the
-///layer.
-class Layer: public Object
+///hidden layer. The state of all neurons is kept in contiguous buffers: the outputs (the
+///last one belongs to the bias neuron and is always 1.0), the gradients and a row-major
+///matrix with one row of input weights per neuron. Row j holds the weights from all neurons
+///of the previous layer (including its bias neuron) to neuron j, so the forward, gradient
+///and update passes all stream through memory in order. The activation function is applied
+///to a whole row of sums at once, so there is no call per neuron. [Real] is the number type
+///of the net (double or float), the template is instantiated for both in Layer.cpp.
+///
+///A layer doesn't own its buffers: the net places the layers and their buffers in one
+///Arena. The layer has no virtual functions and only points into the arena, so the net
+///copies all layers with the arena and moves the pointers with Rebase. A copy of a layer
+///on its own shares the buffers of the original.
+///
+///The weights are updated by the optimizer of the net (see Optimizer.h), which keeps its
+///state in the delta weights and, for RMSProp and Adam, in a matrix of running squares that
+///is only part of the storage if it was asked for.
+///
+///Pruned layers store their weights in another WeightFormat. The weights, delta weights
+///and running squares then hold getNumWeights() values in the same order: the rows of the
+///matrix for Masked, the nonzeros of the rows for Sparse. The bias weights are never
+///pruned, so in a sparse row the bias weight is always the last one.
+template<typename Real>
+class BasicLayer
 {
 public:
 	//-------------------------------------------------------------------------------------
+	///Description: Get the size of the buffers of a layer
+	///Params: [numberNeurons], [numPrevNeurons] Like in the constructor, [squares] Whether
+	///the storage holds the running squares of the optimizer, [format] How the weights are
+	///stored, [numWeights] Number of weights that are not pruned (only used for Sparse)
+	///Return: Bytes of storage the constructor needs, a multiple of Arena::cAlignment
+	static size_t getStorageSize(size_t const numberNeurons, size_t const numPrevNeurons, bool const squares = false,
+		WeightFormat const format = WeightFormat::Dense, size_t const numWeights = 0);
+	//-------------------------------------------------------------------------------------
 	///Description: Constructor
-	///Params: [numberNeurons] Number of neurons [activationFunc] Activation function for neurons
-	Layer(size_t const numberNeurons, size_t const numCon);
+	///Params: [numberNeurons] Number of neurons, [numPrevNeurons] Number of neurons in the
+	///previous layer WITHOUT bias neuron (0 for the input layer), [activation] Activation
+	///function of the neurons (not used by the input layer), [storage] Zeroed memory of
+	///getStorageSize bytes aligned to Arena::cAlignment, which must outlive the layer,
+	///[squares] Whether the storage holds the running squares. The weights start at zero
+	///until they are drawn with DrawRandomWeights or DrawWeights.
+	BasicLayer(size_t const numberNeurons, size_t const numPrevNeurons, Activation const activation,
+		char* storage, bool const squares = false);
+	//-------------------------------------------------------------------------------------
+	///Description: Move the buffer pointers of a layer that was copied along with its arena
+	///Params: [from] The arena the layer was copied from, [to] The copy
+	void Rebase(Arena const& from, Arena const& to);
+	//-------------------------------------------------------------------------------------
+	///Description: Copy the buffers into new storage, e.g. to add the running squares
+	///Params: [storage] Zeroed memory of getStorageSize(getSize(), previous size, [squares],
+	///getFormat(), getNumWeights()) bytes, the old storage is not used afterwards,
+	///[squares] Like in the constructor
+	void Relocate(char* storage, bool const squares);
+	//-------------------------------------------------------------------------------------
+	///Description: Choose the weights to prune by magnitude: the smallest weights of the
+	///layer are pruned until [sparsity] of them are zero. Bias weights are never pruned and
+	///weights that were pruned before stay pruned, so the sparsity never decreases. Ties
+	///are broken by position, so the selection is deterministic.
+	///Params: [sparsity] Fraction of the weights WITHOUT bias weights to prune in [0, 1],
+	///[keep] Receives one flag per weight of the dense matrix, 0 for the pruned ones
+	///Return: Number of weights that are kept
+	size_t SelectWeights(double const sparsity, std::vector<char>& keep) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Copy the buffers into new storage and prune the weights: the pruned
+	///weights and their optimizer state are set to zero (Dense, Masked) or dropped (Sparse)
+	///Params: [storage] Zeroed memory of getStorageSize(getSize(), previous size, [squares],
+	///[format], number of kept weights) bytes, [squares] Like in the constructor, [format]
+	///The new format of the weights, [keep] Flags of SelectWeights
+	void Prune(char* storage, bool const squares, WeightFormat const format, char const* keep);
+	//-------------------------------------------------------------------------------------
+	///Description: Draw all weights from rand() (Initializer::Rand) in the order the
+	///neurons of the previous layer would draw their forward connections, throws if the
+	///layer is sparse
+	void DrawRandomWeights();
+	//-------------------------------------------------------------------------------------
+	///Description: Draw the weights of a range of neurons with a counter-based initializer
+	///(see initializer::DrawRow), throws if the layer is sparse. The pruned weights of a
+	///masked layer stay zero. Ranges of different threads must not overlap.
+	///Params: [type] The initializer, [generator] Generator with the seed of the net,
+	///[index] Index of the layer in the net, [first] First neuron, [count] Number of neurons
+	void DrawWeights(Initializer const type, Philox const& generator, size_t const index, size_t const first,
+		size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Zero the state of the optimizer, the delta weights and running squares
+	void ResetState();
 	//-------------------------------------------------------------------------------------
 	///Description: Get the size of the neuron vector WITHOUT bias neuron
 	size_t getSize() const;
 	//-------------------------------------------------------------------------------------
-	///Description: Get all neurons of this layer
-	///Return: Reference to the neurons
-	std::vector<Neuron>& getNeurons();
+	///Description: Get the length of a weight row (previous layer size + bias neuron)
+	size_t getNumInputs() const;
 	//-------------------------------------------------------------------------------------
-	///Description: Get neuron at a specified index
+	///Description: Get the activation function of the neurons
+	Activation getActivation() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the format of the weights
+	WeightFormat getFormat() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of stored weights, getSize() x getNumInputs() unless the
+	///layer is sparse
+	size_t getNumWeights() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get neuron at a specified index, throws if the layer is sparse
 	///Params: [index] Index of neuron
-	///Return: Reference to the neuron
-	Neuron& getNeuronAt(size_t const index);
+	///Return: Neuron pointing into the buffers of this layer
+	BasicNeuron<Real> getNeuronAt(size_t const index);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the outputs of all neurons including the bias neuron [getSize() + 1]
+	Real const* getOutputs() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the gradients of all neurons WITHOUT bias neuron [getSize()]
+	Real const* getGradients() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the input weights [getNumWeights()] in the format of the layer, the
+	///row-major matrix [getSize() x getNumInputs()] unless the layer is sparse
+	Real const* getWeights() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the delta weights [getNumWeights()] in the format of the layer
+	Real const* getDeltaWeights() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the running squares [getNumWeights()] in the format of the layer,
+	///nullptr if the storage has none
+	Real const* getSquares() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Copy the weights into dense matrices, the pruned weights are zero
+	///Params: [weights], [deltaWeights], [squares], [keep] Receive the row-major matrices
+	///[getSize() x getNumInputs()], all but [weights] may be nullptr, the squares are zero
+	///if the layer has none, [keep] receives the flags of SelectWeights
+	void CopyWeights(Real* weights, Real* deltaWeights, Real* squares = nullptr, char* keep = nullptr) const;
 	//-------------------------------------------------------------------------------------
-	///Description: Set the eta of all neurons
-	///Params: [eta] Learning rate
-	void setEta(double const& eta);
+	///Description: Replace the weights, delta weights and running squares, e.g. with the
+	///ones of a model file, throws if the layer is sparse. The pruned weights of a masked
+	///layer stay zero.
+	///Params: [weights], [deltaWeights], [squares] Row-major matrices [getSize() x
+	///getNumInputs()], [squares] may be nullptr, which keeps them, otherwise the layer
+	///must have running squares
+	void setWeights(Real const* weights, Real const* deltaWeights, Real const* squares = nullptr);
+	//-------------------------------------------------------------------------------------
+	///Description: Set the output values of the neurons manually (needed for input layer)
+	///Params: [input] Input values, one per neuron
+	void setOutputs(Real const* input);
+	//-------------------------------------------------------------------------------------
+	///Description: Process the outputs of the previous layer
+	///Params: [prevLayer] The previous layer
+	void ForwardPropagate(BasicLayer const& prevLayer);
+	//-------------------------------------------------------------------------------------
+	///Description: Calculate the gradients of an output layer
+	///Params: [target] Target values, one per neuron
+	///Return: Sum of the squared errors, calculated in the same pass
+	Real CalcOutputGradients(Real const* target);
+	//-------------------------------------------------------------------------------------
+	///Description: Fused backward step of a layer whose gradients are calculated: the
+	///gradients of the previous layer are summed up from the rows of the weight matrix and
+	///every row is updated to 'learn' right after it was used, so the matrix is swept once
+	///instead of once for the gradients and once for the update. The gradients are taken
+	///from the weights before the update, so the results are the same as with two passes.
+	///Params: [prevLayer] The previous layer, its gradients are calculated unless it is
+	///the input layer, [step] The update of the optimizer
+	void BackPropagate(BasicLayer& prevLayer, optimizer::Step<Real> const& step);
+	//-------------------------------------------------------------------------------------
+	///Batched versions of the passes above. They work on row-major matrices with one row per
+	///sample (see Workspace) instead of the buffers of the layer, so they don't change the
+	///layer and several batches can share its weights.
+
+	//-------------------------------------------------------------------------------------
+	///Description: Process a batch of outputs of the previous layer
+	///Params: [prevOutputs] Outputs of the previous layer [count x getNumInputs()],
+	///[outputs] Outputs of this layer [count x (getSize() + 1)], [count] Number of samples
+	void ForwardPropagateBatch(Real const* prevOutputs, Real* outputs, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: ForwardPropagateBatch on weights that don't belong to a layer, e.g. the
+	///blocks of a mapped model file
+	///Params: [weights] Row-major weights [size x numInputs], [size] Number of neurons
+	///WITHOUT bias neuron, [numInputs] Length of a weight row, [activation] Activation
+	///function of the neurons, the other parameters like above
+	static void ForwardPropagateBatch(Real const* weights, size_t const size, size_t const numInputs,
+		Activation const activation, Real const* prevOutputs, Real* outputs, size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Calculate the gradients of an output layer for a batch
+	///Params: [outputs] Outputs of this layer [count x (getSize() + 1)], [targets] Target
+	///values [count x getSize()], [gradients] Gradients [count x getSize()]
+	///Return: Sum of the squared errors of all samples
+	Real CalcOutputGradientsBatch(Real const* outputs, Real const* targets, Real* gradients,
+		size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Add the squared errors of a batch to a sum in the same order as
+	///CalcOutputGradientsBatch, so the parts of a batch added one after the other give the
+	///same sum as the whole batch
+	///Params: [sqrError] The sum the errors are added to, the other parameters like above
+	///Return: The new sum
+	Real AddSquaredErrorsBatch(Real const* outputs, Real const* targets, size_t const count, Real sqrError) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Calculate the gradients of a hidden layer for a batch
+	///Params: [nextLayer] The next layer, [nextGradients] Its gradients [count x next size],
+	///[outputs] Outputs of this layer [count x (getSize() + 1)], [gradients] Gradients of
+	///this layer [count x getSize()]
+	void CalcHiddenGradientsBatch(BasicLayer const& nextLayer, Real const* nextGradients,
+		Real const* outputs, Real* gradients, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Sum up the weight gradients of a batch
+	///Params: [prevOutputs] Outputs of the previous layer [count x getNumInputs()],
+	///[gradients] Gradients of this layer [count x getSize()], [weightGradients] Receives the
+	///sums in the format of the weights [getNumWeights()], a buffer of [getSize() x
+	///getNumInputs()] fits every format
+	void CalcWeightGradientsBatch(Real const* prevOutputs, Real const* gradients,
+		Real* weightGradients, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Add the weight gradients of a batch to the sums of a range of rows. Each
+	///sum collects the samples in their order, so the parts of a batch added one after the
+	///other give the same sums as CalcWeightGradientsBatch of the whole batch, and the
+	///ranges of rows can be summed up on different threads
+	///Params: [first] First row, [rows] Number of rows, [clear] Whether the sums of the rows
+	///start at zero, the other parameters like in CalcWeightGradientsBatch
+	void AddWeightGradientsBatch(Real const* prevOutputs, Real const* gradients, Real* weightGradients,
+		size_t const count, size_t const first, size_t const rows, bool const clear) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Update the input weights with the averaged weight gradients of a batch
+	///Params: [weightGradients] Summed weight gradients [getNumWeights()],
+	///[count] Number of samples that were summed up, [step] The update of the optimizer
+	void UpdateInputWeightsBatch(Real const* weightGradients, size_t const count, optimizer::Step<Real> const& step);
 private:
-	std::vector<Neuron> mNeurons;
+	//-------------------------------------------------------------------------------------
+	///Description: Copy the buffers into new storage in another format
+	///Params: [keep] Flags of the weights to keep, nullptr keeps the current ones, the other
+	///parameters like in Prune
+	void Rebuild(char* storage, bool const squares, WeightFormat const format, char const* keep);
+	//-------------------------------------------------------------------------------------
+	///Description: Copy a row of the buffers into dense rows [getNumInputs()], pruned
+	///weights are zero
+	///Params: [index] Index of the row, [weights], [deltaWeights], [squares] Receive the
+	///values, [kept] Receives 1 for the weights that are not pruned, all may be nullptr
+	void ExpandRow(size_t const index, Real* weights, Real* deltaWeights, Real* squares, char* kept) const;
+
+	size_t mSize = 0;
+	size_t mNumInputs = 0;
+	Activation mActivation = Activation::Clip;
+	WeightFormat mFormat = WeightFormat::Dense;
+	size_t mNumWeights = 0;
+	Real* mOutputs = nullptr;
+	Real* mGradients = nullptr;
+	Real* mWeights = nullptr;
+	Real* mDeltaWeights = nullptr;
+	Real* mSquares = nullptr;
+	// Masked: zeros and ones [getSize() x getNumInputs()]
+	Real* mMask = nullptr;
+	// Sparse: first weight of every row and one past the last [getSize() + 1], column of
+	// every weight [getNumWeights()] and the inputs gathered for the update of a row
+	uint32_t* mRowStarts = nullptr;
+	uint32_t* mColumns = nullptr;
+	Real* mGathered = nullptr;
 };
-#endif //_LAYER
\ No newline at end of file
+
+typedef BasicLayer<double> Layer;
+#endif //_LAYER
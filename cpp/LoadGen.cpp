@@ -0,0 +1,269 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    LoadGen.cpp
+// Date:        2026/10/16
+// Description: Load generator of the inference server (Server.cpp). Opens a number of
+//              connections, sends scoring requests with random inputs on all of them at
+//              the same time and reports the throughput and the latencies the clients see.
+//
+//              Closed loop (default): every connection sends its next request as soon as
+//              the previous one is answered. Open loop (--rate): the requests are sent on
+//              a fixed schedule and the latency counts from the scheduled time, so a
+//              server that falls behind is not hidden by requests that were sent late.
+//
+//              Usage: loadgen [options], see PrintUsage
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include "Serving.h"
+#include "Socket.h"
+#include "Random.h"
+#include "Manipulators.h"
+
+using namespace std;
+using namespace ownmanips;
+
+namespace {
+	typedef chrono::steady_clock Clock;
+
+	// different inputs of a connection, used in turn
+	size_t const cInputSets = 64;
+
+	struct Options {
+		sockets::Endpoint endpoint = sockets::Parse("tcp:5555");
+		size_t connections = 4;
+		size_t requests = 10000;
+		double durationSeconds = 0.0;
+		size_t samples = 1;
+		double rate = 0.0;
+		uint64_t seed = 1;
+	};
+
+	// what one connection measured
+	struct ConnectionResult {
+		vector<double> latencies;
+		size_t samples = 0;
+		string error;
+	};
+
+	double ParseNumber(string const& text)
+	{
+		char* end = nullptr;
+		double const value = strtod(text.c_str(), &end);
+		if (text.empty() || *end != '\0') throw string("Invalid number " + text);
+		return value;
+	}
+
+	void PrintUsage()
+	{
+		cout << "Usage: loadgen [options]" << endl
+			<< "  --connect ENDPOINT   unix:PATH or tcp:PORT of the server (default tcp:5555)" << endl
+			<< "  --connections N      connections sending at the same time (default 4)" << endl
+			<< "  --requests N         requests of all connections together (default 10000)" << endl
+			<< "  --duration SECONDS   send for this time instead of a number of requests" << endl
+			<< "  --samples N          samples per request (default 1)" << endl
+			<< "  --rate R             requests per second of all connections (open loop)," << endl
+			<< "                       0 = each connection waits for its answer (default 0)" << endl
+			<< "  --seed N             seed of the random inputs (default 1)" << endl;
+	}
+
+	Options ParseOptions(int const argc, char const* const argv[])
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i) {
+			string const option = argv[i];
+			auto value = [&]() -> string {
+				if (i + 1 >= argc) throw string("Missing value of " + option);
+				return argv[++i];
+			};
+			auto count = [&]() -> size_t {
+				double const number = ParseNumber(value());
+				if (number < 1) throw string(option + " must be at least 1");
+				return static_cast<size_t>(number);
+			};
+
+			if (option == "--connect") options.endpoint = sockets::Parse(value());
+			else if (option == "--connections") options.connections = count();
+			else if (option == "--requests") options.requests = count();
+			else if (option == "--duration") {
+				options.durationSeconds = ParseNumber(value());
+				if (options.durationSeconds <= 0) throw string("--duration must be positive");
+			}
+			else if (option == "--samples") options.samples = count();
+			else if (option == "--rate") {
+				options.rate = ParseNumber(value());
+				if (options.rate < 0) throw string("--rate must not be negative");
+			}
+			else if (option == "--seed") options.seed = static_cast<uint64_t>(ParseNumber(value()));
+			else throw string("Unknown option " + option);
+		}
+		if (options.samples > UINT32_MAX) throw string("--samples is too large");
+		return options;
+	}
+
+	serving::Hello ReceiveHello(Socket& socket)
+	{
+		serving::Hello hello;
+		if (!socket.Receive(&hello, sizeof(hello))) throw string("The server closed the connection");
+		if (memcmp(hello.magic, serving::cMagic, sizeof(hello.magic)) != 0) throw string("Not an inference server");
+		if (hello.version != serving::cVersion) throw string("The server speaks protocol version " +
+			to_string(hello.version) + ", expected " + to_string(serving::cVersion));
+		if (hello.scalar != model::Scalar::Double && hello.scalar != model::Scalar::Float) {
+			throw string("The server uses an unknown number type");
+		}
+		return hello;
+	}
+
+	// requests of a connection: an even share of all requests, the first connections
+	// send one more if they don't divide
+	size_t RequestsOf(Options const& options, size_t const connection)
+	{
+		if (options.durationSeconds > 0) return SIZE_MAX;
+		return options.requests / options.connections + ((connection < options.requests % options.connections) ? 1 : 0);
+	}
+
+	template<typename Real>
+	void Send(Socket& socket, size_t const connection, serving::Hello const& hello, Options const& options,
+		Clock::time_point const start, ConnectionResult& result)
+	{
+		size_t const inputCount = options.samples * hello.inputSize;
+		size_t const outputCount = options.samples * hello.outputSize;
+
+		// request buffers (header and inputs) with random inputs in [-1, 1), drawn before
+		// the clock runs
+		Philox const generator(options.seed);
+		size_t const requestSize = sizeof(serving::RequestHeader) + inputCount * sizeof(Real);
+		vector<unsigned char> requests(cInputSets * requestSize);
+		serving::RequestHeader const header = { static_cast<uint32_t>(options.samples) };
+		for (size_t set = 0; set < cInputSets; ++set) {
+			unsigned char* request = requests.data() + set * requestSize;
+			memcpy(request, &header, sizeof(header));
+			for (size_t i = 0; i < inputCount; ++i) {
+				Philox::Block const counter = { { static_cast<uint32_t>(i), static_cast<uint32_t>(set),
+					static_cast<uint32_t>(connection), 0 } };
+				Real const input = static_cast<Real>(2.0 * generator.Uniform(counter) - 1.0);
+				memcpy(request + sizeof(header) + i * sizeof(Real), &input, sizeof(Real));
+			}
+		}
+		vector<Real> outputs(outputCount);
+
+		size_t const count = RequestsOf(options, connection);
+		Clock::time_point const end = start + chrono::duration_cast<Clock::duration>(
+			chrono::duration<double>(options.durationSeconds));
+		// open loop: the connections take turns, connection c sends at (c + k * connections) / rate
+		double const interval = (options.rate > 0) ? options.connections / options.rate : 0.0;
+		double const offset = (options.rate > 0) ? connection / options.rate : 0.0;
+
+		result.latencies.reserve((count == SIZE_MAX) ? 1 << 16 : count);
+		for (size_t k = 0; k < count; ++k) {
+			Clock::time_point sent = Clock::now();
+			if (options.rate > 0) {
+				sent = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(offset + k * interval));
+				this_thread::sleep_until(sent);
+			}
+			if (options.durationSeconds > 0 && sent >= end) break;
+
+			socket.Send(requests.data() + (k % cInputSets) * requestSize, requestSize);
+			serving::ResponseHeader response;
+			if (!socket.Receive(&response, sizeof(response))) throw string("The server closed the connection");
+			if (response.status != serving::Status::Ok) throw string("The server rejected a request of " +
+				to_string(options.samples) + " samples (at most " + to_string(hello.maxRequestSamples) + ")");
+			if (response.count != options.samples) throw string("The server answered with a wrong number of samples");
+			if (!socket.Receive(outputs.data(), outputCount * sizeof(Real))) {
+				throw string("The server closed the connection");
+			}
+			result.latencies.push_back(chrono::duration<double, micro>(Clock::now() - sent).count());
+			result.samples += options.samples;
+		}
+	}
+
+	template<typename Real>
+	void Run(vector<Socket>& sockets, serving::Hello const& hello, Options const& options)
+	{
+		PrintHeader("Load generator");
+		cout << sockets::Name(options.endpoint) << " (" << ((hello.scalar == model::Scalar::Double) ? "double" : "float")
+			<< ", " << hello.inputSize << " inputs, " << hello.outputSize << " outputs), " << options.connections
+			<< " connections, " << options.samples << " samples per request, ";
+		if (options.rate > 0) cout << options.rate << " requests/s" << endl << endl;
+		else cout << "closed loop" << endl << endl;
+
+		vector<ConnectionResult> results(sockets.size());
+		vector<thread> threads;
+		Clock::time_point const start = Clock::now();
+		for (size_t c = 0; c < sockets.size(); ++c) {
+			threads.emplace_back([&, c]() {
+				try {
+					Send<Real>(sockets[c], c, hello, options, start, results[c]);
+				}
+				catch (string const& error) {
+					results[c].error = error;
+				}
+			});
+		}
+		for (auto& worker : threads) {
+			worker.join();
+		}
+		double const seconds = chrono::duration<double>(Clock::now() - start).count();
+
+		vector<double> latencies;
+		size_t samples = 0;
+		for (auto& result : results) {
+			if (!result.error.empty()) throw result.error;
+			latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+			samples += result.samples;
+		}
+		size_t const requests = latencies.size();
+		serving::Summary const latency = serving::Summarize(latencies);
+
+		cout << fixed << setprecision(2) << requests << " requests, " << samples << " samples in " << seconds << " s" << endl
+			<< setprecision(0) << "Throughput  " << requests / seconds << " requests/s, " << samples / seconds
+			<< " samples/s" << endl
+			<< "Latency     mean " << latency.mean << " us, p50 " << latency.p50 << " us, p99 " << latency.p99
+			<< " us, max " << latency.max << " us" << endl;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	try {
+		options = ParseOptions(argc, argv);
+	}
+	catch (string const& error) {
+		PrintError("LoadGen", error);
+		PrintUsage();
+		return 1;
+	}
+
+#ifdef SIGPIPE
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	try {
+		// all connections are open before the first request is sent
+		vector<Socket> sockets;
+		serving::Hello hello;
+		for (size_t c = 0; c < options.connections; ++c) {
+			sockets.push_back(Socket::Connect(options.endpoint));
+			serving::Hello const received = ReceiveHello(sockets.back());
+			if (c == 0) hello = received;
+			else if (memcmp(&hello, &received, sizeof(hello)) != 0) throw string("The connections reached different servers");
+		}
+		if (options.samples > hello.maxRequestSamples) throw string("The server accepts at most " +
+			to_string(hello.maxRequestSamples) + " samples per request");
+
+		if (hello.scalar == model::Scalar::Double) Run<double>(sockets, hello, options);
+		else Run<float>(sockets, hello, options);
+	}
+	catch (string const& error) {
+		PrintError("LoadGen", error);
+		return 1;
+	}
+	return 0;
+}
@@ -2,158 +2,116 @@
 // Workfile:    Manipulators.h
 // Date:        2016/4/3
 // Description: This module contains several functions for console output as well as debug
-//              macros and manipulators. All print functions are threadsafe on Windows!
+//              macros and manipulators. All print functions are threadsafe, a record
+//              is never mixed with the output of another thread.
 // Author:      Nik Haminger
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include <iomanip>
 #include <fstream>
+#include <mutex>
+#include <atomic>
 #include "Manipulators.h"
 
 using namespace std;
 
 //###########################################################################################
-// Windows only: Threadsafe printing
-#ifdef WIN32
-#include <Windows.h>
-
-#ifndef _CRITSEC
-class CritSec
-{
-public:
-	//-------------------------------------------------------------------------------------
-	///Description: Declare CSLock as friend of this class
-	friend class CSLock;
-
-	//-------------------------------------------------------------------------------------
-	///Description: Default constructor
-	CritSec() {
-		InitializeCriticalSection(&mCS);
+// Threadsafe printing: every print function formats its whole record in a buffer of the
+// calling thread and hands it to the stream in one write under one lock for all streams,
+// so records can't be mixed up even if two streams write to the same file. Threads only
+// wait for each other while a finished record is written, never while one is formatted.
+// The stream is not flushed, that is left to the stream and the caller.
+namespace {
+	//###########################################################################################
+	///This class collects the characters of a record in a string. Every thread keeps its
+	///buffer, so after the first records printing doesn't allocate memory.
+	class RecordBuffer: public std::streambuf
+	{
+	public:
+		void Clear() {
+			mRecord.clear();
+		}
+		std::string const& getRecord() const {
+			return mRecord;
+		}
+	protected:
+		int_type overflow(int_type ch) override {
+			if (!traits_type::eq_int_type(ch, traits_type::eof())) mRecord += traits_type::to_char_type(ch);
+			return ch;
+		}
+		std::streamsize xsputn(char const* s, std::streamsize n) override {
+			mRecord.append(s, static_cast<size_t>(n));
+			return n;
+		}
+	private:
+		std::string mRecord;
+	};
+
+	struct Record {
+		RecordBuffer buffer;
+		std::ostream stream;
+		Record() : stream(&buffer) {}
+	};
+
+	//start a record in the buffer of the calling thread
+	std::ostream& BeginRecord() {
+		thread_local Record record;
+		record.buffer.Clear();
+		return record.stream;
 	}
 
-	~CritSec() {
-		DeleteCriticalSection(&mCS);
-	}
-private:
-	///acquire and release lock
-	void Acquire() {
-		EnterCriticalSection(&mCS);
-	}
-	void Release() {
-		LeaveCriticalSection(&mCS);
-	}
-	///delete copy-ctor and assignment-op
-	CritSec(CritSec const&) = delete;
-	CritSec & operator=(CritSec const&) = delete;
-	///Critical Section
-	CRITICAL_SECTION mCS;
-};
-
-class CSLock
-{
-public:
-	//-------------------------------------------------------------------------------------
-	///Description: Constructor
-	///Params: [CSObj] The lock object
-	CSLock(CritSec& CSObj) : mCSAccess(CSObj) {
-		mCSAccess.Acquire();
-	}
-
-	//-------------------------------------------------------------------------------------
-	///Description: Destructor, releases lock
-	virtual ~CSLock() {
-		mCSAccess.Release();
-	}
-private:
-	///delete copy-ctor and assignment-op
-	CSLock(CSLock const&) = delete;
-	CSLock& operator=(CSLock const&) = delete;
-	///the lock object
-	CritSec& mCSAccess;
-};
-#endif //_CRITSEC
-
-// CritSec-variable
-static CritSec printCS;
-
-//print a header
-void ownmanips::PrintHeader(std::string const& title, std::ostream& os) {
-	CSLock lock(printCS);
-	os << titleLine << endl << title << endl2 << titleLine;
-}
-
-//print a subheader
-void ownmanips::PrintSubHeader(std::string const& title, std::ostream& os) {
-	CSLock lock(printCS);
-	os << std::endl << line << title << std::endl << line;
-}
-
-//print an error
-void ownmanips::PrintError(std::string const & errSource, std::string const & errMsg) {
-	CSLock lock(printCS);
-	std::cout << "|Error in [" << errSource << "]: " << errMsg << "|" << std::endl;
-}
+	//number of records of PrintError
+	std::atomic<size_t> errorCount(0);
 
-//print info
-void ownmanips::PrintInfo(std::string const& msg, std::ostream& os) {
-	CSLock lock(printCS);
-	os << shortline;
-	os << "|Info: " << msg << "|" << std::endl;
-	os << shortline;
-}
-
-//print debug info
-void ownmanips::DebugInfo(std::string const& msg, std::ostream& os) {
-	CSLock lock(printCS);
-	os << "|Debug-Info: " << msg << "|" << std::endl;
-}
-
-//print content of file to console
-void ownmanips::PrintFileOnCmd(string const& fileName) {
-	CSLock lock(printCS);
-	ifstream inFile(fileName);
-	if (!inFile) { PrintError("Main::PrintFileOnCmd", "Could not access file."); return; }
+	//lock of all streams
+	std::mutex printLock;
 
-	char ch = 0;
-	int cnt = 0;
-	while (!inFile.eof()) {
-		ch = inFile.get();
-		if (inFile.eof()) break;
-		cout << ch;
-		cnt++;
+	//write the record to the stream in one piece
+	void EndRecord(std::ostream& record, std::ostream& os) {
+		std::string const& text = static_cast<RecordBuffer*>(record.rdbuf())->getRecord();
+		std::lock_guard<std::mutex> lock(printLock);
+		os.write(text.data(), static_cast<std::streamsize>(text.size()));
 	}
-	if (cnt == 0) cout << "File is empty...";
-	cout << endl;
-
-	inFile.close();
 }
 
-
-//###########################################################################################
-// Else: non-threadsafe printing!
-#else
 //print a header
 void ownmanips::PrintHeader(std::string const& title, std::ostream& os) {
-	os << titleLine << endl << title << endl2 << titleLine;
+	std::ostream& record = BeginRecord();
+	record << titleLine << endl << title << endl2 << titleLine;
+	EndRecord(record, os);
 }
 
 //print a subheader
 void ownmanips::PrintSubHeader(std::string const& title, std::ostream& os) {
-	os << std::endl << line << title << std::endl << line;
+	std::ostream& record = BeginRecord();
+	record << std::endl << line << title << std::endl << line;
+	EndRecord(record, os);
 }
 
 //print an error
 void ownmanips::PrintError(std::string const & errSource, std::string const & errMsg) {
-	std::cout << "|Error in [" << errSource << "]: " << errMsg << "|" << std::endl;
+	std::ostream& record = BeginRecord();
+	record << "|Error in [" << errSource << "]: " << errMsg << "|" << std::endl;
+	EndRecord(record, std::cout);
+	++errorCount;
+}
+
+//number of errors printed so far
+size_t ownmanips::GetErrorCount() {
+	return errorCount;
 }
 
 //print info
 void ownmanips::PrintInfo(std::string const& msg, std::ostream& os) {
-	os << "|Info: " << msg << "|" << std::endl;
+	std::ostream& record = BeginRecord();
+	record << "|Info: " << msg << "|" << std::endl;
+	EndRecord(record, os);
 }
 
 //print debug info
 void ownmanips::DebugInfo(std::string const& msg, std::ostream& os) {
-	os << "|Debug-Info: " << msg << "|" << std::endl;
+	std::ostream& record = BeginRecord();
+	record << "|Debug-Info: " << msg << "|" << std::endl;
+	EndRecord(record, os);
 }
 
 //print content of file to console
@@ -161,20 +119,20 @@ void ownmanips::PrintFileOnCmd(string const& fileName) {
 	ifstream inFile(fileName);
 	if (!inFile) { PrintError("Main::PrintFileOnCmd", "Could not access file."); return; }
 
-	char ch = 0;
-	int cnt = 0;
-	while (!inFile.eof()) {
-		ch = inFile.get();
-		if (inFile.eof()) break;
-		cout << ch;
-		cnt++;
+	// the file is read in large blocks and printed as one record
+	std::ostream& record = BeginRecord();
+	char block[1 << 16];
+	bool empty = true;
+	while (inFile.read(block, sizeof(block)) || inFile.gcount() > 0) {
+		record.write(block, inFile.gcount());
+		empty = false;
 	}
-	if (cnt == 0) cout << "File is empty...";
-	cout << endl;
+	if (empty) record << "File is empty...";
+	record << endl;
+	EndRecord(record, cout);
 
 	inFile.close();
 }
-#endif //WIN32
 
 
 //double endline
@@ -2,7 +2,8 @@
 // Workfile:    Manipulators.h
 // Date:        2016/4/3
 // Description: This module contains several functions for console output as well as debug
-//              macros and manipulators. All print functions are threadsafe on Windows!
+//              macros and manipulators. All print functions are threadsafe, a record
+//              is never mixed with the output of another thread.
 // Author:      Nik Haminger
 /////////////////////////////////////////////////////////////////////////////////////////////
 #ifndef _OWNMANIPS
@@ -35,6 +36,8 @@ namespace ownmanips {
 	void PrintSubHeader(std::string const& title, std::ostream& os = std::cout);
 	//print an error
 	void PrintError(std::string const& errSource, std::string const& errMsg);
+	//number of errors printed so far, e.g. for the exit status
+	size_t GetErrorCount();
 	//print info
 	void PrintInfo(std::string const& msg, std::ostream& os = std::cout);
 	//print debug info
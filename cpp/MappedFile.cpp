@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    MappedFile.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+MappedFile::MappedFile(string const& fileName)
+{
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw string("Could not open " + fileName);
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		throw string("Could not map " + fileName + ", the file is empty");
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* data = (mapping != nullptr) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (data == nullptr) {
+		if (mapping != nullptr) CloseHandle(mapping);
+		CloseHandle(file);
+		throw string("Could not map " + fileName);
+	}
+
+	mFile = file;
+	mMapping = mapping;
+	mData = static_cast<unsigned char const*>(data);
+	mSize = static_cast<size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	UnmapViewOfFile(mData);
+	CloseHandle(mMapping);
+	CloseHandle(mFile);
+}
+#else
+MappedFile::MappedFile(string const& fileName)
+{
+	int file = open(fileName.c_str(), O_RDONLY);
+	if (file < 0) throw string("Could not open " + fileName);
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		throw string("Could not map " + fileName + ", the file is empty");
+	}
+
+	// the mapping keeps its own reference to the file, so the descriptor isn't needed anymore
+	size_t const size = static_cast<size_t>(info.st_size);
+	void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (data == MAP_FAILED) throw string("Could not map " + fileName);
+
+	mData = static_cast<unsigned char const*>(data);
+	mSize = size;
+}
+
+MappedFile::~MappedFile()
+{
+	munmap(const_cast<unsigned char*>(mData), mSize);
+}
+#endif
+
+unsigned char const* MappedFile::getData() const
+{
+	return mData;
+}
+
+size_t MappedFile::getSize() const
+{
+	return mSize;
+}
+
+void MappedFile::AdviseSequential() const
+{
+#ifndef _WIN32
+	// only a hint, failures don't matter
+	madvise(const_cast<unsigned char*>(mData), mSize, MADV_SEQUENTIAL);
+#endif
+}
@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    MappedFile.h
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _MAPPEDFILE
+#define _MAPPEDFILE
+
+#include <string>
+#include <cstddef>
+#include "Object.h"
+
+//###########################################################################################
+///This class maps a whole file read-only into memory (mmap on POSIX systems, a file mapping
+///object on Windows). The pages are loaded by the operating system when they are touched
+///for the first time, so opening a file takes the same time for any file size, and several
+///processes mapping the same file share the pages in the page cache. The mapping is
+///released in the destructor.
+class MappedFile: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, maps the file. Throws if the file can't be opened or is
+	///empty.
+	///Params: [fileName] Name of the file
+	explicit MappedFile(std::string const& fileName);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, unmaps the file
+	~MappedFile();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the first byte of the file, the address is page aligned
+	unsigned char const* getData() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the size of the file in bytes
+	size_t getSize() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Tell the operating system that the file will be read from front to
+	///back, so it reads ahead and may drop pages that were read already. Files that are
+	///bigger than the memory are streamed this way. Does nothing on Windows.
+	void AdviseSequential() const;
+private:
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	unsigned char const* mData = nullptr;
+	size_t mSize = 0;
+#ifdef _WIN32
+	// handles of the file and the mapping object, void* to keep windows.h out of the header
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#endif
+};
+#endif //_MAPPEDFILE
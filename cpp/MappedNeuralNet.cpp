@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    MappedNeuralNet.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include "MappedNeuralNet.h"
+#include "ModelFile.h"
+#include "Profiler.h"
+
+using namespace std;
+
+// number of samples Predict processes at once, like in NeuralNet
+static size_t const cPredictBlock = 64;
+
+template<typename Real>
+MappedNeuralNet<Real>::MappedNeuralNet(string const& fileName, ActivationFunc outputActivation)
+	: mFile(fileName), mOutputActivationFunc(outputActivation)
+{
+	model::Header const& header = model::Validate(mFile.getData(), mFile.getSize(), model::ScalarOf<Real>::value);
+	model::LayerEntry const* layers = model::getLayers(header);
+
+	mLayerSizes.resize(header.numLayers);
+	for (size_t i = 0; i < mLayerSizes.size(); ++i) {
+		mLayerSizes[i] = static_cast<size_t>(layers[i].size);
+		if (mLayerSizes[i] + 1 > mMaxColumns) mMaxColumns = mLayerSizes[i] + 1;
+	}
+
+	// the weights of layer i are used in place, the delta weights are only for training
+	for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+		MappedLayer layer;
+		layer.size = mLayerSizes[i];
+		layer.numInputs = mLayerSizes[i - 1] + 1;
+		layer.activation = static_cast<Activation>(layers[i].activation);
+		layer.weights = reinterpret_cast<Real const*>(mFile.getData() + layers[i].weights);
+		mLayers.push_back(layer);
+	}
+	mRecentError = header.recentError;
+}
+
+template<typename Real>
+LayerSizes const& MappedNeuralNet<Real>::getLayerSizes() const
+{
+	return mLayerSizes;
+}
+
+template<typename Real>
+void MappedNeuralNet<Real>::Predict(Real const* inputs, size_t const count, Real* outputs) const
+{
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+
+	for (size_t first = 0; first < count; first += cPredictBlock) {
+		size_t const blockCount = (first + cPredictBlock < count) ? cPredictBlock : count - first;
+		PredictBlock(inputs + first * inputSize, blockCount, outputs + first * outputSize);
+	}
+}
+
+template<typename Real>
+void MappedNeuralNet<Real>::PredictBlock(Real const* inputs, size_t const count, Real* outputs) const
+{
+	// every thread ping-pongs between two scratch buffers that only grow
+	thread_local BasicData<Real> bufferA, bufferB;
+	if (bufferA.size() < count * mMaxColumns) {
+		bufferA.resize(count * mMaxColumns);
+		bufferB.resize(count * mMaxColumns);
+	}
+
+	// pass values to input neurons, the last column is the bias neuron
+	size_t columns = mLayerSizes.front() + 1;
+	Real* prevOutputs = bufferA.data();
+	Real* curOutputs = bufferB.data();
+	for (size_t s = 0; s < count; ++s) {
+		copy(inputs + s * (columns - 1), inputs + (s + 1) * (columns - 1), prevOutputs + s * columns);
+		prevOutputs[s * columns + columns - 1] = 1.0;
+	}
+
+	for (size_t i = 0; i < mLayers.size(); ++i) {
+		NEURO_PROFILE_SCOPE(Predict, i + 1, count);
+		MappedLayer const& layer = mLayers[i];
+		columns = layer.size + 1;
+		BasicLayer<Real>::ForwardPropagateBatch(layer.weights, layer.size, layer.numInputs, layer.activation,
+			prevOutputs, curOutputs, count);
+		for (size_t s = 0; s < count; ++s) {
+			curOutputs[s * columns + columns - 1] = 1.0;
+		}
+		swap(prevOutputs, curOutputs);
+	}
+
+	size_t const outputSize = columns - 1;
+	for (size_t s = 0; s < count; ++s) {
+		for (size_t j = 0; j < outputSize; ++j) {
+			outputs[s * outputSize + j] = static_cast<Real>(mOutputActivationFunc(prevOutputs[s * columns + j]));
+		}
+	}
+}
+
+template<typename Real>
+double MappedNeuralNet<Real>::getRecentError() const
+{
+	return mRecentError;
+}
+
+template class MappedNeuralNet<double>;
+template class MappedNeuralNet<float>;
@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    MappedNeuralNet.h
+// Date:        2026/10/16
+// Description: Read-only neural net on a memory mapped model file
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _MAPPEDNET
+#define _MAPPEDNET
+
+#include <string>
+#include <vector>
+#include "Object.h"
+#include "NeuralNet.h"
+#include "MappedFile.h"
+
+//###########################################################################################
+///This class runs the inference of a net saved with BasicNeuralNet::Save directly on the
+///mapped file: the weight blocks are passed to the kernels where they are, nothing is
+///copied or parsed. Opening a model only checks the header and the layer table, so it takes
+///the same time for any model size; the weights are paged in by the first predictions.
+///Predict gives the same results as Predict of the saved net. The net can't be trained.
+///The template is instantiated for double and float in MappedNeuralNet.cpp.
+template<typename Real>
+class MappedNeuralNet: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, maps and validates the model file
+	///Params: [fileName] Name of the file, the number type must match Real,
+	///[outputActivation] Output activation like in BasicNeuralNet
+	MappedNeuralNet(std::string const& fileName, ActivationFunc outputActivation);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the sizes of the layers WITHOUT bias neurons
+	LayerSizes const& getLayerSizes() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a batch like BasicNeuralNet::Predict. May be called from
+	///several threads at the same time.
+	///Params: [inputs] Row-major inputs [count x input size], [count] Number of samples,
+	///[outputs] Receives the row-major results [count x output size]
+	void Predict(Real const* inputs, size_t const count, Real* outputs) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the recent average error of the saved net
+	double getRecentError() const;
+
+private:
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a block of samples with the scratch buffers of the thread
+	void PredictBlock(Real const* inputs, size_t const count, Real* outputs) const;
+
+	struct MappedLayer {
+		size_t size;
+		size_t numInputs;
+		Activation activation;
+		Real const* weights;
+	};
+
+	MappedFile mFile;
+	LayerSizes mLayerSizes;
+	std::vector<MappedLayer> mLayers;
+	size_t mMaxColumns = 0;
+	double mRecentError = 0.0;
+	const ActivationFunc mOutputActivationFunc;
+};
+#endif //_MAPPEDNET
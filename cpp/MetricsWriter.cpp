@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    MetricsWriter.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <chrono>
+#include "MetricsWriter.h"
+#include "ModelFile.h"
+
+using namespace std;
+
+namespace {
+	// the background thread writes when it has collected this many bytes
+	size_t const cBlockBytes = 1 << 16;
+	// time between two looks of the background thread into the ring buffer, shorter while
+	// records are coming in (the default ring buffer takes 65536 records per ms then)
+	chrono::milliseconds const cIdleInterval(50);
+	chrono::milliseconds const cBusyInterval(1);
+}
+
+MetricsWriter::MetricsWriter(string const& fileName, MetricsFormat const format, size_t const capacity)
+	: mFileName(fileName), mFormat(format), mFile(fileName, ios::binary | ios::trunc), mStream(&mFile),
+	mQueue(capacity)
+{
+	if (!mFile.is_open()) throw string("Could not open " + fileName);
+	Start();
+}
+
+MetricsWriter::MetricsWriter(ostream& stream, MetricsFormat const format, size_t const capacity)
+	: mFileName("the metrics stream"), mFormat(format), mStream(&stream), mQueue(capacity)
+{
+	Start();
+}
+
+MetricsWriter::~MetricsWriter()
+{
+	try {
+		if (mWorker.joinable()) Close();
+	}
+	catch (string const&) {
+		// a destructor must not throw, Close reports write errors
+	}
+}
+
+bool MetricsWriter::Push(Metric const& metric)
+{
+	if (mQueue.TryPush(metric)) return true;
+	mDropped.fetch_add(1, memory_order_relaxed);
+	return false;
+}
+
+void MetricsWriter::Close()
+{
+	if (mWorker.joinable()) {
+		{
+			lock_guard<mutex> lock(mMutex);
+			mStop = true;
+		}
+		mStopped.notify_one();
+		mWorker.join();
+	}
+
+	if (mFile.is_open()) mFile.close();
+	else mStream->flush();
+	if (!*mStream) throw string("Could not write " + mFileName);
+}
+
+size_t MetricsWriter::getDropped() const
+{
+	return mDropped.load(memory_order_relaxed);
+}
+
+void MetricsWriter::Start()
+{
+	if (mFormat == MetricsFormat::Binary) {
+		metrics::Header header;
+		memcpy(header.magic, metrics::cMagic, sizeof(header.magic));
+		header.byteOrder = model::cByteOrder;
+		header.version = metrics::cVersion;
+		header.recordSize = sizeof(Metric);
+		mStream->write(reinterpret_cast<char const*>(&header), sizeof(header));
+	}
+
+	mWorker = thread(&MetricsWriter::Run, this);
+}
+
+void MetricsWriter::Run()
+{
+	string block;
+	block.reserve(cBlockBytes + 64);
+
+	unique_lock<mutex> lock(mMutex);
+	for (;;) {
+		// stop is read before the queue is emptied, so all records that were pushed
+		// before Close are written
+		bool const stop = mStop;
+		lock.unlock();
+
+		Metric metric;
+		bool const idle = !mQueue.TryPop(metric);
+		if (!idle) {
+			do {
+				Format(metric, block);
+				if (block.size() >= cBlockBytes) {
+					mStream->write(block.data(), block.size());
+					block.clear();
+				}
+			} while (mQueue.TryPop(metric));
+		}
+
+		// the rest of a block is written once training pauses or stops logging
+		if (idle || stop) {
+			if (!block.empty()) {
+				mStream->write(block.data(), block.size());
+				block.clear();
+			}
+			mStream->flush();
+			if (stop) return;
+		}
+
+		lock.lock();
+		mStopped.wait_for(lock, idle ? cIdleInterval : cBusyInterval, [this]() { return mStop; });
+	}
+}
+
+void MetricsWriter::Format(Metric const& metric, string& block) const
+{
+	if (mFormat == MetricsFormat::Binary) {
+		block.append(reinterpret_cast<char const*>(&metric), sizeof(metric));
+		return;
+	}
+
+	// %g gives the same text as the default formatting of an ostream
+	char line[96];
+	int const length = (mFormat == MetricsFormat::Text)
+		? snprintf(line, sizeof(line), "Run %" PRIu64 ": recent average error %g, eta %g\n", metric.iteration,
+			metric.recentError, metric.eta)
+		: snprintf(line, sizeof(line), "%" PRIu64 ",%g\n", metric.iteration, metric.recentError);
+	block.append(line, static_cast<size_t>(length));
+}
+
+vector<Metric> metrics::ReadBinary(string const& fileName)
+{
+	ifstream file(fileName, ios::binary);
+	if (!file.is_open()) throw string("Could not open " + fileName);
+
+	Header header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) throw string("Metrics file is too short");
+	if (memcmp(header.magic, cMagic, sizeof(cMagic)) != 0) throw string("Not a metrics file");
+	if (header.byteOrder != model::cByteOrder) throw string("Metrics file was written with a different byte order");
+	if (header.version != cVersion) throw string("Metrics file has version " + to_string(header.version) +
+		", expected " + to_string(cVersion));
+	if (header.recordSize != sizeof(Metric)) throw string("Metrics file has a different record size");
+
+	vector<Metric> records;
+	Metric metric;
+	while (file.read(reinterpret_cast<char*>(&metric), sizeof(metric))) {
+		records.push_back(metric);
+	}
+	if (file.gcount() != 0) throw string("Metrics file is truncated");
+	return records;
+}
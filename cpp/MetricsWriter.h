@@ -0,0 +1,128 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    MetricsWriter.h
+// Date:        2026/10/16
+// Description: Asynchronous writer of training metrics. The training thread only copies a
+//              record into a ring buffer, a background thread formats the records and
+//              writes them in large blocks.
+//
+//              Csv     - one line "iteration,recentError" per record, the layout of the
+//                        tanh_*.csv files that creatediagram.m reads
+//              Binary  - a Header followed by packed Metric records, see below
+//              Text    - one line "Run iteration: recent average error ..., eta ..." per
+//                        record, for progress reports on the console
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _METRICSWRITER
+#define _METRICSWRITER
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "Object.h"
+#include "RingBuffer.h"
+
+//-------------------------------------------------------------------------------------------
+///One record of the training progress
+struct Metric {
+	uint64_t iteration;
+	double recentError;
+	double eta;
+};
+
+enum class MetricsFormat { Csv, Binary, Text };
+
+namespace metrics {
+	char const cMagic[4] = { 'N', 'M', 'E', 'T' };
+	// increase for every change of the format
+	uint32_t const cVersion = 1;
+
+	//-------------------------------------------------------------------------------------
+	///First bytes of a binary metrics file, byteOrder is model::cByteOrder
+	struct Header {
+		char magic[4];
+		uint32_t byteOrder;
+		uint32_t version;
+		uint32_t recordSize;
+	};
+	static_assert(sizeof(Metric) == 24, "Metric records must not contain padding");
+
+	//-------------------------------------------------------------------------------------
+	///Description: Read a file written with MetricsFormat::Binary
+	///Params: [fileName] Name of the file
+	///Return: All records of the file
+	std::vector<Metric> ReadBinary(std::string const& fileName);
+}
+
+//###########################################################################################
+///This class writes training metrics without slowing down training. Push never waits and
+///never makes a system call: if the background thread falls behind and the ring buffer is
+///full, the record is dropped and counted. The background thread empties the ring buffer
+///every millisecond while records are coming in and writes whenever it has collected a large
+///block, the rest is written when no new records came in for a poll interval. Push must
+///always be called from the same thread.
+class MetricsWriter: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, creates the file and starts the background thread
+	///Params: [fileName] Name of the file, an existing file is overwritten, [format] Layout
+	///of the file, [capacity] Number of records the ring buffer holds
+	MetricsWriter(std::string const& fileName, MetricsFormat const format = MetricsFormat::Csv,
+		size_t const capacity = 1 << 16);
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, which writes to a stream like std::cout instead of a file.
+	///Nothing else may write to the stream until Close returned.
+	///Params: [stream] The stream, it must outlive the writer, the other parameters like above
+	MetricsWriter(std::ostream& stream, MetricsFormat const format = MetricsFormat::Text,
+		size_t const capacity = 1 << 16);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, writes the remaining records (see Close)
+	~MetricsWriter();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Queue a record for writing
+	///Params: [metric] The record
+	///Return: false if the ring buffer was full and the record was dropped
+	bool Push(Metric const& metric);
+	//-------------------------------------------------------------------------------------
+	///Description: Write all queued records, stop the background thread and close the
+	///file or flush the stream. Throws if the file or stream couldn't be written.
+	void Close();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of records that were dropped because the ring buffer
+	///was full
+	size_t getDropped() const;
+
+private:
+	MetricsWriter(MetricsWriter const&) = delete;
+	MetricsWriter& operator=(MetricsWriter const&) = delete;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Loop of the background thread
+	void Run();
+	//-------------------------------------------------------------------------------------
+	///Description: Write the header of the format and start the background thread
+	void Start();
+	//-------------------------------------------------------------------------------------
+	///Description: Append a record to the block in the layout of the file
+	void Format(Metric const& metric, std::string& block) const;
+
+	std::string mFileName;
+	MetricsFormat mFormat;
+	std::ofstream mFile;
+	// the file or the stream of the second constructor
+	std::ostream* mStream;
+	RingBuffer<Metric> mQueue;
+	std::atomic<size_t> mDropped{ 0 };
+	std::mutex mMutex;
+	std::condition_variable mStopped;
+	bool mStop = false;
+	std::thread mWorker;
+};
+#endif //_METRICSWRITER
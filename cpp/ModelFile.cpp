@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    ModelFile.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <string>
+#include <cstring>
+#include "ModelFile.h"
+#include "Optimizer.h"
+#include "Layer.h"
+
+using namespace std;
+
+model::Header const& model::Validate(unsigned char const* data, size_t const size, Scalar const scalar)
+{
+	if (size < sizeof(Header)) throw string("Model file is too short");
+
+	Header const& header = *reinterpret_cast<Header const*>(data);
+	if (memcmp(header.magic, cMagic, sizeof(cMagic)) != 0) throw string("Not a model file");
+	if (header.byteOrder != cByteOrder) throw string("Model file was saved with a different byte order");
+	if (header.version != cVersion) throw string("Model file has version " + to_string(header.version) +
+		", expected " + to_string(cVersion));
+	if (header.scalar != scalar) throw string("Model file has a different number type");
+	if (header.fileSize != size) throw string("Model file is truncated");
+	if (header.numLayers < 2) throw string("A neural net must have at least an input and an output layer...");
+	if (header.numLayers > (size - sizeof(Header)) / sizeof(LayerEntry)) throw string("Model file is truncated");
+	Optimizer const optimizer = static_cast<Optimizer>(header.optimizer);
+	if (!optimizer::IsValid(optimizer)) throw string("Model file uses an unknown optimizer");
+
+	// every block must be aligned and inside the file, the size checks are done in
+	// bytes per row first so that corrupt sizes can't overflow
+	size_t const scalarSize = (scalar == Scalar::Double) ? sizeof(double) : sizeof(float);
+	size_t const tableEnd = sizeof(Header) + header.numLayers * sizeof(LayerEntry);
+	LayerEntry const* layers = getLayers(header);
+	if (layers[0].size == 0) throw string("A layer must have at least 1 neuron");
+	for (uint32_t i = 1; i < header.numLayers; ++i) {
+		LayerEntry const& layer = layers[i];
+		if (layer.size == 0) throw string("A layer must have at least 1 neuron");
+		if (!activation::IsValid(static_cast<Activation>(layer.activation))) {
+			throw string("Model file uses an unknown activation function");
+		}
+		if (layers[i - 1].size >= size / scalarSize) throw string("Model file is truncated");
+		uint64_t const numInputs = layers[i - 1].size + 1;
+		if (layer.size > size / scalarSize / numInputs) {
+			throw string("Model file is truncated");
+		}
+		uint64_t const matrixSize = layer.size * numInputs;
+		auto checkBlock = [&](uint64_t const offset, uint64_t const blockSize) {
+			if (offset % cAlignment != 0) throw string("Weight block of the model file is not aligned");
+			if (offset < tableEnd) throw string("Weight block overlaps the header of the model file");
+			if (offset > size || blockSize > size - offset) throw string("Model file is truncated");
+		};
+		checkBlock(layer.weights, matrixSize * scalarSize);
+		checkBlock(layer.deltaWeights, matrixSize * scalarSize);
+		// the running squares are only saved if the net has them
+		if (layer.squares != 0) checkBlock(layer.squares, matrixSize * scalarSize);
+		else if (optimizer::NeedsSquares(optimizer)) throw string("Model file has no running squares for its optimizer");
+
+		// the mask belongs to the pruned formats, its flags are checked by Load
+		WeightFormat const format = static_cast<WeightFormat>(layer.format);
+		if (format != WeightFormat::Dense && format != WeightFormat::Masked && format != WeightFormat::Sparse) {
+			throw string("Model file uses an unknown weight format");
+		}
+		if (format == WeightFormat::Dense) {
+			if (layer.mask != 0) throw string("Model file has a mask for a dense layer");
+			continue;
+		}
+		checkBlock(layer.mask, matrixSize);
+	}
+
+	return header;
+}
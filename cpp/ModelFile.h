@@ -0,0 +1,119 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    ModelFile.h
+// Date:        2026/10/16
+// Description: Binary file format of trained nets. A model file starts with a Header,
+//              followed by one LayerEntry per layer and the weight blocks:
+//
+//              Header      128 bytes, see below
+//              LayerEntry  numLayers x 48 bytes
+//              Blocks      per layer (except the input layer) the row-major weights, delta
+//                          weights and, if the net has them, running squares in the number
+//                          type of the net and for a pruned layer the mask of the kept
+//                          weights (one byte per weight, 0 or 1), every block starts at a
+//                          multiple of cAlignment bytes
+//
+//              All numbers are stored in the byte order of the machine that saved the
+//              file; files of the other byte order are rejected. The blocks are used in
+//              place by MappedNeuralNet, so a file must not change while it is mapped.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _MODELFILE
+#define _MODELFILE
+
+#include <cstddef>
+#include <cstdint>
+#include "Activation.h"
+
+namespace model {
+	char const cMagic[4] = { 'N', 'N', 'E', 'T' };
+	// written as a number, reads differently on a machine with the other byte order
+	uint32_t const cByteOrder = 0x01020304;
+	// increase for every change of the format
+	uint32_t const cVersion = 1;
+	// alignment of the weight blocks in bytes (a cache line, enough for any SIMD load)
+	size_t const cAlignment = 64;
+
+	//-------------------------------------------------------------------------------------
+	///Number type of the weights
+	enum class Scalar : uint32_t { Double = 1, Float = 2 };
+	//-------------------------------------------------------------------------------------
+	///Description: The Scalar of a number type
+	template<typename Real>
+	struct ScalarOf;
+	template<>
+	struct ScalarOf<double> {
+		static Scalar const value = Scalar::Double;
+	};
+	template<>
+	struct ScalarOf<float> {
+		static Scalar const value = Scalar::Float;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///First bytes of a model file. The eta state is the learning rate of the layers, the
+	///errors it is calculated from and the hyperparameters of setBeta, setEtaUpdate and
+	///setAlpha. With the optimizer::Settings (alpha is the momentum), the number of steps
+	///of the optimizer and the delta weights and running squares of the layers, a loaded
+	///net continues training where the saved one stopped.
+	struct Header {
+		char magic[4];
+		uint32_t byteOrder;
+		uint32_t version;
+		Scalar scalar;
+		uint32_t optimizer;	// Optimizer of optimizer::Settings
+		uint32_t numLayers;
+		double eta;
+		double error;
+		double recentError;
+		uint64_t fileSize;
+		double beta;
+		double etaUpdate;
+		double alpha;
+		double learningRate;
+		double decay;
+		double epsilon;
+		uint64_t steps;
+		uint64_t reserved[2];
+	};
+	static_assert(sizeof(Header) == 128, "The header must not contain padding");
+
+	//-------------------------------------------------------------------------------------
+	///Size of a layer WITHOUT bias neuron, the file offsets of its blocks, its activation
+	///function and its WeightFormat (all 0 for the input layer, which has no weights). The
+	///offset of the running squares is 0 if the net has none, the one of the mask is 0 for
+	///a dense layer. The blocks of a pruned layer are dense matrices with zeros.
+	struct LayerEntry {
+		uint64_t size;
+		uint64_t weights;
+		uint64_t deltaWeights;
+		uint64_t squares;
+		uint64_t mask;
+		uint32_t activation;
+		uint32_t format;
+	};
+	static_assert(sizeof(LayerEntry) == 48, "A layer entry must not contain padding");
+
+	//-------------------------------------------------------------------------------------
+	///Description: Round an offset up to the next multiple of cAlignment
+	inline size_t Align(size_t const offset) {
+		return (offset + cAlignment - 1) / cAlignment * cAlignment;
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Check that a file is a complete model of the expected number type:
+	///header, layer table and all blocks must be inside the file and aligned, an optimizer
+	///with running squares needs their blocks and a pruned layer its mask. Only the header
+	///and the layer table are read, so the time doesn't depend on the model size; the
+	///flags of the masks are checked by BasicNeuralNet::Load, which uses them. Throws if
+	///the file is not valid, so the blocks can be used without further checks.
+	///Params: [data] Contents of the file, [size] Size of the file in bytes, [scalar]
+	///Expected number type
+	///Return: The header, the layer table follows directly after it
+	Header const& Validate(unsigned char const* data, size_t const size, Scalar const scalar);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the layer table of a validated file
+	inline LayerEntry const* getLayers(Header const& header) {
+		return reinterpret_cast<LayerEntry const*>(&header + 1);
+	}
+}
+
+#endif //_MODELFILE
@@ -6,114 +6,956 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include <string>
 #include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <atomic>
+#include <thread>
 #include "NeuralNet.h"
 #include "Manipulators.h"
+#include "ModelFile.h"
+#include "MappedFile.h"
+#include "Profiler.h"
 
 using namespace std;
 using namespace ownmanips;
 
-NeuralNet::NeuralNet(LayerSizes const & layerSize, ActivationFunc outputActivation) : mOutputActivationFunc(outputActivation)
+// number of samples Predict processes at once per thread
+static size_t const cPredictBlock = 64;
+
+// number of neurons Initialize draws per task
+static size_t const cInitializeBlock = 32;
+
+// the layers are copied with the bytes of the arena
+static_assert(std::is_trivially_copyable<BasicLayer<double>>::value, "A layer must be trivially copyable");
+static_assert(std::is_trivially_copyable<BasicLayer<float>>::value, "A layer must be trivially copyable");
+
+// size of the arena of a net: the layer objects, then the buffers of every layer
+template<typename Real>
+static size_t getArenaSize(LayerSizes const& layerSizes)
+{
+	size_t size = Arena::Align(layerSizes.size() * sizeof(BasicLayer<Real>));
+	for (size_t i = 0; i < layerSizes.size(); ++i) {
+		size += BasicLayer<Real>::getStorageSize(layerSizes[i], (i > 0) ? layerSizes[i - 1] : 0);
+	}
+	return size;
+}
+
+template<typename Real>
+BasicNeuralNet<Real>::BasicNeuralNet(LayerSizes const & layerSize, ActivationFunc outputActivation, size_t const maxBatchSize)
+	: BasicNeuralNet(layerSize, Activations((layerSize.size() > 1) ? layerSize.size() - 1 : 0, Activation::Clip),
+		outputActivation, maxBatchSize)
+{
+}
+
+template<typename Real>
+BasicNeuralNet<Real>::BasicNeuralNet(LayerSizes const & layerSize, Activations const& activations,
+	ActivationFunc outputActivation, size_t const maxBatchSize)
+	: BasicNeuralNet(layerSize, activations, initializer::Settings{ Initializer::Rand, 0 }, outputActivation,
+		maxBatchSize)
+{
+}
+
+template<typename Real>
+BasicNeuralNet<Real>::BasicNeuralNet(LayerSizes const & layerSize, Activations const& activations,
+	initializer::Settings const& initializer, ActivationFunc outputActivation, size_t const maxBatchSize)
+	: BasicNeuralNet(layerSize, activations, outputActivation, maxBatchSize, Uninitialized())
+{
+	Initialize(initializer);
+}
+
+template<typename Real>
+BasicNeuralNet<Real>::BasicNeuralNet(LayerSizes const & layerSize, Activations const& activations,
+	ActivationFunc outputActivation, size_t const maxBatchSize, Uninitialized)
+	: mLayerSizes(layerSize), mArena(getArenaSize<Real>(layerSize)), mWorkspace(layerSize, maxBatchSize),
+	mOutputActivationFunc(outputActivation)
 {
 	if (layerSize.size() < 2) throw string("A neural net must have at least an input and an output layer...");
+	if (activations.size() != layerSize.size() - 1) throw string("Number of activations does not match number of layers");
 
-	// input layer
-	mLayers.push_back(Layer(layerSize[0], layerSize[1]));
+	// the input layer has no weights, the hidden and output layers each hold the weights
+	// from the previous layer
+	mLayers = reinterpret_cast<BasicLayer<Real>*>(mArena.getData());
+	char* storage = mArena.getData() + Arena::Align(layerSize.size() * sizeof(BasicLayer<Real>));
+	for (size_t i = 0; i < layerSize.size(); ++i) {
+		size_t const numPrevNeurons = (i > 0) ? layerSize[i - 1] : 0;
+		new (&mLayers[i]) BasicLayer<Real>(layerSize[i], numPrevNeurons,
+			(i > 0) ? activations[i - 1] : Activation::Clip, storage);
+		storage += BasicLayer<Real>::getStorageSize(layerSize[i], numPrevNeurons);
+	}
+
+	// staging buffers of TrainBatch
+	mBatchInputs.reserve(maxBatchSize * layerSize.front());
+	mBatchTargets.reserve(maxBatchSize * layerSize.back());
+}
+
+template<typename Real>
+BasicNeuralNet<Real>::BasicNeuralNet(BasicNeuralNet const& other)
+	: mLayerSizes(other.mLayerSizes), mArena(other.mArena),
+	mLayers(reinterpret_cast<BasicLayer<Real>*>(mArena.getData())),
+	mWorkspace(other.mLayerSizes, other.mWorkspace.getCapacity()), mTrainingMode(other.mTrainingMode),
+	mError(other.mError), mRecentError(other.mRecentError), mBeta(other.mBeta), mEtaUpdate(other.mEtaUpdate),
+	mOptimizer(other.mOptimizer), mInitializer(other.mInitializer), mEta(other.mEta), mSteps(other.mSteps), mSparseCrossover(other.mSparseCrossover),
+	mOutputActivationFunc(other.mOutputActivationFunc)
+{
+	// the layers came with the arena, but still point into the arena of the other net
+	for (size_t i = 0; i < mLayerSizes.size(); ++i) {
+		mLayers[i].Rebase(other.mArena, mArena);
+	}
+
+	mBatchInputs.reserve(other.mBatchInputs.capacity());
+	mBatchTargets.reserve(other.mBatchTargets.capacity());
+}
 
-	// hidden layers
-	for (size_t i = 1; i < layerSize.size() - 1; ++i) {
-		mLayers.push_back(Layer(layerSize[i], layerSize[i+1]));
+template<typename Real>
+BasicNeuralNet<Real>& BasicNeuralNet<Real>::operator=(BasicNeuralNet const& other)
+{
+	if (this == &other) return *this;
+
+	// the scratch buffers only depend on the topology
+	if (mLayerSizes != other.mLayerSizes) {
+		mLayerSizes = other.mLayerSizes;
+		mWorkspace = BasicWorkspace<Real>(mLayerSizes, other.mWorkspace.getCapacity());
+		mReplicas.assign(mReplicas.size(), BasicWorkspace<Real>(mLayerSizes, 0));
+	}
+	mWorkspace.Reserve(other.mWorkspace.getCapacity());
+
+	// the arena keeps its block if the size is the same
+	mArena = other.mArena;
+	mLayers = reinterpret_cast<BasicLayer<Real>*>(mArena.getData());
+	for (size_t i = 0; i < mLayerSizes.size(); ++i) {
+		mLayers[i].Rebase(other.mArena, mArena);
 	}
 
-	// output layer
-	mLayers.push_back(Layer(layerSize.back(), 0));
+	mTrainingMode = other.mTrainingMode;
+	mError = other.mError;
+	mRecentError = other.mRecentError;
+	mBeta = other.mBeta;
+	mEtaUpdate = other.mEtaUpdate;
+	mOptimizer = other.mOptimizer;
+	mInitializer = other.mInitializer;
+	mEta = other.mEta;
+	mSteps = other.mSteps;
+	mSparseCrossover = other.mSparseCrossover;
+	mOutputActivationFunc = other.mOutputActivationFunc;
+	return *this;
 }
 
-void NeuralNet::ForwardPropagate(Data const & input)
+template<typename Real>
+void BasicNeuralNet<Real>::ForwardPropagate(BasicData<Real> const& input)
 {
 	if (input.size() != mLayers[0].getSize()) throw string("Input vector size does not match number of input neurons");
+	ForwardPropagate(input.data());
+}
 
+template<typename Real>
+void BasicNeuralNet<Real>::ForwardPropagate(Real const* input)
+{
 	// pass values to input neurons
-	for (size_t i = 0; i < input.size(); ++i) {
-		mLayers[0].getNeuronAt(i).setOutputVal(input[i]);
-	}
+	mLayers[0].setOutputs(input);
 
 	// forward propagation for all layers except input layer
-	// and for all neurons inside a layer except the bias neuron
-	for (size_t i = 1; i < mLayers.size(); ++i) {
-		for (size_t j = 0; j < mLayers[i].getSize(); ++j) {
-			auto& curLayer = mLayers[i];
-			auto& prevLayer = mLayers[i - 1];
-			curLayer.getNeuronAt(j).ForwardPropagate(prevLayer.getNeurons());
+	for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+		NEURO_PROFILE_SCOPE(Forward, i, 1);
+		mLayers[i].ForwardPropagate(mLayers[i - 1]);
+	}
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::BackPropagate(BasicData<Real> const& target)
+{
+	if (target.size() != mLayerSizes.back()) throw string("Number of target values does not match number of output neurons");
+	BackPropagate(target.data());
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::BackPropagate(Real const* target)
+{
+	// calculate overall net error (sum of squared output neuron errors)
+	// and output layer gradients in one pass
+	size_t const last = mLayerSizes.size() - 1;
+	Real sqrError;
+	{
+		NEURO_PROFILE_SCOPE(OutputGradients, last, 1);
+		sqrError = mLayers[last].CalcOutputGradients(target);
+	}
+
+	// every layer calculates the gradients of the previous one and updates its weights in
+	// one sweep over its weight matrix
+	optimizer::Step<Real> const step = NextStep();
+	for (size_t i = last; i > 0; --i) {
+		NEURO_PROFILE_SCOPE(Backward, i, 1);
+		mLayers[i].BackPropagate(mLayers[i - 1], step);
+	}
+
+	// RMS error, recent average and learning rate (eta)
+	UpdateError(sqrError, 1);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Train(BasicData<Real> const& input, BasicData<Real> const& target)
+{
+	ForwardPropagate(input);
+	BackPropagate(target);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Train(Real const* input, Real const* target)
+{
+	ForwardPropagate(input);
+	BackPropagate(target);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::TrainBatch(std::vector<BasicData<Real>> const& inputs,
+	std::vector<BasicData<Real>> const& targets)
+{
+	if (inputs.size() != targets.size()) throw string("Number of inputs does not match number of targets");
+
+	size_t const count = inputs.size();
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+	mBatchInputs.resize(count * inputSize);
+	mBatchTargets.resize(count * outputSize);
+
+	// copy the samples into contiguous batch buffers
+	for (size_t s = 0; s < count; ++s) {
+		if (inputs[s].size() != inputSize) throw string("Input vector size does not match number of input neurons");
+		if (targets[s].size() != outputSize) throw string("Number of target values does not match number of output neurons");
+		copy(inputs[s].begin(), inputs[s].end(), mBatchInputs.begin() + s * inputSize);
+		copy(targets[s].begin(), targets[s].end(), mBatchTargets.begin() + s * outputSize);
+	}
+
+	TrainBatch(mBatchInputs.data(), mBatchTargets.data(), count);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::TrainBatch(Real const* inputs, Real const* targets, size_t const count)
+{
+	if (count == 0) return;
+
+	if (mPool) {
+		if (mTrainingMode == TrainingMode::Hogwild) TrainBatchHogwild(inputs, targets, count);
+		else TrainBatchParallel(inputs, targets, count);
+		return;
+	}
+
+	mWorkspace.Reserve(count);
+	LoadInputs(mWorkspace, inputs, count);
+	ForwardPropagateBatch(mWorkspace, count);
+	Real sqrError = BackPropagateBatch(mWorkspace, targets, count, NextStep());
+	UpdateError(sqrError, count);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::SetThreads(size_t const numThreads, TrainingMode const mode)
+{
+	mTrainingMode = mode;
+	if (numThreads == getThreads()) return;
+
+	mPool.reset();
+	mReplicas.clear();
+	mReplicaErrors.clear();
+
+	if (numThreads > 1) {
+		mPool = make_shared<ThreadPool>(numThreads);
+		mReplicas.assign(numThreads, BasicWorkspace<Real>(mLayerSizes, 0));
+		mReplicaErrors.assign(numThreads, Real(0));
+		WarmUpThreads();
+	}
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::WarmUpThreads()
+{
+	// every index waits until all threads have one, so no thread runs two of them
+	size_t const numThreads = mPool->getNumThreads();
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+	BasicData<Real> inputs(cPredictBlock * inputSize);
+	BasicData<Real> outputs(numThreads * cPredictBlock * outputSize);
+	atomic<size_t> arrived(0);
+	mPool->ParallelFor(numThreads, [&](size_t index) {
+		++arrived;
+		while (arrived < numThreads) this_thread::yield();
+		PredictBlock(inputs.data(), cPredictBlock, outputs.data() + index * cPredictBlock * outputSize);
+	});
+}
+
+template<typename Real>
+size_t BasicNeuralNet<Real>::getThreads() const
+{
+	return mPool ? mPool->getNumThreads() : 1;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Initialize(initializer::Settings const& initializer)
+{
+	initializer::Validate(initializer);
+	for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+		if (mLayers[i].getFormat() == WeightFormat::Sparse) throw string("The weights of a sparse layer can't be replaced");
+	}
+
+	if (!initializer::IsCounterBased(initializer.type)) {
+		// rand() is drawn layer by layer in the order the weights were always drawn
+		for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+			mLayers[i].DrawRandomWeights();
+		}
+	}
+	else {
+		// every weight only depends on the seed and its position, so the blocks of neurons
+		// can be drawn by any thread
+		Philox const generator(initializer.seed);
+		for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+			size_t const size = mLayerSizes[i];
+			size_t const blocks = (size + cInitializeBlock - 1) / cInitializeBlock;
+			auto draw = [&](size_t block) {
+				size_t const first = block * cInitializeBlock;
+				mLayers[i].DrawWeights(initializer.type, generator, i, first, min(cInitializeBlock, size - first));
+			};
+			if (mPool && blocks > 1) mPool->ParallelFor(blocks, draw);
+			else for (size_t block = 0; block < blocks; ++block) draw(block);
 		}
 	}
+
+	for (size_t i = 0; i < mLayerSizes.size(); ++i) {
+		mLayers[i].ResetState();
+	}
+	mInitializer = initializer;
+	mError = Real(0);
+	mRecentError = Real(0);
+	mEta = static_cast<Real>(mOptimizer.learningRate);
+	mSteps = 0;
 }
 
-void NeuralNet::BackPropagate(Data const & target)
+template<typename Real>
+initializer::Settings BasicNeuralNet<Real>::getInitializer() const
 {
-	// calculate overall net error (RMS of output neuron errors)
-	Layer& outputLayer = mLayers.back();
-	mError = 0.0;
+	return mInitializer;
+}
 
-	if (target.size() != outputLayer.getSize()) throw string("Number of target values does not match number of output neurons");
+template<typename Real>
+void BasicNeuralNet<Real>::LoadInputs(BasicWorkspace<Real>& workspace, Real const* inputs, size_t const count) const
+{
+	size_t const inputSize = mLayerSizes.front();
+	Real* batchInputs = workspace.getOutputs(0);
 
-	for (size_t i = 0; i < outputLayer.getSize(); ++i) {
-		double delta = target[i] - outputLayer.getNeuronAt(i).getOutputVal();
-		mError += delta*delta;
+	for (size_t s = 0; s < count; ++s) {
+		copy(inputs + s * inputSize, inputs + (s + 1) * inputSize, batchInputs + s * (inputSize + 1));
 	}
-	mError /= outputLayer.getSize();
-	mError = sqrt(mError);
+}
 
-	// recent average measurement
-	mRecentError = (mRecentError * mBeta + mError) / (mBeta + 1.0);
+template<typename Real>
+void BasicNeuralNet<Real>::TrainBatchParallel(Real const* inputs, Real const* targets, size_t const count)
+{
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+	size_t const shards = (count < mReplicas.size()) ? count : mReplicas.size();
 
-	// calculate output layer gradients
-	for (size_t i = 0; i < outputLayer.getSize(); ++i) {
-		outputLayer.getNeuronAt(i).CalcOutputGradients(target[i]);
+	size_t const last = mLayerSizes.size() - 1;
+	auto firstOf = [count, shards](size_t const shard) { return shard * count / shards; };
+
+	// every shard computes the gradients of its samples in its own workspace
+	mPool->ParallelFor(shards, [&](size_t shard) {
+		size_t const first = firstOf(shard);
+		size_t const shardCount = firstOf(shard + 1) - first;
+		BasicWorkspace<Real>& workspace = mReplicas[shard];
+
+		workspace.Reserve(shardCount);
+		LoadInputs(workspace, inputs + first * inputSize, shardCount);
+		ForwardPropagateBatch(workspace, shardCount);
+		CalcGradientsBatch(workspace, targets + first * outputSize, shardCount);
+	});
+
+	// the errors and the weight gradients are summed up in the order of the samples like
+	// on one thread, so the result doesn't depend on the number of threads: the rows of
+	// every layer are split among the threads and each row adds the shards in turn, the
+	// sums are collected in the first workspace
+	Real sqrError = 0;
+	for (size_t shard = 0; shard < shards; ++shard) {
+		sqrError = mLayers[last].AddSquaredErrorsBatch(mReplicas[shard].getOutputs(last),
+			targets + firstOf(shard) * outputSize, firstOf(shard + 1) - firstOf(shard), sqrError);
+	}
+	for (size_t i = last; i > 0; --i) {
+		size_t const size = mLayerSizes[i];
+		size_t const blocks = (size < mPool->getNumThreads()) ? size : mPool->getNumThreads();
+		mPool->ParallelFor(blocks, [&](size_t block) {
+			NEURO_PROFILE_SCOPE(Reduction, i, count);
+			size_t const firstRow = block * size / blocks;
+			size_t const rows = (block + 1) * size / blocks - firstRow;
+			for (size_t shard = 0; shard < shards; ++shard) {
+				mLayers[i].AddWeightGradientsBatch(mReplicas[shard].getOutputs(i - 1), mReplicas[shard].getGradients(i),
+					mReplicas[0].getWeightGradients(i), firstOf(shard + 1) - firstOf(shard), firstRow, rows, shard == 0);
+			}
+		});
 	}
 
-	// calculate hidden layers gradients
-	for (size_t i = mLayers.size() - 2; i > 0; --i) {
-		Layer& hiddenLayer = mLayers[i];
-		Layer& nextLayer = mLayers[i + 1];
+	UpdateBatch(mReplicas[0], sqrError, count);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::TrainBatchHogwild(Real const* inputs, Real const* targets, size_t const count)
+{
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+	size_t const shards = (count < mReplicas.size()) ? count : mReplicas.size();
+	optimizer::Step<Real> const step = NextStep();
 
-		for (size_t j = 0; j < hiddenLayer.getNeurons().size(); ++j) {
-			hiddenLayer.getNeuronAt(j).CalcHiddenGradients(nextLayer.getNeurons());
+	// every shard trains sample by sample and updates the shared weights without locking,
+	// only the activations and gradients are private
+	mPool->ParallelFor(shards, [&](size_t shard) {
+		size_t const first = shard * count / shards;
+		size_t const last = (shard + 1) * count / shards;
+		BasicWorkspace<Real>& workspace = mReplicas[shard];
+		Real sqrError = 0;
+
+		workspace.Reserve(1);
+		for (size_t s = first; s < last; ++s) {
+			LoadInputs(workspace, inputs + s * inputSize, 1);
+			ForwardPropagateBatch(workspace, 1);
+			sqrError += BackPropagateBatch(workspace, targets + s * outputSize, 1, step);
 		}
+		mReplicaErrors[shard] = sqrError;
+	});
+
+	Real sqrError = 0;
+	for (size_t shard = 0; shard < shards; ++shard) {
+		sqrError += mReplicaErrors[shard];
 	}
+	UpdateError(sqrError, count);
+}
 
-	// update connection weights
-	for (size_t i = mLayers.size() - 1; i > 0; --i) {
-		Layer& layer = mLayers[i];
-		Layer& prevLayer = mLayers[i - 1];
+template<typename Real>
+void BasicNeuralNet<Real>::ForwardPropagateBatch(BasicWorkspace<Real>& workspace, size_t const count) const
+{
+	for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+		NEURO_PROFILE_SCOPE(Forward, i, count);
+		mLayers[i].ForwardPropagateBatch(workspace.getOutputs(i - 1), workspace.getOutputs(i), count);
+	}
+}
+
+template<typename Real>
+Real BasicNeuralNet<Real>::CalcOutputGradientsBatch(BasicWorkspace<Real>& workspace, Real const* targets,
+	size_t const count) const
+{
+	size_t const last = mLayerSizes.size() - 1;
+	NEURO_PROFILE_SCOPE(OutputGradients, last, count);
+	return mLayers[last].CalcOutputGradientsBatch(workspace.getOutputs(last), targets, workspace.getGradients(last),
+		count);
+}
+
+template<typename Real>
+Real BasicNeuralNet<Real>::BackPropagateBatch(BasicWorkspace<Real>& workspace, Real const* targets, size_t const count,
+	optimizer::Step<Real> const& step)
+{
+	size_t const last = mLayerSizes.size() - 1;
+	Real const sqrError = CalcOutputGradientsBatch(workspace, targets, count);
 
-		for (size_t j = 0; j < layer.getSize(); ++j) {
-			layer.getNeuronAt(j).UpdateInputWeights(prevLayer.getNeurons());
+	// layer by layer: the weight gradients, the gradients of the previous layer with the
+	// old weights and the update, so the weights of a layer are swept while they are
+	// still in the cache
+	for (size_t i = last; i > 0; --i) {
+		{
+			NEURO_PROFILE_SCOPE(WeightGradients, i, count);
+			mLayers[i].CalcWeightGradientsBatch(workspace.getOutputs(i - 1), workspace.getGradients(i),
+				workspace.getWeightGradients(i), count);
+		}
+		if (i > 1) {
+			NEURO_PROFILE_SCOPE(HiddenGradients, i - 1, count);
+			mLayers[i - 1].CalcHiddenGradientsBatch(mLayers[i], workspace.getGradients(i),
+				workspace.getOutputs(i - 1), workspace.getGradients(i - 1), count);
+		}
+		{
+			NEURO_PROFILE_SCOPE(UpdateWeights, i, count);
+			mLayers[i].UpdateInputWeightsBatch(workspace.getWeightGradients(i), count, step);
 		}
 	}
 
-	// update learning rate (eta)
-	double etaUpdate = mRecentError * mEtaUpdate;
-	for (size_t i = 0; i < mLayers.size(); ++i) {
-		mLayers[i].setEta(etaUpdate);
+	return sqrError;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::CalcGradientsBatch(BasicWorkspace<Real>& workspace, Real const* targets, size_t const count) const
+{
+	size_t const last = mLayerSizes.size() - 1;
+	CalcOutputGradientsBatch(workspace, targets, count);
+
+	// calculate hidden layers gradients
+	for (size_t i = last - 1; i > 0; --i) {
+		NEURO_PROFILE_SCOPE(HiddenGradients, i, count);
+		mLayers[i].CalcHiddenGradientsBatch(mLayers[i + 1], workspace.getGradients(i + 1),
+			workspace.getOutputs(i), workspace.getGradients(i), count);
 	}
 }
 
-void NeuralNet::Train(Data const & input, Data const & target)
+template<typename Real>
+void BasicNeuralNet<Real>::UpdateBatch(BasicWorkspace<Real>& workspace, Real const sqrError, size_t const count)
 {
-	ForwardPropagate(input);
-	BackPropagate(target);
+	// update connection weights
+	optimizer::Step<Real> const step = NextStep();
+	for (size_t i = mLayerSizes.size() - 1; i > 0; --i) {
+		NEURO_PROFILE_SCOPE(UpdateWeights, i, count);
+		mLayers[i].UpdateInputWeightsBatch(workspace.getWeightGradients(i), count, step);
+	}
+
+	UpdateError(sqrError, count);
 }
 
-Data NeuralNet::getResults()
+template<typename Real>
+void BasicNeuralNet<Real>::UpdateError(Real const sqrError, size_t const count)
 {
-	Data res;
-	for (size_t i = 0; i < mLayers.back().getSize(); ++i) {
-		res.push_back(mOutputActivationFunc(mLayers.back().getNeuronAt(i).getOutputVal()));
+	NEURO_PROFILE_SCOPE(UpdateEta, 0, count);
+
+	// overall net error (RMS of output neuron errors of all samples)
+	mError = sqrt(sqrError / (count * mLayerSizes.back()));
+
+	// recent average measurement
+	mRecentError = (mRecentError * mBeta + mError) / (mBeta + Real(1));
+
+	// update learning rate (eta), the other optimizers keep theirs
+	Real etaUpdate = mRecentError * mEtaUpdate;
+	if (mOptimizer.type == Optimizer::Adaptive && etaUpdate > 0.0) {
+		mEta = etaUpdate;
+	}
+}
+
+template<typename Real>
+optimizer::Step<Real> BasicNeuralNet<Real>::NextStep()
+{
+	optimizer::Step<Real> step;
+	step.type = mOptimizer.type;
+	step.eta = mEta;
+	step.momentum = static_cast<Real>(mOptimizer.momentum);
+	step.decay = static_cast<Real>(mOptimizer.decay);
+	step.epsilon = static_cast<Real>(mOptimizer.epsilon);
+
+	// the running mean and squares of Adam start at 0, the bias correction scales eta up
+	// while they are still too small
+	if (mOptimizer.type == Optimizer::Adam) {
+		++mSteps;
+		double const t = static_cast<double>(mSteps);
+		double const correction = sqrt(1.0 - pow(mOptimizer.decay, t)) / (1.0 - pow(mOptimizer.momentum, t));
+		step.eta = static_cast<Real>(mEta * correction);
 	}
+	return step;
+}
+
+template<typename Real>
+BasicData<Real> BasicNeuralNet<Real>::getResults()
+{
+	BasicData<Real> res(mLayerSizes.back());
+	getResults(res.data());
 	return res;
 }
 
-double NeuralNet::getRecentError() const
+template<typename Real>
+void BasicNeuralNet<Real>::getResults(Real* results) const
+{
+	Real const* outputs = mLayers[mLayerSizes.size() - 1].getOutputs();
+	for (size_t i = 0; i < mLayerSizes.back(); ++i) {
+		results[i] = static_cast<Real>(mOutputActivationFunc(outputs[i]));
+	}
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Predict(Real const* inputs, size_t const count, Real* outputs) const
+{
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+	size_t const blocks = (count + cPredictBlock - 1) / cPredictBlock;
+
+	if (mPool && blocks > 1) {
+		mPool->ParallelFor(blocks, [&](size_t block) {
+			size_t const first = block * cPredictBlock;
+			size_t const blockCount = (first + cPredictBlock < count) ? cPredictBlock : count - first;
+			PredictBlock(inputs + first * inputSize, blockCount, outputs + first * outputSize);
+		});
+	}
+	else {
+		for (size_t first = 0; first < count; first += cPredictBlock) {
+			size_t const blockCount = (first + cPredictBlock < count) ? cPredictBlock : count - first;
+			PredictBlock(inputs + first * inputSize, blockCount, outputs + first * outputSize);
+		}
+	}
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::PredictBlock(Real const* inputs, size_t const count, Real* outputs) const
+{
+	// every thread ping-pongs between two scratch buffers that only grow, so they can be
+	// shared by all nets the thread runs
+	thread_local BasicData<Real> bufferA, bufferB;
+	size_t maxColumns = 0;
+	for (auto size : mLayerSizes) {
+		if (size + 1 > maxColumns) maxColumns = size + 1;
+	}
+	if (bufferA.size() < count * maxColumns) {
+		bufferA.resize(count * maxColumns);
+		bufferB.resize(count * maxColumns);
+	}
+
+	// pass values to input neurons, the last column is the bias neuron
+	size_t columns = mLayerSizes.front() + 1;
+	Real* prevOutputs = bufferA.data();
+	Real* curOutputs = bufferB.data();
+	for (size_t s = 0; s < count; ++s) {
+		copy(inputs + s * (columns - 1), inputs + (s + 1) * (columns - 1), prevOutputs + s * columns);
+		prevOutputs[s * columns + columns - 1] = 1.0;
+	}
+
+	for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+		NEURO_PROFILE_SCOPE(Predict, i, count);
+		columns = mLayers[i].getSize() + 1;
+		mLayers[i].ForwardPropagateBatch(prevOutputs, curOutputs, count);
+		for (size_t s = 0; s < count; ++s) {
+			curOutputs[s * columns + columns - 1] = 1.0;
+		}
+		swap(prevOutputs, curOutputs);
+	}
+
+	size_t const outputSize = columns - 1;
+	for (size_t s = 0; s < count; ++s) {
+		for (size_t j = 0; j < outputSize; ++j) {
+			outputs[s * outputSize + j] = static_cast<Real>(mOutputActivationFunc(prevOutputs[s * columns + j]));
+		}
+	}
+}
+
+template<typename Real>
+Real BasicNeuralNet<Real>::getRecentError() const
 {
 	return mRecentError;
 }
+
+template<typename Real>
+Real BasicNeuralNet<Real>::getEta() const
+{
+	return mEta;
+}
+
+template<typename Real>
+LayerSizes const& BasicNeuralNet<Real>::getLayerSizes() const
+{
+	return mLayerSizes;
+}
+
+template<typename Real>
+Activations BasicNeuralNet<Real>::getActivations() const
+{
+	Activations activations;
+	for (size_t i = 1; i < mLayerSizes.size(); ++i) {
+		activations.push_back(mLayers[i].getActivation());
+	}
+	return activations;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::setBeta(Real const beta)
+{
+	if (!(beta >= 0.0)) throw string("Beta must not be negative");
+	mBeta = beta;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::setEtaUpdate(Real const etaUpdate)
+{
+	if (!(etaUpdate > 0.0)) throw string("The eta update factor must be positive");
+	mEtaUpdate = etaUpdate;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::setAlpha(Real const alpha)
+{
+	if (!(alpha >= 0.0 && alpha < 1.0)) throw string("The momentum must be in [0, 1)");
+	mOptimizer.momentum = alpha;
+}
+
+template<typename Real>
+Real BasicNeuralNet<Real>::getBeta() const
+{
+	return mBeta;
+}
+
+template<typename Real>
+Real BasicNeuralNet<Real>::getEtaUpdate() const
+{
+	return mEtaUpdate;
+}
+
+template<typename Real>
+Real BasicNeuralNet<Real>::getAlpha() const
+{
+	return static_cast<Real>(mOptimizer.momentum);
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::setOptimizer(optimizer::Settings const& settings)
+{
+	optimizer::Validate(settings);
+
+	// the running squares are added once, the layers and their buffers are copied into a
+	// larger arena with the same layout
+	size_t const numLayers = mLayerSizes.size();
+	if (optimizer::NeedsSquares(settings.type) && mLayers[numLayers - 1].getSquares() == nullptr) {
+		Restructure(true, vector<vector<char>>(numLayers));
+	}
+
+	for (size_t i = 0; i < numLayers; ++i) {
+		mLayers[i].ResetState();
+	}
+	mOptimizer = settings;
+	mEta = static_cast<Real>(settings.learningRate);
+	mSteps = 0;
+}
+
+template<typename Real>
+optimizer::Settings BasicNeuralNet<Real>::getOptimizer() const
+{
+	return mOptimizer;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Prune(double const sparsity)
+{
+	if (!(sparsity >= 0.0 && sparsity <= 1.0)) throw string("The sparsity must be in [0, 1]");
+
+	size_t const numLayers = mLayerSizes.size();
+	vector<vector<char>> keep(numLayers);
+	for (size_t i = 1; i < numLayers; ++i) {
+		mLayers[i].SelectWeights(sparsity, keep[i]);
+	}
+	Restructure(mLayers[numLayers - 1].getSquares() != nullptr, keep);
+	// the sparse layers have scratch buffers of their own
+	if (mPool) WarmUpThreads();
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::setSparseCrossover(double const density)
+{
+	if (!(density >= 0.0 && density <= 1.0)) throw string("The sparse crossover must be in [0, 1]");
+	mSparseCrossover = density;
+}
+
+template<typename Real>
+double BasicNeuralNet<Real>::getSparseCrossover() const
+{
+	return (mSparseCrossover < 0.0) ? kernels::SparseCrossover<Real>() : mSparseCrossover;
+}
+
+template<typename Real>
+WeightFormat BasicNeuralNet<Real>::getWeightFormat(size_t const index) const
+{
+	if (index >= mLayerSizes.size()) throw string("Net doesn't have that many layers");
+	return mLayers[index].getFormat();
+}
+
+template<typename Real>
+BasicLayer<Real> const& BasicNeuralNet<Real>::getLayer(size_t const index) const
+{
+	if (index >= mLayerSizes.size()) throw string("Net doesn't have that many layers");
+	return mLayers[index];
+}
+
+template<typename Real>
+size_t BasicNeuralNet<Real>::getModelSize() const
+{
+	return mArena.getSize();
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Restructure(bool const squares, vector<vector<char>> const& keep,
+	vector<WeightFormat> const& formats)
+{
+	// the format of every layer decides the size of its storage
+	size_t const numLayers = mLayerSizes.size();
+	double const crossover = getSparseCrossover();
+	vector<WeightFormat> newFormats(numLayers);
+	vector<size_t> storageSizes(numLayers);
+	size_t arenaSize = Arena::Align(numLayers * sizeof(BasicLayer<Real>));
+	for (size_t i = 0; i < numLayers; ++i) {
+		size_t const numPrevNeurons = (i > 0) ? mLayerSizes[i - 1] : 0;
+		newFormats[i] = mLayers[i].getFormat();
+		size_t numWeights = mLayers[i].getNumWeights();
+		if (!keep[i].empty()) {
+			numWeights = static_cast<size_t>(count(keep[i].begin(), keep[i].end(), 1));
+			double const density = static_cast<double>(numWeights) / keep[i].size();
+			if (!formats.empty()) newFormats[i] = formats[i];
+			else if (numWeights == keep[i].size()) newFormats[i] = WeightFormat::Dense;
+			else if (density <= crossover) newFormats[i] = WeightFormat::Sparse;
+			else newFormats[i] = WeightFormat::Masked;
+		}
+		storageSizes[i] = BasicLayer<Real>::getStorageSize(mLayerSizes[i], numPrevNeurons, squares, newFormats[i],
+			numWeights);
+		arenaSize += storageSizes[i];
+	}
+
+	Arena arena(arenaSize);
+	BasicLayer<Real>* layers = reinterpret_cast<BasicLayer<Real>*>(arena.getData());
+	char* storage = arena.getData() + Arena::Align(numLayers * sizeof(BasicLayer<Real>));
+	for (size_t i = 0; i < numLayers; ++i) {
+		new (&layers[i]) BasicLayer<Real>(mLayers[i]);
+		if (keep[i].empty()) layers[i].Relocate(storage, squares);
+		else layers[i].Prune(storage, squares, newFormats[i], keep[i].data());
+		storage += storageSizes[i];
+	}
+	mArena = move(arena);
+	mLayers = layers;
+}
+
+template<typename Real>
+void BasicNeuralNet<Real>::Save(string const& fileName) const
+{
+	size_t const numLayers = mLayerSizes.size();
+	size_t const tableSize = numLayers * sizeof(model::LayerEntry);
+	vector<model::LayerEntry> layers(numLayers);
+	bool const squares = mLayers[numLayers - 1].getSquares() != nullptr;
+
+	// the blocks follow the layer table, each one aligned
+	size_t offset = sizeof(model::Header) + tableSize;
+	for (size_t i = 0; i < numLayers; ++i) {
+		size_t const blockSize = mLayers[i].getSize() * mLayers[i].getNumInputs() * sizeof(Real);
+		layers[i].size = mLayers[i].getSize();
+		layers[i].weights = 0;
+		layers[i].deltaWeights = 0;
+		layers[i].squares = 0;
+		layers[i].mask = 0;
+		layers[i].activation = 0;
+		layers[i].format = 0;
+		if (i == 0) continue;
+
+		layers[i].activation = static_cast<uint32_t>(mLayers[i].getActivation());
+		layers[i].format = static_cast<uint32_t>(mLayers[i].getFormat());
+		layers[i].weights = model::Align(offset);
+		layers[i].deltaWeights = model::Align(layers[i].weights + blockSize);
+		offset = layers[i].deltaWeights + blockSize;
+		if (squares) {
+			layers[i].squares = model::Align(offset);
+			offset = layers[i].squares + blockSize;
+		}
+		if (mLayers[i].getFormat() != WeightFormat::Dense) {
+			layers[i].mask = model::Align(offset);
+			offset = layers[i].mask + mLayers[i].getSize() * mLayers[i].getNumInputs();
+		}
+	}
+
+	model::Header header;
+	memcpy(header.magic, model::cMagic, sizeof(header.magic));
+	header.byteOrder = model::cByteOrder;
+	header.version = model::cVersion;
+	header.scalar = model::ScalarOf<Real>::value;
+	header.optimizer = static_cast<uint32_t>(mOptimizer.type);
+	header.numLayers = static_cast<uint32_t>(numLayers);
+	header.eta = mEta;
+	header.error = mError;
+	header.recentError = mRecentError;
+	header.fileSize = offset;
+	header.beta = mBeta;
+	header.etaUpdate = mEtaUpdate;
+	header.alpha = mOptimizer.momentum;
+	header.learningRate = mOptimizer.learningRate;
+	header.decay = mOptimizer.decay;
+	header.epsilon = mOptimizer.epsilon;
+	header.steps = mSteps;
+	memset(header.reserved, 0, sizeof(header.reserved));
+
+	ofstream file(fileName, ios::binary | ios::trunc);
+	if (!file.is_open()) throw string("Could not open " + fileName);
+	file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	file.write(reinterpret_cast<char const*>(layers.data()), tableSize);
+
+	// pad with zeros up to each block, pruned layers are expanded to dense matrices and
+	// their masks
+	char const padding[model::cAlignment] = { 0 };
+	size_t position = sizeof(header) + tableSize;
+	BasicData<Real> weights, deltaWeights, squareValues;
+	vector<char> keep;
+	for (size_t i = 1; i < numLayers; ++i) {
+		size_t const matrixSize = mLayers[i].getSize() * mLayers[i].getNumInputs();
+		size_t const blockSize = matrixSize * sizeof(Real);
+		Real const* weightData = mLayers[i].getWeights();
+		Real const* deltaData = mLayers[i].getDeltaWeights();
+		Real const* squareData = mLayers[i].getSquares();
+		if (mLayers[i].getFormat() != WeightFormat::Dense) {
+			weights.resize(matrixSize);
+			deltaWeights.resize(matrixSize);
+			squareValues.resize(squares ? matrixSize : 0);
+			keep.resize(matrixSize);
+			mLayers[i].CopyWeights(weights.data(), deltaWeights.data(), squares ? squareValues.data() : nullptr,
+				keep.data());
+			weightData = weights.data();
+			deltaData = deltaWeights.data();
+			squareData = squareValues.data();
+		}
+
+		auto writeBlock = [&](uint64_t const blockOffset, void const* data, size_t const size) {
+			file.write(padding, blockOffset - position);
+			file.write(reinterpret_cast<char const*>(data), size);
+			position = blockOffset + size;
+		};
+		writeBlock(layers[i].weights, weightData, blockSize);
+		writeBlock(layers[i].deltaWeights, deltaData, blockSize);
+		if (squares) writeBlock(layers[i].squares, squareData, blockSize);
+		if (layers[i].mask != 0) writeBlock(layers[i].mask, keep.data(), matrixSize);
+	}
+
+	file.close();
+	if (!file) throw string("Could not write " + fileName);
+}
+
+template<typename Real>
+BasicNeuralNet<Real> BasicNeuralNet<Real>::Load(string const& fileName, ActivationFunc outputActivation,
+	size_t const maxBatchSize)
+{
+	MappedFile file(fileName);
+	model::Header const& header = model::Validate(file.getData(), file.getSize(), model::ScalarOf<Real>::value);
+	model::LayerEntry const* layers = model::getLayers(header);
+
+	LayerSizes layerSizes(header.numLayers);
+	Activations activations;
+	for (size_t i = 0; i < layerSizes.size(); ++i) {
+		layerSizes[i] = static_cast<size_t>(layers[i].size);
+		if (i > 0) activations.push_back(static_cast<Activation>(layers[i].activation));
+	}
+
+	// the weights are copied into a net that didn't draw any. The optimizer is set first,
+	// it adds the running squares to the arena if it needs them.
+	BasicNeuralNet net(layerSizes, activations, outputActivation, maxBatchSize, Uninitialized());
+	optimizer::Settings const settings = { static_cast<Optimizer>(header.optimizer), header.learningRate,
+		header.alpha, header.decay, header.epsilon };
+	net.setOptimizer(settings);
+	bool const squares = net.mLayers[layerSizes.size() - 1].getSquares() != nullptr;
+	for (size_t i = 1; i < layerSizes.size(); ++i) {
+		net.mLayers[i].setWeights(reinterpret_cast<Real const*>(file.getData() + layers[i].weights),
+			reinterpret_cast<Real const*>(file.getData() + layers[i].deltaWeights),
+			squares ? reinterpret_cast<Real const*>(file.getData() + layers[i].squares) : nullptr);
+	}
+
+	// the pruned layers are pruned again with their masks, in their saved formats
+	vector<vector<char>> keep(layerSizes.size());
+	vector<WeightFormat> formats(layerSizes.size(), WeightFormat::Dense);
+	bool pruned = false;
+	for (size_t i = 1; i < layerSizes.size(); ++i) {
+		formats[i] = static_cast<WeightFormat>(layers[i].format);
+		if (formats[i] == WeightFormat::Dense) continue;
+		char const* mask = reinterpret_cast<char const*>(file.getData() + layers[i].mask);
+		keep[i].assign(mask, mask + layers[i].size * (layers[i - 1].size + 1));
+		for (char const flag : keep[i]) {
+			if (flag != 0 && flag != 1) throw string("Model file has a mask with values other than 0 and 1");
+		}
+		pruned = true;
+	}
+	if (pruned) net.Restructure(squares, keep, formats);
+	net.mEta = static_cast<Real>(header.eta);
+	net.mError = static_cast<Real>(header.error);
+	net.mRecentError = static_cast<Real>(header.recentError);
+	net.mSteps = header.steps;
+	net.setBeta(static_cast<Real>(header.beta));
+	net.setEtaUpdate(static_cast<Real>(header.etaUpdate));
+
+	return net;
+}
+
+template class BasicNeuralNet<double>;
+template class BasicNeuralNet<float>;
@@ -8,49 +8,349 @@
 #define _NET
 
 #include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
 #include "Object.h"
 #include "Layer.h"
+#include "Optimizer.h"
+#include "Initializer.h"
+#include "Arena.h"
+#include "Workspace.h"
+#include "ThreadPool.h"
 
-typedef std::vector<double> Data;
-typedef std::vector<size_t> LayerSizes;
+// output activation of getResults and Predict, the values of float nets are converted
 typedef double(*ActivationFunc)(double const x);
 
+//-------------------------------------------------------------------------------------------
+///How TrainBatch uses the threads of the net:
+///Synchronous - the batch is split into one shard per thread, every shard computes its
+///              gradients in a private workspace, the threads sum up the weight gradients
+///              of different rows in the order of the samples and apply them in one update.
+///              The weights are the same as when the batch is trained on one thread.
+///Hogwild     - every thread runs per-sample training on its shard and writes the weight
+///              updates to the shared weights without any locking. Updates of different
+///              threads may overwrite each other, so results are not reproducible.
+enum class TrainingMode { Synchronous, Hogwild };
+
 //###########################################################################################
 ///This class represents an adaptive neural network. It consists of several layers of neurons,
-///which dimensions can be stated as a parameter in the constructor.
-class NeuralNet: public Object
+///which dimensions can be stated as a parameter in the constructor. [Real] is the number
+///type of all weights, activations and kernels: NeuralNet computes with double, FloatNeuralNet
+///with float, which halves the memory traffic and doubles the SIMD width. The template is
+///instantiated for both in NeuralNet.cpp.
+///
+///The net is sized up front: the layers and all their weights, delta weights, outputs and
+///gradients are placed in one Arena, so constructing a net allocates the model at once and
+///copying a net copies it with one memcpy (see BasicLayer).
+///
+///The initial weights are drawn by an initializer (see Initializer.h), Initializer::Rand by
+///default. The counter-based initializers derive every weight from the seed and its
+///position, so a net is reproducible without touching the global state of rand(), and
+///Initialize draws the weights of large nets on all threads of the net.
+///
+///The weights are updated by the optimizer set with setOptimizer, Optimizer::Adaptive by
+///default (see Optimizer.h).
+///
+///Prune zeroes the weights with the smallest magnitudes (see Pruning.h for a schedule).
+///Every layer chooses its WeightFormat by its density: below the sparse crossover the
+///layer switches to compressed sparse rows, which only store and multiply the remaining
+///weights, above it the layer stays dense with a mask, where the dense kernels are faster.
+template<typename Real>
+class BasicNeuralNet: public Object
 {
 public:
 	//-------------------------------------------------------------------------------------
-	///Description: Constructor, which takes the nets layerSizes as parameter
-	NeuralNet(LayerSizes const& layerSizes, ActivationFunc outputActivation);
+	///Description: Constructor, which takes the nets layerSizes as parameter. All scratch
+	///buffers for single samples and batches of up to [maxBatchSize] samples are allocated
+	///here, so training and inference don't allocate memory afterwards.
+	BasicNeuralNet(LayerSizes const& layerSizes, ActivationFunc outputActivation, size_t const maxBatchSize = 1);
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor with an activation function per layer, the one above uses
+	///Activation::Clip for all layers
+	///Params: [activations] One activation per layer after the input layer, the other
+	///parameters like above
+	BasicNeuralNet(LayerSizes const& layerSizes, Activations const& activations, ActivationFunc outputActivation,
+		size_t const maxBatchSize = 1);
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor with an initializer, the ones above use Initializer::Rand.
+	///The weights are drawn on the calling thread, see Initialize for large nets.
+	///Params: [initializer] How the weights are drawn, e.g.
+	///initializer::Make(Initializer::HeNormal, seed), the other parameters like above
+	BasicNeuralNet(LayerSizes const& layerSizes, Activations const& activations,
+		initializer::Settings const& initializer, ActivationFunc outputActivation, size_t const maxBatchSize = 1);
+	//-------------------------------------------------------------------------------------
+	///Description: Copy constructor, clones the weights, the eta, error and optimizer state
+	///and the hyperparameters. The arena of the model is copied at once, the scratch buffers are
+	///allocated fresh. The copy trains with one thread, SetThreads starts its own workers.
+	BasicNeuralNet(BasicNeuralNet const& other);
+	//-------------------------------------------------------------------------------------
+	///Description: Move constructor, the arena is taken over without copying
+	BasicNeuralNet(BasicNeuralNet&& other) = default;
+	//-------------------------------------------------------------------------------------
+	///Description: Assignment, clones another net like the copy constructor. If both nets
+	///have the same topology, the model is copied into the existing arena without any
+	///allocation, which makes resetting replicas as fast as a memcpy. The net keeps its own
+	///threads.
+	BasicNeuralNet& operator=(BasicNeuralNet const& other);
 
 	//-------------------------------------------------------------------------------------
 	///Description: A forward propagation cycle
 	///Params: [input] Input data
-	void ForwardPropagate(Data const& input);
+	void ForwardPropagate(BasicData<Real> const& input);
+	//-------------------------------------------------------------------------------------
+	///Description: A forward propagation cycle without size check
+	///Params: [input] Input values, one per input neuron
+	void ForwardPropagate(Real const* input);
 	//-------------------------------------------------------------------------------------
 	///Description: Backpropagation - adjust the weights of the neurons according to the RMS
 	///Params: [target] Target vector
-	void BackPropagate(Data const& target);
+	void BackPropagate(BasicData<Real> const& target);
+	//-------------------------------------------------------------------------------------
+	///Description: Backpropagation without size check
+	///Params: [target] Target values, one per output neuron
+	void BackPropagate(Real const* target);
 	//-------------------------------------------------------------------------------------
 	///Description: Training cycle - forward- and backpropagation batch
 	///Params: [input] Input data, [target] Target vector
-	void Train(Data const& input, Data const& target);
+	void Train(BasicData<Real> const& input, BasicData<Real> const& target);
+	//-------------------------------------------------------------------------------------
+	///Description: Training cycle without size checks
+	///Params: [input] Input values, [target] Target values
+	void Train(Real const* input, Real const* target);
+	//-------------------------------------------------------------------------------------
+	///Description: Mini-batch training cycle - forward- and backpropagation of all samples
+	///as matrix-matrix products, the gradients are averaged and the weights are updated once.
+	///The recent average error and eta are updated with the RMS error of the whole batch.
+	///The batch is one step of the optimizer, also in Hogwild mode.
+	///getResults() is not affected.
+	///Params: [inputs] Input data, [targets] Target vectors, one per input
+	void TrainBatch(std::vector<BasicData<Real>> const& inputs,
+		std::vector<BasicData<Real>> const& targets);
+	//-------------------------------------------------------------------------------------
+	///Description: Mini-batch training cycle on contiguous data
+	///Params: [inputs] Row-major inputs [count x input size], [targets] Row-major targets
+	///[count x output size], [count] Number of samples
+	void TrainBatch(Real const* inputs, Real const* targets, size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Set the number of threads used by TrainBatch. The worker threads are
+	///started here and kept alive until the number changes or the net is destroyed. Every
+	///thread predicts a block once, so the scratch buffers of the workers are allocated
+	///here and not by the first batches.
+	///Params: [numThreads] Number of threads including the calling thread (1 = no workers),
+	///[mode] How the threads train a batch
+	void SetThreads(size_t const numThreads, TrainingMode const mode = TrainingMode::Synchronous);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of threads used by TrainBatch
+	size_t getThreads() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Draw new weights and start over: the state of the optimizer, eta and
+	///the errors are reset like for a new net. A counter-based initializer draws the rows
+	///of every layer on the threads set with SetThreads, the weights are the same for any
+	///number of threads. Throws if a layer is sparse, the pruned weights of masked layers
+	///stay zero.
+	///Params: [initializer] How the weights are drawn
+	void Initialize(initializer::Settings const& initializer);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the initializer the weights were drawn with last
+	initializer::Settings getInitializer() const;
 	//-------------------------------------------------------------------------------------
 	///Description: Get the results of a forwardpropagation
 	///Return: Data vector
-	Data getResults();
+	BasicData<Real> getResults();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the results of a forwardpropagation without allocating memory
+	///Params: [results] Receives one value per output neuron
+	void getResults(Real* results) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a batch. The net is not changed, so Predict may be called
+	///from several threads at the same time (but not concurrently with training or
+	///SetThreads). Large batches are split across the threads set with SetThreads.
+	///Params: [inputs] Row-major inputs [count x input size], [count] Number of samples,
+	///[outputs] Receives the row-major results [count x output size], the output activation
+	///is applied like in getResults()
+	void Predict(Real const* inputs, size_t const count, Real* outputs) const;
 	//-------------------------------------------------------------------------------------
 	///Description: Get the recent average error
-	double getRecentError() const;
+	Real getRecentError() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the current learning rate (eta), all layers use the same one. Adam
+	///scales it with its bias correction in every step.
+	Real getEta() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the sizes of the layers WITHOUT bias neurons
+	LayerSizes const& getLayerSizes() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the activation functions of the layers after the input layer
+	Activations getActivations() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Set the smoothing of the recent average error: every error is added
+	///with a weight of 1 / (beta + 1) (0.5 by default)
+	///Params: [beta] Smoothing factor >= 0
+	void setBeta(Real const beta);
+	//-------------------------------------------------------------------------------------
+	///Description: Set the factor from the recent average error to eta (0.55 by default),
+	///only used by Optimizer::Adaptive
+	///Params: [etaUpdate] Factor > 0
+	void setEtaUpdate(Real const etaUpdate);
+	//-------------------------------------------------------------------------------------
+	///Description: Set the momentum of the optimizer (0 by default, beta1 of Adam)
+	///Params: [alpha] Momentum in [0, 1)
+	void setAlpha(Real const alpha);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the smoothing of the recent average error
+	Real getBeta() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the factor from the recent average error to eta
+	Real getEtaUpdate() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the momentum of the optimizer
+	Real getAlpha() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Set the optimizer and its hyperparameters. Eta starts at the learning
+	///rate and the state of the previous optimizer is reset. The running squares of RMSProp
+	///and Adam are added to the arena of the net the first time one of them is set.
+	///Params: [settings] Optimizer and hyperparameters, e.g. optimizer::Defaults(Optimizer::Adam)
+	void setOptimizer(optimizer::Settings const& settings);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the optimizer and its hyperparameters
+	optimizer::Settings getOptimizer() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Magnitude pruning: zero the smallest weights of every layer after the
+	///input layer (see BasicLayer::SelectWeights) and store the layers in the format their
+	///density calls for. The layers and their buffers are copied into a new arena, the
+	///state of the optimizer is kept for the remaining weights.
+	///Params: [sparsity] Fraction of the weights of every layer WITHOUT bias weights that
+	///is zero afterwards in [0, 1], the weights that were pruned before stay pruned
+	void Prune(double const sparsity);
+	//-------------------------------------------------------------------------------------
+	///Description: Set the density (remaining weights / all weights of a layer) at or
+	///below which Prune stores a layer in compressed sparse rows. By default the crossover
+	///of the kernels is used (see kernels::SparseCrossover), it only depends on the
+	///instruction set and the number type, so the formats are reproducible.
+	///Params: [density] Crossover in [0, 1], 0 keeps all layers dense with a mask
+	void setSparseCrossover(double const density);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the density at or below which Prune stores a layer sparse
+	double getSparseCrossover() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the format of the weights of a layer
+	///Params: [index] Index of the layer, the input layer has no weights
+	WeightFormat getWeightFormat(size_t const index) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get a layer, e.g. to read its weights
+	///Params: [index] Index of the layer, 0 is the input layer
+	BasicLayer<Real> const& getLayer(size_t const index) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the bytes of the model: the arena with the layers and all their
+	///weights and buffers, without the scratch buffers
+	size_t getModelSize() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Save the topology, the activation functions, the weights, the eta
+	///state with beta, eta update and alpha and the optimizer with its hyperparameters and
+	///state in the binary model format (see ModelFile.h). The output activation is not
+	///saved. Pruned layers are saved as dense matrices with zeros together with their
+	///WeightFormat and mask, the sparse crossover is not saved.
+	///Params: [fileName] Name of the file, an existing file is overwritten
+	void Save(std::string const& fileName) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Create a net from a file written by Save. The net can be trained further
+	///and continues with the saved eta state, beta, eta update and alpha and the saved
+	///optimizer and its state, pruned layers get their saved format and mask back. For
+	///inference only, MappedNeuralNet uses the file in place instead of copying the weights.
+	///Params: [fileName] Name of the file, the number type must match Real,
+	///[outputActivation], [maxBatchSize] Like in the constructor
+	static BasicNeuralNet Load(std::string const& fileName, ActivationFunc outputActivation,
+		size_t const maxBatchSize = 1);
 
 private:
-	std::vector<Layer> mLayers;
-	double mError = 0.0;
-	double mRecentError = 0.0;
-	const double mBeta = 0.5;
-	const double mEtaUpdate = 0.55;
-	const ActivationFunc mOutputActivationFunc;
+	// marks the constructor that doesn't initialize the weights
+	struct Uninitialized {};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor of a net whose weights are all zero, for Load, which copies
+	///the saved weights over them without drawing any
+	///Params: Like in the constructors above
+	BasicNeuralNet(LayerSizes const& layerSizes, Activations const& activations, ActivationFunc outputActivation,
+		size_t const maxBatchSize, Uninitialized);
+	//-------------------------------------------------------------------------------------
+	///Description: Copy row-major inputs into the input layer matrix of a workspace
+	void LoadInputs(BasicWorkspace<Real>& workspace, Real const* inputs, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Synchronous data-parallel TrainBatch on the thread pool
+	void TrainBatchParallel(Real const* inputs, Real const* targets, size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Lock-free asynchronous TrainBatch on the thread pool
+	void TrainBatchHogwild(Real const* inputs, Real const* targets, size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Predict a block of cPredictBlock samples on every thread of the pool at
+	///the same time, which sizes the scratch buffers of all threads for the net
+	void WarmUpThreads();
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a block of samples with the scratch buffers of the thread
+	void PredictBlock(Real const* inputs, size_t const count, Real* outputs) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Forward pass of a batch whose inputs are already in the workspace
+	void ForwardPropagateBatch(BasicWorkspace<Real>& workspace, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Calculate the output gradients of a batch
+	///Return: Sum of the squared output errors
+	Real CalcOutputGradientsBatch(BasicWorkspace<Real>& workspace, Real const* targets, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Fused backward pass of a batch, which updates the weights of every
+	///layer right after its gradients (see BasicLayer::BackPropagate), the error and eta
+	///are not updated
+	///Return: Sum of the squared output errors
+	Real BackPropagateBatch(BasicWorkspace<Real>& workspace, Real const* targets, size_t const count,
+		optimizer::Step<Real> const& step);
+	//-------------------------------------------------------------------------------------
+	///Description: Gradients of all layers of a batch without weight gradients and update,
+	///TrainBatchParallel sums up the weight gradients of all workspaces afterwards
+	void CalcGradientsBatch(BasicWorkspace<Real>& workspace, Real const* targets, size_t const count) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Apply summed weight gradients and update error and eta
+	void UpdateBatch(BasicWorkspace<Real>& workspace, Real const sqrError, size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Update the recent average error and eta after a batch
+	void UpdateError(Real const sqrError, size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Start the next step of the optimizer
+	///Return: The parameters of the update of all layers
+	optimizer::Step<Real> NextStep();
+	//-------------------------------------------------------------------------------------
+	///Description: Copy the layers and their buffers into a new arena
+	///Params: [squares] Whether the buffers hold the running squares, [keep] Per layer the
+	///flags of BasicLayer::SelectWeights to prune it with, an empty vector keeps a layer
+	///as it is, [formats] Per layer the format of a pruned layer, empty to choose it by
+	///the density and the sparse crossover
+	void Restructure(bool const squares, std::vector<std::vector<char>> const& keep,
+		std::vector<WeightFormat> const& formats = std::vector<WeightFormat>());
+
+	LayerSizes mLayerSizes;
+	// the layers are the first objects in the arena, followed by their buffers
+	Arena mArena;
+	BasicLayer<Real>* mLayers = nullptr;
+	BasicWorkspace<Real> mWorkspace;
+	BasicData<Real> mBatchInputs;
+	BasicData<Real> mBatchTargets;
+	std::shared_ptr<ThreadPool> mPool;
+	std::vector<BasicWorkspace<Real>> mReplicas;
+	std::vector<Real> mReplicaErrors;
+	TrainingMode mTrainingMode = TrainingMode::Synchronous;
+	Real mError = Real(0);
+	Real mRecentError = Real(0);
+	Real mBeta = Real(0.5);
+	Real mEtaUpdate = Real(0.55);
+	optimizer::Settings mOptimizer = optimizer::Defaults(Optimizer::Adaptive);
+	initializer::Settings mInitializer = { Initializer::Rand, 0 };
+	Real mEta = Real(0.15);
+	// number of steps of the optimizer since it was set, for the bias correction of Adam
+	uint64_t mSteps = 0;
+	// negative: the crossover of the kernels
+	double mSparseCrossover = -1.0;
+	ActivationFunc mOutputActivationFunc;
 };
+
+typedef BasicNeuralNet<double> NeuralNet;
+typedef BasicNeuralNet<float> FloatNeuralNet;
 #endif //_NET
\ No newline at end of file
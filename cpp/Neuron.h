@@ -7,74 +7,79 @@
 #ifndef _NEURON
 #define _NEURON
 
-#include <vector>
-#include <memory>
-#include "Object.h"
-
-class Neuron;
-
-typedef std::vector<Neuron> LayerNeurons;
-struct Connection {
-	double weight;
-	double deltaWeight;
-};
+#include <cstddef>
+#include "Activation.h"
 
 //###########################################################################################
-///This is the representation of a neuron. The neuron itself contains the connections with
-///the weights to the neurons in the previous layer and an activation function as well as
-///an output value. When constructed, it needs to know the previous layer and the activation
-///function.
-class Neuron: public Object
+///This is the representation of a neuron. A neuron does not own any memory: its output
+///value, gradient and the row of weights to the neurons in the previous layer are stored
+///in the contiguous buffers of its layer, the neuron only points into them. The activation
+///function is chosen per layer (see Activation.h), activationFunc is the default one.
+///[Real] is the number type of the net (double or float), the template is instantiated for
+///both in Neuron.cpp. Like its layer, a neuron has no virtual functions.
+template<typename Real>
+class BasicNeuron
 {
 public:
 	//-------------------------------------------------------------------------------------
 	///Description: Constructor
-	///Params: [numCom] Number of connections [myIndex] Index of the neuron in its layer
-	Neuron(size_t const numCon, size_t const myIndex);
+	///Params: [outputVal] Output slot in the layer, [gradient] Gradient slot in the layer
+	///(nullptr for bias neurons), [weights] Row of input weights, [deltaWeights] Row of
+	///delta weights, [numInputs] Length of the weight rows
+	BasicNeuron(Real* outputVal, Real* gradient, Real* weights, Real* deltaWeights,
+		size_t const numInputs);
 
 	//-------------------------------------------------------------------------------------
-	///Description: Update the weights of the inputs to 'learn'
-	///Params: [prevLayer] Vector of neurons of the previous layer
-	void UpdateInputWeights(LayerNeurons& prevLayer);
+	///Description: Returns the output value of the neuron
+	Real getOutputVal() const;
 	//-------------------------------------------------------------------------------------
-	///Description: Calculate hidden layers gradients
-	///Params: [nextLayer] Vector of neurons of the next layer
-	void CalcHiddenGradients(LayerNeurons& nextLayer);
+	///Description: Set the output value of the neuron manually (needed for input neurons)
+	void setOutputVal(Real const x);
 	//-------------------------------------------------------------------------------------
-	///Description: Calculate output gradients
-	///Params: [targetVal] The target value
-	void CalcOutputGradients(double const targetVal);
+	///Description: Get the current gradient
+	Real getGradient() const;
 	//-------------------------------------------------------------------------------------
-	///Description: Process input values by calculating new output value
-	///Params: [prevLayer] Vector of neurons of the previous layer
-	void ForwardPropagate(LayerNeurons& prevLayer);
+	///Description: Get the row of weights to the neurons in the previous layer
+	Real* getWeights();
 	//-------------------------------------------------------------------------------------
-	///Description: Returns the output value of the neuron
-	double getOutputVal() const;
+	///Description: Get the row of delta weights to the neurons in the previous layer
+	Real* getDeltaWeights();
 	//-------------------------------------------------------------------------------------
-	///Description: Set the output value of the neuron manually (needed for input neurons)
-	void setOutputVal(double const x);
+	///Description: Get the number of input connections (including the bias connection)
+	size_t getNumInputs() const;
+
 	//-------------------------------------------------------------------------------------
-	///Description: Get the connection vector
-	std::vector<Connection>& getConnections();
+	///Description: Returns a random initial weight in [0, 1], all number types draw the
+	///same sequence from rand()
+	static Real getRandomWeight();
 	//-------------------------------------------------------------------------------------
-	///Description: Get the current gradient
-	double getGradient() const;
+	///Description: The default activation function of the neurons (Activation::Clip)
+	static Real activationFunc(Real const x);
 	//-------------------------------------------------------------------------------------
-	///Description: Set the learning rate (eta)
-	void setEta(double const& eta);
+	///Description: Derivative of the default activation function, takes the output value
+	static Real activationFuncDeriv(Real const x);
 
 private:
-	double mOutputVal = 0.0;
-	double mGradient = 0.0;
-	size_t mMyIndex = 0;
-	std::vector<Connection> mConnections;
-	double mEta = 0.15;
-
-	double sumDow(LayerNeurons const& nextLayer) const;
-	static double getRandomWeight();
-	static double activationFunc(double const x);
-	static double activationFuncDeriv(double const x);
-	const double alpha = 0.0;
+	Real* mOutputVal = nullptr;
+	Real* mGradient = nullptr;
+	Real* mWeights = nullptr;
+	Real* mDeltaWeights = nullptr;
+	size_t mNumInputs = 0;
 };
-#endif //_NEURON
\ No newline at end of file
+
+typedef BasicNeuron<double> Neuron;
+
+// the activation pair is called for every neuron of every sample, so it is defined here to
+// let the compiler inline it
+template<typename Real>
+inline Real BasicNeuron<Real>::activationFunc(Real const x)
+{
+	return activation::Clip::Func(x);
+}
+
+template<typename Real>
+inline Real BasicNeuron<Real>::activationFuncDeriv(Real const x)
+{
+	return activation::Clip::Deriv(x);
+}
+#endif //_NEURON
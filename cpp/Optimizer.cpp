@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Optimizer.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "Optimizer.h"
+
+using namespace std;
+
+namespace {
+	Optimizer const cOptimizers[] = {
+		Optimizer::Adaptive, Optimizer::Sgd, Optimizer::Nesterov, Optimizer::RMSProp, Optimizer::Adam
+	};
+}
+
+optimizer::Settings optimizer::Defaults(Optimizer const type)
+{
+	switch (type) {
+	case Optimizer::Adaptive: return { type, 0.15, 0.0, 0.0, 0.0 };
+	case Optimizer::Sgd: return { type, 0.15, 0.0, 0.0, 0.0 };
+	case Optimizer::Nesterov: return { type, 0.05, 0.9, 0.0, 0.0 };
+	case Optimizer::RMSProp: return { type, 0.01, 0.0, 0.9, 1e-8 };
+	case Optimizer::Adam: return { type, 0.01, 0.9, 0.999, 1e-8 };
+	default: throw string("Unknown optimizer");
+	}
+}
+
+void optimizer::Validate(Settings const& settings)
+{
+	if (!IsValid(settings.type)) throw string("Unknown optimizer");
+	if (!(settings.learningRate > 0.0)) throw string("The learning rate must be positive");
+	if (!(settings.momentum >= 0.0 && settings.momentum < 1.0)) throw string("The momentum must be in [0, 1)");
+	if (NeedsSquares(settings.type)) {
+		if (!(settings.decay >= 0.0 && settings.decay < 1.0)) throw string("The decay must be in [0, 1)");
+		if (!(settings.epsilon > 0.0)) throw string("Epsilon must be positive");
+	}
+}
+
+bool optimizer::NeedsSquares(Optimizer const type)
+{
+	return type == Optimizer::RMSProp || type == Optimizer::Adam;
+}
+
+bool optimizer::IsValid(Optimizer const type)
+{
+	for (auto known : cOptimizers) {
+		if (type == known) return true;
+	}
+	return false;
+}
+
+char const* optimizer::Name(Optimizer const type)
+{
+	switch (type) {
+	case Optimizer::Adaptive: return "adaptive";
+	case Optimizer::Sgd: return "sgd";
+	case Optimizer::Nesterov: return "nesterov";
+	case Optimizer::RMSProp: return "rmsprop";
+	case Optimizer::Adam: return "adam";
+	default: return "unknown";
+	}
+}
+
+Optimizer optimizer::Parse(string const& name)
+{
+	for (auto type : cOptimizers) {
+		if (name == Name(type)) return type;
+	}
+	throw string("Unknown optimizer " + name);
+}
@@ -0,0 +1,122 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Optimizer.h
+// Date:        2026/10/16
+// Description: Optimizers, the rules that turn the gradients of a layer into weight updates.
+//              The net chooses one for all layers, every update of a weight row is one
+//              vectorized kernel call (see Kernels.h).
+//
+//              Adaptive    - the rule the net was always trained with and the default:
+//                            momentum alpha, eta follows the recent average error
+//                            (eta = recent error * eta update, see setEtaUpdate)
+//              Sgd         - fixed eta and momentum alpha, 0 gives plain SGD
+//              Nesterov    - fixed eta and Nesterov momentum
+//              RMSProp     - fixed eta divided by the running RMS of the gradients of
+//                            every weight
+//              Adam        - running mean and RMS of the gradients of every weight with
+//                            bias correction
+//
+//              The state of the optimizers is kept per weight in the arena of the net: the
+//              delta weights of a layer are the velocity (Adaptive, Sgd, Nesterov) or the
+//              running mean (Adam), RMSProp and Adam need a second buffer with the running
+//              squares, which is only allocated for them.
+//
+//              The gradients of the net point from the output to the target, so the kernels
+//              add the updates to the weights.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _OPTIMIZER
+#define _OPTIMIZER
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "Kernels.h"
+
+//-------------------------------------------------------------------------------------------
+///Optimizer of a net
+enum class Optimizer : uint32_t { Adaptive = 1, Sgd = 2, Nesterov = 3, RMSProp = 4, Adam = 5 };
+
+namespace optimizer {
+	//-------------------------------------------------------------------------------------
+	///Hyperparameters of an optimizer, not every optimizer uses all of them
+	struct Settings {
+		Optimizer type;
+		// eta, the initial one for Adaptive
+		double learningRate;
+		// alpha of Adaptive, Sgd and Nesterov, beta1 of Adam
+		double momentum;
+		// decay of the running squares, rho of RMSProp and beta2 of Adam
+		double decay;
+		// added to the running RMS, so there is no division by zero
+		double epsilon;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Parameters of one update of all layers in the number type of the net
+	template<typename Real>
+	struct Step {
+		Optimizer type;
+		// learning rate of this update, Adam's contains the bias correction
+		Real eta;
+		Real momentum;
+		Real decay;
+		Real epsilon;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the default hyperparameters of an optimizer:
+	///Adaptive, Sgd - eta 0.15, no momentum (the defaults of the net)
+	///Nesterov      - eta 0.05, momentum 0.9
+	///RMSProp       - eta 0.01, decay 0.9, epsilon 1e-8
+	///Adam          - eta 0.01, beta1 0.9, beta2 0.999, epsilon 1e-8
+	Settings Defaults(Optimizer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Check the hyperparameters, throws if one is out of range
+	void Validate(Settings const& settings);
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the optimizer needs the running squares
+	bool NeedsSquares(Optimizer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the value is one of the optimizers
+	bool IsValid(Optimizer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the name of an optimizer, e.g. "adam"
+	char const* Name(Optimizer const type);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the optimizer of a name, throws if there is none
+	Optimizer Parse(std::string const& name);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Update a row of weights
+	///Params: [step] The update, [weights] Row of weights, [deltaWeights] Velocities or
+	///running means of the row, [squares] Running squares of the row (only used by RMSProp
+	///and Adam), [inputs] Inputs of the weights, [gradient] Gradient they are multiplied
+	///with, [n] Length of the row
+	template<typename Real>
+	void Update(Step<Real> const& step, Real* weights, Real* deltaWeights, Real* squares, Real const* inputs,
+		Real const gradient, size_t const n);
+}
+
+// called for every row of every layer, so it is defined here to let the compiler inline it
+template<typename Real>
+inline void optimizer::Update(Step<Real> const& step, Real* weights, Real* deltaWeights, Real* squares,
+	Real const* inputs, Real const gradient, size_t const n)
+{
+	switch (step.type) {
+	case Optimizer::Nesterov:
+		kernels::UpdateWeightsNesterov(weights, deltaWeights, inputs, step.eta, gradient, step.momentum, n);
+		break;
+	case Optimizer::RMSProp:
+		kernels::UpdateWeightsRMSProp(weights, squares, inputs, step.eta, gradient, step.decay, step.epsilon, n);
+		break;
+	case Optimizer::Adam:
+		kernels::UpdateWeightsAdam(weights, deltaWeights, squares, inputs, step.eta, gradient, step.momentum,
+			step.decay, step.epsilon, n);
+		break;
+	default:
+		// Adaptive and Sgd only differ in the eta
+		kernels::UpdateWeights(weights, deltaWeights, inputs, step.eta, gradient, step.momentum, n);
+		break;
+	}
+}
+#endif //_OPTIMIZER
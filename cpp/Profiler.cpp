@@ -0,0 +1,425 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Profiler.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <iomanip>
+#include <algorithm>
+#include "Profiler.h"
+
+#ifdef NEURO_PROFILE
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_RDTSC
+#endif
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#endif //NEURO_PROFILE
+
+using namespace std;
+
+namespace {
+	size_t const cNumPhases = static_cast<size_t>(profiling::Phase::Count);
+
+	profiling::Stats& operator+=(profiling::Stats& sum, profiling::Stats const& stats)
+	{
+		sum.calls += stats.calls;
+		sum.samples += stats.samples;
+		sum.cycles += stats.cycles;
+		sum.instructions += stats.instructions;
+		sum.cacheMisses += stats.cacheMisses;
+		return sum;
+	}
+}
+
+char const* profiling::PhaseName(Phase const phase)
+{
+	switch (phase) {
+	case Phase::Forward: return "Forward";
+	case Phase::OutputGradients: return "OutputGradients";
+	case Phase::Backward: return "Backward";
+	case Phase::HiddenGradients: return "HiddenGradients";
+	case Phase::WeightGradients: return "WeightGradients";
+	case Phase::Reduction: return "Reduction";
+	case Phase::UpdateWeights: return "UpdateWeights";
+	case Phase::UpdateEta: return "UpdateEta";
+	case Phase::Predict: return "Predict";
+	default: return "Unknown";
+	}
+}
+
+#ifdef NEURO_PROFILE
+namespace {
+	// sums of a phase of a layer, the thread that owns the table is the only writer, so
+	// it adds with a plain load and store, the atomics make reading from other threads
+	// well defined
+	struct Slot {
+		atomic<uint64_t> calls;
+		atomic<uint64_t> samples;
+		atomic<uint64_t> cycles;
+		atomic<uint64_t> instructions;
+		atomic<uint64_t> cacheMisses;
+	};
+
+	struct Table {
+		Slot slots[cNumPhases][profiling::cMaxLayers];
+	};
+
+	void Add(atomic<uint64_t>& sum, uint64_t const value)
+	{
+		sum.store(sum.load(memory_order_relaxed) + value, memory_order_relaxed);
+	}
+
+	void Clear(Table& table)
+	{
+		for (auto& phase : table.slots) {
+			for (auto& slot : phase) {
+				slot.calls.store(0, memory_order_relaxed);
+				slot.samples.store(0, memory_order_relaxed);
+				slot.cycles.store(0, memory_order_relaxed);
+				slot.instructions.store(0, memory_order_relaxed);
+				slot.cacheMisses.store(0, memory_order_relaxed);
+			}
+		}
+	}
+
+	profiling::Stats Read(Slot const& slot)
+	{
+		return { slot.calls.load(memory_order_relaxed), slot.samples.load(memory_order_relaxed),
+			slot.cycles.load(memory_order_relaxed), slot.instructions.load(memory_order_relaxed),
+			slot.cacheMisses.load(memory_order_relaxed) };
+	}
+
+	// tables of the running threads and the sums of the finished ones
+	mutex sTablesMutex;
+	vector<Table*> sTables;
+	Table sFinished;
+	atomic<bool> sHardwareCounters(false);
+
+	//---------------------------------------------------------------------------------------
+	// Table and hardware counters of a thread, registered while the thread runs
+	struct ThreadState {
+		Table table;
+		// perf event group: instructions (leader) and cache misses
+		int group = -1;
+		int cacheMisses = -1;
+		bool opened = false;
+
+		ThreadState()
+		{
+			Clear(table);
+			lock_guard<mutex> lock(sTablesMutex);
+			sTables.push_back(&table);
+		}
+
+		~ThreadState()
+		{
+			{
+				lock_guard<mutex> lock(sTablesMutex);
+				for (size_t p = 0; p < cNumPhases; ++p) {
+					for (size_t l = 0; l < profiling::cMaxLayers; ++l) {
+						Slot& sum = sFinished.slots[p][l];
+						profiling::Stats const stats = Read(table.slots[p][l]);
+						Add(sum.calls, stats.calls);
+						Add(sum.samples, stats.samples);
+						Add(sum.cycles, stats.cycles);
+						Add(sum.instructions, stats.instructions);
+						Add(sum.cacheMisses, stats.cacheMisses);
+					}
+				}
+				sTables.erase(find(sTables.begin(), sTables.end(), &table));
+			}
+#ifdef __linux__
+			if (cacheMisses >= 0) close(cacheMisses);
+			if (group >= 0) close(group);
+#endif
+		}
+
+		// opens the counters once, returns false if they are not available
+		bool OpenCounters()
+		{
+			if (opened) return group >= 0;
+			opened = true;
+#ifdef __linux__
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			attr.read_format = PERF_FORMAT_GROUP;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			group = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+			if (group < 0) return false;
+
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			cacheMisses = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+			if (cacheMisses < 0) {
+				close(group);
+				group = -1;
+			}
+#endif
+			return group >= 0;
+		}
+
+		bool ReadCounters(uint64_t& instructions, uint64_t& misses) const
+		{
+#ifdef __linux__
+			struct { uint64_t count; uint64_t values[2]; } data;
+			if (read(group, &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) return false;
+			instructions = data.values[0];
+			misses = data.values[1];
+			return true;
+#else
+			return false;
+#endif
+		}
+	};
+
+	ThreadState& LocalState()
+	{
+		thread_local ThreadState state;
+		return state;
+	}
+
+	uint64_t ReadCycles()
+	{
+#ifdef HAS_RDTSC
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+			chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+}
+
+bool profiling::isEnabled()
+{
+	return true;
+}
+
+double profiling::getCyclesPerSecond()
+{
+#ifdef HAS_RDTSC
+	// measured once against the steady clock
+	static double const cyclesPerSecond = []() {
+		chrono::steady_clock::time_point const start = chrono::steady_clock::now();
+		uint64_t const startCycles = __rdtsc();
+		this_thread::sleep_for(chrono::milliseconds(20));
+		uint64_t const cycles = __rdtsc() - startCycles;
+		return cycles / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}();
+	return cyclesPerSecond;
+#else
+	return 1e9;
+#endif
+}
+
+bool profiling::EnableHardwareCounters(bool const enable)
+{
+	if (enable && !LocalState().OpenCounters()) return false;
+	sHardwareCounters.store(enable, memory_order_relaxed);
+	return true;
+}
+
+profiling::Stats profiling::getStats(Phase const phase, size_t const layer)
+{
+	size_t const p = static_cast<size_t>(phase);
+	size_t const l = min(layer, cMaxLayers - 1);
+	lock_guard<mutex> lock(sTablesMutex);
+
+	Stats sum = Read(sFinished.slots[p][l]);
+	for (Table const* table : sTables) {
+		sum += Read(table->slots[p][l]);
+	}
+	return sum;
+}
+
+void profiling::Reset()
+{
+	lock_guard<mutex> lock(sTablesMutex);
+	Clear(sFinished);
+	for (Table* table : sTables) {
+		Clear(*table);
+	}
+}
+
+profiling::Scope::Scope(Phase const phase, size_t const layer, size_t const samples)
+	: mPhase(phase), mLayer(min(layer, cMaxLayers - 1)), mSamples(samples), mCounted(false)
+{
+	// the counters are read before the cycles, so reading them isn't part of the cycles
+	if (sHardwareCounters.load(memory_order_relaxed)) {
+		ThreadState& state = LocalState();
+		mCounted = state.OpenCounters() && state.ReadCounters(mInstructions, mCacheMisses);
+	}
+	mCycles = ReadCycles();
+}
+
+profiling::Scope::~Scope()
+{
+	uint64_t const cycles = ReadCycles() - mCycles;
+	ThreadState& state = LocalState();
+	Slot& slot = state.table.slots[static_cast<size_t>(mPhase)][mLayer];
+
+	uint64_t instructions = 0, cacheMisses = 0;
+	if (mCounted && state.ReadCounters(instructions, cacheMisses)) {
+		Add(slot.instructions, instructions - mInstructions);
+		Add(slot.cacheMisses, cacheMisses - mCacheMisses);
+	}
+	Add(slot.calls, 1);
+	Add(slot.samples, mSamples);
+	Add(slot.cycles, cycles);
+}
+#else
+bool profiling::isEnabled()
+{
+	return false;
+}
+
+double profiling::getCyclesPerSecond()
+{
+	return 1e9;
+}
+
+bool profiling::EnableHardwareCounters(bool const enable)
+{
+	return !enable;
+}
+
+profiling::Stats profiling::getStats(Phase const, size_t const)
+{
+	return Stats();
+}
+
+void profiling::Reset()
+{
+}
+
+profiling::Scope::Scope(Phase const phase, size_t const layer, size_t const samples)
+	: mPhase(phase), mLayer(layer), mSamples(samples), mCycles(0), mInstructions(0), mCacheMisses(0), mCounted(false)
+{
+}
+
+profiling::Scope::~Scope()
+{
+}
+#endif //NEURO_PROFILE
+
+profiling::Stats profiling::getStats(Phase const phase)
+{
+	Stats sum = Stats();
+	for (size_t layer = 0; layer < cMaxLayers; ++layer) {
+		sum += getStats(phase, layer);
+	}
+	return sum;
+}
+
+vector<profiling::Entry> profiling::getReport()
+{
+	vector<Entry> report;
+	for (size_t p = 0; p < cNumPhases; ++p) {
+		for (size_t layer = 0; layer < cMaxLayers; ++layer) {
+			Stats const stats = getStats(static_cast<Phase>(p), layer);
+			if (stats.calls > 0) report.push_back({ static_cast<Phase>(p), layer, stats });
+		}
+	}
+	return report;
+}
+
+void profiling::Dump(ostream& os)
+{
+	if (!isEnabled()) {
+		os << "Profiling is disabled, compile with NEURO_PROFILE to enable it" << endl;
+		return;
+	}
+
+	vector<Entry> const report = getReport();
+	Stats total = Stats();
+	for (auto& entry : report) {
+		total += entry.stats;
+	}
+	bool const counters = total.instructions > 0;
+
+	ios::fmtflags const flags = os.flags();
+	streamsize const precision = os.precision();
+	os << left << setw(18) << "Phase" << setw(7) << "Layer" << right << setw(12) << "Calls" << setw(14) << "Samples"
+		<< setw(12) << "Time [ms]" << setw(16) << "Cycles/sample" << setw(8) << "Share";
+	if (counters) os << setw(14) << "Instr/sample" << setw(14) << "Misses/sample";
+	os << endl;
+
+	double const msPerCycle = 1e3 / getCyclesPerSecond();
+	for (auto& entry : report) {
+		Stats const& stats = entry.stats;
+		double const samples = (stats.samples > 0) ? double(stats.samples) : 1.0;
+		os << left << setw(18) << PhaseName(entry.phase) << setw(7) << entry.layer << right << setw(12) << stats.calls
+			<< setw(14) << stats.samples << fixed << setprecision(2) << setw(12) << stats.cycles * msPerCycle
+			<< setprecision(0) << setw(16) << stats.cycles / samples << setprecision(1) << setw(7)
+			<< ((total.cycles > 0) ? 100.0 * stats.cycles / total.cycles : 0.0) << "%";
+		if (counters) os << setprecision(0) << setw(14) << stats.instructions / samples << setprecision(2) << setw(14)
+			<< stats.cacheMisses / samples;
+		os << endl;
+	}
+	os << left << setw(18) << "Total" << setw(7) << "" << right << setw(12) << total.calls << setw(14) << ""
+		<< fixed << setprecision(2) << setw(12) << total.cycles * msPerCycle << endl;
+	os.flags(flags);
+	os.precision(precision);
+}
+
+namespace {
+	//---------------------------------------------------------------------------------------
+	// background thread of the periodic dump, stopped at the latest when the program ends
+	struct PeriodicDump {
+		mutex dumpMutex;
+		condition_variable stopped;
+		bool stop = false;
+		thread worker;
+
+		~PeriodicDump()
+		{
+			Stop();
+		}
+
+		void Stop()
+		{
+			{
+				lock_guard<mutex> lock(dumpMutex);
+				stop = true;
+			}
+			stopped.notify_all();
+			if (worker.joinable()) worker.join();
+		}
+	} sPeriodicDump;
+}
+
+void profiling::StartPeriodicDump(ostream& os, chrono::milliseconds const interval)
+{
+	sPeriodicDump.Stop();
+	sPeriodicDump.stop = false;
+	sPeriodicDump.worker = thread([&os, interval]() {
+		unique_lock<mutex> lock(sPeriodicDump.dumpMutex);
+		while (!sPeriodicDump.stopped.wait_for(lock, interval, []() { return sPeriodicDump.stop; })) {
+			lock.unlock();
+			Dump(os);
+			os << flush;
+			lock.lock();
+		}
+	});
+}
+
+void profiling::StopPeriodicDump()
+{
+	sPeriodicDump.Stop();
+}
@@ -0,0 +1,143 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Profiler.h
+// Date:        2026/10/16
+// Description: Instrumentation of the hot paths of the neural net. When the program is
+//              compiled with NEURO_PROFILE defined, every phase of training and inference
+//              records its calls, samples and cycles per layer, optionally together with
+//              hardware counters (instructions and cache misses, Linux only). Otherwise
+//              NEURO_PROFILE_SCOPE expands to nothing and the queries return zeros.
+//
+//              The records of all nets and threads are summed up. Every thread writes to
+//              its own table, so the instrumentation doesn't synchronize threads.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _PROFILER
+#define _PROFILER
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+namespace profiling {
+	//-------------------------------------------------------------------------------------
+	///Phases of training and inference. Phases that belong to the whole net and not to a
+	///layer are recorded as layer 0 (the input layer has no work of its own).
+	///Forward          - forward propagation of a layer in Train and TrainBatch
+	///OutputGradients  - squared error and gradients of the output layer
+	///Backward         - fused backward step of a layer in Train: gradients of the previous
+	///                   layer and update of the input weights
+	///HiddenGradients  - gradients of a hidden layer in TrainBatch
+	///WeightGradients  - summed weight gradients of a batch
+	///Reduction        - summing up the weight gradients of all shards in TrainBatch
+	///UpdateWeights    - update of the input weights of a layer in TrainBatch
+	///UpdateEta        - recent error and eta of the optimizer (layer 0)
+	///Predict          - forward propagation of a layer in Predict
+	enum class Phase { Forward, OutputGradients, Backward, HiddenGradients, WeightGradients, Reduction,
+		UpdateWeights, UpdateEta, Predict, Count };
+
+	// layers with a higher index are recorded in the last one
+	size_t const cMaxLayers = 16;
+
+	//-------------------------------------------------------------------------------------
+	///Sums of a phase, the hardware counters stay 0 if they are not enabled
+	struct Stats {
+		uint64_t calls;
+		uint64_t samples;
+		uint64_t cycles;
+		uint64_t instructions;
+		uint64_t cacheMisses;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///A phase of a layer with its sums
+	struct Entry {
+		Phase phase;
+		size_t layer;
+		Stats stats;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the program was compiled with NEURO_PROFILE
+	bool isEnabled();
+	//-------------------------------------------------------------------------------------
+	///Description: Get a printable name of a phase
+	char const* PhaseName(Phase const phase);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the frequency of the cycle counter. The cycles are time stamp
+	///counter cycles on x86, which run at a constant rate, and nanoseconds elsewhere.
+	double getCyclesPerSecond();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Count instructions and cache misses with perf_event_open. Every thread
+	///opens its counters the next time it records a phase. Reading the counters costs a
+	///system call per phase, so the cycles get bigger, especially for small nets.
+	///Params: [enable] Turn the counters on or off
+	///Return: false if hardware counters are not supported (not Linux, not compiled with
+	///NEURO_PROFILE, or not permitted, see /proc/sys/kernel/perf_event_paranoid)
+	bool EnableHardwareCounters(bool const enable);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the sums of a phase of a layer
+	Stats getStats(Phase const phase, size_t const layer);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the sums of a phase over all layers
+	Stats getStats(Phase const phase);
+	//-------------------------------------------------------------------------------------
+	///Description: Get all phases of all layers that were recorded at least once, ordered
+	///by phase and layer
+	std::vector<Entry> getReport();
+	//-------------------------------------------------------------------------------------
+	///Description: Set all sums to 0. Phases that are running while Reset is called may
+	///keep their old sums.
+	void Reset();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Print the report as a table with the cycles per sample and the share
+	///of every phase in the recorded cycles
+	void Dump(std::ostream& os = std::cout);
+	//-------------------------------------------------------------------------------------
+	///Description: Dump the report periodically from a background thread until
+	///StopPeriodicDump is called. A running periodic dump is stopped first.
+	///Params: [os] Stream to write to, must be valid until StopPeriodicDump, [interval]
+	///Time between two dumps
+	void StartPeriodicDump(std::ostream& os, std::chrono::milliseconds const interval);
+	//-------------------------------------------------------------------------------------
+	///Description: Stop the periodic dump, returns after the background thread is finished
+	void StopPeriodicDump();
+
+	//###################################################################################
+	///This class records a phase from its construction to its destruction. It is used
+	///through NEURO_PROFILE_SCOPE only.
+	class Scope
+	{
+	public:
+		Scope(Phase const phase, size_t const layer, size_t const samples);
+		~Scope();
+	private:
+		Scope(Scope const&) = delete;
+		Scope& operator=(Scope const&) = delete;
+
+		Phase mPhase;
+		size_t mLayer;
+		size_t mSamples;
+		uint64_t mCycles;
+		uint64_t mInstructions;
+		uint64_t mCacheMisses;
+		bool mCounted;
+	};
+}
+
+//-------------------------------------------------------------------------------------------
+// record the rest of the enclosing block as [phase] of [layer] with [samples] samples
+#ifdef NEURO_PROFILE
+#define NEURO_PROFILE_CONCAT2(a, b) a##b
+#define NEURO_PROFILE_CONCAT(a, b) NEURO_PROFILE_CONCAT2(a, b)
+#define NEURO_PROFILE_SCOPE(phase, layer, samples) \
+	profiling::Scope const NEURO_PROFILE_CONCAT(profileScope, __LINE__)(profiling::Phase::phase, layer, samples)
+#else
+#define NEURO_PROFILE_SCOPE(phase, layer, samples) (void)0
+#endif
+
+#endif //_PROFILER
@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Pruning.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <string>
+#include <algorithm>
+#include "Pruning.h"
+
+using namespace std;
+
+void pruning::Validate(Schedule const& schedule)
+{
+	if (!(schedule.initialSparsity >= 0.0 && schedule.initialSparsity <= schedule.finalSparsity &&
+		schedule.finalSparsity <= 1.0)) {
+		throw string("The sparsities must be in [0, 1] and must not decrease");
+	}
+	if (schedule.endRuns < schedule.beginRuns) throw string("The schedule must not end before it begins");
+	if (schedule.intervalRuns == 0) throw string("The interval between two pruning steps must not be 0");
+}
+
+double pruning::Sparsity(Schedule const& schedule, size_t const runs)
+{
+	if (runs < schedule.beginRuns) return 0.0;
+	if (runs >= schedule.endRuns) return schedule.finalSparsity;
+
+	double const remaining = 1.0 - static_cast<double>(runs - schedule.beginRuns) /
+		static_cast<double>(schedule.endRuns - schedule.beginRuns);
+	return schedule.finalSparsity +
+		(schedule.initialSparsity - schedule.finalSparsity) * remaining * remaining * remaining;
+}
+
+template<typename Real>
+void pruning::Train(BasicNeuralNet<Real>& net, Dataset<Real> const& dataset, Schedule const& schedule,
+	size_t const maxRuns, size_t const batchSize)
+{
+	Validate(schedule);
+	if (batchSize == 0) throw string("The net must be trained with at least one sample per batch");
+	if (dataset.getCount() == 0) throw string("The dataset must not be empty");
+	LayerSizes const& layerSizes = net.getLayerSizes();
+	if (dataset.getInputSize() != layerSizes.front() || dataset.getOutputSize() != layerSizes.back()) {
+		throw string("The dataset does not match the topology of the net");
+	}
+
+	size_t runs = 0;
+	size_t nextStep = schedule.beginRuns;
+	bool pruned = false;
+	while (true) {
+		if (!pruned && runs >= nextStep) {
+			net.Prune(Sparsity(schedule, runs));
+			if (nextStep >= schedule.endRuns) pruned = true;
+			else nextStep = min(nextStep + schedule.intervalRuns, schedule.endRuns);
+		}
+		if (runs >= maxRuns) break;
+
+		// the batches end at the next step and don't wrap around the end of the dataset
+		size_t const sample = runs % dataset.getCount();
+		size_t count = min(min(batchSize, maxRuns - runs), dataset.getCount() - sample);
+		if (!pruned) count = min(count, nextStep - runs);
+		if (batchSize == 1) net.Train(dataset.getInputs(sample), dataset.getTargets(sample));
+		else net.TrainBatch(dataset.getInputs(sample), dataset.getTargets(sample), count);
+		runs += count;
+	}
+
+	// the training ended before the schedule
+	if (!pruned) net.Prune(Sparsity(schedule, schedule.endRuns));
+}
+
+template void pruning::Train(NeuralNet& net, Dataset<double> const& dataset, Schedule const& schedule,
+	size_t const maxRuns, size_t const batchSize);
+template void pruning::Train(FloatNeuralNet& net, Dataset<float> const& dataset, Schedule const& schedule,
+	size_t const maxRuns, size_t const batchSize);
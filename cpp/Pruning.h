@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Pruning.h
+// Date:        2026/10/16
+// Description: Gradual magnitude pruning. A net is trained while the sparsity of its layers
+//              is raised from an initial to a final value in steps, so the remaining weights
+//              can take over the work of the pruned ones before the next step. The sparsity
+//              follows the cubic schedule of Zhu and Gupta ("To prune, or not to prune",
+//              2017): it rises fast while there are many redundant weights and slowly at the
+//              end:
+//
+//              s(t) = s_final + (s_initial - s_final) * (1 - (t - t_begin) / (t_end - t_begin))^3
+//
+//              Every step is one BasicNeuralNet::Prune, which switches the layers to the
+//              sparse format once they are sparse enough (see WeightFormat). The training
+//              after t_end fine-tunes the remaining weights.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _PRUNING
+#define _PRUNING
+
+#include "NeuralNet.h"
+#include "Dataset.h"
+
+namespace pruning {
+	//-------------------------------------------------------------------------------------
+	///When and how much a net is pruned, in samples the net was trained with
+	struct Schedule {
+		// sparsity of the first and the last step
+		double initialSparsity;
+		double finalSparsity;
+		// samples before the first and the last step
+		size_t beginRuns;
+		size_t endRuns;
+		// samples between two steps
+		size_t intervalRuns;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Check a schedule, throws if the sparsities are not in [0, 1] and
+	///increasing, the end is before the beginning or the interval is 0
+	void Validate(Schedule const& schedule);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the target sparsity after a number of samples
+	///Params: [schedule] The schedule, [runs] Samples the net was trained with
+	///Return: 0 before the beginning, s(runs) up to the end, the final sparsity afterwards
+	double Sparsity(Schedule const& schedule, size_t const runs);
+	//-------------------------------------------------------------------------------------
+	///Description: Train a net and prune it according to a schedule, the dataset is
+	///repeated. The net is pruned at the beginning, every interval and at the end of the
+	///schedule, the last step is taken after the training if it ends before the schedule.
+	///Params: [net] The net, [dataset] Samples the net is trained with, [schedule] The
+	///schedule, [maxRuns] Samples the net is trained with, [batchSize] Samples per call of
+	///TrainBatch, 1 trains sample by sample with Train
+	template<typename Real>
+	void Train(BasicNeuralNet<Real>& net, Dataset<Real> const& dataset, Schedule const& schedule,
+		size_t const maxRuns, size_t const batchSize = 1);
+}
+
+#endif //_PRUNING
@@ -0,0 +1,282 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    QuantizedNeuralNet.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "QuantizedNeuralNet.h"
+#include "Kernels.h"
+#include "Profiler.h"
+
+using namespace std;
+
+namespace {
+	// number of samples Predict processes at once, like in NeuralNet
+	size_t const cPredictBlock = 64;
+
+	// largest quantized value, -128 is not used so the range is symmetric
+	double const cMaxQuantized = 127.0;
+
+	// the sums of a row stay exact in 32 bit up to this length: 65536 * 127 * 127 plus a
+	// bias of at most cMaxBias is below 2^31
+	size_t const cMaxInputs = 65536;
+	double const cMaxBias = 1 << 30;
+
+	// scale that maps the largest magnitude to cMaxQuantized, 1 if all values are zero
+	double Scale(double const maxAbs)
+	{
+		return (maxAbs > 0.0) ? maxAbs / cMaxQuantized : 1.0;
+	}
+}
+
+template<typename Real>
+QuantizedNeuralNet<Real>::QuantizedNeuralNet(BasicNeuralNet<Real> const& net, Real const* calibration,
+	size_t const count, ActivationFunc outputActivation, quantization::Granularity const granularity)
+	: mLayerSizes(net.getLayerSizes()), mGranularity(granularity), mOutputActivationFunc(outputActivation)
+{
+	if (count == 0) throw string("The net must be calibrated with at least one sample");
+	if (granularity != quantization::Granularity::PerLayer && granularity != quantization::Granularity::PerChannel) {
+		throw string("Unknown quantization granularity");
+	}
+
+	// dense copies of the weights, the calibration runs the batched forward pass on them
+	size_t const numLayers = mLayerSizes.size();
+	vector<BasicData<Real>> weights(numLayers);
+	size_t maxColumns = 0;
+	for (size_t l = 0; l < numLayers; ++l) {
+		if (mLayerSizes[l] + 1 > maxColumns) maxColumns = mLayerSizes[l] + 1;
+		if (mLayerSizes[l] > mMaxSize) mMaxSize = mLayerSizes[l];
+		if (l == 0) continue;
+		if (mLayerSizes[l - 1] > cMaxInputs) throw string("A layer is too wide for 32 bit sums");
+		BasicLayer<Real> const& layer = net.getLayer(l);
+		weights[l].resize(layer.getSize() * layer.getNumInputs());
+		layer.CopyWeights(weights[l].data(), nullptr);
+	}
+
+	// largest magnitude of the inputs of every layer, the outputs of the last layer are
+	// not quantized
+	vector<double> maxInputs(numLayers - 1, 0.0);
+	BasicData<Real> bufferA(cPredictBlock * maxColumns), bufferB(cPredictBlock * maxColumns);
+	size_t const inputSize = mLayerSizes.front();
+	for (size_t first = 0; first < count; first += cPredictBlock) {
+		size_t const blockCount = min(cPredictBlock, count - first);
+		Real* prevOutputs = bufferA.data();
+		Real* curOutputs = bufferB.data();
+		size_t columns = inputSize + 1;
+		for (size_t s = 0; s < blockCount; ++s) {
+			Real const* input = calibration + (first + s) * inputSize;
+			copy(input, input + inputSize, prevOutputs + s * columns);
+			prevOutputs[s * columns + columns - 1] = 1.0;
+		}
+
+		for (size_t l = 1; l < numLayers; ++l) {
+			for (size_t s = 0; s < blockCount; ++s) {
+				for (size_t i = 0; i < columns - 1; ++i) {
+					maxInputs[l - 1] = max(maxInputs[l - 1], fabs(static_cast<double>(prevOutputs[s * columns + i])));
+				}
+			}
+			BasicLayer<Real> const& layer = net.getLayer(l);
+			columns = layer.getSize() + 1;
+			BasicLayer<Real>::ForwardPropagateBatch(weights[l].data(), layer.getSize(), layer.getNumInputs(),
+				layer.getActivation(), prevOutputs, curOutputs, blockCount);
+			for (size_t s = 0; s < blockCount; ++s) {
+				curOutputs[s * columns + columns - 1] = 1.0;
+			}
+			swap(prevOutputs, curOutputs);
+		}
+	}
+
+	for (size_t l = 1; l < numLayers; ++l) {
+		BasicLayer<Real> const& layer = net.getLayer(l);
+		QuantizedLayer quantized;
+		quantized.size = layer.getSize();
+		quantized.numInputs = layer.getNumInputs() - 1;
+		quantized.activation = layer.getActivation();
+
+		double const inputScale = Scale(maxInputs[l - 1]);
+		quantized.inputInvScale = static_cast<Real>(1.0 / inputScale);
+
+		// the weight scales leave out the bias weights, they are quantized with the finer
+		// scale of the sums
+		size_t const numInputs = layer.getNumInputs();
+		vector<double> maxWeights(quantized.size, 0.0);
+		for (size_t j = 0; j < quantized.size; ++j) {
+			for (size_t i = 0; i < quantized.numInputs; ++i) {
+				maxWeights[j] = max(maxWeights[j], fabs(static_cast<double>(weights[l][j * numInputs + i])));
+			}
+		}
+		if (mGranularity == quantization::Granularity::PerLayer) {
+			double const maxWeight = *max_element(maxWeights.begin(), maxWeights.end());
+			fill(maxWeights.begin(), maxWeights.end(), maxWeight);
+		}
+
+		quantized.weights.resize(quantized.size * quantized.numInputs);
+		quantized.biases.resize(quantized.size);
+		quantized.scales.resize(quantized.size);
+		for (size_t j = 0; j < quantized.size; ++j) {
+			Real const* row = weights[l].data() + j * numInputs;
+			double const weightScale = Scale(maxWeights[j]);
+			for (size_t i = 0; i < quantized.numInputs; ++i) {
+				double const q = round(static_cast<double>(row[i]) / weightScale);
+				quantized.weights[j * quantized.numInputs + i] =
+					static_cast<int8_t>(max(-cMaxQuantized, min(cMaxQuantized, q)));
+			}
+			double const sumScale = inputScale * weightScale;
+			double const bias = round(static_cast<double>(row[quantized.numInputs]) / sumScale);
+			quantized.biases[j] = static_cast<int32_t>(max(-cMaxBias, min(cMaxBias, bias)));
+			quantized.scales[j] = static_cast<Real>(sumScale);
+		}
+		mLayers.push_back(move(quantized));
+	}
+}
+
+template<typename Real>
+LayerSizes const& QuantizedNeuralNet<Real>::getLayerSizes() const
+{
+	return mLayerSizes;
+}
+
+template<typename Real>
+quantization::Granularity QuantizedNeuralNet<Real>::getGranularity() const
+{
+	return mGranularity;
+}
+
+template<typename Real>
+size_t QuantizedNeuralNet<Real>::getModelSize() const
+{
+	size_t size = 0;
+	for (QuantizedLayer const& layer : mLayers) {
+		size += layer.weights.size() * sizeof(int8_t) + layer.biases.size() * sizeof(int32_t)
+			+ layer.scales.size() * sizeof(Real) + sizeof(Real);
+	}
+	return size;
+}
+
+template<typename Real>
+void QuantizedNeuralNet<Real>::Predict(Real const* inputs, size_t const count, Real* outputs) const
+{
+	size_t const inputSize = mLayerSizes.front();
+	size_t const outputSize = mLayerSizes.back();
+
+	for (size_t first = 0; first < count; first += cPredictBlock) {
+		size_t const blockCount = (first + cPredictBlock < count) ? cPredictBlock : count - first;
+		PredictBlock(inputs + first * inputSize, blockCount, outputs + first * outputSize);
+	}
+}
+
+template<typename Real>
+void QuantizedNeuralNet<Real>::PredictBlock(Real const* inputs, size_t const count, Real* outputs) const
+{
+	// every thread keeps the quantized inputs and the outputs of the current layer in
+	// scratch buffers that only grow
+	thread_local vector<int8_t> quantizedInputs;
+	thread_local BasicData<Real> layerOutputs;
+	if (quantizedInputs.size() < count * mMaxSize) quantizedInputs.resize(count * mMaxSize);
+	if (layerOutputs.size() < count * mMaxSize) layerOutputs.resize(count * mMaxSize);
+
+	size_t const inputSize = mLayerSizes.front();
+	for (size_t s = 0; s < count; ++s) {
+		Quantize(inputs + s * inputSize, mLayers.front().inputInvScale, quantizedInputs.data() + s * inputSize,
+			inputSize);
+	}
+
+	for (size_t l = 0; l < mLayers.size(); ++l) {
+		NEURO_PROFILE_SCOPE(Predict, l + 1, count);
+		QuantizedLayer const& layer = mLayers[l];
+		size_t const n = layer.numInputs;
+		int8_t const* w = layer.weights.data();
+
+		// four neurons at a time for all samples, so their rows stay in the cache while the
+		// inputs of the block are swept
+		int32_t sums[4];
+		size_t j = 0;
+		for (; j + 4 <= layer.size; j += 4) {
+			for (size_t s = 0; s < count; ++s) {
+				kernels::Dot4Int8(quantizedInputs.data() + s * n, w + j * n, w + (j + 1) * n, w + (j + 2) * n,
+					w + (j + 3) * n, n, sums);
+				Real* row = layerOutputs.data() + s * layer.size;
+				for (size_t k = 0; k < 4; ++k) {
+					row[j + k] = static_cast<Real>(sums[k] + layer.biases[j + k]) * layer.scales[j + k];
+				}
+			}
+		}
+		for (; j < layer.size; ++j) {
+			for (size_t s = 0; s < count; ++s) {
+				int32_t const sum = kernels::DotInt8(quantizedInputs.data() + s * n, w + j * n, n);
+				layerOutputs[s * layer.size + j] = static_cast<Real>(sum + layer.biases[j]) * layer.scales[j];
+			}
+		}
+		for (size_t s = 0; s < count; ++s) {
+			activation::Apply(layer.activation, layerOutputs.data() + s * layer.size, layer.size);
+		}
+
+		// the sums of all samples are done, so the inputs can be overwritten
+		if (l + 1 < mLayers.size()) {
+			for (size_t s = 0; s < count; ++s) {
+				Quantize(layerOutputs.data() + s * layer.size, mLayers[l + 1].inputInvScale,
+					quantizedInputs.data() + s * layer.size, layer.size);
+			}
+		}
+	}
+
+	size_t const outputSize = mLayerSizes.back();
+	for (size_t i = 0; i < count * outputSize; ++i) {
+		outputs[i] = static_cast<Real>(mOutputActivationFunc(layerOutputs[i]));
+	}
+}
+
+template<typename Real>
+void QuantizedNeuralNet<Real>::Quantize(Real const* values, Real const invScale, int8_t* quantized, size_t const n)
+{
+	Real const limit = static_cast<Real>(cMaxQuantized);
+	for (size_t i = 0; i < n; ++i) {
+		Real const q = round(values[i] * invScale);
+		quantized[i] = static_cast<int8_t>(max(-limit, min(limit, q)));
+	}
+}
+
+template<typename Real>
+quantization::Report QuantizedNeuralNet<Real>::Compare(BasicNeuralNet<Real> const& net,
+	Dataset<Real> const& dataset) const
+{
+	if (dataset.getInputSize() != mLayerSizes.front() || dataset.getOutputSize() != mLayerSizes.back() ||
+		net.getLayerSizes() != mLayerSizes) {
+		throw string("The net and the dataset must match the topology of the quantized net");
+	}
+	if (dataset.getCount() == 0) throw string("The dataset must not be empty");
+
+	size_t const outputSize = mLayerSizes.back();
+	BasicData<Real> reference(cPredictBlock * outputSize), quantized(cPredictBlock * outputSize);
+	double maxDelta = 0.0, sqrDelta = 0.0, sqrReference = 0.0, sqrQuantized = 0.0;
+
+	for (size_t first = 0; first < dataset.getCount(); first += cPredictBlock) {
+		size_t const count = min(cPredictBlock, dataset.getCount() - first);
+		net.Predict(dataset.getInputs(first), count, reference.data());
+		Predict(dataset.getInputs(first), count, quantized.data());
+		Real const* targets = dataset.getTargets(first);
+		for (size_t i = 0; i < count * outputSize; ++i) {
+			double const delta = static_cast<double>(quantized[i]) - static_cast<double>(reference[i]);
+			double const referenceDelta = static_cast<double>(targets[i]) - static_cast<double>(reference[i]);
+			double const quantizedDelta = static_cast<double>(targets[i]) - static_cast<double>(quantized[i]);
+			maxDelta = max(maxDelta, fabs(delta));
+			sqrDelta += delta * delta;
+			sqrReference += referenceDelta * referenceDelta;
+			sqrQuantized += quantizedDelta * quantizedDelta;
+		}
+	}
+
+	double const values = static_cast<double>(dataset.getCount() * outputSize);
+	quantization::Report report;
+	report.maxDelta = maxDelta;
+	report.rmsDelta = sqrt(sqrDelta / values);
+	report.referenceError = sqrt(sqrReference / values);
+	report.quantizedError = sqrt(sqrQuantized / values);
+	return report;
+}
+
+template class QuantizedNeuralNet<double>;
+template class QuantizedNeuralNet<float>;
@@ -0,0 +1,121 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    QuantizedNeuralNet.h
+// Date:        2026/10/16
+// Description: Post-training quantization to 8 bit weights. A trained net is converted with
+//              symmetric scales, zero is always exactly representable:
+//
+//              weights     w = s_w * q_w, q_w in [-127, 127], s_w = max|w| / 127 of the
+//                          layer or of every neuron (output channel)
+//              inputs      x = s_x * q_x, q_x in [-127, 127], s_x = max|x| / 127 of the
+//                          layer inputs over a calibration set
+//              biases      b = s_x * s_w * q_b, q_b in 32 bit
+//
+//              A neuron sums up q_x * q_w in 32 bit with the int8 kernels (see Kernels.h),
+//              adds q_b and multiplies the sum once with s_x * s_w. The activation is
+//              applied in the number type of the net and the outputs are quantized again
+//              with the scale of the next layer. Inputs beyond the calibrated range
+//              saturate at -127 or 127, so the calibration set should cover the inputs the
+//              model will see.
+//
+//              Per-channel scales cost one multiplication per neuron like per-layer scales,
+//              but keep small rows next to large ones accurate, so they are the default.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _QUANTIZEDNET
+#define _QUANTIZEDNET
+
+#include <vector>
+#include <cstdint>
+#include "Object.h"
+#include "NeuralNet.h"
+#include "Dataset.h"
+
+namespace quantization {
+	//-------------------------------------------------------------------------------------
+	///Which weights share a scale
+	enum class Granularity { PerLayer, PerChannel };
+
+	//-------------------------------------------------------------------------------------
+	///Accuracy of a quantized net compared to the net it was made from
+	struct Report {
+		// largest and RMS difference of the outputs of both nets
+		double maxDelta;
+		double rmsDelta;
+		// RMS error of both nets on the targets
+		double referenceError;
+		double quantizedError;
+	};
+}
+
+//###########################################################################################
+///This class runs the inference of a trained net with 8 bit weights and 32 bit sums. The
+///weights are copied and quantized by the constructor, later changes of the net don't
+///affect it. Pruned layers are quantized as dense matrices with zeros. The net can't be
+///trained. The template is instantiated for double and float in QuantizedNeuralNet.cpp.
+template<typename Real>
+class QuantizedNeuralNet: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, quantizes a net. The scales of the layer inputs are the
+	///largest values of a forward pass over the calibration samples.
+	///Params: [net] The trained net, [calibration] Row-major inputs [count x input size],
+	///[count] Number of calibration samples, [outputActivation] Output activation like in
+	///BasicNeuralNet, [granularity] Scales per layer or per neuron
+	QuantizedNeuralNet(BasicNeuralNet<Real> const& net, Real const* calibration, size_t const count,
+		ActivationFunc outputActivation,
+		quantization::Granularity const granularity = quantization::Granularity::PerChannel);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the sizes of the layers WITHOUT bias neurons
+	LayerSizes const& getLayerSizes() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the scale granularity of the weights
+	quantization::Granularity getGranularity() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the bytes of the model: the quantized weights, the biases and the
+	///scales, without the scratch buffers
+	size_t getModelSize() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a batch like BasicNeuralNet::Predict. May be called from
+	///several threads at the same time.
+	///Params: [inputs] Row-major inputs [count x input size], [count] Number of samples,
+	///[outputs] Receives the row-major results [count x output size]
+	void Predict(Real const* inputs, size_t const count, Real* outputs) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Compare the outputs with the ones of a net on all samples of a dataset
+	///Params: [net] The net this one was quantized from, [dataset] The samples, its
+	///targets give the errors of both nets
+	///Return: The accuracy report
+	quantization::Report Compare(BasicNeuralNet<Real> const& net, Dataset<Real> const& dataset) const;
+
+private:
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a block of samples with the scratch buffers of the thread
+	void PredictBlock(Real const* inputs, size_t const count, Real* outputs) const;
+	//-------------------------------------------------------------------------------------
+	///Description: Quantize a row of values with the scale of a layer input
+	///Params: [values] The values, [invScale] 1 / s_x, [quantized] Receives q_x, [n] Length
+	static void Quantize(Real const* values, Real const invScale, int8_t* quantized, size_t const n);
+
+	struct QuantizedLayer {
+		size_t size;
+		// length of a weight row WITHOUT bias weight, the bias is added as q_b
+		size_t numInputs;
+		Activation activation;
+		// 1 / s_x of the inputs
+		Real inputInvScale;
+		// row-major q_w [size x numInputs]
+		std::vector<int8_t> weights;
+		// q_b and s_x * s_w of every neuron
+		std::vector<int32_t> biases;
+		std::vector<Real> scales;
+	};
+
+	LayerSizes mLayerSizes;
+	std::vector<QuantizedLayer> mLayers;
+	size_t mMaxSize = 0;
+	quantization::Granularity mGranularity;
+	const ActivationFunc mOutputActivationFunc;
+};
+#endif //_QUANTIZEDNET
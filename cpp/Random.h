@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Random.h
+// Date:        2026/10/16
+// Description: Counter-based random numbers (Philox4x32-10 of Salmon et al., "Parallel
+//              random numbers: as easy as 1, 2, 3", 2011). A generator has no state besides
+//              its key: every number is a function of the key and a counter, so any number
+//              of a sequence can be drawn directly, in any order and on any thread. Two
+//              generators with the same seed give the same numbers for the same counters.
+//
+//              The numbers are calculated with 32 bit integer operations only, so they are
+//              the same on all platforms and compilers. Uniform and Normal convert them with
+//              correctly rounded double operations and the functions of <cmath>.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _RANDOM
+#define _RANDOM
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+//###########################################################################################
+///This class is the Philox4x32-10 generator: ten rounds of multiplications and xors turn a
+///128 bit counter and a 64 bit key (the seed) into 128 random bits. It passes BigCrush for
+///any sequence of counters, so counters that are built from indices (e.g. layer, neuron
+///and connection of a weight) give independent numbers.
+class Philox
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Four 32 bit words, used as counter and as result
+	typedef std::array<uint32_t, 4> Block;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor
+	///Params: [seed] The key of the generator
+	explicit Philox(uint64_t const seed)
+		: mKey{ { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) } } {}
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the 128 random bits of a counter
+	Block operator()(Block counter) const {
+		uint32_t key0 = mKey[0], key1 = mKey[1];
+		for (int round = 0; round < 10; ++round) {
+			uint64_t const product0 = uint64_t(cMultiplier0) * counter[0];
+			uint64_t const product1 = uint64_t(cMultiplier1) * counter[2];
+			counter = { { static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key0, static_cast<uint32_t>(product1),
+				static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key1, static_cast<uint32_t>(product0) } };
+			key0 += cWeyl0;
+			key1 += cWeyl1;
+		}
+		return counter;
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Get a uniform number in [0, 1) with 53 random bits
+	double Uniform(Block const& counter) const {
+		Block const bits = (*this)(counter);
+		return ToUniform(bits[0], bits[1]);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Get a normal distributed number (mean 0, standard deviation 1), the
+	///Box-Muller transform of both halves of the random bits
+	double Normal(Block const& counter) const {
+		Block const bits = (*this)(counter);
+		// 1 - u is in (0, 1], so the logarithm is finite
+		double const radius = std::sqrt(-2.0 * std::log(1.0 - ToUniform(bits[0], bits[1])));
+		return radius * std::cos(2.0 * cPi * ToUniform(bits[2], bits[3]));
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Get the seed the generator was created with
+	uint64_t getSeed() const {
+		return (uint64_t(mKey[1]) << 32) | mKey[0];
+	}
+
+private:
+	static uint32_t const cMultiplier0 = 0xD2511F53;
+	static uint32_t const cMultiplier1 = 0xCD9E8D57;
+	static uint32_t const cWeyl0 = 0x9E3779B9;
+	static uint32_t const cWeyl1 = 0xBB67AE85;
+	static constexpr double cPi = 3.14159265358979323846;
+
+	//-------------------------------------------------------------------------------------
+	///Description: The upper 53 of 64 bits as a number in [0, 1)
+	static double ToUniform(uint32_t const low, uint32_t const high) {
+		uint64_t const bits = (uint64_t(high) << 32) | low;
+		return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	std::array<uint32_t, 2> mKey;
+};
+#endif //_RANDOM
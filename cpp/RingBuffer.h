@@ -0,0 +1,88 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    RingBuffer.h
+// Date:        2026/10/16
+// Description: Lock-free ring buffer for one producer and one consumer thread
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _RINGBUFFER
+#define _RINGBUFFER
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include "Object.h"
+
+//###########################################################################################
+///This class passes values from one producer thread to one consumer thread without locks
+///and without system calls. Both sides only read the index of the other side when their
+///cached copy says the buffer is full (or empty), so in the common case a push or pop
+///touches no cache line that the other thread writes. The indices are kept on separate
+///cache lines for the same reason. [T] should be cheap to copy, the buffer holds copies.
+template<typename T>
+class RingBuffer: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, allocates the buffer
+	///Params: [capacity] Number of values, rounded up to a power of two
+	explicit RingBuffer(size_t const capacity) {
+		size_t size = 2;
+		while (size < capacity) size *= 2;
+		mValues.resize(size);
+		mMask = size - 1;
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: Append a value, may only be called by the producer thread. Never waits.
+	///Return: false if the buffer is full, the value is not stored then
+	bool TryPush(T const& value) {
+		size_t const head = mHead.load(std::memory_order_relaxed);
+		if (head - mCachedTail == mValues.size()) {
+			mCachedTail = mTail.load(std::memory_order_acquire);
+			if (head - mCachedTail == mValues.size()) return false;
+		}
+		mValues[head & mMask] = value;
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: Remove the oldest value, may only be called by the consumer thread
+	///Params: [value] Receives the value
+	///Return: false if the buffer is empty
+	bool TryPop(T& value) {
+		size_t const tail = mTail.load(std::memory_order_relaxed);
+		if (tail == mCachedHead) {
+			mCachedHead = mHead.load(std::memory_order_acquire);
+			if (tail == mCachedHead) return false;
+		}
+		value = mValues[tail & mMask];
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of values the buffer can hold
+	size_t getCapacity() const {
+		return mValues.size();
+	}
+
+private:
+	RingBuffer(RingBuffer const&) = delete;
+	RingBuffer& operator=(RingBuffer const&) = delete;
+
+	static size_t const cCacheLine = 64;
+
+	std::vector<T> mValues;
+	size_t mMask = 0;
+	char mPad0[cCacheLine];
+	// written by the producer: next index to write and the last tail it has seen
+	std::atomic<size_t> mHead{ 0 };
+	size_t mCachedTail = 0;
+	char mPad1[cCacheLine];
+	// written by the consumer: next index to read and the last head it has seen
+	std::atomic<size_t> mTail{ 0 };
+	size_t mCachedHead = 0;
+	char mPad2[cCacheLine];
+};
+#endif //_RINGBUFFER
@@ -0,0 +1,274 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Server.cpp
+// Date:        2026/10/16
+// Description: Inference server. Loads a model saved with BasicNeuralNet::Save, listens on
+//              a Unix domain socket or loopback TCP and answers scoring requests (protocol
+//              in Serving.h). The requests of all connections are coalesced into batches
+//              by a Batcher, the throughput and the p50/p99 latencies are reported
+//              periodically and when the server stops (Ctrl+C). LoadGen.cpp is the
+//              matching load generator.
+//
+//              Usage: server --model FILE [options], see PrintUsage
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <list>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include "MappedNeuralNet.h"
+#include "MappedFile.h"
+#include "ModelFile.h"
+#include "Serving.h"
+#include "Socket.h"
+#include "Manipulators.h"
+
+using namespace std;
+using namespace ownmanips;
+
+namespace {
+	// time the accept loop waits before it checks for a stop or a report
+	int const cAcceptTimeoutMs = 200;
+
+	struct Options {
+		string modelFile;
+		sockets::Endpoint endpoint = sockets::Parse("tcp:5555");
+		serving::Options serving = { 64, chrono::microseconds(200) };
+		size_t maxRequestSamples = 1024;
+		double reportSeconds = 5.0;
+	};
+
+	atomic<bool> gStop(false);
+
+	void Stop(int)
+	{
+		gStop = true;
+	}
+
+	// the results of the last layer are served as they are
+	double Identity(double const x)
+	{
+		return x;
+	}
+
+	double ParseNumber(string const& text)
+	{
+		char* end = nullptr;
+		double const value = strtod(text.c_str(), &end);
+		if (text.empty() || *end != '\0') throw string("Invalid number " + text);
+		return value;
+	}
+
+	void PrintUsage()
+	{
+		cout << "Usage: server --model FILE [options]" << endl
+			<< "  --model FILE         model saved with BasicNeuralNet::Save (double or float)" << endl
+			<< "  --listen ENDPOINT    unix:PATH or tcp:PORT on 127.0.0.1 (default tcp:5555)" << endl
+			<< "  --max-batch N        samples of a batch at most (default 64)" << endl
+			<< "  --max-delay US       microseconds a request waits for a batch at most (default 200)" << endl
+			<< "  --max-request N      samples of a request at most (default 1024)" << endl
+			<< "  --report SECONDS     seconds between two reports, 0 = only when stopped (default 5)" << endl;
+	}
+
+	Options ParseOptions(int const argc, char const* const argv[])
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i) {
+			string const option = argv[i];
+			auto value = [&]() -> string {
+				if (i + 1 >= argc) throw string("Missing value of " + option);
+				return argv[++i];
+			};
+			auto count = [&]() -> size_t {
+				double const number = ParseNumber(value());
+				if (number < 1) throw string(option + " must be at least 1");
+				return static_cast<size_t>(number);
+			};
+
+			if (option == "--model") options.modelFile = value();
+			else if (option == "--listen") options.endpoint = sockets::Parse(value());
+			else if (option == "--max-batch") options.serving.maxBatchSize = count();
+			else if (option == "--max-delay") {
+				double const delay = ParseNumber(value());
+				if (delay < 0) throw string("--max-delay must not be negative");
+				options.serving.maxDelay = chrono::microseconds(static_cast<long long>(delay));
+			}
+			else if (option == "--max-request") options.maxRequestSamples = count();
+			else if (option == "--report") {
+				options.reportSeconds = ParseNumber(value());
+				if (options.reportSeconds < 0) throw string("--report must not be negative");
+			}
+			else throw string("Unknown option " + option);
+		}
+
+		if (options.modelFile.empty()) throw string("--model is needed");
+		if (options.maxRequestSamples > UINT32_MAX) throw string("--max-request is too large");
+		return options;
+	}
+
+	// number type of a model file, read from its header
+	model::Scalar PeekScalar(string const& fileName)
+	{
+		MappedFile const file(fileName);
+		if (file.getSize() < sizeof(model::Header)) throw string("Model file is too short");
+		model::Header header;
+		memcpy(&header, file.getData(), sizeof(header));
+		if (header.scalar != model::Scalar::Double && header.scalar != model::Scalar::Float) {
+			throw string("Model file has an unknown number type");
+		}
+		return header.scalar;
+	}
+
+	void PrintReport(serving::Statistics const& statistics)
+	{
+		if (statistics.requests == 0) {
+			cout << fixed << setprecision(1) << setw(6) << statistics.seconds << " s  no requests" << endl;
+			return;
+		}
+		cout << fixed << setprecision(1) << setw(6) << statistics.seconds << " s  "
+			<< setprecision(0) << statistics.requests / statistics.seconds << " requests/s, "
+			<< statistics.samples / statistics.seconds << " samples/s, batch "
+			<< setprecision(1) << static_cast<double>(statistics.samples) / statistics.batches
+			<< setprecision(0) << ", queueing p50 " << statistics.queueing.p50 << " us p99 " << statistics.queueing.p99
+			<< " us, latency p50 " << statistics.latency.p50 << " us p99 " << statistics.latency.p99
+			<< " us max " << statistics.latency.max << " us" << endl;
+	}
+
+	// a client connection and the thread that serves it
+	struct Connection {
+		Socket socket;
+		thread worker;
+		atomic<bool> finished;
+
+		explicit Connection(Socket&& connected)
+			: socket(move(connected)), finished(false) {}
+		// a connection that is still served is shut down, its thread returns
+		~Connection() {
+			socket.ShutDown();
+			if (worker.joinable()) worker.join();
+		}
+	};
+
+	template<typename Real>
+	void Serve(Socket& socket, Batcher<Real>& batcher, serving::Hello const& hello)
+	{
+		socket.Send(&hello, sizeof(hello));
+
+		vector<Real> inputs;
+		// header and outputs are sent with one call, the outputs start 8 bytes into the
+		// buffer, which is aligned for any Real
+		vector<unsigned char> response;
+		serving::RequestHeader request;
+		while (socket.Receive(&request, sizeof(request))) {
+			serving::ResponseHeader header = { serving::Status::Ok, request.count };
+			if (request.count == 0 || request.count > hello.maxRequestSamples) {
+				header.status = serving::Status::Invalid;
+				socket.Send(&header, sizeof(header));
+				return;
+			}
+
+			inputs.resize(request.count * hello.inputSize);
+			if (!socket.Receive(inputs.data(), inputs.size() * sizeof(Real))) {
+				throw string("The connection was closed within a request");
+			}
+			response.resize(sizeof(header) + request.count * hello.outputSize * sizeof(Real));
+			memcpy(response.data(), &header, sizeof(header));
+			batcher.Predict(inputs.data(), request.count, reinterpret_cast<Real*>(response.data() + sizeof(header)));
+			socket.Send(response.data(), response.size());
+		}
+	}
+
+	template<typename Real>
+	void Run(Options const& options)
+	{
+		MappedNeuralNet<Real> const net(options.modelFile, Identity);
+		Batcher<Real> batcher(net, options.serving);
+
+		serving::Hello hello;
+		memcpy(hello.magic, serving::cMagic, sizeof(hello.magic));
+		hello.version = serving::cVersion;
+		hello.scalar = model::ScalarOf<Real>::value;
+		hello.inputSize = static_cast<uint32_t>(net.getLayerSizes().front());
+		hello.outputSize = static_cast<uint32_t>(net.getLayerSizes().back());
+		hello.maxRequestSamples = static_cast<uint32_t>(options.maxRequestSamples);
+
+		Listener listener(options.endpoint);
+		PrintHeader("Server");
+		cout << options.modelFile << " (" << ((hello.scalar == model::Scalar::Double) ? "double" : "float") << ", "
+			<< hello.inputSize << " inputs, " << hello.outputSize << " outputs) at " << sockets::Name(options.endpoint)
+			<< ", batches of " << options.serving.maxBatchSize << " samples, max delay "
+			<< options.serving.maxDelay.count() << " us" << endl << endl;
+
+		list<unique_ptr<Connection>> connections;
+		auto const reportInterval = chrono::duration<double>(options.reportSeconds);
+		auto lastReport = chrono::steady_clock::now();
+		while (!gStop) {
+			Socket socket = listener.Accept(cAcceptTimeoutMs);
+			if (socket.isValid()) {
+				connections.emplace_back(new Connection(move(socket)));
+				Connection& connection = *connections.back();
+				// an error only ends its own connection, e.g. a request too large to allocate
+				connection.worker = thread([&connection, &batcher, &hello]() {
+					try {
+						Serve(connection.socket, batcher, hello);
+					}
+					catch (string const& error) {
+						if (!gStop) PrintError("Server", error);
+					}
+					catch (exception const& error) {
+						if (!gStop) PrintError("Server", error.what());
+					}
+					connection.socket.ShutDown();
+					connection.finished = true;
+				});
+			}
+			connections.remove_if([](unique_ptr<Connection> const& connection) { return connection->finished.load(); });
+
+			auto const now = chrono::steady_clock::now();
+			if (options.reportSeconds > 0 && now - lastReport >= reportInterval) {
+				PrintReport(batcher.TakeStatistics());
+				lastReport = now;
+			}
+		}
+
+		// the open connections are shut down before the batcher stops
+		connections.clear();
+		cout << endl << "Stopped" << endl;
+		PrintReport(batcher.TakeStatistics());
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	try {
+		options = ParseOptions(argc, argv);
+	}
+	catch (string const& error) {
+		PrintError("Server", error);
+		PrintUsage();
+		return 1;
+	}
+
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+#ifdef SIGPIPE
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	try {
+		if (PeekScalar(options.modelFile) == model::Scalar::Double) Run<double>(options);
+		else Run<float>(options);
+	}
+	catch (string const& error) {
+		PrintError("Server", error);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,202 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Serving.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include "Serving.h"
+#include "Random.h"
+
+using namespace std;
+
+namespace {
+	double Microseconds(chrono::steady_clock::duration const duration)
+	{
+		return chrono::duration<double, micro>(duration).count();
+	}
+
+	double Percentile(vector<double>& values, double const p)
+	{
+		size_t const rank = static_cast<size_t>(ceil(p * (values.size() - 1)));
+		nth_element(values.begin(), values.begin() + rank, values.end());
+		return values[rank];
+	}
+}
+
+serving::Summary serving::Summarize(vector<double>& latencies)
+{
+	Summary summary = { latencies.size(), 0.0, 0.0, 0.0, 0.0 };
+	if (latencies.empty()) return summary;
+
+	double sum = 0.0;
+	for (double const latency : latencies) {
+		sum += latency;
+	}
+	summary.mean = sum / latencies.size();
+	summary.p50 = Percentile(latencies, 0.5);
+	summary.p99 = Percentile(latencies, 0.99);
+	summary.max = *max_element(latencies.begin(), latencies.end());
+	return summary;
+}
+
+void LatencyReservoir::Add(double const latency)
+{
+	// the n-th latency replaces a random one of the sample with the probability
+	// cCapacity / n, so every latency is in the sample with the same probability
+	if (mSample.size() < cCapacity) mSample.push_back(latency);
+	else {
+		Philox const generator(0);
+		Philox::Block const counter = { { static_cast<uint32_t>(mCount), static_cast<uint32_t>(uint64_t(mCount) >> 32), 0, 0 } };
+		Philox::Block const bits = generator(counter);
+		uint64_t const index = ((uint64_t(bits[1]) << 32) | bits[0]) % (mCount + 1);
+		if (index < cCapacity) mSample[index] = latency;
+	}
+	++mCount;
+	mSum += latency;
+	mMax = max(mMax, latency);
+}
+
+serving::Summary LatencyReservoir::Summarize()
+{
+	serving::Summary summary = serving::Summarize(mSample);
+	if (mCount == 0) return summary;
+	summary.count = mCount;
+	summary.mean = mSum / mCount;
+	summary.max = mMax;
+	return summary;
+}
+
+void LatencyReservoir::Swap(LatencyReservoir& other)
+{
+	mSample.swap(other.mSample);
+	swap(mCount, other.mCount);
+	swap(mSum, other.mSum);
+	swap(mMax, other.mMax);
+}
+
+template<typename Real>
+Batcher<Real>::Batcher(MappedNeuralNet<Real> const& net, serving::Options const& options)
+	: mNet(net), mOptions(options), mInputSize(net.getLayerSizes().front()), mOutputSize(net.getLayerSizes().back()),
+	mInputs(options.maxBatchSize * mInputSize), mOutputs(options.maxBatchSize * mOutputSize),
+	mStatisticsStart(Clock::now()), mThread(&Batcher::Loop, this)
+{
+}
+
+template<typename Real>
+Batcher<Real>::~Batcher()
+{
+	{
+		lock_guard<mutex> lock(mMutex);
+		mStop = true;
+	}
+	mArrived.notify_all();
+	mThread.join();
+}
+
+template<typename Real>
+void Batcher<Real>::Predict(Real const* inputs, size_t const count, Real* outputs)
+{
+	if (count == 0) return;
+
+	// the request lives on the stack of the calling thread until the worker is done with it
+	Request request = { inputs, outputs, count, Clock::now(), false };
+	unique_lock<mutex> lock(mMutex);
+	mQueue.push_back(&request);
+	mQueuedSamples += count;
+	mArrived.notify_one();
+	mFinished.wait(lock, [&request]() { return request.done; });
+}
+
+template<typename Real>
+serving::Statistics Batcher<Real>::TakeStatistics()
+{
+	serving::Statistics statistics;
+	LatencyReservoir queueing, latencies;
+	{
+		lock_guard<mutex> lock(mMutex);
+		Clock::time_point const now = Clock::now();
+		statistics.seconds = chrono::duration<double>(now - mStatisticsStart).count();
+		statistics.requests = mRequests;
+		statistics.samples = mSamples;
+		statistics.batches = mBatches;
+		queueing.Swap(mQueueing);
+		latencies.Swap(mLatencies);
+		mStatisticsStart = now;
+		mRequests = mSamples = mBatches = 0;
+	}
+
+	// sorted outside the lock, the worker goes on meanwhile
+	statistics.queueing = queueing.Summarize();
+	statistics.latency = latencies.Summarize();
+	return statistics;
+}
+
+template<typename Real>
+void Batcher<Real>::Loop()
+{
+	vector<Request*> batch;
+	unique_lock<mutex> lock(mMutex);
+	while (true) {
+		mArrived.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+		if (mQueue.empty()) return;
+
+		// the oldest request waits for a full batch at most until its deadline, the
+		// remaining requests are finished without delay when the batcher stops
+		Clock::time_point const deadline = mQueue.front()->arrival + mOptions.maxDelay;
+		mArrived.wait_until(lock, deadline, [this]() { return mStop || mQueuedSamples >= mOptions.maxBatchSize; });
+
+		// requests in the order they arrived while they fit, at least one
+		batch.clear();
+		size_t samples = 0;
+		while (!mQueue.empty() && (batch.empty() || samples + mQueue.front()->count <= mOptions.maxBatchSize)) {
+			batch.push_back(mQueue.front());
+			samples += mQueue.front()->count;
+			mQueue.pop_front();
+		}
+		mQueuedSamples -= samples;
+
+		Clock::time_point const start = Clock::now();
+		lock.unlock();
+		Run(batch, samples);
+		Clock::time_point const end = Clock::now();
+		lock.lock();
+
+		for (Request* request : batch) {
+			mQueueing.Add(Microseconds(start - request->arrival));
+			mLatencies.Add(Microseconds(end - request->arrival));
+			request->done = true;
+		}
+		mRequests += batch.size();
+		mSamples += samples;
+		++mBatches;
+		mFinished.notify_all();
+	}
+}
+
+template<typename Real>
+void Batcher<Real>::Run(vector<Request*> const& batch, size_t const samples)
+{
+	// a single request is predicted in place
+	if (batch.size() == 1) {
+		mNet.Predict(batch.front()->inputs, samples, batch.front()->outputs);
+		return;
+	}
+
+	size_t offset = 0;
+	for (Request const* request : batch) {
+		copy(request->inputs, request->inputs + request->count * mInputSize, mInputs.data() + offset * mInputSize);
+		offset += request->count;
+	}
+	mNet.Predict(mInputs.data(), samples, mOutputs.data());
+	offset = 0;
+	for (Request* request : batch) {
+		Real const* outputs = mOutputs.data() + offset * mOutputSize;
+		copy(outputs, outputs + request->count * mOutputSize, request->outputs);
+		offset += request->count;
+	}
+}
+
+template class Batcher<double>;
+template class Batcher<float>;
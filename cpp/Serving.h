@@ -0,0 +1,222 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Serving.h
+// Date:        2026/10/16
+// Description: Inference server with dynamic batching (see Server.cpp for the executable
+//              and LoadGen.cpp for its load generator). Every connection sends requests of
+//              one or more samples and waits for their results. A Batcher coalesces the
+//              requests of all connections: the first request of a batch waits at most
+//              Options::maxDelay for others to join, a full batch of Options::maxBatchSize
+//              samples starts at once. The batch runs through one batched forward pass
+//              (MappedNeuralNet::Predict), so under load the requests share the matrix
+//              products instead of running one by one, and a lone request only pays the
+//              delay.
+//
+//              Protocol, all numbers in the byte order of the machine (the server is
+//              local):
+//
+//              server  Hello                           after the connection is accepted
+//              client  RequestHeader, count x input size values
+//              server  ResponseHeader, count x output size values
+//
+//              The values are in the number type of the model (Hello::scalar). A request
+//              with 0 or more than Hello::maxRequestSamples samples is answered with
+//              Status::Invalid and the connection is closed.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _SERVING
+#define _SERVING
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include "Object.h"
+#include "MappedNeuralNet.h"
+#include "ModelFile.h"
+
+namespace serving {
+	char const cMagic[4] = { 'N', 'N', 'S', 'V' };
+	// increase for every change of the protocol
+	uint32_t const cVersion = 1;
+
+	//-------------------------------------------------------------------------------------
+	///First message of the server on a new connection
+	struct Hello {
+		char magic[4];
+		uint32_t version;
+		model::Scalar scalar;
+		uint32_t inputSize;
+		uint32_t outputSize;
+		uint32_t maxRequestSamples;
+	};
+	static_assert(sizeof(Hello) == 24, "The hello must not contain padding");
+
+	//-------------------------------------------------------------------------------------
+	///Header of a request, followed by the inputs
+	struct RequestHeader {
+		uint32_t count;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Result of a request
+	enum class Status : uint32_t { Ok = 0, Invalid = 1 };
+
+	//-------------------------------------------------------------------------------------
+	///Header of a response, followed by the outputs if the status is Ok
+	struct ResponseHeader {
+		Status status;
+		uint32_t count;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Distribution of latencies in microseconds
+	struct Summary {
+		size_t count;
+		double mean;
+		double p50;
+		double p99;
+		double max;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Summarize latencies, the percentiles are the values at the rank
+	///p * (count - 1) rounded to the next integer (nearest-rank)
+	///Params: [latencies] Latencies in microseconds, they are reordered
+	///Return: The summary, all zero if there are no latencies
+	Summary Summarize(std::vector<double>& latencies);
+
+	//-------------------------------------------------------------------------------------
+	///How a Batcher forms batches
+	struct Options {
+		// samples of a batch at most, a larger request is run on its own
+		size_t maxBatchSize;
+		// time the first request of a batch waits for others at most
+		std::chrono::microseconds maxDelay;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Statistics of a Batcher since the previous call of TakeStatistics, the percentiles
+	///are estimated from a sample of the latencies (see LatencyReservoir)
+	struct Statistics {
+		double seconds;
+		size_t requests;
+		size_t samples;
+		size_t batches;
+		// from the arrival of a request to the start of its batch
+		Summary queueing;
+		// from the arrival of a request to its results
+		Summary latency;
+	};
+}
+
+//###########################################################################################
+///This class collects the latencies of any number of requests in bounded memory. Count,
+///mean and maximum are exact, the percentiles are taken from a uniform random sample of
+///at most cCapacity latencies (reservoir sampling, Vitter's algorithm R), which holds all
+///of them as long as there are no more. The sample is drawn with a Philox generator, so
+///the same latencies always give the same summary.
+class LatencyReservoir: public Object
+{
+public:
+	// latencies that are kept at most
+	static size_t const cCapacity = 4096;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Add a latency
+	///Params: [latency] Latency in microseconds
+	void Add(double const latency);
+	//-------------------------------------------------------------------------------------
+	///Description: Summarize the latencies, the sample is reordered
+	///Return: The summary, all zero if there are no latencies
+	serving::Summary Summarize();
+	//-------------------------------------------------------------------------------------
+	///Description: Exchange the latencies with another reservoir
+	void Swap(LatencyReservoir& other);
+
+private:
+	std::vector<double> mSample;
+	size_t mCount = 0;
+	double mSum = 0.0;
+	double mMax = 0.0;
+};
+
+//###########################################################################################
+///This class runs the requests of many threads in batches on one model. The threads block
+///in Predict until their results are there; a worker thread collects the waiting requests,
+///runs them through one Predict of the model and wakes their threads up. The requests
+///of a batch are taken in the order they arrived. The template is instantiated for double
+///and float in Serving.cpp.
+template<typename Real>
+class Batcher: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, starts the worker thread
+	///Params: [net] The model, it must outlive the batcher, [options] How batches are formed
+	Batcher(MappedNeuralNet<Real> const& net, serving::Options const& options);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, finishes the waiting requests and stops the worker
+	~Batcher();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Inference of a request, waits until its batch is done. May be called
+	///from any number of threads at the same time.
+	///Params: [inputs] Row-major inputs [count x input size], [count] Number of samples,
+	///[outputs] Receives the row-major results [count x output size]
+	void Predict(Real const* inputs, size_t const count, Real* outputs);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the statistics since the previous call (or the start) and start
+	///new ones
+	serving::Statistics TakeStatistics();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Request {
+		Real const* inputs;
+		Real* outputs;
+		size_t count;
+		Clock::time_point arrival;
+		bool done;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Main loop of the worker thread
+	void Loop();
+	//-------------------------------------------------------------------------------------
+	///Description: Run the requests of a batch without holding the lock
+	void Run(std::vector<Request*> const& batch, size_t const samples);
+
+	Batcher(Batcher const&) = delete;
+	Batcher& operator=(Batcher const&) = delete;
+
+	MappedNeuralNet<Real> const& mNet;
+	serving::Options const mOptions;
+	size_t const mInputSize;
+	size_t const mOutputSize;
+	// staging matrices of a batch of several requests, only used by the worker
+	BasicData<Real> mInputs;
+	BasicData<Real> mOutputs;
+
+	std::mutex mMutex;
+	std::condition_variable mArrived;
+	std::condition_variable mFinished;
+	std::deque<Request*> mQueue;
+	size_t mQueuedSamples = 0;
+	bool mStop = false;
+
+	// statistics, guarded by the mutex
+	Clock::time_point mStatisticsStart;
+	size_t mRequests = 0;
+	size_t mSamples = 0;
+	size_t mBatches = 0;
+	LatencyReservoir mQueueing;
+	LatencyReservoir mLatencies;
+
+	// started last, when all members are initialized
+	std::thread mThread;
+};
+#endif //_SERVING
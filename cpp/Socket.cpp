@@ -0,0 +1,309 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Socket.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <cstdlib>
+#include <cstring>
+#include "Socket.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+using namespace std;
+
+namespace {
+#ifdef _WIN32
+	typedef SOCKET Native;
+	typedef int Length;
+
+	// Winsock is started once per process and never cleaned up, the sockets may live
+	// until the end of the process
+	void Startup()
+	{
+		static bool const started = []() {
+			WSADATA data;
+			if (WSAStartup(MAKEWORD(2, 2), &data) != 0) throw string("Could not start Winsock");
+			return true;
+		}();
+		(void)started;
+	}
+
+	void CloseNative(Native const handle)
+	{
+		closesocket(handle);
+	}
+
+	bool Interrupted()
+	{
+		return WSAGetLastError() == WSAEINTR;
+	}
+
+	string LastError()
+	{
+		return "error " + to_string(WSAGetLastError());
+	}
+
+	int const cShutdownBoth = SD_BOTH;
+	int const cSendFlags = 0;
+#else
+	typedef int Native;
+	typedef size_t Length;
+
+	void Startup()
+	{
+	}
+
+	void CloseNative(Native const handle)
+	{
+		close(handle);
+	}
+
+	bool Interrupted()
+	{
+		return errno == EINTR;
+	}
+
+	string LastError()
+	{
+		return strerror(errno);
+	}
+
+	int const cShutdownBoth = SHUT_RDWR;
+	// a peer that is gone is reported as an error instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+	int const cSendFlags = MSG_NOSIGNAL;
+#else
+	int const cSendFlags = 0;
+#endif
+#endif
+
+	Native ToNative(intptr_t const handle)
+	{
+		return static_cast<Native>(handle);
+	}
+
+	// a stream socket of the endpoint and its address
+	struct Address {
+		sockaddr_storage storage;
+		socklen_t length;
+	};
+
+	Address MakeAddress(sockets::Endpoint const& endpoint)
+	{
+		Address address;
+		memset(&address, 0, sizeof(address));
+		if (endpoint.kind == sockets::Endpoint::Kind::Tcp) {
+			sockaddr_in* ip = reinterpret_cast<sockaddr_in*>(&address.storage);
+			ip->sin_family = AF_INET;
+			ip->sin_port = htons(endpoint.port);
+			ip->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			address.length = sizeof(sockaddr_in);
+			return address;
+		}
+#ifdef _WIN32
+		throw string("Unix domain sockets are not supported on Windows, use tcp:PORT");
+#else
+		sockaddr_un* local = reinterpret_cast<sockaddr_un*>(&address.storage);
+		if (endpoint.path.size() >= sizeof(local->sun_path)) throw string("The socket path " + endpoint.path + " is too long");
+		local->sun_family = AF_UNIX;
+		strcpy(local->sun_path, endpoint.path.c_str());
+		address.length = sizeof(sockaddr_un);
+		return address;
+#endif
+	}
+
+	Native OpenSocket(sockets::Endpoint const& endpoint)
+	{
+		Startup();
+		int const family = (endpoint.kind == sockets::Endpoint::Kind::Tcp) ? AF_INET : AF_UNIX;
+		Native const handle = socket(family, SOCK_STREAM, 0);
+		if (ToNative(-1) == handle) throw string("Could not create a socket: " + LastError());
+		return handle;
+	}
+
+	void SetNoDelay(Native const handle)
+	{
+		int const enable = 1;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const*>(&enable), sizeof(enable));
+	}
+}
+
+sockets::Endpoint sockets::Parse(string const& text)
+{
+	Endpoint endpoint;
+	endpoint.port = 0;
+	if (text.compare(0, 5, "unix:") == 0 && text.size() > 5) {
+		endpoint.kind = Endpoint::Kind::Unix;
+		endpoint.path = text.substr(5);
+		return endpoint;
+	}
+	if (text.compare(0, 4, "tcp:") == 0) {
+		char* end = nullptr;
+		unsigned long const port = strtoul(text.c_str() + 4, &end, 10);
+		if (text.size() > 4 && *end == '\0' && port > 0 && port <= 65535) {
+			endpoint.kind = Endpoint::Kind::Tcp;
+			endpoint.port = static_cast<uint16_t>(port);
+			return endpoint;
+		}
+	}
+	throw string("Invalid endpoint " + text + ", expected unix:PATH or tcp:PORT");
+}
+
+string sockets::Name(Endpoint const& endpoint)
+{
+	return (endpoint.kind == Endpoint::Kind::Unix) ? "unix:" + endpoint.path : "tcp:" + to_string(endpoint.port);
+}
+
+Socket::Socket(intptr_t const handle)
+	: mHandle(handle)
+{
+}
+
+Socket::Socket(Socket&& other)
+	: mHandle(other.mHandle)
+{
+	other.mHandle = -1;
+}
+
+Socket& Socket::operator=(Socket&& other)
+{
+	if (this != &other) {
+		Close();
+		mHandle = other.mHandle;
+		other.mHandle = -1;
+	}
+	return *this;
+}
+
+Socket::~Socket()
+{
+	Close();
+}
+
+Socket Socket::Connect(sockets::Endpoint const& endpoint)
+{
+	Address const address = MakeAddress(endpoint);
+	Native const handle = OpenSocket(endpoint);
+	if (connect(handle, reinterpret_cast<sockaddr const*>(&address.storage), address.length) != 0) {
+		string const error = LastError();
+		CloseNative(handle);
+		throw string("Could not connect to " + sockets::Name(endpoint) + ": " + error);
+	}
+	if (endpoint.kind == sockets::Endpoint::Kind::Tcp) SetNoDelay(handle);
+	return Socket(static_cast<intptr_t>(handle));
+}
+
+bool Socket::isValid() const
+{
+	return mHandle != -1;
+}
+
+void Socket::Send(void const* data, size_t const size)
+{
+	char const* bytes = static_cast<char const*>(data);
+	size_t sent = 0;
+	while (sent < size) {
+		auto const result = send(ToNative(mHandle), bytes + sent, static_cast<Length>(size - sent), cSendFlags);
+		if (result < 0 && Interrupted()) continue;
+		if (result <= 0) throw string("Could not send: " + LastError());
+		sent += static_cast<size_t>(result);
+	}
+}
+
+bool Socket::Receive(void* data, size_t const size)
+{
+	char* bytes = static_cast<char*>(data);
+	size_t received = 0;
+	while (received < size) {
+		auto const result = recv(ToNative(mHandle), bytes + received, static_cast<Length>(size - received), 0);
+		if (result < 0 && Interrupted()) continue;
+		if (result < 0) throw string("Could not receive: " + LastError());
+		if (result == 0) {
+			if (received == 0) return false;
+			throw string("The connection was closed within a message");
+		}
+		received += static_cast<size_t>(result);
+	}
+	return true;
+}
+
+void Socket::ShutDown()
+{
+	if (isValid()) shutdown(ToNative(mHandle), cShutdownBoth);
+}
+
+void Socket::Close()
+{
+	if (isValid()) CloseNative(ToNative(mHandle));
+	mHandle = -1;
+}
+
+Listener::Listener(sockets::Endpoint const& endpoint)
+	: mEndpoint(endpoint)
+{
+	Address const address = MakeAddress(endpoint);
+#ifndef _WIN32
+	if (endpoint.kind == sockets::Endpoint::Kind::Unix) unlink(endpoint.path.c_str());
+#endif
+	Native const handle = OpenSocket(endpoint);
+	if (endpoint.kind == sockets::Endpoint::Kind::Tcp) {
+		int const enable = 1;
+		setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char const*>(&enable), sizeof(enable));
+	}
+	if (bind(handle, reinterpret_cast<sockaddr const*>(&address.storage), address.length) != 0 ||
+		listen(handle, SOMAXCONN) != 0) {
+		string const error = LastError();
+		CloseNative(handle);
+		throw string("Could not listen at " + sockets::Name(endpoint) + ": " + error);
+	}
+	mHandle = static_cast<intptr_t>(handle);
+}
+
+Listener::~Listener()
+{
+	CloseNative(ToNative(mHandle));
+#ifndef _WIN32
+	if (mEndpoint.kind == sockets::Endpoint::Kind::Unix) unlink(mEndpoint.path.c_str());
+#endif
+}
+
+Socket Listener::Accept(int const timeoutMs)
+{
+	Native const handle = ToNative(mHandle);
+	fd_set ready;
+	FD_ZERO(&ready);
+	FD_SET(handle, &ready);
+	timeval timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+	// a signal counts as a timeout, the caller checks why it was woken up
+	int const result = select(static_cast<int>(handle) + 1, &ready, nullptr, nullptr, &timeout);
+	if (result < 0 && !Interrupted()) throw string("Could not wait for connections: " + LastError());
+	if (result <= 0) return Socket();
+
+	Native const connection = accept(handle, nullptr, nullptr);
+	if (ToNative(-1) == connection) {
+		if (Interrupted()) return Socket();
+		throw string("Could not accept a connection: " + LastError());
+	}
+	if (mEndpoint.kind == sockets::Endpoint::Kind::Tcp) SetNoDelay(connection);
+	return Socket(static_cast<intptr_t>(connection));
+}
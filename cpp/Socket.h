@@ -0,0 +1,118 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Socket.h
+// Date:        2026/10/16
+// Description: Local stream sockets of the inference server and its clients. An endpoint
+//              is written as
+//
+//              unix:PATH   - Unix domain socket at PATH (POSIX systems only)
+//              tcp:PORT    - TCP on the loopback interface 127.0.0.1
+//
+//              Only local connections are supported: the server has no authentication and
+//              trusts its clients. TCP connections have Nagle's algorithm switched off, a
+//              request or response is sent as soon as it is written.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _SOCKET
+#define _SOCKET
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "Object.h"
+
+namespace sockets {
+	//-------------------------------------------------------------------------------------
+	///Address of a local socket
+	struct Endpoint {
+		enum class Kind { Unix, Tcp } kind;
+		std::string path;
+		uint16_t port;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Parse an endpoint, e.g. "tcp:5555" or "unix:/tmp/neuralnet.sock",
+	///throws if it is invalid
+	Endpoint Parse(std::string const& text);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the text of an endpoint, the inverse of Parse
+	std::string Name(Endpoint const& endpoint);
+}
+
+//###########################################################################################
+///This class represents a connected stream socket. It owns the socket and closes it in the
+///destructor, it can be moved but not copied. Send and Receive transfer whole messages:
+///they loop until all bytes are through and throw on errors.
+class Socket: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor of a socket that isn't connected
+	Socket() = default;
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, takes over a connected socket
+	///Params: [handle] The socket of the operating system
+	explicit Socket(intptr_t const handle);
+	//-------------------------------------------------------------------------------------
+	///Description: Move constructor and assignment, the other socket is not connected
+	///afterwards
+	Socket(Socket&& other);
+	Socket& operator=(Socket&& other);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, closes the socket
+	~Socket();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Connect to a server, throws if nobody listens at the endpoint
+	static Socket Connect(sockets::Endpoint const& endpoint);
+	//-------------------------------------------------------------------------------------
+	///Description: Returns true if the socket is connected
+	bool isValid() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Send all bytes of a message
+	void Send(void const* data, size_t const size);
+	//-------------------------------------------------------------------------------------
+	///Description: Receive all bytes of a message
+	///Return: false if the peer closed the connection before the first byte, throws if
+	///it closed it within the message
+	bool Receive(void* data, size_t const size);
+	//-------------------------------------------------------------------------------------
+	///Description: Shut down both directions, a Receive of another thread returns false.
+	///The socket is closed by the destructor.
+	void ShutDown();
+
+private:
+	Socket(Socket const&) = delete;
+	Socket& operator=(Socket const&) = delete;
+
+	void Close();
+
+	// SOCKET on Windows, a file descriptor elsewhere, -1 if not connected
+	intptr_t mHandle = -1;
+};
+
+//###########################################################################################
+///This class represents a listening socket. A Unix domain socket file is removed when the
+///listener is destroyed, an existing one is replaced.
+class Listener: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, binds and listens, throws if the endpoint is in use
+	explicit Listener(sockets::Endpoint const& endpoint);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, closes the socket
+	~Listener();
+	//-------------------------------------------------------------------------------------
+	///Description: Wait for the next connection
+	///Params: [timeoutMs] Milliseconds to wait at most
+	///Return: The connection, a socket that isn't connected if the time ran out
+	Socket Accept(int const timeoutMs);
+
+private:
+	Listener(Listener const&) = delete;
+	Listener& operator=(Listener const&) = delete;
+
+	sockets::Endpoint mEndpoint;
+	intptr_t mHandle = -1;
+};
+#endif //_SOCKET
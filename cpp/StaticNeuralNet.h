@@ -0,0 +1,304 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    StaticNeuralNet.h
+// Date:        2026/10/16
+// Description: Neural net with a topology that is fixed at compile time
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _STATICNET
+#define _STATICNET
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "Object.h"
+#include "Neuron.h"
+#include "NeuralNet.h"
+
+namespace staticnet {
+	//-------------------------------------------------------------------------------------
+	///Description: Calls func(0), func(1), ..., func(N - 1) in this order. The recursion is
+	///resolved at compile time, so the loop is fully unrolled once func is inlined.
+	template<size_t N>
+	struct Unroll {
+		template<typename Func>
+		static void Run(Func const& func) {
+			Unroll<N - 1>::Run(func);
+			func(N - 1);
+		}
+	};
+
+	template<>
+	struct Unroll<0> {
+		template<typename Func>
+		static void Run(Func const&) {}
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Last value of a parameter pack of sizes
+	template<size_t First, size_t... Rest>
+	struct Back {
+		static constexpr size_t value = Back<Rest...>::value;
+	};
+
+	template<size_t First>
+	struct Back<First> {
+		static constexpr size_t value = First;
+	};
+
+	//###########################################################################################
+	///This struct holds one layer of a static net: the outputs (the last one belongs to the
+	///bias neuron and is always 1.0), the gradients and one row of input weights per neuron.
+	///The arithmetic is done in the same order as Layer does it with the scalar kernels.
+	template<size_t Size, size_t NumInputs>
+	struct StaticLayer {
+		typedef std::array<double, NumInputs> Inputs;
+
+		std::array<double, Size + 1> outputs;
+		std::array<double, Size> gradients;
+		std::array<Inputs, Size> weights;
+		std::array<Inputs, Size> deltaWeights;
+
+		//-------------------------------------------------------------------------------------
+		///Description: Draw the random weights in the same order as Layer
+		void Init() {
+			outputs.fill(0.0);
+			outputs[Size] = 1.0;
+			gradients.fill(0.0);
+			for (auto& row : deltaWeights) row.fill(0.0);
+
+			Unroll<NumInputs>::Run([this](size_t i) {
+				Unroll<Size>::Run([this, i](size_t j) {
+					weights[j][i] = Neuron::getRandomWeight();
+				});
+			});
+		}
+		//-------------------------------------------------------------------------------------
+		///Description: Forward propagation from the outputs of the previous layer
+		void ForwardPropagate(Inputs const& prevOutputs) {
+			Unroll<Size>::Run([&](size_t j) {
+				double sum = 0.0;
+				Unroll<NumInputs>::Run([&](size_t i) {
+					sum += prevOutputs[i] * weights[j][i];
+				});
+				outputs[j] = Neuron::activationFunc(sum);
+			});
+		}
+		//-------------------------------------------------------------------------------------
+		///Description: Gradients of an output layer
+		///Return: Sum of the squared output errors
+		double CalcOutputGradients(double const* target) {
+			double sqrError = 0.0;
+			Unroll<Size>::Run([&](size_t j) {
+				double delta = target[j] - outputs[j];
+				sqrError += delta*delta;
+				gradients[j] = delta * Neuron::activationFuncDeriv(outputs[j]);
+			});
+			return sqrError;
+		}
+		//-------------------------------------------------------------------------------------
+		///Description: Gradients of a hidden layer from the gradients of the next layer
+		template<size_t NextSize>
+		void CalcHiddenGradients(StaticLayer<NextSize, Size + 1> const& nextLayer) {
+			gradients.fill(0.0);
+			Unroll<NextSize>::Run([&](size_t k) {
+				Unroll<Size>::Run([&](size_t j) {
+					gradients[j] += nextLayer.weights[k][j] * nextLayer.gradients[k];
+				});
+			});
+			Unroll<Size>::Run([&](size_t j) {
+				gradients[j] = gradients[j] * Neuron::activationFuncDeriv(outputs[j]);
+			});
+		}
+		//-------------------------------------------------------------------------------------
+		///Description: Update the input weights with the current gradients
+		void UpdateInputWeights(Inputs const& prevOutputs, double const eta, double const alpha) {
+			Unroll<Size>::Run([&](size_t j) {
+				Unroll<NumInputs>::Run([&](size_t i) {
+					double newDeltaWeight = eta * prevOutputs[i] * gradients[j] + alpha * deltaWeights[j][i];
+					deltaWeights[j][i] = newDeltaWeight;
+					weights[j][i] += newDeltaWeight;
+				});
+			});
+		}
+	};
+
+	//###########################################################################################
+	///This struct chains the layers after the input layer, every link holds one layer and the
+	///rest of the chain. [PrevSize] is the size of the layer in front of the chain.
+	template<size_t PrevSize, size_t... Sizes>
+	struct StaticLayerChain;
+
+	template<size_t PrevSize>
+	struct StaticLayerChain<PrevSize> {
+		typedef std::array<double, PrevSize + 1> Inputs;
+
+		void Init() {}
+		void ForwardPropagate(Inputs const&) {}
+		void UpdateInputWeights(Inputs const&, double const, double const) {}
+
+		// the layer in front of the end of the chain is the output layer
+		template<typename PrevLayer>
+		double CalcGradients(PrevLayer& prevLayer, double const* target) {
+			return prevLayer.CalcOutputGradients(target);
+		}
+		Inputs const& getOutputs(Inputs const& prevOutputs) const {
+			return prevOutputs;
+		}
+	};
+
+	template<size_t PrevSize, size_t Size, size_t... Rest>
+	struct StaticLayerChain<PrevSize, Size, Rest...> {
+		typedef std::array<double, PrevSize + 1> Inputs;
+
+		StaticLayer<Size, PrevSize + 1> layer;
+		StaticLayerChain<Size, Rest...> next;
+
+		void Init() {
+			layer.Init();
+			next.Init();
+		}
+		void ForwardPropagate(Inputs const& prevOutputs) {
+			layer.ForwardPropagate(prevOutputs);
+			next.ForwardPropagate(layer.outputs);
+		}
+		void UpdateInputWeights(Inputs const& prevOutputs, double const eta, double const alpha) {
+			layer.UpdateInputWeights(prevOutputs, eta, alpha);
+			next.UpdateInputWeights(layer.outputs, eta, alpha);
+		}
+		// the input layer doesn't need gradients
+		double CalcGradients(double const* target) {
+			return next.CalcGradients(layer, target);
+		}
+		// output layer first, then the hidden layers from back to front
+		template<typename PrevLayer>
+		double CalcGradients(PrevLayer& prevLayer, double const* target) {
+			double sqrError = next.CalcGradients(layer, target);
+			prevLayer.CalcHiddenGradients(layer);
+			return sqrError;
+		}
+		std::array<double, Back<Size, Rest...>::value + 1> const& getOutputs(Inputs const&) const {
+			return next.getOutputs(layer.outputs);
+		}
+	};
+}
+
+//###########################################################################################
+///This class represents an adaptive neural network with a topology that is fixed at compile
+///time, e.g. StaticNeuralNet<2, 5, 1>. All buffers are std::arrays inside the object, the
+///loops over neurons and connections are unrolled and there are no size checks, which pays
+///off for small nets where the call overhead of the dynamic NeuralNet dominates the math.
+///The weights are drawn from rand() in the same order and trained with the same activation,
+///error and eta logic, so a static net gives the same results as a NeuralNet of the same
+///topology computing with the scalar kernels. Big topologies are better left to NeuralNet,
+///since the unrolled code grows with the number of connections.
+template<size_t... Sizes>
+class StaticNeuralNet;
+
+template<size_t InputSize, size_t... Sizes>
+class StaticNeuralNet<InputSize, Sizes...>: public Object
+{
+	static_assert(sizeof...(Sizes) >= 1, "A neural net must have at least an input and an output layer...");
+public:
+	static constexpr size_t cInputSize = InputSize;
+	static constexpr size_t cOutputSize = staticnet::Back<InputSize, Sizes...>::value;
+	typedef std::array<double, cInputSize> Input;
+	typedef std::array<double, cOutputSize> Output;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, draws the random weights
+	explicit StaticNeuralNet(ActivationFunc outputActivation)
+		: mOutputActivationFunc(outputActivation)
+	{
+		// pass values to input neurons, the bias neuron is forced to 1.0
+		mInputs.fill(0.0);
+		mInputs[cInputSize] = 1.0;
+		mLayers.Init();
+	}
+
+	//-------------------------------------------------------------------------------------
+	///Description: A forward propagation cycle
+	///Params: [input] Input values, one per input neuron
+	void ForwardPropagate(Input const& input) {
+		ForwardPropagate(input.data());
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: A forward propagation cycle
+	///Params: [input] Input values, one per input neuron
+	void ForwardPropagate(double const* input) {
+		staticnet::Unroll<cInputSize>::Run([&](size_t i) {
+			mInputs[i] = input[i];
+		});
+		mLayers.ForwardPropagate(mInputs);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Backpropagation - adjust the weights of the neurons according to the RMS
+	///Params: [target] Target values, one per output neuron
+	void BackPropagate(Output const& target) {
+		BackPropagate(target.data());
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Backpropagation - adjust the weights of the neurons according to the RMS
+	///Params: [target] Target values, one per output neuron
+	void BackPropagate(double const* target) {
+		double sqrError = mLayers.CalcGradients(target);
+		mLayers.UpdateInputWeights(mInputs, mEta, alpha);
+
+		// overall net error (RMS of output neuron errors)
+		mError = sqrt(sqrError / cOutputSize);
+
+		// recent average measurement
+		mRecentError = (mRecentError * mBeta + mError) / (mBeta + 1.0);
+
+		// update learning rate (eta)
+		double etaUpdate = mRecentError * mEtaUpdate;
+		if (etaUpdate > 0.0) {
+			mEta = etaUpdate;
+		}
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Training cycle - forward- and backpropagation
+	///Params: [input] Input values, [target] Target values
+	void Train(Input const& input, Output const& target) {
+		Train(input.data(), target.data());
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Training cycle - forward- and backpropagation
+	///Params: [input] Input values, [target] Target values
+	void Train(double const* input, double const* target) {
+		ForwardPropagate(input);
+		BackPropagate(target);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Get the results of a forwardpropagation
+	Output getResults() const {
+		Output res;
+		getResults(res.data());
+		return res;
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Get the results of a forwardpropagation
+	///Params: [results] Receives one value per output neuron
+	void getResults(double* results) const {
+		auto const& outputs = mLayers.getOutputs(mInputs);
+		staticnet::Unroll<cOutputSize>::Run([&](size_t i) {
+			results[i] = mOutputActivationFunc(outputs[i]);
+		});
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Get the recent average error
+	double getRecentError() const {
+		return mRecentError;
+	}
+
+private:
+	std::array<double, cInputSize + 1> mInputs;
+	staticnet::StaticLayerChain<InputSize, Sizes...> mLayers;
+	double mEta = 0.15;
+	const double alpha = 0.0;
+	double mError = 0.0;
+	double mRecentError = 0.0;
+	const double mBeta = 0.5;
+	const double mEtaUpdate = 0.55;
+	const ActivationFunc mOutputActivationFunc;
+};
+#endif //_STATICNET
@@ -0,0 +1,294 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Sweep.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "Sweep.h"
+#include "NeuralNet.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+namespace {
+	typedef chrono::steady_clock Clock;
+
+	// number of samples the error on the dataset is calculated with at once
+	size_t const cEvaluateBlock = 256;
+
+	double Identity(double const x) {
+		return x;
+	}
+
+	//###########################################################################################
+	// State of one net of a running sweep, only the task of the net touches it
+	struct Trial {
+		sweep::Result result;
+		unique_ptr<NeuralNet> net;
+	};
+
+	//###########################################################################################
+	// Recent errors of the nets at every round, shared by all tasks
+	class Reports {
+	public:
+		Reports(size_t const rounds, double const quantile, size_t const minReports)
+			: mErrors(rounds), mQuantile(quantile), mMinReports(minReports) {}
+
+		// report the error after a round
+		// returns true if the net should be cancelled
+		bool Report(size_t const round, double const error) {
+			if (!isfinite(error)) return true;
+
+			lock_guard<mutex> lock(mMutex);
+			vector<double>& errors = mErrors[round];
+			errors.push_back(error);
+			if (mQuantile >= 1.0 || errors.size() < mMinReports) return false;
+
+			// the error at the quantile of all nets that got here, including this one
+			vector<double> sorted(errors);
+			size_t const rank = static_cast<size_t>(mQuantile * (sorted.size() - 1));
+			nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+			return error > sorted[rank];
+		}
+
+	private:
+		vector<vector<double>> mErrors;
+		double mQuantile;
+		size_t mMinReports;
+		mutex mMutex;
+	};
+
+	// the weights only depend on the seed, so the nets are built on all threads at once
+	unique_ptr<NeuralNet> CreateNet(sweep::Config const& config)
+	{
+		Activations const activations(config.layerSizes.size() - 1, config.activation);
+		unique_ptr<NeuralNet> net(new NeuralNet(config.layerSizes, activations,
+			initializer::Make(Initializer::Uniform, config.seed), Identity));
+		net->setBeta(config.beta);
+		net->setEtaUpdate(config.etaUpdate);
+		net->setAlpha(config.alpha);
+		return net;
+	}
+
+	// RMS error of a net on all samples of a dataset
+	double Evaluate(NeuralNet const& net, Dataset<double> const& dataset)
+	{
+		size_t const outputSize = dataset.getOutputSize();
+		vector<double> outputs(cEvaluateBlock * outputSize);
+		double sqrError = 0.0;
+
+		for (size_t first = 0; first < dataset.getCount(); first += cEvaluateBlock) {
+			size_t const count = min(cEvaluateBlock, dataset.getCount() - first);
+			net.Predict(dataset.getInputs(first), count, outputs.data());
+			double const* targets = dataset.getTargets(first);
+			for (size_t i = 0; i < count * outputSize; ++i) {
+				double const delta = targets[i] - outputs[i];
+				sqrError += delta * delta;
+			}
+		}
+		return sqrt(sqrError / (dataset.getCount() * outputSize));
+	}
+
+	// better results first: finished nets before cancelled ones, then by the error, an
+	// error that is not a number ranks last
+	bool IsBetter(sweep::Result const& a, sweep::Result const& b)
+	{
+		if (a.cancelled != b.cancelled) return !a.cancelled;
+		if (isnan(a.error) || isnan(b.error)) return !isnan(a.error) && isnan(b.error);
+		return a.error < b.error;
+	}
+}
+
+sweep::Options sweep::DefaultOptions()
+{
+	Options options;
+	options.threads = max(thread::hardware_concurrency(), 1u);
+	options.maxRuns = 10000;
+	options.roundRuns = 500;
+	options.cancelQuantile = 0.5;
+	options.minReports = 4;
+	options.targetError = 0.0;
+	return options;
+}
+
+vector<sweep::Config> sweep::Grid(Space const& space)
+{
+	vector<Config> configs;
+	for (auto& layerSizes : space.layerSizes) {
+		for (auto activation : space.activations) {
+			for (auto beta : space.betas) {
+				for (auto etaUpdate : space.etaUpdates) {
+					for (auto alpha : space.alphas) {
+						for (auto seed : space.seeds) {
+							configs.push_back({ layerSizes, activation, beta, etaUpdate, alpha, seed });
+						}
+					}
+				}
+			}
+		}
+	}
+	return configs;
+}
+
+vector<sweep::Config> sweep::Random(Space const& space, size_t const count, unsigned const seed)
+{
+	if (space.layerSizes.empty() || space.activations.empty() || space.betas.empty() ||
+		space.etaUpdates.empty() || space.alphas.empty()) {
+		throw string("Every hyperparameter of a random search needs at least one value");
+	}
+
+	mt19937 generator(seed);
+	auto pick = [&generator](size_t const size) {
+		return uniform_int_distribution<size_t>(0, size - 1)(generator);
+	};
+	auto draw = [&generator](vector<double> const& values) {
+		auto const range = minmax_element(values.begin(), values.end());
+		return uniform_real_distribution<double>(*range.first, *range.second)(generator);
+	};
+
+	vector<Config> configs;
+	for (size_t i = 0; i < count; ++i) {
+		Config config;
+		config.layerSizes = space.layerSizes[pick(space.layerSizes.size())];
+		config.activation = space.activations[pick(space.activations.size())];
+		config.beta = draw(space.betas);
+		config.etaUpdate = draw(space.etaUpdates);
+		config.alpha = draw(space.alphas);
+		config.seed = static_cast<unsigned>(generator());
+		configs.push_back(config);
+	}
+	return configs;
+}
+
+vector<sweep::Result> sweep::Run(vector<Config> const& configs, Dataset<double> const& dataset,
+	Options const& options)
+{
+	if (options.roundRuns == 0 || options.maxRuns == 0) throw string("A round must train at least one sample");
+	for (auto& config : configs) {
+		if (config.layerSizes.size() < 2 || config.layerSizes.front() != dataset.getInputSize() ||
+			config.layerSizes.back() != dataset.getOutputSize()) {
+			throw string("Topology " + TopologyName(config.layerSizes) + " does not match the dataset");
+		}
+	}
+
+	size_t const rounds = (options.maxRuns + options.roundRuns - 1) / options.roundRuns;
+	Reports reports(rounds, options.cancelQuantile, options.minReports);
+	vector<Trial> trials(configs.size());
+	WorkStealingPool pool(options.threads);
+
+	// one task trains a net for a round and queues the next round of the same net, which
+	// stays on the same worker unless another one runs out of work and steals it
+	function<void(size_t)> train = [&](size_t const index) {
+		Trial& trial = trials[index];
+		Result& result = trial.result;
+		Clock::time_point const start = Clock::now();
+		if (!trial.net) trial.net = CreateNet(result.config);
+
+		size_t const end = min(result.runs + options.roundRuns, options.maxRuns);
+		for (; result.runs < end; ++result.runs) {
+			size_t const sample = result.runs % dataset.getCount();
+			trial.net->Train(dataset.getInputs(sample), dataset.getTargets(sample));
+		}
+		result.recentError = trial.net->getRecentError();
+		result.seconds += chrono::duration<double>(Clock::now() - start).count();
+
+		size_t const round = (result.runs - 1) / options.roundRuns;
+		bool const done = result.runs >= options.maxRuns || result.recentError < options.targetError;
+		result.cancelled = !done && reports.Report(round, result.recentError);
+		if (!done && !result.cancelled) {
+			pool.Submit([&train, index]() { train(index); });
+			return;
+		}
+
+		// the net is finished, only its result is kept
+		result.error = Evaluate(*trial.net, dataset);
+		trial.net.reset();
+	};
+
+	for (size_t i = 0; i < configs.size(); ++i) {
+		Result& result = trials[i].result;
+		result.config = configs[i];
+		result.runs = 0;
+		result.recentError = 0.0;
+		result.error = 0.0;
+		result.seconds = 0.0;
+		result.cancelled = false;
+		pool.Submit([&train, i]() { train(i); });
+	}
+	pool.Wait();
+
+	vector<Result> results;
+	for (auto& trial : trials) {
+		results.push_back(trial.result);
+	}
+	stable_sort(results.begin(), results.end(), IsBetter);
+	return results;
+}
+
+void sweep::PrintTable(ostream& os, vector<Result> const& results, size_t const maxRows)
+{
+	ios::fmtflags const flags = os.flags();
+	streamsize const precision = os.precision();
+
+	// fixed point keeps the numbers of a column at the same width, the columns are separated
+	// by a space even if a number is wider than its field
+	os << left << setw(5) << "Rank" << ' ' << setw(16) << "Topology" << ' ' << setw(18) << "Activation"
+		<< right << ' ' << setw(7) << "Beta" << ' ' << setw(7) << "EtaUpd" << ' ' << setw(7) << "Alpha"
+		<< ' ' << setw(12) << "Seed" << ' ' << setw(10) << "Runs" << ' ' << setw(12) << "RecentError"
+		<< ' ' << setw(12) << "Error" << ' ' << setw(9) << "Time/s" << "  Status" << endl;
+	os << fixed;
+	for (size_t i = 0; i < results.size() && i < maxRows; ++i) {
+		Result const& result = results[i];
+		Config const& config = result.config;
+		os << left << setw(5) << i + 1 << ' ' << setw(16) << TopologyName(config.layerSizes) << ' ' << setw(18)
+			<< activation::Name(config.activation) << right << setprecision(3) << ' ' << setw(7) << config.beta
+			<< ' ' << setw(7) << config.etaUpdate << ' ' << setw(7) << config.alpha << ' ' << setw(12) << config.seed
+			<< ' ' << setw(10) << result.runs << setprecision(6) << ' ' << setw(12) << result.recentError
+			<< ' ' << setw(12) << result.error << setprecision(4) << ' ' << setw(9) << result.seconds
+			<< "  " << (result.cancelled ? "cancelled" : "done") << endl;
+	}
+	if (results.size() > maxRows) {
+		os << "... " << results.size() - maxRows << " more" << endl;
+	}
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+void sweep::WriteCsv(string const& fileName, vector<Result> const& results)
+{
+	ofstream file(fileName);
+	if (!file.is_open()) throw string("Could not open " + fileName);
+
+	file << "rank,topology,activation,beta,eta_update,alpha,seed,runs,recent_error,error,seconds,cancelled\n"
+		<< setprecision(10);
+	for (size_t i = 0; i < results.size(); ++i) {
+		Result const& result = results[i];
+		Config const& config = result.config;
+		file << i + 1 << ',' << TopologyName(config.layerSizes) << ',' << activation::Name(config.activation) << ','
+			<< config.beta << ',' << config.etaUpdate << ',' << config.alpha << ',' << config.seed << ','
+			<< result.runs << ',' << result.recentError << ',' << result.error << ',' << result.seconds << ','
+			<< (result.cancelled ? 1 : 0) << '\n';
+	}
+	if (!file) throw string("Could not write " + fileName);
+}
+
+string sweep::TopologyName(LayerSizes const& layerSizes)
+{
+	string name;
+	for (size_t i = 0; i < layerSizes.size(); ++i) {
+		if (i > 0) name += '-';
+		name += to_string(layerSizes[i]);
+	}
+	return name;
+}
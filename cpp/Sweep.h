@@ -0,0 +1,118 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Sweep.h
+// Date:        2026/10/16
+// Description: Hyperparameter and topology sweeps. Many independent nets are trained on the
+//              same dataset at the same time, one WorkStealingPool task per round of
+//              training, and ranked by their error on the dataset afterwards.
+//
+//              Configurations that are hopeless are cancelled early with the median
+//              stopping rule: after every round a net compares its recent average error
+//              with the errors the other nets had after the same number of samples. If it
+//              is worse than Options::cancelQuantile of them, it won't catch up and stops.
+//              Which nets are compared depends on the order in which they get there, so
+//              the set of cancelled nets may vary between sweeps; the training of a net
+//              that is not cancelled doesn't depend on the other nets.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _SWEEP
+#define _SWEEP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "Layer.h"
+#include "Activation.h"
+#include "Dataset.h"
+
+namespace sweep {
+	//-------------------------------------------------------------------------------------
+	///Hyperparameters of one net, see BasicNeuralNet::setBeta, setEtaUpdate and setAlpha.
+	///[seed] is the seed of the weights, which are drawn with Initializer::Uniform (the
+	///distribution of the default weights, but independent of rand()).
+	struct Config {
+		LayerSizes layerSizes;
+		Activation activation;
+		double beta;
+		double etaUpdate;
+		double alpha;
+		unsigned seed;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Values a sweep chooses from. The activation is used by all layers after the input
+	///layer.
+	struct Space {
+		std::vector<LayerSizes> layerSizes;
+		std::vector<Activation> activations;
+		std::vector<double> betas;
+		std::vector<double> etaUpdates;
+		std::vector<double> alphas;
+		std::vector<unsigned> seeds;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///How the nets of a sweep are trained
+	struct Options {
+		// number of nets trained at the same time
+		size_t threads;
+		// samples every net is trained with at most, the dataset is repeated
+		size_t maxRuns;
+		// samples between two comparisons with the other nets
+		size_t roundRuns;
+		// a net is cancelled if its recent error is worse than this quantile of the nets
+		// that got as far, 1 never cancels
+		double cancelQuantile;
+		// nets that must have got as far before any net is cancelled there
+		size_t minReports;
+		// a net stops as soon as its recent error is below this, 0 trains all samples
+		double targetError;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Outcome of one net
+	struct Result {
+		Config config;
+		size_t runs;
+		double recentError;
+		// RMS error of the trained net on the whole dataset, the sweep is ranked by it
+		double error;
+		// training time of the net
+		double seconds;
+		bool cancelled;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the default options: all hardware threads, 10000 samples in rounds
+	///of 500, cancel below the median after 4 nets
+	Options DefaultOptions();
+	//-------------------------------------------------------------------------------------
+	///Description: Get all combinations of the values of a space
+	std::vector<Config> Grid(Space const& space);
+	//-------------------------------------------------------------------------------------
+	///Description: Draw random configurations from a space. Topology and activation are
+	///picked from their lists, beta, etaUpdate and alpha are drawn uniformly between the
+	///smallest and the largest listed value and every configuration gets a random seed.
+	///Params: [space] The values, [count] Number of configurations, [seed] Seed of the
+	///random search, the same seed gives the same configurations
+	std::vector<Config> Random(Space const& space, size_t const count, unsigned const seed);
+	//-------------------------------------------------------------------------------------
+	///Description: Train a net for every configuration
+	///Params: [configs] The configurations, [dataset] Samples the nets are trained and
+	///ranked with, [options] How they are trained
+	///Return: One result per configuration, the nets that were not cancelled first, each
+	///group sorted by the error on the dataset
+	std::vector<Result> Run(std::vector<Config> const& configs, Dataset<double> const& dataset,
+		Options const& options);
+	//-------------------------------------------------------------------------------------
+	///Description: Print a ranked table of the results
+	///Params: [os] Output stream, [results] Results of Run, [maxRows] Rows to print at most
+	void PrintTable(std::ostream& os, std::vector<Result> const& results, size_t const maxRows);
+	//-------------------------------------------------------------------------------------
+	///Description: Write all results as CSV, one line per configuration in the ranked order
+	void WriteCsv(std::string const& fileName, std::vector<Result> const& results);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the name of a topology, e.g. "2-5-1"
+	std::string TopologyName(LayerSizes const& layerSizes);
+}
+
+#endif //_SWEEP
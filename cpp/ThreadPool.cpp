@@ -0,0 +1,140 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    ThreadPool.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "ThreadPool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t const numThreads)
+{
+	for (size_t i = 1; i < numThreads; ++i) {
+		mWorkers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(mMutex);
+		mStop = true;
+	}
+	mWorkAvailable.notify_all();
+
+	for (auto& worker : mWorkers) {
+		worker.join();
+	}
+}
+
+size_t ThreadPool::getNumThreads() const
+{
+	return mWorkers.size() + 1;
+}
+
+void ThreadPool::Run(size_t const count, TaskFunc func, void const* task)
+{
+	if (count == 0) return;
+
+	// nothing to share -> run on the calling thread only
+	if (count == 1 || mWorkers.empty()) {
+		for (size_t i = 0; i < count; ++i) {
+			func(task, i);
+		}
+		return;
+	}
+
+	Job job = { func, task, count, 0, count, nullptr, nullptr };
+	unique_lock<mutex> lock(mMutex);
+	if (mLastJob != nullptr) mLastJob->nextJob = &job;
+	else mFirstJob = &job;
+	mLastJob = &job;
+	mWorkAvailable.notify_all();
+
+	// help with our own job (or older ones) until all indices are claimed
+	Job* current = nullptr;
+	size_t index = 0;
+	while (job.next < job.count && ClaimIndex(current, index)) {
+		lock.unlock();
+		RunIndex(*current, index);
+		lock.lock();
+	}
+
+	// wait for the indices that are still running on the workers, the job must not be
+	// left before, not even by an exception
+	mJobDone.wait(lock, [&job] { return job.remaining == 0; });
+	if (job.error) rethrow_exception(job.error);
+}
+
+void ThreadPool::WorkerLoop()
+{
+	unique_lock<mutex> lock(mMutex);
+	while (true) {
+		mWorkAvailable.wait(lock, [this] { return mStop || mFirstJob != nullptr; });
+		if (mStop) return;
+
+		Job* job = nullptr;
+		size_t index = 0;
+		while (ClaimIndex(job, index)) {
+			lock.unlock();
+			RunIndex(*job, index);
+			lock.lock();
+		}
+	}
+}
+
+bool ThreadPool::ClaimIndex(Job*& job, size_t& index)
+{
+	if (mFirstJob == nullptr) return false;
+
+	job = mFirstJob;
+	index = job->next++;
+
+	// all indices are handed out -> nobody needs to find the job anymore
+	if (job->next == job->count) {
+		mFirstJob = job->nextJob;
+		if (mFirstJob == nullptr) mLastJob = nullptr;
+	}
+	return true;
+}
+
+void ThreadPool::RunIndex(Job& job, size_t const index)
+{
+	exception_ptr error;
+	try {
+		job.func(job.task, index);
+	}
+	catch (...) {
+		error = current_exception();
+	}
+	FinishIndex(job, error);
+}
+
+void ThreadPool::FinishIndex(Job& job, exception_ptr const& error)
+{
+	lock_guard<mutex> lock(mMutex);
+	if (error) {
+		if (!job.error) job.error = error;
+		// the indices nobody has claimed yet are dropped
+		if (job.next < job.count) {
+			Unlink(job);
+			job.remaining -= job.count - job.next;
+			job.next = job.count;
+		}
+	}
+	if (--job.remaining == 0) {
+		mJobDone.notify_all();
+	}
+}
+
+void ThreadPool::Unlink(Job& job)
+{
+	Job* previous = nullptr;
+	for (Job* current = mFirstJob; current != &job; current = current->nextJob) {
+		previous = current;
+	}
+	if (previous != nullptr) previous->nextJob = job.nextJob;
+	else mFirstJob = job.nextJob;
+	if (mLastJob == &job) mLastJob = previous;
+}
@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    ThreadPool.h
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _THREADPOOL
+#define _THREADPOOL
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "Object.h"
+
+//###########################################################################################
+///This class represents a pool of persistent worker threads. The workers are created once
+///in the constructor and wait for jobs until the pool is destroyed. A job is a task that is
+///run for a range of indices; the calling thread works on the job as well and returns when
+///all indices are done. Several threads may submit jobs to the same pool at the same time.
+class ThreadPool: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor
+	///Params: [numThreads] Number of threads working on a job including the calling thread,
+	///so numThreads - 1 workers are started
+	explicit ThreadPool(size_t const numThreads);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, stops and joins all workers
+	~ThreadPool();
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of threads working on a job including the calling thread
+	size_t getNumThreads() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Run task(index) for all indices in [0, count) and wait until all are done.
+	///Which thread runs which index is not specified. The task is passed by reference and
+	///not copied, so submitting a job doesn't allocate memory. If the task throws, the
+	///indices that haven't started are skipped, the running ones are waited for and the
+	///first exception is rethrown on the calling thread.
+	template<typename Task>
+	void ParallelFor(size_t const count, Task const& task) {
+		Run(count, &Invoke<Task>, &task);
+	}
+private:
+	typedef void(*TaskFunc)(void const* task, size_t index);
+
+	struct Job {
+		TaskFunc func;
+		void const* task;
+		size_t count;
+		size_t next;
+		size_t remaining;
+		Job* nextJob;
+		std::exception_ptr error;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Call a task of a known type through a type-erased pointer
+	template<typename Task>
+	static void Invoke(void const* task, size_t index) {
+		(*static_cast<Task const*>(task))(index);
+	}
+	//-------------------------------------------------------------------------------------
+	///Description: Type-erased implementation of ParallelFor
+	void Run(size_t const count, TaskFunc func, void const* task);
+
+	//-------------------------------------------------------------------------------------
+	///Description: Main loop of the workers
+	void WorkerLoop();
+	//-------------------------------------------------------------------------------------
+	///Description: Claim the next index of the oldest job, the lock must be held
+	///Return: false if there is no work
+	bool ClaimIndex(Job*& job, size_t& index);
+	//-------------------------------------------------------------------------------------
+	///Description: Run the task of a claimed index and mark it as done, an exception of the
+	///task is stored in the job, the lock must not be held
+	void RunIndex(Job& job, size_t const index);
+	//-------------------------------------------------------------------------------------
+	///Description: Mark an index of a job as done, a failed index cancels the indices that
+	///are not claimed yet, the lock must not be held
+	void FinishIndex(Job& job, std::exception_ptr const& error);
+	//-------------------------------------------------------------------------------------
+	///Description: Remove a job with unclaimed indices from the queue, the lock must be held
+	void Unlink(Job& job);
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	std::vector<std::thread> mWorkers;
+	// intrusive queue of the jobs with unclaimed indices, the jobs live on the stack of
+	// the submitting threads
+	Job* mFirstJob = nullptr;
+	Job* mLastJob = nullptr;
+	std::mutex mMutex;
+	std::condition_variable mWorkAvailable;
+	std::condition_variable mJobDone;
+	bool mStop = false;
+};
+#endif //_THREADPOOL
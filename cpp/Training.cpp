@@ -0,0 +1,250 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Training.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "Training.h"
+
+using namespace std;
+
+namespace {
+	typedef chrono::steady_clock Clock;
+
+	// number of samples the validation error is calculated with at once
+	size_t const cValidateBlock = 256;
+
+	double Seconds(Clock::time_point const start)
+	{
+		return chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	//###########################################################################################
+	// Background thread that validates snapshots of a net one at a time. The training thread
+	// submits a snapshot and collects its error later, in between only the validation thread
+	// touches the snapshot and the best weights.
+	template<typename Real>
+	class Validator {
+	public:
+		Validator(BasicNeuralNet<Real> const& net, Dataset<Real> const& dataset)
+			: mSnapshot(net), mBest(net), mDataset(dataset), mOutputs(cValidateBlock * dataset.getOutputSize()),
+			mThread(&Validator::Loop, this) {}
+
+		~Validator() {
+			{
+				lock_guard<mutex> lock(mMutex);
+				mStop = true;
+			}
+			mChanged.notify_all();
+			mThread.join();
+		}
+
+		// copy the weights of the net and start their validation, the previous result must
+		// have been collected
+		void Submit(BasicNeuralNet<Real> const& net) {
+			// same topology, so the snapshot is copied without allocation
+			mSnapshot = net;
+			{
+				lock_guard<mutex> lock(mMutex);
+				mState = State::Submitted;
+			}
+			mChanged.notify_all();
+		}
+
+		// wait for the validation error of the submitted snapshot
+		double Collect() {
+			unique_lock<mutex> lock(mMutex);
+			mChanged.wait(lock, [this]() { return mState == State::Done; });
+			mState = State::Idle;
+			return mError;
+		}
+
+		// the snapshot with the lowest error so far, only valid while no snapshot is submitted
+		BasicNeuralNet<Real> const& getBest() const {
+			return mBest;
+		}
+
+	private:
+		enum class State { Idle, Submitted, Done };
+
+		void Loop() {
+			unique_lock<mutex> lock(mMutex);
+			while (true) {
+				mChanged.wait(lock, [this]() { return mStop || mState == State::Submitted; });
+				if (mStop) return;
+
+				lock.unlock();
+				double const error = Evaluate();
+				if (error < mBestError) {
+					mBest = mSnapshot;
+					mBestError = error;
+				}
+				lock.lock();
+
+				mError = error;
+				mState = State::Done;
+				mChanged.notify_all();
+			}
+		}
+
+		// RMS error of the snapshot on all samples of the dataset
+		double Evaluate() {
+			size_t const outputSize = mDataset.getOutputSize();
+			double sqrError = 0.0;
+
+			for (size_t first = 0; first < mDataset.getCount(); first += cValidateBlock) {
+				size_t const count = min(cValidateBlock, mDataset.getCount() - first);
+				mSnapshot.Predict(mDataset.getInputs(first), count, mOutputs.data());
+				Real const* targets = mDataset.getTargets(first);
+				for (size_t i = 0; i < count * outputSize; ++i) {
+					double const delta = static_cast<double>(targets[i]) - static_cast<double>(mOutputs[i]);
+					sqrError += delta * delta;
+				}
+			}
+			return sqrt(sqrError / (mDataset.getCount() * outputSize));
+		}
+
+		Validator(Validator const&) = delete;
+		Validator& operator=(Validator const&) = delete;
+
+		BasicNeuralNet<Real> mSnapshot;
+		BasicNeuralNet<Real> mBest;
+		double mBestError = numeric_limits<double>::infinity();
+		Dataset<Real> const& mDataset;
+		BasicData<Real> mOutputs;
+		mutex mMutex;
+		condition_variable mChanged;
+		State mState = State::Idle;
+		double mError = 0.0;
+		bool mStop = false;
+		// started last, when all members are initialized
+		thread mThread;
+	};
+}
+
+training::Options training::DefaultOptions()
+{
+	Options options;
+	options.maxRuns = 100000;
+	options.batchSize = 1;
+	options.validationRuns = 1000;
+	options.targetError = 0.0;
+	options.patience = 10;
+	options.minDelta = 0.0;
+	options.restoreBest = true;
+	return options;
+}
+
+template<typename Real>
+training::Report training::Run(BasicNeuralNet<Real>& net, Dataset<Real> const& trainingSet,
+	Dataset<Real> const& validationSet, Options const& options)
+{
+	if (options.maxRuns == 0 || options.batchSize == 0 || options.validationRuns == 0) {
+		throw string("The net must be trained and validated with at least one sample");
+	}
+	if (trainingSet.getCount() == 0 || validationSet.getCount() == 0) {
+		throw string("The training and the validation set must not be empty");
+	}
+	LayerSizes const& layerSizes = net.getLayerSizes();
+	if (trainingSet.getInputSize() != layerSizes.front() || trainingSet.getOutputSize() != layerSizes.back() ||
+		validationSet.getInputSize() != layerSizes.front() || validationSet.getOutputSize() != layerSizes.back()) {
+		throw string("The datasets do not match the topology of the net");
+	}
+
+	Clock::time_point const start = Clock::now();
+	Report report;
+	report.reason = StopReason::MaxRuns;
+	report.runs = 0;
+	report.bestError = numeric_limits<double>::infinity();
+	report.bestRuns = 0;
+	report.waitSeconds = 0.0;
+
+	Validator<Real> validator(net, validationSet);
+	bool pending = false;
+	size_t pendingRuns = 0;
+	double plateauError = numeric_limits<double>::infinity();
+	size_t stale = 0;
+
+	// record the error of the submitted snapshot, an error that is not a number is never
+	// an improvement
+	auto collect = [&]() {
+		Clock::time_point const waitStart = Clock::now();
+		double const error = validator.Collect();
+		report.waitSeconds += Seconds(waitStart);
+		pending = false;
+
+		report.history.push_back({ pendingRuns, error });
+		if (error < report.bestError) {
+			report.bestError = error;
+			report.bestRuns = pendingRuns;
+		}
+		if (error < plateauError - options.minDelta) {
+			plateauError = error;
+			stale = 0;
+		}
+		else {
+			++stale;
+		}
+		return error;
+	};
+
+	while (report.runs < options.maxRuns) {
+		// one round, the batches don't wrap around the end of the training set
+		size_t const end = min(report.runs + options.validationRuns, options.maxRuns);
+		while (report.runs < end) {
+			size_t const sample = report.runs % trainingSet.getCount();
+			size_t const count = min(min(options.batchSize, end - report.runs), trainingSet.getCount() - sample);
+			if (options.batchSize == 1) net.Train(trainingSet.getInputs(sample), trainingSet.getTargets(sample));
+			else net.TrainBatch(trainingSet.getInputs(sample), trainingSet.getTargets(sample), count);
+			report.runs += count;
+		}
+
+		// the previous snapshot had a whole round to be validated
+		if (pending) {
+			double const error = collect();
+			if (error < options.targetError) {
+				report.reason = StopReason::Target;
+				break;
+			}
+			if (options.patience > 0 && stale >= options.patience) {
+				report.reason = StopReason::Plateau;
+				break;
+			}
+		}
+
+		validator.Submit(net);
+		pending = true;
+		pendingRuns = report.runs;
+	}
+
+	// the last round is validated as well, it may hold the best weights or reach the target
+	if (pending && collect() < options.targetError) report.reason = StopReason::Target;
+	if (options.restoreBest && report.bestRuns > 0) {
+		net = validator.getBest();
+	}
+
+	report.seconds = Seconds(start);
+	return report;
+}
+
+char const* training::Name(StopReason const reason)
+{
+	switch (reason) {
+	case StopReason::MaxRuns: return "max runs";
+	case StopReason::Target: return "target";
+	case StopReason::Plateau: return "plateau";
+	default: return "unknown";
+	}
+}
+
+template training::Report training::Run(NeuralNet& net, Dataset<double> const& trainingSet,
+	Dataset<double> const& validationSet, Options const& options);
+template training::Report training::Run(FloatNeuralNet& net, Dataset<float> const& trainingSet,
+	Dataset<float> const& validationSet, Options const& options);
@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Training.h
+// Date:        2026/10/16
+// Description: Training loop with validation and early stopping. The net is trained on a
+//              training set in rounds of Options::validationRuns samples. After every round
+//              the weights are copied into a snapshot, which a background thread evaluates
+//              on the validation set while the net trains the next round, so the training
+//              thread only pays for the copy (one memcpy of the arena, see Arena).
+//
+//              Before the snapshot of a round is taken, the result of the previous one is
+//              collected: the loop stops when the validation error is below the target or
+//              hasn't improved for Options::patience validations. Only if the validation of
+//              a round takes longer than training the next one, the training thread waits
+//              for it (see Report::waitSeconds). Every decision is made on a known snapshot,
+//              so a run is as reproducible as the training of the net itself.
+//
+//              Whenever a snapshot has the lowest validation error so far, the background
+//              thread keeps a copy of it. At the end these best weights are copied back into
+//              the net, so it doesn't keep the round(s) it was trained after the best one.
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _TRAINING
+#define _TRAINING
+
+#include <vector>
+#include "NeuralNet.h"
+#include "Dataset.h"
+
+namespace training {
+	//-------------------------------------------------------------------------------------
+	///How a net is trained
+	struct Options {
+		// samples the net is trained with at most, the training set is repeated
+		size_t maxRuns;
+		// samples per call of TrainBatch, 1 trains sample by sample with Train
+		size_t batchSize;
+		// samples between two validations
+		size_t validationRuns;
+		// stop as soon as the validation error is below this, 0 never stops early
+		double targetError;
+		// stop after this many validations without an improvement of more than minDelta,
+		// 0 never stops early
+		size_t patience;
+		double minDelta;
+		// copy the weights with the lowest validation error back into the net at the end
+		bool restoreBest;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Why the training stopped
+	enum class StopReason { MaxRuns, Target, Plateau };
+
+	//-------------------------------------------------------------------------------------
+	///Validation error of the snapshot after [runs] samples
+	struct Validation {
+		size_t runs;
+		double error;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Outcome of a training run
+	struct Report {
+		StopReason reason;
+		// samples the net was trained with
+		size_t runs;
+		// every validation in the order of the rounds
+		std::vector<Validation> history;
+		// lowest validation error and the samples its snapshot was trained with, 0 runs if
+		// no validation gave a finite error
+		double bestError;
+		size_t bestRuns;
+		// training time including the snapshots and the waits for the validation
+		double seconds;
+		// time the training thread waited for the validation thread
+		double waitSeconds;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the default options: at most 100000 samples one by one, a validation
+	///every 1000 samples, stop after 10 validations without improvement, no target, restore
+	///the best weights
+	Options DefaultOptions();
+	//-------------------------------------------------------------------------------------
+	///Description: Train a net with validation and early stopping. The validation error is
+	///the RMS error of Predict on all samples of the validation set, so it includes the
+	///output activation of the net. The net is not used by other threads while it trains,
+	///its own threads (SetThreads) are used by TrainBatch as usual.
+	///Params: [net] The net, [trainingSet] Samples the net is trained with, [validationSet]
+	///Held-out samples the snapshots are evaluated with, [options] How the net is trained
+	///Return: The report of the run
+	template<typename Real>
+	Report Run(BasicNeuralNet<Real>& net, Dataset<Real> const& trainingSet, Dataset<Real> const& validationSet,
+		Options const& options);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the name of a stop reason, e.g. "plateau"
+	char const* Name(StopReason const reason);
+}
+
+#endif //_TRAINING
@@ -0,0 +1,222 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Tuner.cpp
+// Date:        2026/10/16
+// Description: Hyperparameter tuner of the neural net. Trains one net per configuration of
+//              a grid or a random search over topology, activation, beta, eta update and
+//              momentum on all cores (see Sweep.h) and prints the configurations ranked by
+//              their error. Without a dataset the XOR samples of the test driver are used.
+//
+//              Usage: tuner [options], see PrintUsage
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include "Sweep.h"
+#include "Dataset.h"
+#include "Manipulators.h"
+
+using namespace std;
+using namespace ownmanips;
+
+namespace {
+	struct Options {
+		sweep::Space space;
+		sweep::Options sweep = sweep::DefaultOptions();
+		size_t randomCount = 0;
+		unsigned randomSeed = 1;
+		string datasetFile;
+		string csvFile;
+		size_t rows = 20;
+	};
+
+	vector<string> Split(string const& text, char const separator)
+	{
+		vector<string> parts;
+		stringstream stream(text);
+		string part;
+		while (getline(stream, part, separator)) {
+			parts.push_back(part);
+		}
+		return parts;
+	}
+
+	double ParseNumber(string const& text)
+	{
+		char* end = nullptr;
+		double const value = strtod(text.c_str(), &end);
+		if (text.empty() || *end != '\0') throw string("Invalid number " + text);
+		return value;
+	}
+
+	vector<double> ParseNumbers(string const& text)
+	{
+		vector<double> values;
+		for (auto& part : Split(text, ',')) {
+			values.push_back(ParseNumber(part));
+		}
+		return values;
+	}
+
+	LayerSizes ParseTopology(string const& name)
+	{
+		LayerSizes layerSizes;
+		for (auto& size : Split(name, '-')) {
+			char* end = nullptr;
+			unsigned long const value = strtoul(size.c_str(), &end, 10);
+			if (size.empty() || *end != '\0' || value == 0) throw string("Invalid topology " + name);
+			layerSizes.push_back(value);
+		}
+		if (layerSizes.size() < 2) throw string("Invalid topology " + name + ", at least two layers are needed");
+		return layerSizes;
+	}
+
+	void WriteXorDataset(string const& fileName)
+	{
+		double const inputs[] = { 0,0, 1,0, 0,1, 1,1 };
+		double const targets[] = { 0, 1, 1, 0 };
+		DatasetWriter<double> writer(fileName, 2, 1, 4);
+		for (size_t i = 0; i < 4; ++i) {
+			writer.Append(inputs + 2 * i, targets + i);
+		}
+		writer.Close();
+	}
+
+	void PrintUsage()
+	{
+		cout << "Usage: tuner [options]" << endl
+			<< "  --dataset FILE       samples to train with (see Dataset.h), default: XOR" << endl
+			<< "  --topology A-B-C     topology to try (repeatable), default: 2-3-1, 2-5-1 and 2-8-1" << endl
+			<< "  --activation LIST    activations to try, e.g. clip,tanh (see Activation.h)" << endl
+			<< "  --beta LIST          smoothings of the recent average error, e.g. 0.25,0.5,1" << endl
+			<< "  --eta-update LIST    factors from the recent average error to eta" << endl
+			<< "  --alpha LIST         momentums" << endl
+			<< "  --seeds N            initial weights to try per configuration (default 3)" << endl
+			<< "  --random N           N random configurations instead of the grid, the values" << endl
+			<< "                       of beta, eta update and alpha are ranges then" << endl
+			<< "  --random-seed N      seed of the random search (default 1)" << endl
+			<< "  --runs N             samples per net (default 10000)" << endl
+			<< "  --round N            samples between two comparisons of the nets (default 500)" << endl
+			<< "  --quantile Q         cancel nets worse than this quantile, 1 = never (default 0.5)" << endl
+			<< "  --min-reports N      nets to compare with before cancelling (default 4)" << endl
+			<< "  --target ERROR       stop a net once its recent error is below ERROR" << endl
+			<< "  --threads N          nets trained at the same time (default: all cores)" << endl
+			<< "  --rows N             rows of the printed table (default 20)" << endl
+			<< "  --csv FILE           write all results as CSV" << endl;
+	}
+
+	Options ParseOptions(int const argc, char const* const argv[])
+	{
+		Options options;
+		options.space.activations = { Activation::Clip, Activation::Tanh, Activation::Sigmoid, Activation::TanhRational };
+		options.space.betas = { 0.25, 0.5, 1.0 };
+		options.space.etaUpdates = { 0.3, 0.55, 1.0 };
+		options.space.alphas = { 0.0, 0.5 };
+		size_t seeds = 3;
+
+		for (int i = 1; i < argc; ++i) {
+			string const option = argv[i];
+			auto value = [&]() -> string {
+				if (i + 1 >= argc) throw string("Missing value of " + option);
+				return argv[++i];
+			};
+			auto count = [&]() -> size_t {
+				double const number = ParseNumber(value());
+				if (number < 1) throw string(option + " must be at least 1");
+				return static_cast<size_t>(number);
+			};
+
+			if (option == "--dataset") options.datasetFile = value();
+			else if (option == "--topology") options.space.layerSizes.push_back(ParseTopology(value()));
+			else if (option == "--activation") {
+				options.space.activations.clear();
+				for (auto& name : Split(value(), ',')) {
+					options.space.activations.push_back(activation::Parse(name));
+				}
+			}
+			else if (option == "--beta") options.space.betas = ParseNumbers(value());
+			else if (option == "--eta-update") options.space.etaUpdates = ParseNumbers(value());
+			else if (option == "--alpha") options.space.alphas = ParseNumbers(value());
+			else if (option == "--seeds") seeds = count();
+			else if (option == "--random") options.randomCount = count();
+			else if (option == "--random-seed") options.randomSeed = static_cast<unsigned>(ParseNumber(value()));
+			else if (option == "--runs") options.sweep.maxRuns = count();
+			else if (option == "--round") options.sweep.roundRuns = count();
+			else if (option == "--quantile") options.sweep.cancelQuantile = ParseNumber(value());
+			else if (option == "--min-reports") options.sweep.minReports = count();
+			else if (option == "--target") options.sweep.targetError = ParseNumber(value());
+			else if (option == "--threads") options.sweep.threads = count();
+			else if (option == "--rows") options.rows = count();
+			else if (option == "--csv") options.csvFile = value();
+			else throw string("Unknown option " + option);
+		}
+
+		if (options.space.layerSizes.empty()) {
+			if (!options.datasetFile.empty()) throw string("--topology is needed with --dataset");
+			options.space.layerSizes = { { 2, 3, 1 }, { 2, 5, 1 }, { 2, 8, 1 } };
+		}
+		for (unsigned seed = 1; seed <= seeds; ++seed) {
+			options.space.seeds.push_back(seed);
+		}
+		return options;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	try {
+		options = ParseOptions(argc, argv);
+	}
+	catch (string const& error) {
+		PrintError("Tuner", error);
+		PrintUsage();
+		return 1;
+	}
+
+	string const xorFile = "tuner_xor.dataset";
+	try {
+		string datasetFile = options.datasetFile;
+		if (datasetFile.empty()) {
+			datasetFile = xorFile;
+			WriteXorDataset(datasetFile);
+		}
+		Dataset<double> const dataset(datasetFile, false);
+
+		vector<sweep::Config> const configs = (options.randomCount > 0) ?
+			sweep::Random(options.space, options.randomCount, options.randomSeed) : sweep::Grid(options.space);
+
+		PrintHeader("Tuner");
+		cout << configs.size() << " configurations, " << dataset.getCount() << " samples, " << options.sweep.maxRuns
+			<< " runs per net, threads: " << options.sweep.threads << endl << endl;
+
+		auto const start = chrono::steady_clock::now();
+		vector<sweep::Result> const results = sweep::Run(configs, dataset, options.sweep);
+		chrono::duration<double> const seconds = chrono::steady_clock::now() - start;
+
+		size_t const cancelled = count_if(results.begin(), results.end(),
+			[](sweep::Result const& result) { return result.cancelled; });
+		double trainSeconds = 0.0;
+		for (auto& result : results) {
+			trainSeconds += result.seconds;
+		}
+
+		sweep::PrintTable(cout, results, options.rows);
+		cout << endl << cancelled << " of " << results.size() << " nets cancelled early, " << seconds.count()
+			<< " s (" << trainSeconds << " s of training)" << endl;
+
+		if (!options.csvFile.empty()) sweep::WriteCsv(options.csvFile, results);
+	}
+	catch (string const& error) {
+		PrintError("Tuner", error);
+		remove(xorFile.c_str());
+		return 1;
+	}
+
+	remove(xorFile.c_str());
+	return 0;
+}
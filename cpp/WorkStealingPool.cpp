@@ -0,0 +1,147 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    WorkStealingPool.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+namespace {
+	// index of the worker the current thread is, cWorkerNone for other threads
+	size_t const cWorkerNone = static_cast<size_t>(-1);
+	thread_local WorkStealingPool const* sPool = nullptr;
+	thread_local size_t sWorkerIndex = cWorkerNone;
+}
+
+WorkStealingPool::WorkStealingPool(size_t const numThreads)
+{
+	size_t const count = (numThreads > 0) ? numThreads : 1;
+	for (size_t i = 0; i < count; ++i) {
+		mWorkers.emplace_back(new Worker);
+	}
+	for (size_t i = 0; i < count; ++i) {
+		mThreads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	try {
+		Wait();
+	}
+	catch (...) {
+		// a destructor must not throw, Wait reports the errors of the tasks
+	}
+
+	{
+		lock_guard<mutex> lock(mMutex);
+		mStop = true;
+	}
+	mWorkAvailable.notify_all();
+	for (auto& thread : mThreads) {
+		thread.join();
+	}
+}
+
+void WorkStealingPool::Submit(Task task)
+{
+	// workers keep their own tasks, the other threads deal them out
+	size_t index = (sPool == this) ? sWorkerIndex : cWorkerNone;
+	if (index == cWorkerNone) index = mNextWorker.fetch_add(1) % mWorkers.size();
+
+	// counted before it is queued, so a worker can't finish it before it is counted (a
+	// worker that wakes up in between just looks again)
+	{
+		lock_guard<mutex> lock(mMutex);
+		++mPending;
+		mQueued.fetch_add(1);
+	}
+	{
+		lock_guard<mutex> lock(mWorkers[index]->mutex);
+		mWorkers[index]->tasks.push_back(move(task));
+	}
+	mWorkAvailable.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+	unique_lock<mutex> lock(mMutex);
+	mAllDone.wait(lock, [this] { return mPending == 0; });
+
+	if (mError) {
+		exception_ptr const error = mError;
+		mError = nullptr;
+		rethrow_exception(error);
+	}
+}
+
+size_t WorkStealingPool::getNumThreads() const
+{
+	return mThreads.size();
+}
+
+size_t WorkStealingPool::getSteals() const
+{
+	return mSteals.load();
+}
+
+void WorkStealingPool::WorkerLoop(size_t const index)
+{
+	sPool = this;
+	sWorkerIndex = index;
+
+	while (true) {
+		Task task;
+		if (FindTask(index, task)) {
+			exception_ptr error;
+			try {
+				task();
+			}
+			catch (...) {
+				error = current_exception();
+			}
+			// the task is destroyed before the pool can be
+			task = nullptr;
+
+			lock_guard<mutex> lock(mMutex);
+			if (error && !mError) mError = error;
+			if (--mPending == 0) mAllDone.notify_all();
+			continue;
+		}
+
+		unique_lock<mutex> lock(mMutex);
+		mWorkAvailable.wait(lock, [this] { return mStop || mQueued.load() > 0; });
+		if (mStop) return;
+	}
+}
+
+bool WorkStealingPool::FindTask(size_t const index, Task& task)
+{
+	// newest task of the own deque
+	{
+		Worker& worker = *mWorkers[index];
+		lock_guard<mutex> lock(worker.mutex);
+		if (!worker.tasks.empty()) {
+			task = move(worker.tasks.back());
+			worker.tasks.pop_back();
+			mQueued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// oldest task of the other deques, starting with the next worker
+	for (size_t i = 1; i < mWorkers.size(); ++i) {
+		Worker& victim = *mWorkers[(index + i) % mWorkers.size()];
+		lock_guard<mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = move(victim.tasks.front());
+			victim.tasks.pop_front();
+			mQueued.fetch_sub(1);
+			mSteals.fetch_add(1);
+			return true;
+		}
+	}
+	return false;
+}
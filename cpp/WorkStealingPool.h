@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    WorkStealingPool.h
+// Date:        2026/10/16
+// Description: Thread pool for many independent tasks of unknown length
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _WORKSTEALINGPOOL
+#define _WORKSTEALINGPOOL
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include "Object.h"
+
+//###########################################################################################
+///This class runs tasks on persistent worker threads with work stealing. Every worker has
+///its own deque: a task submitted by a worker goes to the back of the worker's deque and is
+///taken from there by the same worker (last in, first out), so a task that submits its own
+///continuation keeps running on the core whose cache holds its data. A worker whose deque
+///is empty steals the oldest task from the front of another deque. Tasks submitted from
+///other threads are dealt to the workers in turn. Unlike ThreadPool, which runs one index
+///range at a time for the data-parallel training, the tasks may have very different run
+///times and may submit new tasks.
+class WorkStealingPool: public Object
+{
+public:
+	typedef std::function<void()> Task;
+
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor, starts the workers
+	///Params: [numThreads] Number of workers (at least 1)
+	explicit WorkStealingPool(size_t const numThreads);
+	//-------------------------------------------------------------------------------------
+	///Description: Destructor, waits for all tasks (see Wait) and joins the workers
+	~WorkStealingPool();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Queue a task, may be called from any thread including the workers
+	///Params: [task] The task, an exception it throws is passed on by Wait
+	void Submit(Task task);
+	//-------------------------------------------------------------------------------------
+	///Description: Wait until all submitted tasks and the tasks they submitted are done.
+	///Must not be called from a worker. Throws the first error a task threw.
+	void Wait();
+
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of workers
+	size_t getNumThreads() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of tasks that were stolen from another worker so far
+	size_t getSteals() const;
+
+private:
+	WorkStealingPool(WorkStealingPool const&) = delete;
+	WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	//-------------------------------------------------------------------------------------
+	///Description: Main loop of a worker
+	void WorkerLoop(size_t const index);
+	//-------------------------------------------------------------------------------------
+	///Description: Take a task from the back of the own deque or steal one from the front
+	///of another deque
+	///Return: false if all deques are empty
+	bool FindTask(size_t const index, Task& task);
+
+	std::vector<std::unique_ptr<Worker>> mWorkers;
+	std::vector<std::thread> mThreads;
+	// next worker that gets a task submitted from outside
+	std::atomic<size_t> mNextWorker{ 0 };
+	std::atomic<size_t> mSteals{ 0 };
+	// tasks in the deques (raised under mMutex, so no wakeup is lost) and tasks that are
+	// queued or running
+	std::atomic<size_t> mQueued{ 0 };
+	size_t mPending = 0;
+	// first exception of a task since the last Wait
+	std::exception_ptr mError;
+	std::mutex mMutex;
+	std::condition_variable mWorkAvailable;
+	std::condition_variable mAllDone;
+	bool mStop = false;
+};
+#endif //_WORKSTEALINGPOOL
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Workspace.cpp
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "Workspace.h"
+
+using namespace std;
+
+template<typename Real>
+BasicWorkspace<Real>::BasicWorkspace(LayerSizes const& layerSizes, size_t const capacity)
+	: mLayerSizes(layerSizes), mOffsets(layerSizes.size())
+{
+	// the weight gradients don't depend on the number of samples, they are allocated even
+	// without any capacity
+	Allocate(capacity);
+}
+
+template<typename Real>
+void BasicWorkspace<Real>::Reserve(size_t const count)
+{
+	if (count <= mCapacity) return;
+	Allocate(count);
+}
+
+template<typename Real>
+size_t BasicWorkspace<Real>::getCapacity() const
+{
+	return mCapacity;
+}
+
+template<typename Real>
+Real* BasicWorkspace<Real>::getOutputs(size_t const layer)
+{
+	return reinterpret_cast<Real*>(mArena.getData() + mOffsets[layer].outputs);
+}
+
+template<typename Real>
+Real* BasicWorkspace<Real>::getGradients(size_t const layer)
+{
+	return reinterpret_cast<Real*>(mArena.getData() + mOffsets[layer].gradients);
+}
+
+template<typename Real>
+Real* BasicWorkspace<Real>::getWeightGradients(size_t const layer)
+{
+	return reinterpret_cast<Real*>(mArena.getData() + mOffsets[layer].weightGradients);
+}
+
+template<typename Real>
+void BasicWorkspace<Real>::Allocate(size_t const capacity)
+{
+	size_t size = 0;
+	for (size_t i = 0; i < mLayerSizes.size(); ++i) {
+		size_t const numInputs = (i > 0) ? mLayerSizes[i - 1] + 1 : 0;
+		mOffsets[i].outputs = size;
+		mOffsets[i].gradients = Arena::Align(size + capacity * (mLayerSizes[i] + 1) * sizeof(Real));
+		mOffsets[i].weightGradients = Arena::Align(mOffsets[i].gradients + capacity * mLayerSizes[i] * sizeof(Real));
+		size = Arena::Align(mOffsets[i].weightGradients + mLayerSizes[i] * numInputs * sizeof(Real));
+	}
+	mArena = Arena(size);
+	mCapacity = capacity;
+
+	// bias neuron -> force output val to 1.0
+	for (size_t i = 0; i < mLayerSizes.size(); ++i) {
+		size_t const columns = mLayerSizes[i] + 1;
+		Real* outputs = getOutputs(i);
+		for (size_t j = 0; j < capacity; ++j) {
+			outputs[j * columns + columns - 1] = 1.0;
+		}
+	}
+}
+
+template class BasicWorkspace<double>;
+template class BasicWorkspace<float>;
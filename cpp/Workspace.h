@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Workfile:    Workspace.h
+// Date:        2026/10/16
+// Description: -
+// Author:      Nik Haminger
+/////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef _WORKSPACE
+#define _WORKSPACE
+
+#include <vector>
+#include "Object.h"
+#include "Layer.h"
+#include "Arena.h"
+
+//###########################################################################################
+///This class holds the scratch buffers of a batched forward and backward pass, so the
+///weights of a net can be shared by several workspaces. For every layer there is a
+///row-major output matrix with one row per sample (the last column belongs to the bias
+///neuron and is always 1.0), a gradient matrix with one row per sample and a matrix with
+///the summed weight gradients, which has the shape of the layer's weight matrix. All
+///matrices are placed in one Arena, each starting on a cache line. [Real] is the number
+///type of the net, the template is instantiated for double and float.
+template<typename Real>
+class BasicWorkspace: public Object
+{
+public:
+	//-------------------------------------------------------------------------------------
+	///Description: Constructor
+	///Params: [layerSizes] Number of neurons per layer WITHOUT bias neurons, [capacity]
+	///Number of samples the buffers are sized for initially
+	BasicWorkspace(LayerSizes const& layerSizes, size_t const capacity);
+	//-------------------------------------------------------------------------------------
+	///Description: Make sure the buffers can hold [count] samples, a larger arena is
+	///allocated if not (the values of the matrices are lost then)
+	void Reserve(size_t const count);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the number of samples the buffers can hold
+	size_t getCapacity() const;
+	//-------------------------------------------------------------------------------------
+	///Description: Get the output matrix of a layer [capacity x (size + 1)]
+	Real* getOutputs(size_t const layer);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the gradient matrix of a layer [capacity x size]
+	Real* getGradients(size_t const layer);
+	//-------------------------------------------------------------------------------------
+	///Description: Get the weight gradient matrix of a layer [size x (prev size + 1)]
+	Real* getWeightGradients(size_t const layer);
+private:
+	//-------------------------------------------------------------------------------------
+	///Description: Allocate the arena for [capacity] samples and set the bias columns
+	void Allocate(size_t const capacity);
+
+	// byte offsets of the matrices of a layer in the arena
+	struct Offsets {
+		size_t outputs;
+		size_t gradients;
+		size_t weightGradients;
+	};
+
+	LayerSizes mLayerSizes;
+	size_t mCapacity = 0;
+	std::vector<Offsets> mOffsets;
+	Arena mArena;
+};
+
+typedef BasicWorkspace<double> Workspace;
+#endif //_WORKSPACE
@@ -9,10 +9,30 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <time.h>
 #include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include "NeuralNet.h"
+#include "FixedNeuralNet.h"
+#include "MappedNeuralNet.h"
+#include "StaticNeuralNet.h"
+#include "Kernels.h"
+#include "Random.h"
+#include "WorkStealingPool.h"
+#include "Dataset.h"
 #include "Manipulators.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include "MetricsWriter.h"
+#include "Training.h"
+#include "Pruning.h"
+#include "QuantizedNeuralNet.h"
 
 using namespace std;
 using namespace ownmanips;
@@ -38,65 +58,963 @@ void PrintContainer(string const& msg, Data const& cont) {
 	cout << "]" << endl;
 }
 
-void PrintTestContainer(vector<TestData> const& testVector) {
+void PrintTestContainer(Dataset<double> const& dataset) {
 	cout << "a b | y" << endl;
 	cout << "-------" << endl;
-	for (auto& elem : testVector) {
-		cout << elem.input[0] << " " << elem.input[1] << " | " << elem.target[0] << endl;
+	for (size_t i = 0; i < dataset.getCount(); ++i) {
+		cout << dataset.getInputs(i)[0] << " " << dataset.getInputs(i)[1] << " | " << dataset.getTargets(i)[0] << endl;
 	}
 }
 
-void TrainNet(string const& fileName, size_t const maxRuns) {
+void WriteXorDataset(string const& fileName) {
+	// Test data ----------------------------
+	vector<TestData> const testVector = {
+		{ { 0,0 },{ 0 } },
+		{ { 1,0 },{ 1 } },
+		{ { 0,1 },{ 1 } },
+		{ { 1,1 },{ 0 } }
+	};
+
+	DatasetWriter<double> writer(fileName, 2, 1, testVector.size());
+	for (auto& testData : testVector) {
+		writer.Append(testData.input.data(), testData.target.data());
+	}
+	writer.Close();
+}
+
+void TrainNet(string const& fileName, Dataset<double> const& dataset, size_t const maxRuns) {
 	PrintHeader(fileName);
 	NeuralNet net({ 2, 5, 1 }, PrepareResults);
-	ofstream fileStream(fileName);
-
-	// Test data ----------------------------
-	vector<TestData> testVector;
-	TestData data1 = { { 0,0 },{ 0 } };
-	TestData data2 = { { 1,0 },{ 1 } };
-	TestData data3 = { { 0,1 },{ 1 } };
-	TestData data4 = { { 1,1 },{ 0 } };
-	testVector.push_back(data1);
-	testVector.push_back(data2);
-	testVector.push_back(data3);
-	testVector.push_back(data4);
+	MetricsWriter metrics(fileName);
 
 	// Print test data
 	PrintSubHeader("Test data and expected results");
-	PrintTestContainer(testVector);
+	PrintTestContainer(dataset);
 
 	// Train --------------------------------
+	// the progress is reported by the background thread of a writer on the console, so
+	// the training loop doesn't wait for the output
+	PrintSubHeader("Progress");
+	MetricsWriter progress(cout);
 	for (size_t i = 0; i < maxRuns; ++i) {
-		auto& testData = testVector[i%testVector.size()];
-		net.Train(testData.input, testData.target);
+		// the samples are used in place, straight from the mapped file
+		size_t const sample = i % dataset.getCount();
+		net.Train(dataset.getInputs(sample), dataset.getTargets(sample));
 
 		// Write to csv file to be able to show an error diagram
-		if (fileStream.is_open() && i % testVector.size() == 0) {
-			fileStream << to_string(i + 1) << "," << net.getRecentError() << endl;
+		if (sample == 0) {
+			metrics.Push({ i + 1, net.getRecentError(), net.getEta() });
 		}
 
-		// Print some iterations out in console
+		// Report some iterations on the console
 		if (i % (maxRuns / 10) == 0) {
-			PrintSubHeader("Run number " + to_string(i + 1));
-			PrintContainer("Input    ", testData.input);
-			PrintContainer("Expected ", testData.target);
-			PrintContainer("Result   ", net.getResults());
-			cout << "Recent average error: " << net.getRecentError() << endl;
+			progress.Push({ i + 1, net.getRecentError(), net.getEta() });
+		}
+	}
+	progress.Close();
+	metrics.Close();
+
+	// Print the results of the trained net
+	PrintSubHeader("Results after " + to_string(maxRuns) + " runs");
+	for (size_t sample = 0; sample < dataset.getCount(); ++sample) {
+		double const* input = dataset.getInputs(sample);
+		double const* target = dataset.getTargets(sample);
+		net.ForwardPropagate(input);
+		PrintContainer("Input    ", Data(input, input + dataset.getInputSize()));
+		PrintContainer("Expected ", Data(target, target + dataset.getOutputSize()));
+		PrintContainer("Result   ", net.getResults());
+	}
+	cout << endl;
+}
+
+void TrainWithValidation(Dataset<double> const& dataset, double const targetError) {
+	PrintHeader("Training with validation");
+	// a fixed seed and Adam, with which the XOR net converges for any seed, so the run
+	// doesn't get stuck on a plateau of the random start
+	NeuralNet net({ 2, 5, 1 }, Activations(2, Activation::Clip), initializer::Make(Initializer::XavierUniform, 1), RealVal);
+	optimizer::Settings settings = optimizer::Defaults(Optimizer::Adam);
+	settings.learningRate = 0.1;
+	net.setOptimizer(settings);
+
+	// XOR has no samples to hold out, the validation set is the training set
+	training::Options options = training::DefaultOptions();
+	options.maxRuns = 20000;
+	options.validationRuns = 20;
+	options.targetError = targetError;
+	options.patience = 20;
+	training::Report const report = training::Run(net, dataset, dataset, options);
+
+	cout << "Validation errors";
+	for (auto& validation : report.history) {
+		cout << " " << validation.error << " (" << validation.runs << ")";
+	}
+	cout << endl;
+	cout << "Stopped by " << training::Name(report.reason) << " after " << report.runs << " of " << options.maxRuns
+		<< " samples and " << report.history.size() << " validations" << endl;
+	cout << "Best validation error " << report.bestError << " after " << report.bestRuns << " samples" << endl;
+	cout << "Time " << report.seconds * 1e3 << " ms, waited for the validation " << report.waitSeconds * 1e3 << " ms" << endl;
+	if (report.reason != training::StopReason::Target) {
+		PrintError("Main::TrainWithValidation", "The net didn't reach the validation error " + to_string(targetError));
+	}
+	cout << endl;
+}
+
+void CheckAllocations(size_t const runs) {
+	PrintHeader("Allocation check");
+	size_t const batchSize = 4;
+	NeuralNet net({ 2, 5, 1 }, PrepareResults, batchSize);
+	double const inputs[] = { 0,0, 1,0, 0,1, 1,1 };
+	double const targets[] = { 0, 1, 1, 0 };
+	double results[batchSize] = { 0 };
+
+	// warm-up: the first calls may still size thread-local buffers
+	net.Train(inputs, targets);
+	net.TrainBatch(inputs, targets, batchSize);
+	net.Predict(inputs, batchSize, results);
+
+	size_t const before = allocations::getCount();
+	for (size_t i = 0; i < runs; ++i) {
+		size_t const sample = i % batchSize;
+		net.Train(inputs + 2 * sample, targets + sample);
+		net.getResults(results);
+		net.TrainBatch(inputs, targets, batchSize);
+		net.Predict(inputs, batchSize, results);
+	}
+	size_t const count = allocations::getCount() - before;
+
+	if (count == 0) PrintInfo("No allocations in " + to_string(runs) + " training runs");
+	else PrintError("Main::CheckAllocations", to_string(count) + " allocations in " + to_string(runs) + " training runs");
+
+	// the batches on the thread pool, synchronous and hogwild, and a Predict that is split
+	// across the threads; the batch doesn't divide by the number of threads
+	size_t const poolBatchSize = 37, predictSamples = 300, numThreads = 4;
+	LayerSizes const layerSizes = { 16, 64, 4 };
+	NeuralNet pooled(layerSizes, RealVal, poolBatchSize);
+	Data poolInputs(poolBatchSize * layerSizes.front());
+	Data poolTargets(poolBatchSize * layerSizes.back());
+	Data poolResults(predictSamples * layerSizes.back());
+	Data predictInputs(predictSamples * layerSizes.front());
+	for (auto& value : poolInputs) value = rand() / double(RAND_MAX);
+	for (auto& value : poolTargets) value = rand() / double(RAND_MAX);
+	for (auto& value : predictInputs) value = rand() / double(RAND_MAX);
+
+	for (TrainingMode const mode : { TrainingMode::Synchronous, TrainingMode::Hogwild }) {
+		pooled.SetThreads(numThreads, mode);
+		pooled.TrainBatch(poolInputs.data(), poolTargets.data(), poolBatchSize);
+		pooled.Predict(predictInputs.data(), predictSamples, poolResults.data());
+
+		size_t const poolBefore = allocations::getCount();
+		for (size_t i = 0; i < runs; ++i) {
+			pooled.TrainBatch(poolInputs.data(), poolTargets.data(), poolBatchSize);
+			pooled.Predict(predictInputs.data(), predictSamples, poolResults.data());
+		}
+		size_t const poolCount = allocations::getCount() - poolBefore;
+
+		string const name = (mode == TrainingMode::Synchronous) ? "synchronous" : "hogwild";
+		if (poolCount == 0) PrintInfo("No allocations in " + to_string(runs) + " " + name + " batches on " +
+			to_string(numThreads) + " threads");
+		else PrintError("Main::CheckAllocations", to_string(poolCount) + " allocations in " + to_string(runs) + " " + name +
+			" batches on " + to_string(numThreads) + " threads");
+	}
+}
+
+// number of results of the kernels of an instruction set that differ from the scalar
+// reference by more than the tolerance of Kernels.h
+template<typename Real>
+size_t CompareKernels(kernels::Isa const isa) {
+	auto random = []() { return static_cast<Real>(rand() / double(RAND_MAX) * 2.0 - 1.0); };
+	double const epsilon = numeric_limits<Real>::epsilon();
+	size_t failures = 0;
+
+	// lengths that are no multiple of any vector width, so the remainder loops run too
+	for (size_t const n : { 1, 3, 7, 13, 33, 67, 1025 }) {
+		vector<Real> a(n), b(n), y(n);
+		generate(a.begin(), a.end(), random);
+		generate(b.begin(), b.end(), random);
+		generate(y.begin(), y.end(), random);
+		vector<Real> axpy = y, axpyReference = y;
+
+		kernels::SetIsa(kernels::Isa::Scalar);
+		double const dotReference = kernels::Dot(a.data(), b.data(), n);
+		kernels::Axpy(Real(0.37), a.data(), axpyReference.data(), n);
+		kernels::SetIsa(isa);
+		double const dot = kernels::Dot(a.data(), b.data(), n);
+		kernels::Axpy(Real(0.37), a.data(), axpy.data(), n);
+
+		double bound = 0.0;
+		for (size_t i = 0; i < n; ++i) {
+			bound += fabs(double(a[i]) * b[i]);
+		}
+		if (fabs(dot - dotReference) > 2.0 * n * epsilon * bound) ++failures;
+		if (axpy != axpyReference) ++failures;
+	}
+
+	// C[m x n] from A[m x k], B[n x k] (NT), B[k x n] (NN) and A[k x m] (TN)
+	size_t const m = 5, n = 19, k = 37;
+	vector<Real> a(m * k), b(n * k), c(m * n);
+	generate(a.begin(), a.end(), random);
+	generate(b.begin(), b.end(), random);
+	generate(c.begin(), c.end(), random);
+	vector<Real> nt(m * n), nn = c, tn = c;
+	vector<Real> ntReference(m * n), nnReference = c, tnReference = c;
+
+	kernels::SetIsa(kernels::Isa::Scalar);
+	kernels::GemmNT(a.data(), k, b.data(), k, ntReference.data(), n, m, n, k);
+	kernels::GemmNN(a.data(), k, b.data(), n, nnReference.data(), n, m, n, k);
+	kernels::GemmTN(a.data(), m, b.data(), n, tnReference.data(), n, m, n, k);
+	kernels::SetIsa(isa);
+	kernels::GemmNT(a.data(), k, b.data(), k, nt.data(), n, m, n, k);
+	kernels::GemmNN(a.data(), k, b.data(), n, nn.data(), n, m, n, k);
+	kernels::GemmTN(a.data(), m, b.data(), n, tn.data(), n, m, n, k);
+
+	for (size_t i = 0; i < m; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			double bound = 0.0;
+			for (size_t l = 0; l < k; ++l) {
+				bound += fabs(double(a[i * k + l]) * b[j * k + l]);
+			}
+			if (fabs(double(nt[i * n + j]) - ntReference[i * n + j]) > 2.0 * k * epsilon * bound) ++failures;
+		}
+	}
+	if (nn != nnReference) ++failures;
+	if (tn != tnReference) ++failures;
+	return failures;
+}
+
+// number of results of the 16 bit fixed-point kernels of an instruction set that differ
+// from the scalar reference, they have to be bit-identical
+size_t CompareFixedKernels(kernels::Isa const isa) {
+	// rand() may have only 15 bits, the full range needs two draws
+	auto random = []() { return static_cast<int16_t>(((rand() & 0xFF) << 8) | (rand() & 0xFF)); };
+	auto small = []() { return static_cast<int16_t>(rand() % 2049 - 1024); };
+	size_t failures = 0;
+
+	// wide rows with remainders for every vector width, values over the full range saturate
+	for (int const fracBits : { 0, 8, 10, 15 }) {
+		for (size_t const n : { 1, 7, 15, 33, 1025, 4099 }) {
+			for (bool const full : { true, false }) {
+				auto draw = [&]() { return full ? random() : small(); };
+				vector<int16_t> a(n), b(n), y(n);
+				generate(a.begin(), a.end(), draw);
+				generate(b.begin(), b.end(), draw);
+				generate(y.begin(), y.end(), random);
+				int16_t const factor = draw();
+				vector<int16_t> product(n), productReference(n), axpy = y, axpyReference = y;
+
+				kernels::SetIsa(kernels::Isa::Scalar);
+				kernels::MulFixed(a.data(), b.data(), productReference.data(), n, fracBits);
+				kernels::AxpyFixed(factor, a.data(), axpyReference.data(), n, fracBits);
+				kernels::SetIsa(isa);
+				kernels::MulFixed(a.data(), b.data(), product.data(), n, fracBits);
+				kernels::AxpyFixed(factor, a.data(), axpy.data(), n, fracBits);
+
+				if (product != productReference) ++failures;
+				if (axpy != axpyReference) ++failures;
+			}
+		}
+	}
+	return failures;
+}
+
+void CheckKernels() {
+	PrintHeader("Kernel check");
+	kernels::Isa const current = kernels::GetIsa();
+	kernels::Isa const best = kernels::DetectIsa();
+	for (int i = static_cast<int>(kernels::Isa::SSE2); i <= static_cast<int>(best); ++i) {
+		kernels::Isa const isa = static_cast<kernels::Isa>(i);
+		size_t const failures = CompareKernels<double>(isa) + CompareKernels<float>(isa) + CompareFixedKernels(isa);
+		string const name = kernels::IsaName(isa);
+		if (failures == 0) PrintInfo(name + " kernels match the scalar ones");
+		else PrintError("Main::CheckKernels", to_string(failures) + " results of the " + name + " kernels differ from the scalar ones");
+	}
+	kernels::SetIsa(current);
+}
+
+double Sigmoid(double const x) {
+	return 1.0 / (1.0 + exp(-x));
+}
+
+// largest difference of an activation from the exact function, over the range and steps of
+// the error bounds of Activation.h, applied to whole rows like a layer does
+template<typename Real>
+double MaxActivationError(Activation const activation, double (*exact)(double)) {
+	size_t const count = 4000001;
+	vector<Real> values(count);
+	for (size_t i = 0; i < count; ++i) {
+		values[i] = static_cast<Real>(-20.0 + i * 1e-5);
+	}
+	vector<Real> const inputs = values;
+	activation::Apply(activation, values.data(), count);
+
+	double error = 0.0;
+	for (size_t i = 0; i < count; ++i) {
+		error = fmax(error, fabs(values[i] - exact(inputs[i])));
+	}
+	return error;
+}
+
+// true if an activation gives NaN exactly for the NaN inputs, at every position of the
+// vectors of the kernels and of their remainders
+template<typename Real>
+bool PropagatesNaN(Activation const activation) {
+	size_t const count = 37;
+	for (size_t position = 0; position < count; ++position) {
+		vector<Real> values(count);
+		for (size_t i = 0; i < count; ++i) {
+			values[i] = static_cast<Real>(-4.0 + 0.2 * i);
+		}
+		values[position] = numeric_limits<Real>::quiet_NaN();
+		activation::Apply(activation, values.data(), count);
+		for (size_t i = 0; i < count; ++i) {
+			if (isnan(values[i]) != (i == position)) return false;
+		}
+	}
+	return true;
+}
+
+void CheckActivations() {
+	PrintHeader("Activation check");
+	struct Bound {
+		Activation activation;
+		double (*exact)(double);
+		double doubleError;
+		double floatError;
+	};
+	// the table of Activation.h
+	Bound const bounds[] = {
+		{ Activation::TanhRational, tanh, 2.7e-7, 4.0e-7 },
+		{ Activation::SigmoidRational, Sigmoid, 1.3e-7, 2.3e-7 },
+		{ Activation::TanhTable, tanh, 5.9e-6, 6.3e-6 },
+		{ Activation::SigmoidTable, Sigmoid, 3.0e-6, 3.2e-6 }
+	};
+
+	// the bounds hold for the kernels of every instruction set
+	kernels::Isa const current = kernels::GetIsa();
+	for (auto& bound : bounds) {
+		double doubleError = 0.0, floatError = 0.0;
+		bool nan = true;
+		for (int i = static_cast<int>(kernels::Isa::Scalar); i <= static_cast<int>(kernels::DetectIsa()); ++i) {
+			kernels::SetIsa(static_cast<kernels::Isa>(i));
+			doubleError = fmax(doubleError, MaxActivationError<double>(bound.activation, bound.exact));
+			floatError = fmax(floatError, MaxActivationError<float>(bound.activation, bound.exact));
+			nan = nan && PropagatesNaN<double>(bound.activation) && PropagatesNaN<float>(bound.activation);
+		}
+		if (!nan) PrintError("Main::CheckActivations", string(activation::Name(bound.activation)) + " doesn't pass NaN on");
+
+		ostringstream errors;
+		errors << setprecision(2) << activation::Name(bound.activation) << " max. error " << doubleError << " double, "
+			<< floatError << " float";
+		if (doubleError <= bound.doubleError && floatError <= bound.floatError) PrintInfo(errors.str() + ", within the bounds");
+		else {
+			errors << ", bounds " << bound.doubleError << " and " << bound.floatError;
+			PrintError("Main::CheckActivations", errors.str());
+		}
+	}
+	kernels::SetIsa(current);
+}
+
+void CheckStaticNet(size_t const maxRuns) {
+	PrintHeader("Static net check");
+	double const inputs[] = { 0,0, 1,0, 0,1, 1,1 };
+	double const targets[] = { 0, 1, 1, 0 };
+
+	// both nets draw their weights from the same seed, the static net has to follow the
+	// NeuralNet with the scalar kernels sample by sample
+	kernels::Isa const current = kernels::GetIsa();
+	kernels::SetIsa(kernels::Isa::Scalar);
+	srand(1);
+	StaticNeuralNet<2, 3, 1> staticNet(RealVal);
+	srand(1);
+	NeuralNet net({ 2, 3, 1 }, RealVal);
+
+	size_t run = 0;
+	for (; run < maxRuns; ++run) {
+		staticNet.Train(inputs + 2 * (run % 4), targets + run % 4);
+		net.Train(inputs + 2 * (run % 4), targets + run % 4);
+		if (staticNet.getResults()[0] != net.getResults()[0] || staticNet.getRecentError() != net.getRecentError()) break;
+	}
+	kernels::SetIsa(current);
+
+	if (run == maxRuns) PrintInfo("StaticNeuralNet<2, 3, 1> matches NeuralNet in all " + to_string(maxRuns) + " runs");
+	else PrintError("Main::CheckStaticNet", "StaticNeuralNet<2, 3, 1> differs from NeuralNet in run " + to_string(run));
+}
+
+// largest difference of the Predict outputs of a double and a float net on the same samples
+double MaxDifference(NeuralNet const& net, FloatNeuralNet const& floatNet, vector<double> const& inputs) {
+	size_t const count = inputs.size() / net.getLayerSizes().front();
+	vector<float> const floatInputs(inputs.begin(), inputs.end());
+	vector<double> outputs(count * net.getLayerSizes().back());
+	vector<float> floatOutputs(outputs.size());
+	net.Predict(inputs.data(), count, outputs.data());
+	floatNet.Predict(floatInputs.data(), count, floatOutputs.data());
+	double difference = 0.0;
+	for (size_t i = 0; i < outputs.size(); ++i) {
+		difference = fmax(difference, fabs(outputs[i] - floatOutputs[i]));
+	}
+	return difference;
+}
+
+// a double and a float net start with the same weights and are trained with the same
+// samples, the float net has to learn XOR and a regression and stay within the tolerance
+// of the double net
+void CheckFloatNet(size_t const maxRuns, double const tolerance) {
+	PrintHeader("Float check");
+
+	// XOR with the weights of rand() and the adaptive eta
+	vector<double> const xorInputs = { 0,0, 1,0, 0,1, 1,1 };
+	vector<double> const xorTargets = { 0, 1, 1, 0 };
+	vector<float> const xorFloatInputs(xorInputs.begin(), xorInputs.end());
+	vector<float> const xorFloatTargets(xorTargets.begin(), xorTargets.end());
+	srand(1);
+	NeuralNet net({ 2, 5, 1 }, RealVal);
+	srand(1);
+	FloatNeuralNet floatNet({ 2, 5, 1 }, RealVal);
+	for (size_t run = 0; run < maxRuns; ++run) {
+		net.Train(&xorInputs[2 * (run % 4)], &xorTargets[run % 4]);
+		floatNet.Train(&xorFloatInputs[2 * (run % 4)], &xorFloatTargets[run % 4]);
+	}
+	double difference = MaxDifference(net, floatNet, xorInputs);
+	if (floatNet.getRecentError() >= tolerance) {
+		PrintError("Main::CheckFloatNet", "The float net didn't learn XOR, recent error " + to_string(floatNet.getRecentError()));
+	}
+	else if (difference > tolerance) {
+		PrintError("Main::CheckFloatNet", "XOR results of the float net differ by " + to_string(difference) + " from the double net");
+	}
+	else PrintInfo("Float net learned XOR, results within " + to_string(difference) + " of the double net");
+
+	// regression of a smooth function of 16 inputs with seeded weights and Adam
+	size_t const inputSize = 16, outputSize = 4, count = 1024, batchSize = 32;
+	vector<double> inputs(count * inputSize), targets(count * outputSize);
+	for (auto& input : inputs) {
+		input = rand() / double(RAND_MAX) * 2.0 - 1.0;
+	}
+	for (size_t s = 0; s < count; ++s) {
+		double const* x = &inputs[s * inputSize];
+		for (size_t k = 0; k < outputSize; ++k) {
+			targets[s * outputSize + k] = 0.5 * sin(2.0 * x[k] + x[k + 4]) + 0.3 * x[k + 8] * x[k + 12];
+		}
+	}
+	vector<float> const floatInputs(inputs.begin(), inputs.end());
+	vector<float> const floatTargets(targets.begin(), targets.end());
+
+	LayerSizes const layerSizes = { inputSize, 32, outputSize };
+	Activations const activations(layerSizes.size() - 1, Activation::Tanh);
+	optimizer::Settings settings = optimizer::Defaults(Optimizer::Adam);
+	settings.learningRate = 0.003;
+	NeuralNet regression(layerSizes, activations, initializer::Make(Initializer::XavierUniform, 1), RealVal, batchSize);
+	FloatNeuralNet floatRegression(layerSizes, activations, initializer::Make(Initializer::XavierUniform, 1), RealVal, batchSize);
+	regression.setOptimizer(settings);
+	floatRegression.setOptimizer(settings);
+	for (size_t runs = 0; runs < maxRuns; runs += batchSize) {
+		size_t const sample = runs % count;
+		regression.TrainBatch(&inputs[sample * inputSize], &targets[sample * outputSize], batchSize);
+		floatRegression.TrainBatch(&floatInputs[sample * inputSize], &floatTargets[sample * outputSize], batchSize);
+	}
+
+	// RMS error of both nets on all samples
+	auto error = [&](vector<double> const& outputs) {
+		double sqrError = 0.0;
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			sqrError += (targets[i] - outputs[i]) * (targets[i] - outputs[i]);
+		}
+		return sqrt(sqrError / outputs.size());
+	};
+	vector<double> outputs(count * outputSize);
+	vector<float> floatOutputs(outputs.size());
+	regression.Predict(inputs.data(), count, outputs.data());
+	floatRegression.Predict(floatInputs.data(), count, floatOutputs.data());
+	double const rmsError = error(outputs);
+	double const floatRmsError = error(vector<double>(floatOutputs.begin(), floatOutputs.end()));
+	double const targetRms = error(vector<double>(outputs.size(), 0.0));
+	difference = MaxDifference(regression, floatRegression, inputs);
+	if (floatRmsError >= 0.5 * targetRms) {
+		PrintError("Main::CheckFloatNet", "The float net didn't learn the regression, RMS error " + to_string(floatRmsError) +
+			" of targets with RMS " + to_string(targetRms));
+	}
+	else if (fabs(floatRmsError - rmsError) > tolerance || difference > tolerance) {
+		PrintError("Main::CheckFloatNet", "Regression of the float net has RMS error " + to_string(floatRmsError) +
+			", the double net " + to_string(rmsError) + ", results differ by up to " + to_string(difference));
+	}
+	else PrintInfo("Float regression RMS error " + to_string(floatRmsError) + ", double " + to_string(rmsError) +
+		", results within " + to_string(difference));
+}
+
+void CheckHardwareModel(string const& fileName, size_t const epochs) {
+	PrintHeader("Hardware model check");
+	FixedNeuralNet<NeuroReal> net({ 2, 5, 1 }, RealVal);
+	ifstream fileStream(fileName);
+	if (!fileStream.is_open()) {
+		PrintError("Main::CheckHardwareModel", "Could not open " + fileName);
+		return;
+	}
+
+	// same configuration as the testbench (sim/tbneuralnet.vhd): hardware weights, fixed eta
+	// and the patterns in the order of the testbench
+	net.InitHardwareWeights();
+	net.setEta(0.15);
+	net.setAlpha(0.5);
+	vector<TestData> const testVector = {
+		{ { 0,0 },{ 0 } },
+		{ { 1,0 },{ 1 } },
+		{ { 0,1 },{ 1 } },
+		{ { 1,1 },{ 0 } }
+	};
+
+	double recentError = 0.0;
+	size_t mismatches = 0;
+	size_t firstMismatch = 0;
+	for (size_t i = 0; i < epochs; ++i) {
+		for (auto& testData : testVector) {
+			net.ForwardPropagate(testData.input);
+			net.CalcGradients(testData.target);
+
+			// the testbench computes the recent average error in delta cycles until the
+			// signal doesn't change anymore
+			double const error = sqrt(net.getError());
+			double next = recentError;
+			do {
+				recentError = next;
+				next = (recentError * 0.5 + error) / 1.5;
+			} while (next != recentError);
+
+			net.UpdateWeights();
+		}
+
+		// the simulation writes the error after each epoch, with 7 significant digits
+		string line;
+		if (!getline(fileStream, line)) {
+			PrintError("Main::CheckHardwareModel", fileName + " ends after " + to_string(i) + " epochs");
+			return;
+		}
+		double const expected = stod(line.substr(line.find(',') + 1));
+		if (fabs(expected - recentError) > 5e-7 * fmax(fabs(expected), 1.0)) {
+			if (mismatches++ == 0) firstMismatch = i + 1;
+		}
+	}
+
+	if (mismatches == 0) PrintInfo("Error curve of " + fileName + " matches in all " + to_string(epochs) + " epochs");
+	else PrintError("Main::CheckHardwareModel", to_string(mismatches) + " of " + to_string(epochs) + " epochs differ from " +
+		fileName + ", the first one is epoch " + to_string(firstMismatch));
+}
+
+void ProfileTraining(size_t const runs) {
+	PrintHeader("Profile");
+	if (!profiling::EnableHardwareCounters(true)) {
+		PrintInfo("Hardware counters are not available");
+	}
+	profiling::Reset();
+
+	size_t const batchSize = 32;
+	NeuralNet net({ 64, 256, 256, 10 }, RealVal, batchSize);
+	Data inputs(batchSize * 64);
+	Data targets(batchSize * 10);
+	for (auto& value : inputs) value = rand() / double(RAND_MAX);
+	for (auto& value : targets) value = rand() / double(RAND_MAX);
+
+	// the sums grow while the net is trained
+	profiling::StartPeriodicDump(cout, chrono::milliseconds(250));
+	for (size_t i = 0; i < runs; ++i) {
+		net.Train(&inputs[i % batchSize * 64], &targets[i % batchSize * 10]);
+		net.TrainBatch(inputs.data(), targets.data(), batchSize);
+	}
+	profiling::StopPeriodicDump();
+
+	PrintSubHeader("Total");
+	profiling::Dump();
+	profiling::EnableHardwareCounters(false);
+	cout << endl;
+}
+
+// true if the weights of all layers of two nets are equal
+template<typename Real>
+bool SameWeights(BasicNeuralNet<Real> const& a, BasicNeuralNet<Real> const& b) {
+	for (size_t i = 1; i < a.getLayerSizes().size(); ++i) {
+		BasicLayer<Real> const& layerA = a.getLayer(i);
+		BasicLayer<Real> const& layerB = b.getLayer(i);
+		if (layerA.getNumWeights() != layerB.getNumWeights() ||
+			!equal(layerA.getWeights(), layerA.getWeights() + layerA.getNumWeights(), layerB.getWeights())) return false;
+	}
+	return true;
+}
+
+void CheckModelFile(string const& fileName) {
+	PrintHeader("Model file check");
+	NeuralNet net({ 2, 5, 1 }, RealVal);
+	// hyperparameters other than the defaults, the loaded net must train with them
+	net.setBeta(0.25);
+	net.setEtaUpdate(0.4);
+	net.setAlpha(0.3);
+	double const inputs[] = { 0,0, 1,0, 0,1, 1,1 };
+	double const targets[] = { 0, 1, 1, 0 };
+	for (size_t i = 0; i < 800; ++i) {
+		net.Train(inputs + 2 * (i % 4), targets + i % 4);
+	}
+	net.Save(fileName);
+
+	// inference directly on the mapped file must give the results of the saved net
+	auto const start = chrono::steady_clock::now();
+	MappedNeuralNet<double> mapped(fileName, RealVal);
+	chrono::duration<double, micro> const openTime = chrono::steady_clock::now() - start;
+	double expected[4], results[4];
+	net.Predict(inputs, 4, expected);
+	mapped.Predict(inputs, 4, results);
+	bool ok = equal(expected, expected + 4, results) && mapped.getRecentError() == net.getRecentError();
+
+	// a loaded net continues training like the saved one, loading doesn't draw from rand()
+	srand(7);
+	int const draw = rand();
+	srand(7);
+	NeuralNet loaded = NeuralNet::Load(fileName, RealVal);
+	ok = ok && rand() == draw && loaded.getBeta() == net.getBeta() && loaded.getEtaUpdate() == net.getEtaUpdate() &&
+		loaded.getAlpha() == net.getAlpha();
+	for (size_t i = 0; i < 8; ++i) {
+		net.Train(inputs + 2 * (i % 4), targets + i % 4);
+		loaded.Train(inputs + 2 * (i % 4), targets + i % 4);
+	}
+	ok = ok && net.getResults() == loaded.getResults() && net.getRecentError() == loaded.getRecentError();
+
+	// Adam continues with its moments and its step count, the bias correction depends on it.
+	// The net is pruned, its hidden layer stays masked, its output layer becomes sparse.
+	NeuralNet adam({ 2, 5, 1 }, RealVal);
+	optimizer::Settings settings = optimizer::Defaults(Optimizer::Adam);
+	settings.learningRate = 0.05;
+	adam.setOptimizer(settings);
+	for (size_t i = 0; i < 50; ++i) {
+		adam.Train(inputs + 2 * (i % 4), targets + i % 4);
+	}
+	adam.setSparseCrossover(0.5);
+	adam.Prune(0.6);
+	adam.Save(fileName);
+	NeuralNet loadedAdam = NeuralNet::Load(fileName, RealVal);
+	optimizer::Settings const loadedSettings = loadedAdam.getOptimizer();
+	ok = ok && loadedSettings.type == settings.type && loadedSettings.learningRate == settings.learningRate &&
+		loadedSettings.momentum == settings.momentum && loadedSettings.decay == settings.decay &&
+		loadedSettings.epsilon == settings.epsilon && adam.getWeightFormat(1) == WeightFormat::Masked &&
+		adam.getWeightFormat(2) == WeightFormat::Sparse && loadedAdam.getWeightFormat(1) == WeightFormat::Masked &&
+		loadedAdam.getWeightFormat(2) == WeightFormat::Sparse;
+	for (size_t i = 0; i < 8; ++i) {
+		adam.Train(inputs + 2 * (i % 4), targets + i % 4);
+		loadedAdam.Train(inputs + 2 * (i % 4), targets + i % 4);
+	}
+	ok = ok && adam.getResults() == loadedAdam.getResults() && adam.getRecentError() == loadedAdam.getRecentError() &&
+		SameWeights(adam, loadedAdam);
+	remove(fileName.c_str());
+
+	if (ok) PrintInfo("Saved, mapped (" + to_string(static_cast<long>(openTime.count())) + " us) and loaded net match");
+	else PrintError("Main::CheckModelFile", "Results of the saved and the loaded net differ");
+}
+
+void CompareOptimizers(size_t const runs, size_t const maxSamples, double const targetError) {
+	PrintHeader("Optimizer comparison");
+	double const inputs[] = { 0,0, 1,0, 0,1, 1,1 };
+	double const targets[] = { 0, 1, 1, 0 };
+
+	// learning rates that suit the small XOR net, the other hyperparameters are the defaults
+	struct Candidate {
+		Optimizer type;
+		double learningRate;
+	};
+	vector<Candidate> const candidates = {
+		{ Optimizer::Adaptive, 0.15 },
+		{ Optimizer::Sgd, 0.15 },
+		{ Optimizer::Nesterov, 0.05 },
+		{ Optimizer::RMSProp, 0.01 },
+		{ Optimizer::Adam, 0.1 }
+	};
+
+	// every optimizer trains the same nets (same seeds) until the recent average error
+	// falls below the target
+	for (auto& candidate : candidates) {
+		vector<size_t> samples;
+		for (size_t run = 0; run < runs; ++run) {
+			srand(static_cast<unsigned>(run + 1));
+			NeuralNet net({ 2, 5, 1 }, RealVal);
+			optimizer::Settings settings = optimizer::Defaults(candidate.type);
+			settings.learningRate = candidate.learningRate;
+			net.setOptimizer(settings);
+
+			for (size_t i = 0; i < maxSamples; ++i) {
+				net.Train(inputs + 2 * (i % 4), targets + i % 4);
+				if (i >= 4 && net.getRecentError() < targetError) {
+					samples.push_back(i + 1);
+					break;
+				}
+			}
+		}
+
+		sort(samples.begin(), samples.end());
+		cout << setw(9) << left << optimizer::Name(candidate.type) << right << " converged " << setw(3) << samples.size()
+			<< " of " << runs << " runs, median " << (samples.empty() ? 0 : samples[samples.size() / 2]) << " samples" << endl;
+	}
+	cout << endl;
+}
+
+// RMS error of Predict on all samples of a dataset
+double PredictError(FloatNeuralNet const& net, Dataset<float> const& dataset) {
+	vector<float> outputs(dataset.getCount() * dataset.getOutputSize());
+	net.Predict(dataset.getInputs(0), dataset.getCount(), outputs.data());
+	double sqrError = 0.0;
+	for (size_t i = 0; i < outputs.size(); ++i) {
+		double const delta = dataset.getTargets(0)[i] - outputs[i];
+		sqrError += delta * delta;
+	}
+	return sqrt(sqrError / outputs.size());
+}
+
+// microseconds per sample of Predict on the whole dataset
+template<typename Net>
+double PredictTime(Net const& net, Dataset<float> const& dataset, size_t const repeats) {
+	vector<float> outputs(dataset.getCount() * dataset.getOutputSize());
+	auto const start = chrono::steady_clock::now();
+	for (size_t i = 0; i < repeats; ++i) {
+		net.Predict(dataset.getInputs(0), dataset.getCount(), outputs.data());
+	}
+	return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / (repeats * dataset.getCount());
+}
+
+// 16 inputs in [-1, 1] and 4 targets that are a smooth function of them
+void WriteSmoothDataset(string const& fileName, size_t const count) {
+	size_t const inputSize = 16, outputSize = 4;
+	vector<float> inputs(inputSize), targets(outputSize);
+	DatasetWriter<float> writer(fileName, inputSize, outputSize, count);
+	for (size_t s = 0; s < count; ++s) {
+		for (auto& input : inputs) {
+			input = static_cast<float>(rand() / double(RAND_MAX) * 2.0 - 1.0);
+		}
+		for (size_t k = 0; k < outputSize; ++k) {
+			targets[k] = static_cast<float>(0.5 * sin(2.0 * inputs[k] + inputs[k + 4]) + 0.3 * inputs[k + 8] * inputs[k + 12]);
+		}
+		writer.Append(inputs.data(), targets.data());
+	}
+	writer.Close();
+}
+
+void CheckPruning(double const sparsity, size_t const maxRuns) {
+	PrintHeader("Pruning");
+	size_t const inputSize = 16, outputSize = 4, count = 2048, batchSize = 32;
+	WriteSmoothDataset("pruning.dataset", count);
+	Dataset<float> const dataset("pruning.dataset");
+
+	// a wide net trained dense and a copy of it that is pruned gradually while it is
+	// trained with the same samples, the last quarter fine-tunes the remaining weights
+	LayerSizes const layerSizes = { inputSize, 256, 256, outputSize };
+	FloatNeuralNet dense(layerSizes, Activations(layerSizes.size() - 1, Activation::Clip),
+		initializer::Make(Initializer::XavierUniform, 1), RealVal, batchSize);
+	optimizer::Settings settings = optimizer::Defaults(Optimizer::Adam);
+	settings.learningRate = 0.003;
+	dense.setOptimizer(settings);
+	FloatNeuralNet pruned(dense);
+
+	for (size_t runs = 0; runs < maxRuns; runs += batchSize) {
+		size_t const sample = runs % count;
+		dense.TrainBatch(dataset.getInputs(sample), dataset.getTargets(sample), batchSize);
+	}
+	pruning::Schedule const schedule = { 0.0, sparsity, 0, maxRuns * 3 / 4, maxRuns / 20 };
+	pruning::Train(pruned, dataset, schedule, maxRuns, batchSize);
+
+	cout << "Sparsity " << sparsity << " of the weights, crossover to sparse rows at density "
+		<< pruned.getSparseCrossover() << endl;
+	cout << "Formats of the layers:";
+	for (size_t i = 1; i < pruned.getLayerSizes().size(); ++i) {
+		WeightFormat const format = pruned.getWeightFormat(i);
+		cout << " " << ((format == WeightFormat::Sparse) ? "sparse" : (format == WeightFormat::Masked) ? "masked" : "dense");
+	}
+	cout << endl;
+	cout << "Model size  dense " << dense.getModelSize() << " bytes, pruned " << pruned.getModelSize() << " bytes" << endl;
+	cout << "Predict     dense " << PredictTime(dense, dataset, 5) << " us, pruned " << PredictTime(pruned, dataset, 5)
+		<< " us per sample" << endl;
+	cout << "RMS error   dense " << PredictError(dense, dataset) << ", pruned " << PredictError(pruned, dataset) << endl;
+	cout << endl;
+	remove("pruning.dataset");
+}
+
+void CheckRandom() {
+	PrintHeader("Random numbers");
+	// known answers of philox4x32-10 from the test vectors of Random123
+	struct KnownAnswer {
+		uint64_t key;
+		Philox::Block counter;
+		Philox::Block expected;
+	};
+	KnownAnswer const answers[] = {
+		{ 0, { { 0, 0, 0, 0 } }, { { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } } },
+		{ 0xffffffffffffffff, { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff } },
+			{ { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } } },
+		{ 0x299f31d0a4093822, { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } },
+			{ { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } } }
+	};
+	for (auto& answer : answers) {
+		if (Philox(answer.key)(answer.counter) != answer.expected) {
+			PrintError("Main::CheckRandom", "Philox differs from the known answer of key " + to_string(answer.key));
+			return;
+		}
+	}
+	PrintInfo("Philox matches the known answers");
+
+	// the counter-based initializers give the same weights on any number of threads, the
+	// hidden layers have several blocks of neurons, which don't divide by the threads
+	LayerSizes const layerSizes = { 16, 300, 100, 4 };
+	Activations const activations(layerSizes.size() - 1, Activation::Tanh);
+	for (Initializer const type : { Initializer::XavierUniform, Initializer::HeNormal }) {
+		NeuralNet single(layerSizes, activations, initializer::Make(type, 5), RealVal);
+		for (size_t const numThreads : { 2, 3, 8 }) {
+			NeuralNet parallel(layerSizes, activations, RealVal);
+			parallel.SetThreads(numThreads);
+			parallel.Initialize(initializer::Make(type, 5));
+			if (!SameWeights(single, parallel)) {
+				PrintError("Main::CheckRandom", "The weights drawn on " + to_string(numThreads) +
+					" threads differ from the ones of 1 thread");
+				return;
+			}
 		}
 	}
+	PrintInfo("Initialize draws the same weights on 1, 2, 3 and 8 threads");
+}
+
+void CheckThreads(size_t const maxRuns) {
+	PrintHeader("Threads");
+	// the batch doesn't divide by the number of threads
+	size_t const count = 1024, batchSize = 37, numThreads = 4;
+	WriteSmoothDataset("threads.dataset", count);
+	Dataset<float> const dataset("threads.dataset");
+
+	// synchronous batches give the same weights on one and on several threads
+	LayerSizes const layerSizes = { dataset.getInputSize(), 64, 32, dataset.getOutputSize() };
+	FloatNeuralNet single(layerSizes, Activations(layerSizes.size() - 1, Activation::Tanh),
+		initializer::Make(Initializer::XavierUniform, 3), RealVal, batchSize);
+	optimizer::Settings settings = optimizer::Defaults(Optimizer::Adam);
+	settings.learningRate = 0.003;
+	single.setOptimizer(settings);
+	FloatNeuralNet parallel(single);
+	parallel.SetThreads(numThreads);
+	for (size_t runs = 0; runs + batchSize <= maxRuns; runs += batchSize) {
+		size_t const sample = runs % (count - batchSize);
+		single.TrainBatch(dataset.getInputs(sample), dataset.getTargets(sample), batchSize);
+		parallel.TrainBatch(dataset.getInputs(sample), dataset.getTargets(sample), batchSize);
+	}
+	if (SameWeights(single, parallel) && single.getRecentError() == parallel.getRecentError()) {
+		PrintInfo("Synchronous batches on 1 and " + to_string(numThreads) + " threads give the same weights");
+	}
+	else PrintError("Main::CheckThreads", "Synchronous batches on 1 and " + to_string(numThreads) +
+		" threads give different weights");
+	remove("threads.dataset");
+
+	// Hogwild has to learn XOR even though the updates of the threads race
+	double const inputs[] = { 0,0, 1,0, 0,1, 1,1 };
+	double const targets[] = { 0, 1, 1, 0 };
+	size_t const repeats = 4;
+	vector<double> batchInputs, batchTargets;
+	for (size_t r = 0; r < repeats; ++r) {
+		batchInputs.insert(batchInputs.end(), inputs, inputs + 8);
+		batchTargets.insert(batchTargets.end(), targets, targets + 4);
+	}
+	srand(1);
+	NeuralNet hogwild({ 2, 4, 1 }, RealVal, 4 * repeats);
+	optimizer::Settings sgd = optimizer::Defaults(Optimizer::Sgd);
+	sgd.learningRate = 0.15;
+	hogwild.setOptimizer(sgd);
+	hogwild.SetThreads(numThreads, TrainingMode::Hogwild);
+	size_t batches = 0;
+	while (batches < maxRuns && !(batches > 0 && hogwild.getRecentError() < 0.05)) {
+		hogwild.TrainBatch(batchInputs.data(), batchTargets.data(), 4 * repeats);
+		++batches;
+	}
+	if (hogwild.getRecentError() < 0.05) PrintInfo("Hogwild learned XOR in " + to_string(batches) + " batches");
+	else PrintError("Main::CheckThreads", "Hogwild didn't learn XOR in " + to_string(batches) + " batches");
+
+	// a task that throws leaves ParallelFor with its exception after the other indices
+	ThreadPool pool(numThreads);
+	try {
+		pool.ParallelFor(1000, [](size_t index) { if (index == 10) throw string("Task failed"); });
+		PrintError("Main::CheckThreads", "The exception of a task was lost");
+	}
+	catch (string const& error) {
+		PrintInfo("ParallelFor rethrows \"" + error + "\"");
+	}
+
+	// the work stealing pool passes any exception of a task on to Wait
+	WorkStealingPool tasks(numThreads);
+	for (size_t i = 0; i < 100; ++i) {
+		tasks.Submit([i]() { if (i == 10) throw out_of_range("Task failed"); });
+	}
+	try {
+		tasks.Wait();
+		PrintError("Main::CheckThreads", "The exception of a task was lost");
+	}
+	catch (out_of_range const& error) {
+		PrintInfo("WorkStealingPool::Wait rethrows \"" + string(error.what()) + "\"");
+	}
+	cout << endl;
+}
+
+void CheckQuantization(size_t const maxRuns) {
+	PrintHeader("Quantization");
+	size_t const inputSize = 16, outputSize = 4, count = 2048, batchSize = 32, calibrationCount = 256;
+	WriteSmoothDataset("quantization.dataset", count);
+	Dataset<float> const dataset("quantization.dataset");
+
+	LayerSizes const layerSizes = { inputSize, 256, 256, outputSize };
+	FloatNeuralNet net(layerSizes, Activations(layerSizes.size() - 1, Activation::Clip),
+		initializer::Make(Initializer::XavierUniform, 2), RealVal, batchSize);
+	optimizer::Settings settings = optimizer::Defaults(Optimizer::Adam);
+	settings.learningRate = 0.003;
+	net.setOptimizer(settings);
+	for (size_t runs = 0; runs < maxRuns; runs += batchSize) {
+		net.TrainBatch(dataset.getInputs(runs % count), dataset.getTargets(runs % count), batchSize);
+	}
 
-	fileStream.close();
+	// calibrated with the first samples, compared on all of them
+	QuantizedNeuralNet<float> const perLayer(net, dataset.getInputs(0), calibrationCount, RealVal,
+		quantization::Granularity::PerLayer);
+	QuantizedNeuralNet<float> const perChannel(net, dataset.getInputs(0), calibrationCount, RealVal,
+		quantization::Granularity::PerChannel);
+	quantization::Report const layerReport = perLayer.Compare(net, dataset);
+	quantization::Report const channelReport = perChannel.Compare(net, dataset);
+
+	cout << "Model size  float " << net.getModelSize() << " bytes, int8 " << perChannel.getModelSize() << " bytes" << endl;
+	cout << "Predict     float " << PredictTime(net, dataset, 5) << " us, int8 " << PredictTime(perChannel, dataset, 5)
+		<< " us per sample" << endl;
+	cout << "Per layer   max. delta " << layerReport.maxDelta << ", RMS delta " << layerReport.rmsDelta << endl;
+	cout << "Per channel max. delta " << channelReport.maxDelta << ", RMS delta " << channelReport.rmsDelta << endl;
+	cout << "RMS error   float " << channelReport.referenceError << ", int8 " << channelReport.quantizedError << endl;
 	cout << endl;
+	remove("quantization.dataset");
 }
 
 int main(){
 	// initialize random generator
 	srand(time(NULL));
 
-	TrainNet("tanh_etaback1.csv", 800);
-	TrainNet("tanh_etaback2.csv", 800);
-	TrainNet("tanh_etaback3.csv", 800);
+	if (allocations::isEnabled()) {
+		CheckAllocations(1000);
+	}
+	if (profiling::isEnabled()) {
+		ProfileTraining(200);
+	}
+	CheckKernels();
+	CheckActivations();
+	CheckStaticNet(2000);
+	CheckFloatNet(20000, 0.05);
+	CheckHardwareModel("../sim/vhdl-sfixed-fixedeta.csv", 200);
+	CheckModelFile("xor.model");
+	CheckRandom();
+	CheckThreads(20000);
+
+	WriteXorDataset("xor.dataset");
+	{
+		Dataset<double> const dataset("xor.dataset");
+		TrainNet("tanh_etaback1.csv", dataset, 800);
+		TrainNet("tanh_etaback2.csv", dataset, 800);
+		TrainNet("tanh_etaback3.csv", dataset, 800);
+		TrainWithValidation(dataset, 0.05);
+	}
+	remove("xor.dataset");
+	CheckPruning(0.9, 20000);
+	CheckQuantization(20000);
+
+	// last, it seeds the random generator of every run
+	CompareOptimizers(20, 5000, 0.05);
 
-	return 0;
+	// a failed check makes the run fail
+	return (GetErrorCount() == 0) ? 0 : 1;
 }
\ No newline at end of file